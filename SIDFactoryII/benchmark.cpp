@@ -0,0 +1,608 @@
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libraries/ghc/fs_std.h"
+#include "libraries/residfp/SID.h"
+#include "libraries/residfp/resample/SincResampler.h"
+#include "runtime/editor/driver/driver_info.h"
+#include "runtime/environmentdefines.h"
+#include "runtime/emulation/cpuframecapture.h"
+#include "runtime/emulation/cpumemory.h"
+#include "runtime/emulation/cpumos6510.h"
+#include "runtime/emulation/cpuprofiler.h"
+#include "runtime/execution/offlinerenderer.h"
+#include "utils/global.h"
+
+using namespace Emulation;
+using namespace Utility;
+
+// Measures the emulation throughput of the bundled drivers and music, without a window or audio device. The cost of
+// the driver updates on the 6510, of clocking the SID and of rendering end to end are measured separately, so a
+// regression shows up in the part of the emulation it was made in.
+
+namespace
+{
+	struct BenchmarkOptions
+	{
+		std::vector<std::string> m_Paths;
+		unsigned int m_FrameCount = 50 * 60 * 5;
+		bool m_Profile = false;
+		bool m_SID = false;
+		bool m_EndToEnd = false;
+		std::string m_JSONFile;
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: sf2benchmark [options] [<file or folder> ...]" << std::endl
+			<< std::endl
+			<< "Default is the drivers and music folders next to the executable" << std::endl
+			<< std::endl
+			<< "  -n <frames>        Number of driver updates to run per file, default is 15000" << std::endl
+			<< "  -p                 Profile the update routine and print a report per file" << std::endl
+			<< "  -s                 Measure clocking the SID with the writes of each frame, write by write and batched, decimating" << std::endl
+			<< "                     and resampling, and check the SIMD resampler kernels against the scalar one" << std::endl
+			<< "  -e                 Measure rendering end to end, interpolating and resampling" << std::endl
+			<< "  -j <file.json>     Also write the results to a JSON file" << std::endl;
+	}
+
+	bool ParseOptions(int inArgc, char* inArgv[], BenchmarkOptions& outOptions)
+	{
+		for (int i = 1; i < inArgc; ++i)
+		{
+			const std::string argument(inArgv[i]);
+
+			if (argument == "-n" && i + 1 < inArgc)
+				outOptions.m_FrameCount = static_cast<unsigned int>(std::stoul(inArgv[++i]));
+			else if (argument == "-p")
+				outOptions.m_Profile = true;
+			else if (argument == "-s")
+				outOptions.m_SID = true;
+			else if (argument == "-e")
+				outOptions.m_EndToEnd = true;
+			else if (argument == "-j" && i + 1 < inArgc)
+				outOptions.m_JSONFile = inArgv[++i];
+			else if (argument.size() > 1 && argument[0] == '-')
+				return false;
+			else
+				outOptions.m_Paths.push_back(argument);
+		}
+
+		return outOptions.m_FrameCount > 0;
+	}
+
+	void CollectFiles(const fs::path& inPath, std::vector<std::string>& outFiles)
+	{
+		std::error_code error_code;
+
+		if (fs::is_directory(inPath, error_code))
+		{
+			std::vector<std::string> files;
+
+			for (const auto& entry : fs::recursive_directory_iterator(inPath, error_code))
+			{
+				const std::string extension = entry.path().extension().string();
+				if (entry.is_regular_file() && (extension == ".prg" || extension == ".sf2"))
+					files.push_back(entry.path().string());
+			}
+
+			std::sort(files.begin(), files.end());
+			outFiles.insert(outFiles.end(), files.begin(), files.end());
+		}
+		else if (fs::is_regular_file(inPath, error_code))
+			outFiles.push_back(inPath.string());
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	struct CPUResult
+	{
+		unsigned long long m_Cycles = 0;
+		unsigned int m_Frames = 0;
+		double m_Seconds = 0.0;
+	};
+
+	// Run the update routine of the driver, the same way the execution handler does it for every frame. If a
+	// profiler is passed, only the update routine is profiled
+	CPUResult BenchmarkCPU(OfflineRenderer& inRenderer, unsigned int inFrameCount, CPUProfiler* inProfiler)
+	{
+		const Editor::DriverInfo::DriverCommon& driver_common = inRenderer.GetDriverInfo().GetDriverCommon();
+
+		CPUmos6510 cpu;
+		CPUMemory& memory = inRenderer.GetMemory();
+		CPUResult result;
+
+		inRenderer.Start(inRenderer.GetSelectedSong());
+
+		memory.Lock();
+		cpu.SetMemory(&memory);
+
+		{
+			CPUFrameCapture frame_capture(&cpu, 0xd400, 0xd418, EMULATION_CYCLES_PER_FRAME_PAL);
+			frame_capture.Capture(driver_common.m_InitAddress, inRenderer.GetSelectedSong());
+		}
+
+		cpu.SetProfiler(inProfiler);
+
+		const auto start_time = std::chrono::steady_clock::now();
+
+		for (unsigned int i = 0; i < inFrameCount; ++i)
+		{
+			CPUFrameCapture frame_capture(&cpu, 0xd400, 0xd418, EMULATION_CYCLES_PER_FRAME_PAL);
+			frame_capture.Capture(driver_common.m_UpdateAddress, 0);
+
+			result.m_Cycles += frame_capture.GetCyclesSpend();
+			++result.m_Frames;
+
+			if (frame_capture.IsMaxCycleCountReached())
+				break;
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+		result.m_Seconds = elapsed.count();
+
+		memory.Unlock();
+
+		return result;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	struct SIDFrame
+	{
+		unsigned int m_Cycles;
+		std::vector<reSIDfp::RegisterWrite> m_Writes;
+	};
+
+	struct SIDResult
+	{
+		double m_Seconds = 0.0;
+		std::vector<short> m_Output;
+	};
+
+	// Capture the writes to the SID registers of every frame, the input for clocking the SID
+	std::vector<SIDFrame> CaptureSIDFrames(OfflineRenderer& inRenderer, unsigned int inFrameCount)
+	{
+		const Editor::DriverInfo::DriverCommon& driver_common = inRenderer.GetDriverInfo().GetDriverCommon();
+
+		CPUmos6510 cpu;
+		CPUMemory& memory = inRenderer.GetMemory();
+		std::vector<SIDFrame> frames;
+
+		inRenderer.Start(inRenderer.GetSelectedSong());
+
+		memory.Lock();
+		cpu.SetMemory(&memory);
+
+		{
+			CPUFrameCapture frame_capture(&cpu, 0xd400, 0xd418, EMULATION_CYCLES_PER_FRAME_PAL);
+			frame_capture.Capture(driver_common.m_InitAddress, inRenderer.GetSelectedSong());
+		}
+
+		for (unsigned int i = 0; i < inFrameCount; ++i)
+		{
+			CPUFrameCapture frame_capture(&cpu, 0xd400, 0xd418, EMULATION_CYCLES_PER_FRAME_PAL);
+			frame_capture.Capture(driver_common.m_UpdateAddress, 0);
+
+			if (frame_capture.IsMaxCycleCountReached())
+				break;
+
+			SIDFrame frame;
+			frame.m_Cycles = EMULATION_CYCLES_PER_FRAME_PAL;
+
+			while (frame_capture.HasNext())
+			{
+				const CPUFrameCapture::WriteCapture& write = frame_capture.GetNext();
+				frame.m_Writes.push_back({ static_cast<unsigned int>(write.m_iCycle), static_cast<unsigned char>(write.m_usReg - 0xd400), write.m_ucVal });
+			}
+
+			frames.push_back(std::move(frame));
+		}
+
+		memory.Unlock();
+
+		return frames;
+	}
+
+	// Clock a SID through the captured frames, either by clocking up to each write and writing it, the way the
+	// SID proxy used to do it, or by passing the writes of the frame to the SID in a single call
+	SIDResult BenchmarkSID(const std::vector<SIDFrame>& inFrames, reSIDfp::SamplingMethod inSamplingMethod, bool inBatched)
+	{
+		reSIDfp::SID sid;
+		SIDResult result;
+
+		sid.reset();
+		sid.setSamplingParameters(static_cast<double>(EMULATION_CYCLES_PER_SECOND_PAL), inSamplingMethod, 44100.0, 20000.0);
+		sid.setChipModel(reSIDfp::MOS6581);
+
+		std::vector<short> buffer(EMULATION_CYCLES_PER_FRAME_PAL);
+		result.m_Output.reserve(inFrames.size() * 44100 / 50 + 1);
+
+		const auto start_time = std::chrono::steady_clock::now();
+
+		for (const SIDFrame& frame : inFrames)
+		{
+			int sample_count = 0;
+
+			if (inBatched)
+				sample_count = sid.clock(frame.m_Writes.data(), static_cast<unsigned int>(frame.m_Writes.size()), frame.m_Cycles, &buffer[0]);
+			else
+			{
+				unsigned int cycle = 0;
+
+				for (const reSIDfp::RegisterWrite& write : frame.m_Writes)
+				{
+					sample_count += sid.clock(write.cycle - cycle, &buffer[sample_count]);
+					sid.write(write.offset, write.value);
+
+					cycle = write.cycle;
+				}
+
+				if (cycle < frame.m_Cycles)
+					sample_count += sid.clock(frame.m_Cycles - cycle, &buffer[sample_count]);
+			}
+
+			result.m_Output.insert(result.m_Output.end(), buffer.begin(), buffer.begin() + sample_count);
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+		result.m_Seconds = elapsed.count();
+
+		return result;
+	}
+
+	// Check that the SIMD convolution kernels of the resampler return exactly what the scalar kernel does, for every
+	// filter length up to well past the ones the resampler uses and every alignment of the samples and the filter
+	bool CheckConvolveKernels()
+	{
+		const int MaxLength = 3000;
+		const int MaxOffset = 16;
+
+		std::mt19937 random(0x5f2);
+		std::uniform_int_distribution<int> distribution(-32768, 32767);
+
+		std::vector<short> samples(MaxLength + MaxOffset);
+		std::vector<short> filter(MaxLength + MaxOffset);
+
+		for (short& value : samples)
+			value = static_cast<short>(distribution(random));
+		for (short& value : filter)
+			value = static_cast<short>(distribution(random));
+
+		const std::vector<reSIDfp::ConvolveKernel> kernels = reSIDfp::getSIMDConvolveKernels();
+
+		if (kernels.empty())
+		{
+			std::cout << "Resampler kernels: no SIMD kernels supported" << std::endl;
+			return true;
+		}
+
+		bool is_identical = true;
+
+		for (const reSIDfp::ConvolveKernel& kernel : kernels)
+		{
+			unsigned int mismatch_count = 0;
+
+			for (int length = 0; length <= MaxLength; ++length)
+			{
+				for (int sample_offset = 0; sample_offset < MaxOffset; ++sample_offset)
+				{
+					for (int filter_offset = 0; filter_offset < MaxOffset; ++filter_offset)
+					{
+						const short* a = &samples[sample_offset];
+						const short* b = &filter[filter_offset];
+
+						if (kernel.convolve(a, b, length) != reSIDfp::convolveScalar(a, b, length))
+							++mismatch_count;
+					}
+				}
+			}
+
+			std::cout << "Resampler kernels: " << kernel.name << " "
+				<< (mismatch_count == 0 ? "is identical to" : "DIFFERS FROM") << " the scalar kernel for lengths 0 to " << MaxLength
+				<< " at all " << MaxOffset * MaxOffset << " alignments";
+
+			if (mismatch_count > 0)
+				std::cout << " (" << mismatch_count << " mismatches)";
+
+			std::cout << std::endl;
+
+			is_identical = is_identical && mismatch_count == 0;
+		}
+
+		return is_identical;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	struct EndToEndResult
+	{
+		unsigned int m_Frames = 0;
+		double m_Seconds = 0.0;
+		double m_FramesPerSecond = 0.0;		// Frames per second of the song, to compare the rendering speed to realtime
+	};
+
+	// Render the selected song through the execution handler and the SID proxy, as the editor plays it
+	EndToEndResult BenchmarkEndToEnd(OfflineRenderer& inRenderer, unsigned int inFrameCount)
+	{
+		EndToEndResult result;
+
+		const bool is_pal = inRenderer.GetEnvironment() == SID_ENVIRONMENT_PAL;
+		result.m_FramesPerSecond = is_pal ? EMULATION_FRAMES_PER_SECOND_PAL : EMULATION_FRAMES_PER_SECOND_NTSC;
+
+		const unsigned int samples_per_frame = static_cast<unsigned int>(inRenderer.GetSampleFrequency() / result.m_FramesPerSecond);
+		std::vector<short> buffer(samples_per_frame * inRenderer.GetOutputChannelCount());
+
+		inRenderer.Start(inRenderer.GetSelectedSong());
+
+		const auto start_time = std::chrono::steady_clock::now();
+
+		while (result.m_Frames < inFrameCount && !inRenderer.HasDriverStopped() && !inRenderer.IsInErrorState())
+		{
+			inRenderer.Render(&buffer[0], samples_per_frame);
+			++result.m_Frames;
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start_time;
+		result.m_Seconds = elapsed.count();
+
+		return result;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	struct FileResult
+	{
+		std::string m_File;
+		CPUResult m_CPU;
+
+		bool m_HasSID = false;
+		unsigned int m_SIDFrames = 0;
+		double m_SIDPerWriteSeconds = 0.0;
+		double m_SIDDecimateSeconds = 0.0;
+		double m_SIDResampleSeconds = 0.0;
+		bool m_SIDOutputDiffers = false;
+
+		bool m_HasEndToEnd = false;
+		EndToEndResult m_EndToEndInterpolate;
+		EndToEndResult m_EndToEndResample;
+	};
+
+	double PerSecond(double inCount, double inSeconds)
+	{
+		return inSeconds > 0.0 ? inCount / inSeconds : 0.0;
+	}
+
+	std::string EscapeJSON(const std::string& inString)
+	{
+		std::ostringstream output;
+
+		for (const char character : inString)
+		{
+			if (character == '"' || character == '\\')
+				output << '\\' << character;
+			else if (static_cast<unsigned char>(character) < 0x20)
+				output << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character) << std::dec;
+			else
+				output << character;
+		}
+
+		return output.str();
+	}
+
+	void WriteEndToEndJSON(std::ostream& inOutput, const EndToEndResult& inResult)
+	{
+		inOutput << "{ \"frames\": " << inResult.m_Frames
+			<< ", \"frames_per_second\": " << PerSecond(inResult.m_Frames, inResult.m_Seconds)
+			<< ", \"realtime\": " << PerSecond(inResult.m_Frames / inResult.m_FramesPerSecond, inResult.m_Seconds) << " }";
+	}
+
+	void WriteJSON(std::ostream& inOutput, const std::string& inCore, const BenchmarkOptions& inOptions, const std::vector<FileResult>& inResults, unsigned long long inTotalCycles, double inTotalSeconds)
+	{
+		inOutput << std::fixed << std::setprecision(2)
+			<< "{" << std::endl
+			<< "  \"core\": \"" << inCore << "\"," << std::endl
+			<< "  \"frame_count\": " << inOptions.m_FrameCount << "," << std::endl
+			<< "  \"total_mcycles_per_second\": " << PerSecond(static_cast<double>(inTotalCycles) / 1000000.0, inTotalSeconds) << "," << std::endl
+			<< "  \"files\": [";
+
+		for (size_t i = 0; i < inResults.size(); ++i)
+		{
+			const FileResult& result = inResults[i];
+
+			inOutput << (i == 0 ? "" : ",") << std::endl
+				<< "    {" << std::endl
+				<< "      \"file\": \"" << EscapeJSON(result.m_File) << "\"," << std::endl
+				<< "      \"cpu\": { \"updates\": " << result.m_CPU.m_Frames
+				<< ", \"cycles_per_update\": " << (result.m_CPU.m_Frames > 0 ? static_cast<double>(result.m_CPU.m_Cycles) / result.m_CPU.m_Frames : 0.0)
+				<< ", \"mcycles_per_second\": " << PerSecond(static_cast<double>(result.m_CPU.m_Cycles) / 1000000.0, result.m_CPU.m_Seconds)
+				<< ", \"updates_per_second\": " << PerSecond(result.m_CPU.m_Frames, result.m_CPU.m_Seconds) << " }";
+
+			if (result.m_HasSID)
+			{
+				inOutput << "," << std::endl
+					<< "      \"sid\": { \"frames\": " << result.m_SIDFrames
+					<< ", \"per_write_frames_per_second\": " << PerSecond(result.m_SIDFrames, result.m_SIDPerWriteSeconds)
+					<< ", \"decimate_frames_per_second\": " << PerSecond(result.m_SIDFrames, result.m_SIDDecimateSeconds)
+					<< ", \"resample_frames_per_second\": " << PerSecond(result.m_SIDFrames, result.m_SIDResampleSeconds)
+					<< ", \"output_differs\": " << (result.m_SIDOutputDiffers ? "true" : "false") << " }";
+			}
+
+			if (result.m_HasEndToEnd)
+			{
+				inOutput << "," << std::endl << "      \"end_to_end\": { \"interpolate\": ";
+				WriteEndToEndJSON(inOutput, result.m_EndToEndInterpolate);
+				inOutput << ", \"resample\": ";
+				WriteEndToEndJSON(inOutput, result.m_EndToEndResample);
+				inOutput << " }";
+			}
+
+			inOutput << std::endl << "    }";
+		}
+
+		inOutput << std::endl << "  ]" << std::endl << "}" << std::endl;
+	}
+}
+
+int main(int inArgc, char* inArgv[])
+{
+	BenchmarkOptions options;
+
+	if (!ParseOptions(inArgc, inArgv, options))
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	if (options.m_Paths.empty())
+	{
+		const fs::path application_path = fs::path(inArgv[0]).parent_path();
+
+		options.m_Paths.push_back((application_path / "drivers").string());
+		options.m_Paths.push_back((application_path / "music").string());
+	}
+
+	std::vector<std::string> files;
+	for (const std::string& path : options.m_Paths)
+		CollectFiles(path, files);
+
+	if (files.empty())
+	{
+		std::cerr << "No files found" << std::endl;
+		return -1;
+	}
+
+	Global& global = Global::instance();
+	int result = 0;
+
+	{
+		OfflineRenderer renderer(SIDConfiguration{});
+		CPUProfiler profiler(&global.GetPlatform());
+
+		SIDConfiguration resample_configuration;
+		resample_configuration.m_eSampleMethod = SID_SAMPLE_METHOD_RESAMPLE_INTERPOLATE;
+
+		std::unique_ptr<OfflineRenderer> resample_renderer;
+		if (options.m_EndToEnd)
+			resample_renderer = std::make_unique<OfflineRenderer>(resample_configuration);
+
+		unsigned long long total_cycles = 0;
+		double total_seconds = 0.0;
+
+		std::vector<FileResult> file_results;
+
+#if defined(_SF2_CPU_TABLE_DISPATCH)
+		const std::string core = "table dispatch";
+#else
+		const std::string core = "switch dispatch";
+#endif
+		std::cout << "6510 core: " << core << std::endl;
+
+		if (options.m_SID && !CheckConvolveKernels())
+			result = -1;
+
+		for (const std::string& file : files)
+		{
+			if (!renderer.Load(file) || (resample_renderer != nullptr && !resample_renderer->Load(file)))
+			{
+				std::cerr << file << " is not a valid sf2 file or driver" << std::endl;
+				result = -1;
+				continue;
+			}
+
+			profiler.Reset();
+
+			FileResult file_result;
+			file_result.m_File = file;
+
+			const CPUResult cpu_result = BenchmarkCPU(renderer, options.m_FrameCount, options.m_Profile ? &profiler : nullptr);
+			file_result.m_CPU = cpu_result;
+
+			total_cycles += cpu_result.m_Cycles;
+			total_seconds += cpu_result.m_Seconds;
+
+			std::cout << fs::path(file).filename().string() << ": "
+				<< cpu_result.m_Frames << " updates, "
+				<< std::fixed << std::setprecision(1) << static_cast<double>(cpu_result.m_Cycles) / cpu_result.m_Frames << " cycles/update, "
+				<< std::setprecision(2) << static_cast<double>(cpu_result.m_Cycles) / cpu_result.m_Seconds / 1000000.0 << " Mcycles/s"
+				<< std::endl;
+
+			if (options.m_Profile)
+			{
+				std::cout << std::endl;
+				profiler.WriteReport(std::cout);
+				std::cout << std::endl;
+			}
+
+			if (options.m_SID)
+			{
+				const std::vector<SIDFrame> sid_frames = CaptureSIDFrames(renderer, options.m_FrameCount);
+
+				const SIDResult per_write_result = BenchmarkSID(sid_frames, reSIDfp::DECIMATE, false);
+				const SIDResult batched_result = BenchmarkSID(sid_frames, reSIDfp::DECIMATE, true);
+				const SIDResult resample_result = BenchmarkSID(sid_frames, reSIDfp::RESAMPLE, true);
+
+				file_result.m_HasSID = true;
+				file_result.m_SIDFrames = static_cast<unsigned int>(sid_frames.size());
+				file_result.m_SIDPerWriteSeconds = per_write_result.m_Seconds;
+				file_result.m_SIDDecimateSeconds = batched_result.m_Seconds;
+				file_result.m_SIDResampleSeconds = resample_result.m_Seconds;
+				file_result.m_SIDOutputDiffers = per_write_result.m_Output != batched_result.m_Output;
+
+				std::cout << "  SID: " << std::fixed << std::setprecision(0)
+					<< PerSecond(sid_frames.size(), per_write_result.m_Seconds) << " frames/s write by write, "
+					<< PerSecond(sid_frames.size(), batched_result.m_Seconds) << " frames/s batched, "
+					<< PerSecond(sid_frames.size(), resample_result.m_Seconds) << " frames/s batched resampling"
+					<< (file_result.m_SIDOutputDiffers ? ", OUTPUT DIFFERS" : "") << std::endl;
+
+				if (file_result.m_SIDOutputDiffers)
+					result = -1;
+			}
+
+			if (options.m_EndToEnd)
+			{
+				file_result.m_HasEndToEnd = true;
+				file_result.m_EndToEndInterpolate = BenchmarkEndToEnd(renderer, options.m_FrameCount);
+				file_result.m_EndToEndResample = BenchmarkEndToEnd(*resample_renderer, options.m_FrameCount);
+
+				const EndToEndResult& interpolate = file_result.m_EndToEndInterpolate;
+				const EndToEndResult& resample = file_result.m_EndToEndResample;
+
+				std::cout << "  End to end: " << std::fixed << std::setprecision(0)
+					<< PerSecond(interpolate.m_Frames, interpolate.m_Seconds) << " frames/s interpolating ("
+					<< std::setprecision(1) << PerSecond(interpolate.m_Frames / interpolate.m_FramesPerSecond, interpolate.m_Seconds) << "x realtime), "
+					<< std::setprecision(0) << PerSecond(resample.m_Frames, resample.m_Seconds) << " frames/s resampling ("
+					<< std::setprecision(1) << PerSecond(resample.m_Frames / resample.m_FramesPerSecond, resample.m_Seconds) << "x realtime)" << std::endl;
+			}
+
+			file_results.push_back(file_result);
+		}
+
+		if (total_seconds > 0.0)
+			std::cout << "Total: " << std::fixed << std::setprecision(2) << static_cast<double>(total_cycles) / total_seconds / 1000000.0 << " Mcycles/s" << std::endl;
+
+		if (!options.m_JSONFile.empty())
+		{
+			std::ofstream json_file(options.m_JSONFile);
+			WriteJSON(json_file, core, options, file_results, total_cycles, total_seconds);
+
+			if (!json_file)
+			{
+				std::cerr << "Could not write " << options.m_JSONFile << std::endl;
+				result = -1;
+			}
+		}
+	}
+
+	global.deletePlatform();
+
+	return result;
+}
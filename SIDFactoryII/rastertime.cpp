@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libraries/ghc/fs_std.h"
+#include "runtime/editor/driver/driver_info.h"
+#include "runtime/emulation/sid/sidproxydefines.h"
+#include "runtime/execution/rastertimeanalyzer.h"
+#include "utils/global.h"
+
+using namespace Emulation;
+using namespace Utility;
+
+// Worst case rastertime analysis, runs every frame of every song of sf2 files until the order lists loop, and
+// reports the peak and 95th percentile cycles spend by the driver update, with the positions causing them.
+
+namespace
+{
+	struct AnalyzeOptions
+	{
+		std::vector<std::string> m_InputFiles;
+
+		unsigned int m_MaxFrameCount = 50 * 60 * 30;
+		unsigned int m_ThreadCount = 0;			// 0: number of hardware threads
+		unsigned int m_WorstFrameCount = 8;
+		double m_BudgetRasterlines = 0.0;		// 0: no budget
+
+		bool m_HasEnvironment = false;
+		SIDEnvironment m_Environment = SID_ENVIRONMENT_PAL;
+	};
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: sf2rastertime [options] <file.sf2> [<file.sf2> ...]" << std::endl
+			<< std::endl
+			<< "  -n <frames>        Maximum number of frames per song, default is 90000 (30 minutes)" << std::endl
+			<< "  -j <threads>       Number of songs analyzed in parallel, default is the number of hardware threads" << std::endl
+			<< "  -w <count>         Number of worst frames listed per song, default is 8" << std::endl
+			<< "  -b <rasterlines>   Raster budget. Returns an error if the peak of any song exceeds it" << std::endl
+			<< "  -r <pal|ntsc>      Override the region of the file" << std::endl;
+	}
+
+	bool ParseOptions(int inArgc, char* inArgv[], AnalyzeOptions& outOptions)
+	{
+		for (int i = 1; i < inArgc; ++i)
+		{
+			const std::string argument(inArgv[i]);
+			const bool has_value = i + 1 < inArgc;
+
+			if (argument == "-h" || argument == "--help")
+				return false;
+			else if (argument.size() == 2 && argument[0] == '-')
+			{
+				if (!has_value)
+					return false;
+
+				const std::string value(inArgv[++i]);
+
+				switch (argument[1])
+				{
+				case 'n':
+					outOptions.m_MaxFrameCount = static_cast<unsigned int>(std::stoul(value));
+					break;
+				case 'j':
+					outOptions.m_ThreadCount = static_cast<unsigned int>(std::stoul(value));
+					break;
+				case 'w':
+					outOptions.m_WorstFrameCount = static_cast<unsigned int>(std::stoul(value));
+					break;
+				case 'b':
+					outOptions.m_BudgetRasterlines = std::stod(value);
+					break;
+				case 'r':
+					outOptions.m_HasEnvironment = true;
+					outOptions.m_Environment = (value == "ntsc" || value == "NTSC") ? SID_ENVIRONMENT_NTSC : SID_ENVIRONMENT_PAL;
+					break;
+				default:
+					return false;
+				}
+			}
+			else
+				outOptions.m_InputFiles.push_back(argument);
+		}
+
+		return !outOptions.m_InputFiles.empty() && outOptions.m_MaxFrameCount > 0;
+	}
+
+	std::string GetPositionString(const RasterTimeAnalyzer::Frame& inFrame, int inTrackCount)
+	{
+		std::stringstream stream;
+
+		stream << std::hex << std::setfill('0');
+
+		for (int i = 0; i < inTrackCount; ++i)
+		{
+			const RasterTimeAnalyzer::TrackPosition& position = inFrame.m_Tracks[i];
+
+			// Order list entry, sequence and the offset into it, all in hex as shown in the editor
+			stream << (i > 0 ? "  " : "")
+				<< std::setw(2) << static_cast<int>(position.m_OrderListEntry) << ':'
+				<< std::setw(2) << static_cast<int>(position.m_Sequence) << '.'
+				<< std::setw(2) << static_cast<int>(position.m_SequenceIndex);
+		}
+
+		return stream.str();
+	}
+
+	void PrintFrame(const std::string& inLabel, const RasterTimeAnalyzer::Frame& inFrame, const RasterTimeAnalyzer& inAnalyzer, int inTrackCount)
+	{
+		std::cout << "  " << std::left << std::setw(10) << inLabel << std::right
+			<< std::setw(6) << inFrame.m_Cycles << " cycles"
+			<< std::setw(7) << std::fixed << std::setprecision(1) << static_cast<double>(inFrame.m_Cycles) / inAnalyzer.GetCyclesPerRasterline() << " lines"
+			<< "  frame " << std::setw(6) << inFrame.m_FrameIndex
+			<< "  " << GetPositionString(inFrame, inTrackCount) << std::endl;
+	}
+
+	// Returns false if a song exceeds the budget
+	bool PrintSongResult(const RasterTimeAnalyzer::SongResult& inResult, const RasterTimeAnalyzer& inAnalyzer, const AnalyzeOptions& inOptions)
+	{
+		const int track_count = std::min(static_cast<int>(inAnalyzer.GetDriverInfo().GetMusicData().m_TrackCount), RasterTimeAnalyzer::MaxTrackCount);
+		const double peak_rasterlines = static_cast<double>(inResult.m_PeakFrame.m_Cycles) / inAnalyzer.GetCyclesPerRasterline();
+		const bool is_within_budget = inOptions.m_BudgetRasterlines <= 0.0 || peak_rasterlines <= inOptions.m_BudgetRasterlines;
+
+		std::cout << " Song " << (inResult.m_SongIndex + 1);
+		if (!inResult.m_SongName.empty())
+			std::cout << " (" << inResult.m_SongName << ")";
+
+		std::cout << ": " << inResult.m_FrameCount << " frames, "
+			<< (inResult.m_HasLooped ? "looped" : inResult.m_HasStopped ? "stopped" : inResult.m_HasReachedMaxCycles ? "update exceeded a frame" : "did not loop")
+			<< ", average " << std::fixed << std::setprecision(1) << inResult.m_AverageCycles << " cycles" << std::endl;
+
+		if (inResult.m_FrameCount == 0)
+			return true;
+
+		PrintFrame("Peak", inResult.m_PeakFrame, inAnalyzer, track_count);
+		PrintFrame("95%", inResult.m_Percentile95Frame, inAnalyzer, track_count);
+
+		for (size_t i = 0; i < inResult.m_WorstFrames.size(); ++i)
+			PrintFrame("#" + std::to_string(i + 1), inResult.m_WorstFrames[i], inAnalyzer, track_count);
+
+		if (!is_within_budget)
+			std::cout << "  Peak exceeds the budget of " << std::setprecision(1) << inOptions.m_BudgetRasterlines << " rasterlines" << std::endl;
+
+		return is_within_budget && !inResult.m_HasReachedMaxCycles;
+	}
+}
+
+int main(int inArgc, char* inArgv[])
+{
+	AnalyzeOptions options;
+
+	if (!ParseOptions(inArgc, inArgv, options))
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	Global& global = Global::instance();
+	int result = 0;
+
+	{
+		RasterTimeAnalyzer analyzer;
+
+		analyzer.SetMaxFrameCount(options.m_MaxFrameCount);
+		analyzer.SetThreadCount(options.m_ThreadCount);
+		analyzer.SetWorstFrameCount(options.m_WorstFrameCount);
+
+		if (options.m_HasEnvironment)
+			analyzer.OverrideEnvironment(options.m_Environment);
+
+		for (const std::string& input_file : options.m_InputFiles)
+		{
+			if (!analyzer.Load(input_file))
+			{
+				std::cerr << input_file << " is not a valid sf2 file" << std::endl;
+				result = -1;
+				continue;
+			}
+
+			std::cout << fs::path(input_file).filename().string()
+				<< (analyzer.GetEnvironment() == SID_ENVIRONMENT_PAL ? " (PAL)" : " (NTSC)")
+				<< ", positions per track are order list entry:sequence.event offset" << std::endl;
+
+			for (const RasterTimeAnalyzer::SongResult& song_result : analyzer.Analyze())
+			{
+				if (!PrintSongResult(song_result, analyzer, options))
+					result = -1;
+			}
+		}
+	}
+
+	global.deletePlatform();
+
+	return result;
+}
@@ -0,0 +1,615 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "libraries/ghc/fs_std.h"
+#include "runtime/editor/driver/driver_info.h"
+#include "runtime/emulation/sid/sidproxy.h"
+#include "runtime/emulation/sid/sidproxydefines.h"
+#include "runtime/emulation/sid/sidwritedump.h"
+#include "runtime/environmentdefines.h"
+#include "runtime/execution/executionhandler.h"
+#include "runtime/execution/offlinerenderer.h"
+#include "utils/config/configtypes.h"
+#include "utils/configfile.h"
+#include "utils/global.h"
+#include "utils/wavefilewriter.h"
+
+using namespace Emulation;
+using namespace Utility;
+using namespace Utility::Config;
+
+// Headless renderer, writes the songs of sf2 files to wave files as fast as the emulation allows.
+// No window or audio device is opened. SID write dumps (.sf2w) are rendered by playing the writes into the
+// SID chips directly.
+
+namespace
+{
+	struct RenderOptions
+	{
+		std::vector<std::string> m_InputFiles;
+		std::string m_OutputFile;
+		std::string m_OutputFolder;
+
+		int m_Song = -1;					// -1: the selected song of the file
+		bool m_AllSongs = false;
+		double m_Seconds = 180.0;
+		double m_SkipSeconds = 0.0;
+
+		bool m_HasModel = false;
+		SIDModel m_Model = SID_MODEL_6581;
+		bool m_HasEnvironment = false;
+		SIDEnvironment m_Environment = SID_ENVIRONMENT_PAL;
+
+		int m_SampleFrequency = 0;			// 0: use config
+		int m_SIDCount = 0;					// 0: use config
+		bool m_Stereo = false;
+		bool m_Fast = false;
+		bool m_WriteDump = false;
+		bool m_WriteVoices = false;
+	};
+
+	const char* DumpExtension = ".sf2w";
+
+	// Longest time that can be rendered or skipped. The sample count of an hour at the highest sample frequency fits
+	// in an unsigned int
+	const double MaxSeconds = 3600.0;
+
+	void PrintUsage()
+	{
+		std::cout << "Usage: sf2render [options] <file.sf2|file.sf2w> [<file.sf2|file.sf2w> ...]" << std::endl
+			<< std::endl
+			<< "  -o <file.wav>      Output file (single input and song only)" << std::endl
+			<< "  -d <folder>        Output folder, default is the folder of the input file" << std::endl
+			<< "  -s <song>          Song number to render, starting at 1. Default is the selected song" << std::endl
+			<< "  -a                 Render all songs" << std::endl
+			<< "  -t <seconds>       Maximum length in seconds, default is 180, at most 3600. Rendering stops early if the" << std::endl
+			<< "                     driver stops" << std::endl
+			<< "  -k <seconds>       Skip the start of the song, it is played without audio output" << std::endl
+			<< "  -m <6581|8580>     Override the SID model of the file" << std::endl
+			<< "  -r <pal|ntsc>      Override the region of the file" << std::endl
+			<< "  -f <frequency>     Output sample frequency from 11025 to 192000, default is Sound.Emulation.SampleFrequency" << std::endl
+			<< "  -c <1|2|3>         Number of SID chips, default is Sound.Emulation.SIDCount" << std::endl
+			<< "  -2                 Stereo output" << std::endl
+			<< "  -x                 Fast sampling (interpolate instead of resample)" << std::endl
+			<< "  -w                 Also write the SID writes of each song to a dump (" << DumpExtension << ") next to the wave file" << std::endl
+			<< "  -v                 Also write each voice, before the filter, to a wave file of its own next to the wave file" << std::endl
+			<< std::endl
+			<< "A dump is rendered with the region and number of SID chips it was written with, so -r, -c, -s, -a, -k and -w" << std::endl
+			<< "can not be used with " << DumpExtension << " files" << std::endl;
+	}
+
+	bool HasDumpInputFile(const RenderOptions& inOptions)
+	{
+		for (const std::string& input_file : inOptions.m_InputFiles)
+		{
+			if (fs::path(input_file).extension() == DumpExtension)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Returns the first option given that has no meaning for a dump, or nullptr if there is none
+	const char* GetOptionNotApplicableToDump(const RenderOptions& inOptions)
+	{
+		if (inOptions.m_HasEnvironment)
+			return "-r";
+		if (inOptions.m_SIDCount != 0)
+			return "-c";
+		if (inOptions.m_Song >= 0)
+			return "-s";
+		if (inOptions.m_AllSongs)
+			return "-a";
+		if (inOptions.m_SkipSeconds > 0.0)
+			return "-k";
+		if (inOptions.m_WriteDump)
+			return "-w";
+
+		return nullptr;
+	}
+
+	// Parse the whole of the value as a number within the range. std::stoi and std::stod throw on a value that is not
+	// a number or out of the range of the type, and ignore anything after the number
+	bool ParseInteger(const std::string& inValue, int inMin, int inMax, int& outValue)
+	{
+		try
+		{
+			size_t end = 0;
+			const int value = std::stoi(inValue, &end);
+
+			if (end != inValue.size() || value < inMin || value > inMax)
+				return false;
+
+			outValue = value;
+			return true;
+		}
+		catch (const std::logic_error&)
+		{
+			return false;
+		}
+	}
+
+	bool ParseSeconds(const std::string& inValue, double inMin, double& outValue)
+	{
+		try
+		{
+			size_t end = 0;
+			const double value = std::stod(inValue, &end);
+
+			// Also false for not a number
+			if (end != inValue.size() || !(value >= inMin && value <= MaxSeconds))
+				return false;
+
+			outValue = value;
+			return true;
+		}
+		catch (const std::logic_error&)
+		{
+			return false;
+		}
+	}
+
+	bool ParseOptions(int inArgc, char* inArgv[], RenderOptions& outOptions)
+	{
+		for (int i = 1; i < inArgc; ++i)
+		{
+			const std::string argument(inArgv[i]);
+			const bool has_value = i + 1 < inArgc;
+
+			if (argument == "-a")
+				outOptions.m_AllSongs = true;
+			else if (argument == "-x")
+				outOptions.m_Fast = true;
+			else if (argument == "-2")
+				outOptions.m_Stereo = true;
+			else if (argument == "-w")
+				outOptions.m_WriteDump = true;
+			else if (argument == "-v")
+				outOptions.m_WriteVoices = true;
+			else if (argument == "-h" || argument == "--help")
+				return false;
+			else if (argument.size() == 2 && argument[0] == '-')
+			{
+				if (!has_value)
+					return false;
+
+				const std::string value(inArgv[++i]);
+				bool is_valid = true;
+
+				switch (argument[1])
+				{
+				case 'o':
+					outOptions.m_OutputFile = value;
+					break;
+				case 'd':
+					outOptions.m_OutputFolder = value;
+					break;
+				case 's':
+				{
+					// Songs are numbered from 1, and their index must fit in an unsigned char
+					int song = 0;
+					is_valid = ParseInteger(value, 1, 256, song);
+					outOptions.m_Song = song - 1;
+					break;
+				}
+				case 't':
+					is_valid = ParseSeconds(value, 0.0, outOptions.m_Seconds) && outOptions.m_Seconds > 0.0;
+					break;
+				case 'k':
+					is_valid = ParseSeconds(value, 0.0, outOptions.m_SkipSeconds);
+					break;
+				case 'm':
+					outOptions.m_HasModel = true;
+					is_valid = value == "6581" || value == "8580";
+					outOptions.m_Model = value == "6581" ? SID_MODEL_6581 : SID_MODEL_8580;
+					break;
+				case 'r':
+					outOptions.m_HasEnvironment = true;
+					is_valid = value == "pal" || value == "PAL" || value == "ntsc" || value == "NTSC";
+					outOptions.m_Environment = (value == "ntsc" || value == "NTSC") ? SID_ENVIRONMENT_NTSC : SID_ENVIRONMENT_PAL;
+					break;
+				case 'f':
+					is_valid = ParseInteger(value, 11025, 192000, outOptions.m_SampleFrequency);
+					break;
+				case 'c':
+					is_valid = ParseInteger(value, 1, SID_MAX_COUNT, outOptions.m_SIDCount);
+					break;
+				default:
+					return false;
+				}
+
+				if (!is_valid)
+				{
+					std::cerr << "Invalid value for " << argument << ": " << value << std::endl;
+					return false;
+				}
+			}
+			else
+				outOptions.m_InputFiles.push_back(argument);
+		}
+
+		return !outOptions.m_InputFiles.empty();
+	}
+
+	std::string GetOutputFilename(const RenderOptions& inOptions, const std::string& inInputFile, unsigned char inSong, bool inAppendSongNumber)
+	{
+		if (!inOptions.m_OutputFile.empty())
+			return inOptions.m_OutputFile;
+
+		fs::path input_path(inInputFile);
+		fs::path output_folder = inOptions.m_OutputFolder.empty() ? input_path.parent_path() : fs::path(inOptions.m_OutputFolder);
+
+		std::string filename = input_path.stem().string();
+		if (inAppendSongNumber)
+			filename += " - song " + std::to_string(inSong + 1);
+
+		return (output_folder / (filename + ".wav")).string();
+	}
+
+	// Writes the voices of the SID chips, read from the voice taps of the SID proxy, to a mono wave file for each voice
+	class VoiceWriters
+	{
+	public:
+		bool Open(SIDProxy& inSIDProxy, const std::string& inOutputFile)
+		{
+			const int sid_count = inSIDProxy.GetSIDCount();
+			const fs::path output_path(inOutputFile);
+
+			inSIDProxy.SetVoiceTapSampleFrequency(inSIDProxy.GetSampleFrequency());
+
+			for (int sid = 0; sid < sid_count; ++sid)
+			{
+				for (int voice = 0; voice < 3; ++voice)
+				{
+					const std::string suffix = (sid_count > 1 ? " - sid " + std::to_string(sid + 1) + " voice " : " - voice ") + std::to_string(voice + 1);
+					const std::string voice_file = (output_path.parent_path() / (output_path.stem().string() + suffix + ".wav")).string();
+
+					m_Writers.push_back(std::make_unique<WaveFileWriter>(static_cast<unsigned int>(inSIDProxy.GetSampleFrequency()), 1));
+
+					if (!m_Writers.back()->Open(voice_file))
+					{
+						std::cerr << "Could not open " << voice_file << " for writing" << std::endl;
+						Close(inSIDProxy);
+
+						return false;
+					}
+				}
+			}
+
+			return true;
+		}
+
+		// Samples recorded before the song starts are dropped
+		void Start(SIDProxy& inSIDProxy)
+		{
+			for (int sid = 0; sid < inSIDProxy.GetSIDCount(); ++sid)
+				inSIDProxy.DiscardVoiceTap(sid);
+		}
+
+		// The chips may have been clocked further than the samples rendered, the rest is written by the next call
+		void Write(SIDProxy& inSIDProxy, unsigned int inSampleCount)
+		{
+			for (size_t sid = 0; sid * 3 < m_Writers.size(); ++sid)
+			{
+				const unsigned int written_count = m_Writers[sid * 3]->GetWrittenSampleCount();
+				const unsigned int sample_count = std::min(inSIDProxy.GetVoiceTapReadAvailable(static_cast<int>(sid)), inSampleCount - std::min(inSampleCount, written_count));
+
+				m_TapBuffer.resize(sample_count * 3);
+				m_VoiceBuffer.resize(sample_count);
+
+				const unsigned int read_count = sample_count > 0 ? inSIDProxy.ReadVoiceTap(static_cast<int>(sid), &m_TapBuffer[0], sample_count) : 0;
+
+				for (unsigned int voice = 0; voice < 3 && read_count > 0; ++voice)
+				{
+					for (unsigned int i = 0; i < read_count; ++i)
+						m_VoiceBuffer[i] = m_TapBuffer[i * 3 + voice];
+
+					m_Writers[sid * 3 + voice]->Write(&m_VoiceBuffer[0], read_count);
+				}
+			}
+		}
+
+		void Close(SIDProxy& inSIDProxy)
+		{
+			m_Writers.clear();
+			inSIDProxy.SetVoiceTapSampleFrequency(0);
+		}
+
+		bool IsOpen() const
+		{
+			return !m_Writers.empty();
+		}
+
+	private:
+		std::vector<std::unique_ptr<WaveFileWriter>> m_Writers;
+		std::vector<short> m_TapBuffer;
+		std::vector<short> m_VoiceBuffer;
+	};
+
+	void PrintRenderTime(const std::string& inOutputFile, unsigned int inSamplesRendered, int inSampleFrequency, const std::chrono::steady_clock::time_point& inStartTime)
+	{
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - inStartTime;
+		const double rendered_seconds = static_cast<double>(inSamplesRendered) / inSampleFrequency;
+
+		std::cout << inOutputFile << ": " << rendered_seconds << "s rendered in " << elapsed.count() << "s";
+		if (elapsed.count() > 0.0)
+			std::cout << " (" << rendered_seconds / elapsed.count() << "x realtime)";
+		std::cout << std::endl;
+	}
+
+	bool RenderSong(OfflineRenderer& inRenderer, const RenderOptions& inOptions, unsigned char inSong, const std::string& inOutputFile)
+	{
+		const unsigned int channel_count = static_cast<unsigned int>(inRenderer.GetOutputChannelCount());
+		WaveFileWriter writer(static_cast<unsigned int>(inRenderer.GetSampleFrequency()), static_cast<unsigned short>(channel_count));
+
+		if (!writer.Open(inOutputFile))
+		{
+			std::cerr << "Could not open " << inOutputFile << " for writing" << std::endl;
+			return false;
+		}
+
+		const bool is_pal = inRenderer.GetEnvironment() == SID_ENVIRONMENT_PAL;
+		const double frames_per_second = is_pal ? EMULATION_FRAMES_PER_SECOND_PAL : EMULATION_FRAMES_PER_SECOND_NTSC;
+
+		// The dump starts with the SID chips reset, so no frames can be skipped while writing it
+		SIDWriteDumpWriter dump_writer;
+		ExecutionHandler& execution_handler = inRenderer.GetExecutionHandler();
+
+		if (inOptions.m_WriteDump)
+		{
+			const std::string dump_file = fs::path(inOutputFile).replace_extension(DumpExtension).string();
+			const unsigned int cycles_per_frame = is_pal ? EMULATION_CYCLES_PER_FRAME_PAL : EMULATION_CYCLES_PER_FRAME_NTSC;
+
+			if (!dump_writer.Open(dump_file, inRenderer.GetModel(), inRenderer.GetEnvironment(), inRenderer.GetSIDCount(), cycles_per_frame))
+			{
+				std::cerr << "Could not open " << dump_file << " for writing" << std::endl;
+				return false;
+			}
+
+			execution_handler.SetSIDWritesCallback([&dump_writer](const std::vector<SIDWrite>& inWrites)
+			{
+				dump_writer.WriteFrame(inWrites);
+			});
+		}
+
+		VoiceWriters voice_writers;
+		SIDProxy& sid_proxy = inRenderer.GetSIDProxy();
+
+		if (inOptions.m_WriteVoices && !voice_writers.Open(sid_proxy, inOutputFile))
+			return false;
+
+		inRenderer.Start(inSong, static_cast<unsigned int>(inOptions.m_SkipSeconds * frames_per_second));
+
+		if (voice_writers.IsOpen())
+			voice_writers.Start(sid_proxy);
+
+		// Render a frame worth of samples at a time, so that a stopping driver is detected without much delay
+		const unsigned int samples_per_block = static_cast<unsigned int>(inRenderer.GetSampleFrequency() / frames_per_second);
+		const unsigned int sample_count = static_cast<unsigned int>(inOptions.m_Seconds * inRenderer.GetSampleFrequency());
+
+		std::vector<short> buffer(samples_per_block * channel_count);
+
+		const auto start_time = std::chrono::steady_clock::now();
+
+		unsigned int samples_rendered = 0;
+		while (samples_rendered < sample_count && !inRenderer.HasDriverStopped() && !inRenderer.IsInErrorState())
+		{
+			const unsigned int samples_to_render = std::min(samples_per_block, sample_count - samples_rendered);
+
+			inRenderer.Render(&buffer[0], samples_to_render);
+			writer.Write(&buffer[0], samples_to_render * channel_count);
+
+			samples_rendered += samples_to_render;
+
+			if (voice_writers.IsOpen())
+				voice_writers.Write(sid_proxy, samples_rendered);
+		}
+
+		writer.Close();
+
+		if (voice_writers.IsOpen())
+			voice_writers.Close(sid_proxy);
+
+		if (dump_writer.IsOpen())
+		{
+			execution_handler.SetSIDWritesCallback(nullptr);
+			dump_writer.Close();
+		}
+
+		PrintRenderTime(inOutputFile, samples_rendered, inRenderer.GetSampleFrequency(), start_time);
+
+		if (inRenderer.IsInErrorState())
+		{
+			std::cerr << inOutputFile << ": " << inRenderer.GetErrorMessage() << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	// Play the writes of a dump into the SID chips, with the environment and number of chips it was written with. The
+	// output gain is applied as the execution handler does, so the dump renders to the same samples as the song did
+	bool RenderDump(const RenderOptions& inOptions, const SIDConfiguration& inSIDConfiguration, float inOutputGain, const std::string& inInputFile, const std::string& inOutputFile)
+	{
+		SIDWriteDumpReader reader;
+
+		if (!reader.Open(inInputFile))
+		{
+			std::cerr << inInputFile << " is not a valid SID write dump" << std::endl;
+			return false;
+		}
+
+		const SIDWriteDumpHeader& header = reader.GetHeader();
+
+		SIDConfiguration sid_configuration = inSIDConfiguration;
+		sid_configuration.m_nSIDCount = header.m_SIDCount;
+
+		SIDProxy sid_proxy(sid_configuration);
+
+		sid_proxy.SetModel(inOptions.m_HasModel ? inOptions.m_Model : header.m_Model);
+		sid_proxy.SetEnvironment(header.m_Environment);
+		sid_proxy.ApplySettings();
+		sid_proxy.Reset();
+
+		const unsigned int channel_count = static_cast<unsigned int>(sid_proxy.GetOutputChannelCount());
+		const int sample_frequency = sid_proxy.GetSampleFrequency();
+		WaveFileWriter writer(static_cast<unsigned int>(sample_frequency), static_cast<unsigned short>(channel_count));
+
+		if (!writer.Open(inOutputFile))
+		{
+			std::cerr << "Could not open " << inOutputFile << " for writing" << std::endl;
+			return false;
+		}
+
+		VoiceWriters voice_writers;
+
+		if (inOptions.m_WriteVoices && !voice_writers.Open(sid_proxy, inOutputFile))
+			return false;
+
+		const double cycles_per_second = header.m_Environment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SECOND_PAL : EMULATION_CYCLES_PER_SECOND_NTSC;
+		const unsigned int sample_count = static_cast<unsigned int>(inOptions.m_Seconds * sample_frequency);
+
+		std::vector<SIDWrite> writes;
+		std::vector<short> buffer((static_cast<size_t>(header.m_CyclesPerFrame * sample_frequency / cycles_per_second) + 16) * channel_count);
+
+		const auto start_time = std::chrono::steady_clock::now();
+
+		unsigned int samples_rendered = 0;
+		while (samples_rendered < sample_count && reader.ReadFrame(writes))
+		{
+			const unsigned int frame_sample_count = static_cast<unsigned int>(sid_proxy.ClockFrame(writes, static_cast<int>(header.m_CyclesPerFrame), &buffer[0], static_cast<int>(buffer.size()))) / channel_count;
+			const unsigned int samples_to_write = std::min(frame_sample_count, sample_count - samples_rendered);
+
+			for (unsigned int i = 0; i < samples_to_write * channel_count; ++i)
+				buffer[i] = static_cast<short>(fmin(32767.0f, fmax(static_cast<float>(buffer[i]) * inOutputGain, -32767.0f)));
+
+			writer.Write(&buffer[0], samples_to_write * channel_count);
+
+			samples_rendered += samples_to_write;
+
+			if (voice_writers.IsOpen())
+				voice_writers.Write(sid_proxy, samples_rendered);
+		}
+
+		writer.Close();
+
+		if (voice_writers.IsOpen())
+			voice_writers.Close(sid_proxy);
+
+		PrintRenderTime(inOutputFile, samples_rendered, sample_frequency, start_time);
+
+		return true;
+	}
+}
+
+int main(int inArgc, char* inArgv[])
+{
+	RenderOptions options;
+
+	if (!ParseOptions(inArgc, inArgv, options))
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	if (!options.m_OutputFile.empty() && (options.m_InputFiles.size() > 1 || options.m_AllSongs))
+	{
+		std::cerr << "An output file can only be specified when rendering a single song" << std::endl;
+		return -1;
+	}
+
+	if (options.m_WriteDump && options.m_SkipSeconds > 0.0)
+	{
+		std::cerr << "A dump of the SID writes can not be written when skipping the start of a song" << std::endl;
+		return -1;
+	}
+
+	if (HasDumpInputFile(options))
+	{
+		if (const char* option = GetOptionNotApplicableToDump(options))
+		{
+			std::cerr << "The option " << option << " can not be used when rendering a SID write dump (" << DumpExtension << ")" << std::endl;
+			return -1;
+		}
+	}
+
+	Global& global = Global::instance();
+	const ConfigFile& config = global.GetConfig();
+
+	SIDConfiguration sid_configuration;
+
+	const bool sid_use_resample = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.Resample", 1) != 0;
+	const int sid_sample_frequency = options.m_SampleFrequency != 0
+		? options.m_SampleFrequency
+		: GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.SampleFrequency", 44100);
+
+	sid_configuration.m_eSampleMethod = (sid_use_resample && !options.m_Fast) ? SID_SAMPLE_METHOD_RESAMPLE_INTERPOLATE : SID_SAMPLE_METHOD_INTERPOLATE;
+	sid_configuration.m_nSampleFrequency = std::min(std::max(sid_sample_frequency, 11025), 192000);
+
+	sid_configuration.m_nSIDCount = options.m_SIDCount != 0 ? options.m_SIDCount : GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.SIDCount", 1);
+	const std::vector<int> sid_addresses = GetConfigurationValues<ConfigValueInt>(config, "Sound.Emulation.SIDAddress", {});
+	for (size_t i = 0; i < sid_addresses.size() && i < SID_MAX_COUNT; ++i)
+		sid_configuration.m_aSIDAddress[i] = static_cast<unsigned short>(sid_addresses[i]);
+	sid_configuration.m_nOutputChannelCount = (options.m_Stereo || GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.Stereo", 0) != 0) ? 2 : 1;
+	sid_configuration.m_bClockInParallel = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.ParallelClock", 0) != 0;
+
+	const float output_gain = GetSingleConfigurationValue<ConfigValueFloat>(config, "Sound.Output.Gain", -1.0f);
+
+	int result = 0;
+
+	{
+		OfflineRenderer renderer(sid_configuration);
+
+		if (options.m_HasModel)
+			renderer.OverrideModel(options.m_Model);
+		if (options.m_HasEnvironment)
+			renderer.OverrideEnvironment(options.m_Environment);
+
+		for (const std::string& input_file : options.m_InputFiles)
+		{
+			if (fs::path(input_file).extension() == DumpExtension)
+			{
+				if (!RenderDump(options, sid_configuration, output_gain, input_file, GetOutputFilename(options, input_file, 0, false)))
+					result = -1;
+
+				continue;
+			}
+
+			if (!renderer.Load(input_file))
+			{
+				std::cerr << input_file << " is not a valid sf2 file" << std::endl;
+				result = -1;
+				continue;
+			}
+
+			const unsigned char song_count = renderer.GetSongCount();
+			const unsigned char first_song = options.m_AllSongs ? 0 : static_cast<unsigned char>(options.m_Song >= 0 ? options.m_Song : renderer.GetSelectedSong());
+			const unsigned char last_song = options.m_AllSongs ? song_count - 1 : first_song;
+
+			if (first_song >= song_count)
+			{
+				std::cerr << input_file << " has only " << static_cast<int>(song_count) << " song(s)" << std::endl;
+				result = -1;
+				continue;
+			}
+
+			for (unsigned int song = first_song; song <= last_song; ++song)
+			{
+				const std::string output_file = GetOutputFilename(options, input_file, static_cast<unsigned char>(song), options.m_AllSongs && song_count > 1);
+
+				if (!RenderSong(renderer, options, static_cast<unsigned char>(song), output_file))
+					result = -1;
+			}
+		}
+	}
+
+	global.deletePlatform();
+
+	return result;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace Foundation
+{
+	// A lock on a file, which no other process can take while it is held. It is released when the lock is destroyed, or
+	// by the system when the process ends in any way
+	class IFileLock
+	{
+	protected:
+		IFileLock() { }
+	public:
+		virtual ~IFileLock() { }
+
+		IFileLock(const IFileLock& inOther) = delete;
+		IFileLock(const IFileLock&& inOther) = delete;
+	};
+}
@@ -7,6 +7,7 @@ namespace Foundation
 {
 	// Forward declaration
 	class IMutex;
+	class IFileLock;
 
 	class IPlatform
 	{
@@ -32,6 +33,9 @@ namespace Foundation
 		virtual bool Storage_IsSystemFile(const std::string& inPath) const = 0;
 		virtual bool Storage_DeleteFile(const std::string& inPath) const = 0;
 
+		// Lock a file, which is created if it does not exist. Returns nullptr if another process holds a lock on it
+		virtual std::shared_ptr<IFileLock> Storage_LockFile(const std::string& inPath) const = 0;
+
 		// Get the path to the folder that was set on startup of the application
 		virtual std::string Storage_GetApplicationHomePath() const = 0;
 
@@ -52,5 +56,8 @@ namespace Foundation
 
 		// Parse path string for OS specific path aliases
 		virtual std::string OS_ParsePath(const std::string& inPath) const = 0;
+
+		// Get the identifier of the process, which no other running process has
+		virtual unsigned int OS_GetProcessID() const = 0;
 	};
 }
@@ -0,0 +1,40 @@
+#include "file_lock_posix.h"
+
+#ifndef _SF2_WINDOWS
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace Foundation
+{
+	std::shared_ptr<IFileLock> FileLockPosix::Create(const std::string& inPath)
+	{
+		const int file_descriptor = open(inPath.c_str(), O_RDWR | O_CREAT, 0644);
+
+		if (file_descriptor < 0)
+			return nullptr;
+
+		// The lock belongs to the open file, so it is not taken again by another open in the same process either
+		if (flock(file_descriptor, LOCK_EX | LOCK_NB) != 0)
+		{
+			close(file_descriptor);
+			return nullptr;
+		}
+
+		return std::shared_ptr<IFileLock>(new FileLockPosix(file_descriptor));
+	}
+
+
+	FileLockPosix::FileLockPosix(int inFileDescriptor)
+		: m_FileDescriptor(inFileDescriptor)
+	{
+	}
+
+
+	FileLockPosix::~FileLockPosix()
+	{
+		flock(m_FileDescriptor, LOCK_UN);
+		close(m_FileDescriptor);
+	}
+}
+#endif
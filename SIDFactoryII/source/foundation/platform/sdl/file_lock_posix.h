@@ -0,0 +1,24 @@
+#pragma once
+
+#include "foundation/platform/ifilelock.h"
+#include <memory>
+#include <string>
+
+#ifndef _SF2_WINDOWS
+namespace Foundation
+{
+	class FileLockPosix final : public IFileLock
+	{
+	public:
+		// Returns nullptr if the file could not be opened or is locked by another process
+		static std::shared_ptr<IFileLock> Create(const std::string& inPath);
+
+		virtual ~FileLockPosix();
+
+	private:
+		FileLockPosix(int inFileDescriptor);
+
+		int m_FileDescriptor;
+	};
+}
+#endif
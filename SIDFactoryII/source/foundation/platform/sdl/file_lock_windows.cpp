@@ -0,0 +1,31 @@
+#include "file_lock_windows.h"
+
+#ifdef _SF2_WINDOWS
+#include <windows.h>
+
+namespace Foundation
+{
+	std::shared_ptr<IFileLock> FileLockWindows::Create(const std::string& inPath)
+	{
+		// Opened without sharing, which holds off every other open of the file until the handle is closed
+		HANDLE handle = CreateFileA(inPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (handle == INVALID_HANDLE_VALUE)
+			return nullptr;
+
+		return std::shared_ptr<IFileLock>(new FileLockWindows(handle));
+	}
+
+
+	FileLockWindows::FileLockWindows(void* inHandle)
+		: m_Handle(inHandle)
+	{
+	}
+
+
+	FileLockWindows::~FileLockWindows()
+	{
+		CloseHandle(static_cast<HANDLE>(m_Handle));
+	}
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "foundation/platform/ifilelock.h"
+#include <memory>
+#include <string>
+
+#ifdef _SF2_WINDOWS
+namespace Foundation
+{
+	class FileLockWindows final : public IFileLock
+	{
+	public:
+		// Returns nullptr if the file could not be opened or is open in another process
+		static std::shared_ptr<IFileLock> Create(const std::string& inPath);
+
+		virtual ~FileLockWindows();
+
+	private:
+		FileLockWindows(void* inHandle);
+
+		void* m_Handle;
+	};
+}
+#endif
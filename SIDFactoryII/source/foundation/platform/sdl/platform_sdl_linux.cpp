@@ -1,5 +1,6 @@
 #include "platform_sdl_linux.h"
 #include "mutex_sdl.h"
+#include "file_lock_posix.h"
 
 #ifdef _SF2_LINUX
 #include "foundation/base/assert.h"
@@ -8,6 +9,7 @@
 #include <libgen.h>
 #include <pwd.h>
 #include <system_error>
+#include <unistd.h>
 #include <wordexp.h>
 
 using namespace fs;
@@ -109,6 +111,12 @@ namespace Foundation
 	}
 
 
+	std::shared_ptr<IFileLock> PlatformSDLLinux::Storage_LockFile(const std::string& inPath) const
+	{
+		return FileLockPosix::Create(inPath);
+	}
+
+
 	std::string PlatformSDLLinux::Storage_GetApplicationHomePath() const
 	{
 		return m_RealHome; // FIXME: not used, delete?
@@ -159,6 +167,12 @@ namespace Foundation
 		return inPath;
 	}
 
+
+	unsigned int PlatformSDLLinux::OS_GetProcessID() const
+	{
+		return static_cast<unsigned int>(getpid());
+	}
+
 	// https://stackoverflow.com/questions/23943239/how-to-get-path-to-current-exe-file-on-linux
 	std::string PlatformSDLLinux::GetResourcePath(const std::string& relativePath) const
 	{
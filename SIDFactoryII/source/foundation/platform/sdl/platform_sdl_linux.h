@@ -21,6 +21,7 @@ namespace Foundation
 		bool Storage_SetCurrentPath(const std::string& inPath) const override;
 		bool Storage_IsSystemFile(const std::string& inPath) const override;
 		bool Storage_DeleteFile(const std::string& inPath) const override;
+		std::shared_ptr<IFileLock> Storage_LockFile(const std::string& inPath) const override;
 
 		virtual std::string Storage_GetApplicationHomePath() const override;
 		virtual std::string Storage_GetHomePath() const override;
@@ -29,6 +30,7 @@ namespace Foundation
 		virtual std::string Storage_GetOverlaysHomePath() const override;
 		virtual std::string Storage_GetColorSchemesHomePath() const override;
 		virtual std::string OS_ParsePath(const std::string& inPath) const override;
+		virtual unsigned int OS_GetProcessID() const override;
 
 	private:
 		unsigned long m_LogicalDrivesMask;
@@ -1,5 +1,6 @@
 #include "platform_sdl_macos.h"
 #include "mutex_sdl.h"
+#include "file_lock_posix.h"
 
 #ifndef _SF2_WINDOWS
 #ifndef _SF2_LINUX
@@ -9,6 +10,7 @@
 #include <mach-o/dyld.h>
 #include <pwd.h>
 #include <system_error>
+#include <unistd.h>
 #include <wordexp.h>
 
 using namespace fs;
@@ -112,6 +114,12 @@ namespace Foundation
 	}
 
 
+	std::shared_ptr<IFileLock> PlatformSDLMacOS::Storage_LockFile(const std::string& inPath) const
+	{
+		return FileLockPosix::Create(inPath);
+	}
+
+
 	std::string PlatformSDLMacOS::Storage_GetApplicationHomePath() const
 	{
 		return m_RealHome; // FIXME: not used, delete?
@@ -181,6 +189,12 @@ namespace Foundation
 		}
 		return inPath;
 	}
+
+
+	unsigned int PlatformSDLMacOS::OS_GetProcessID() const
+	{
+		return static_cast<unsigned int>(getpid());
+	}
 }
 
 #endif
@@ -1,5 +1,6 @@
 #include "platform_sdl_windows.h"
 #include "mutex_sdl.h"
+#include "file_lock_windows.h"
 
 #ifdef _SF2_WINDOWS
 #include "libraries/ghc/fs_std.h"
@@ -99,6 +100,12 @@ namespace Foundation
 	}
 
 
+	std::shared_ptr<IFileLock> PlatformSDLWindows::Storage_LockFile(const std::string& inPath) const
+	{
+		return FileLockWindows::Create(inPath);
+	}
+
+
 	std::string PlatformSDLWindows::Storage_GetApplicationHomePath() const
 	{
 		return m_ApplicationHomePath;
@@ -142,6 +149,12 @@ namespace Foundation
 	{
 		return inPath;
 	}
+
+
+	unsigned int PlatformSDLWindows::OS_GetProcessID() const
+	{
+		return static_cast<unsigned int>(GetCurrentProcessId());
+	}
 }
 #endif 
 
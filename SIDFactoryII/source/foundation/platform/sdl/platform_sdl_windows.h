@@ -19,6 +19,7 @@ namespace Foundation
 		bool Storage_SetCurrentPath(const std::string& inPath) const override;
 		bool Storage_IsSystemFile(const std::string& inPath) const override;
 		bool Storage_DeleteFile(const std::string& inPath) const override;
+		std::shared_ptr<IFileLock> Storage_LockFile(const std::string& inPath) const override;
 
 		virtual std::string Storage_GetApplicationHomePath() const override;
 		virtual std::string Storage_GetHomePath() const override;
@@ -28,6 +29,7 @@ namespace Foundation
 		virtual std::string Storage_GetColorSchemesHomePath() const override;
 
 		virtual std::string OS_ParsePath(const std::string& inPath) const;
+		virtual unsigned int OS_GetProcessID() const override;
 
 	private:
 		std::string m_ApplicationHomePath;
@@ -3,6 +3,8 @@
 #include "foundation/base/assert.h"
 #include "utils/logging.h"
 
+#include <algorithm>
+
 namespace Foundation
 {
 	void AudioStream::AudioCallback(void* inUserData, unsigned char* inStream, int inByteCount)
@@ -11,13 +13,38 @@ namespace Foundation
 
 		AudioStream* audio_stream_instance = static_cast<AudioStream*>(inUserData);
 
-		if (audio_stream_instance->m_StreamFeeder != nullptr)
+		if (audio_stream_instance->m_StreamFeeder == nullptr)
+			return;
+
+		if (audio_stream_instance->m_BitDepth != 32)
+		{
 			audio_stream_instance->m_StreamFeeder->FeedPCM(static_cast<void*>(inStream), inByteCount);
+			return;
+		}
+
+		// Feed in parts of the conversion buffer, in case the device asks for more than its buffer size
+		std::vector<short>& conversion_buffer = audio_stream_instance->m_ConversionBuffer;
+		float* target = reinterpret_cast<float*>(inStream);
+		unsigned int remaining_sample_count = static_cast<unsigned int>(inByteCount) / sizeof(float);
+
+		while (remaining_sample_count > 0)
+		{
+			const unsigned int sample_count = std::min(remaining_sample_count, static_cast<unsigned int>(conversion_buffer.size()));
+
+			audio_stream_instance->m_StreamFeeder->FeedPCM(static_cast<void*>(conversion_buffer.data()), sample_count * sizeof(short));
+
+			for (unsigned int i = 0; i < sample_count; ++i)
+				target[i] = static_cast<float>(conversion_buffer[i]) * (1.0f / 32768.0f);
+
+			target += sample_count;
+			remaining_sample_count -= sample_count;
+		}
 	}
 
-	AudioStream::AudioStream(unsigned int inFrequency, unsigned int inBitDepth, unsigned int inBufferDuration, IAudioStreamFeeder* inStreamFeeder)
+	AudioStream::AudioStream(unsigned int inFrequency, unsigned int inBitDepth, unsigned int inChannelCount, unsigned int inBufferDuration, IAudioStreamFeeder* inStreamFeeder)
 		: m_Frequency(inFrequency)
 		, m_BitDepth(inBitDepth)
+		, m_ChannelCount(inChannelCount)
 		, m_BufferDuration(inBufferDuration)
 		, m_StreamFeeder(inStreamFeeder)
 	{
@@ -42,8 +69,8 @@ namespace Foundation
 
 		audio_spec.callback = &AudioStream::AudioCallback;
 		audio_spec.userdata = this;
-		audio_spec.channels = 1;
-		audio_spec.format = inBitDepth == 16 ? AUDIO_S16LSB : AUDIO_U8;
+		audio_spec.channels = static_cast<unsigned char>(inChannelCount);
+		audio_spec.format = inBitDepth == 32 ? AUDIO_F32SYS : (inBitDepth == 16 ? AUDIO_S16LSB : AUDIO_U8);
 		audio_spec.freq = inFrequency;
 		audio_spec.samples = static_cast<unsigned short>(buffer_size_power_of_two);
 
@@ -63,6 +90,10 @@ namespace Foundation
 			Utility::Logging::instance().Error("Could not open audio device. SDL Error: %s", SDL_GetError());
 		}
 		Utility::Logging::instance().Info("Audio device frequency: %d", audio_spec_created.freq);
+		Utility::Logging::instance().Info("Audio device buffer size: %d samples%s", audio_spec_created.samples, inBitDepth == 32 ? ", float" : "");
+
+		if (inBitDepth == 32)
+			m_ConversionBuffer.resize(std::max<size_t>(audio_spec_created.samples, 0x80) * inChannelCount);
 	}
 
 	AudioStream::~AudioStream()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include "SDL.h"
 
 namespace Foundation
@@ -24,10 +25,12 @@ namespace Foundation
 		virtual void FeedPCM(void* inBuffer, unsigned int inByteCount) = 0;			// Called when ever the stream needs more data while running
 	};
 
+	// Plays the 16 bit PCM data of a feeder. With a bit depth of 32 the device is opened for float samples, and the data
+	// of the feeder is converted, which spares the conversion in the audio driver on systems that mix in float
 	class AudioStream final
 	{
 	public:
-		AudioStream(unsigned int inFrequency, unsigned int inBitDepth, unsigned int inBufferDuration, IAudioStreamFeeder* inStreamFeeder);
+		AudioStream(unsigned int inFrequency, unsigned int inBitDepth, unsigned int inChannelCount, unsigned int inBufferDuration, IAudioStreamFeeder* inStreamFeeder);
 		~AudioStream();
 
 		void Start();
@@ -36,12 +39,16 @@ namespace Foundation
 	private:
 		unsigned int m_Frequency;
 		unsigned int m_BitDepth;
+		unsigned int m_ChannelCount;
 		unsigned int m_BufferDuration;
 
 		IAudioStreamFeeder* m_StreamFeeder;
 
 		SDL_AudioDeviceID m_AudioDeviceID;
 
+		// Data of the feeder, before it is converted to float samples
+		std::vector<short> m_ConversionBuffer;
+
 		static void AudioCallback(void* inUserData, unsigned char* inStream, int inByteCount);
 	};
 }
@@ -167,4 +167,50 @@ void EnvelopeGenerator::writeSUSTAIN_RELEASE(unsigned char sustain_release)
     }
 }
 
+void EnvelopeGenerator::saveSnapshot(Snapshot& snapshot) const
+{
+    snapshot.lfsr = lfsr;
+    snapshot.rate = rate;
+    snapshot.exponential_counter = exponential_counter;
+    snapshot.exponential_counter_period = exponential_counter_period;
+    snapshot.new_exponential_counter_period = new_exponential_counter_period;
+    snapshot.state_pipeline = state_pipeline;
+    snapshot.envelope_pipeline = envelope_pipeline;
+    snapshot.exponential_pipeline = exponential_pipeline;
+    snapshot.state = state;
+    snapshot.next_state = next_state;
+    snapshot.counter_enabled = counter_enabled;
+    snapshot.gate = gate;
+    snapshot.resetLfsr = resetLfsr;
+    snapshot.envelope_counter = envelope_counter;
+    snapshot.attack = attack;
+    snapshot.decay = decay;
+    snapshot.sustain = sustain;
+    snapshot.release = release;
+    snapshot.env3 = env3;
+}
+
+void EnvelopeGenerator::restoreSnapshot(const Snapshot& snapshot)
+{
+    lfsr = snapshot.lfsr;
+    rate = snapshot.rate;
+    exponential_counter = snapshot.exponential_counter;
+    exponential_counter_period = snapshot.exponential_counter_period;
+    new_exponential_counter_period = snapshot.new_exponential_counter_period;
+    state_pipeline = snapshot.state_pipeline;
+    envelope_pipeline = snapshot.envelope_pipeline;
+    exponential_pipeline = snapshot.exponential_pipeline;
+    state = snapshot.state;
+    next_state = snapshot.next_state;
+    counter_enabled = snapshot.counter_enabled;
+    gate = snapshot.gate;
+    resetLfsr = snapshot.resetLfsr;
+    envelope_counter = snapshot.envelope_counter;
+    attack = snapshot.attack;
+    decay = snapshot.decay;
+    sustain = snapshot.sustain;
+    release = snapshot.release;
+    env3 = snapshot.env3;
+}
+
 } // namespace reSIDfp
@@ -125,6 +125,33 @@ private:
 
     void state_change();
 
+public:
+    /**
+     * State of the envelope generator, without the model tables.
+     */
+    struct Snapshot
+    {
+        unsigned int lfsr;
+        unsigned int rate;
+        unsigned int exponential_counter;
+        unsigned int exponential_counter_period;
+        unsigned int new_exponential_counter_period;
+        unsigned int state_pipeline;
+        unsigned int envelope_pipeline;
+        unsigned int exponential_pipeline;
+        State state;
+        State next_state;
+        bool counter_enabled;
+        bool gate;
+        bool resetLfsr;
+        unsigned char envelope_counter;
+        unsigned char attack;
+        unsigned char decay;
+        unsigned char sustain;
+        unsigned char release;
+        unsigned char env3;
+    };
+
 public:
     /**
      * Set chip model.
@@ -177,6 +204,20 @@ public:
      */
     void reset();
 
+    /**
+     * Save the state, to restore it into an envelope generator of the same chip model.
+     *
+     * @param snapshot the snapshot to save to
+     */
+    void saveSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * Restore a state saved with saveSnapshot().
+     *
+     * @param snapshot the snapshot to restore from
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
+
     /**
      * Write control register.
      *
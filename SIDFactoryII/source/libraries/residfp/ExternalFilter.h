@@ -85,6 +85,30 @@ public:
      * SID reset.
      */
     void reset();
+
+    /**
+     * State of the filter, without the settings of the sampling parameters.
+     */
+    struct Snapshot
+    {
+        int Vlp;
+        int Vhp;
+        unsigned int reset_pipeline;
+    };
+
+    void saveSnapshot(Snapshot& snapshot) const
+    {
+        snapshot.Vlp = Vlp;
+        snapshot.Vhp = Vhp;
+        snapshot.reset_pipeline = reset_pipeline;
+    }
+
+    void restoreSnapshot(const Snapshot& snapshot)
+    {
+        Vlp = snapshot.Vlp;
+        Vhp = snapshot.Vhp;
+        reset_pipeline = snapshot.reset_pipeline;
+    }
 };
 
 } // namespace reSIDfp
@@ -47,6 +47,54 @@ void Filter::reset()
     writeRES_FILT(0);
 }
 
+void Filter::saveSnapshot(Snapshot& snapshot) const
+{
+    snapshot.currentGain = currentGain;
+    snapshot.currentMixer = currentMixer;
+    snapshot.currentSummer = currentSummer;
+    snapshot.currentResonance = currentResonance;
+    snapshot.Vhp = Vhp;
+    snapshot.Vbp = Vbp;
+    snapshot.Vlp = Vlp;
+    snapshot.ve = ve;
+    snapshot.fc = fc;
+    snapshot.filt1 = filt1;
+    snapshot.filt2 = filt2;
+    snapshot.filt3 = filt3;
+    snapshot.filtE = filtE;
+    snapshot.voice3off = voice3off;
+    snapshot.hp = hp;
+    snapshot.bp = bp;
+    snapshot.lp = lp;
+    snapshot.vol = vol;
+    snapshot.enabled = enabled;
+    snapshot.filt = filt;
+}
+
+void Filter::restoreSnapshot(const Snapshot& snapshot)
+{
+    currentGain = snapshot.currentGain;
+    currentMixer = snapshot.currentMixer;
+    currentSummer = snapshot.currentSummer;
+    currentResonance = snapshot.currentResonance;
+    Vhp = snapshot.Vhp;
+    Vbp = snapshot.Vbp;
+    Vlp = snapshot.Vlp;
+    ve = snapshot.ve;
+    fc = snapshot.fc;
+    filt1 = snapshot.filt1;
+    filt2 = snapshot.filt2;
+    filt3 = snapshot.filt3;
+    filtE = snapshot.filtE;
+    voice3off = snapshot.voice3off;
+    hp = snapshot.hp;
+    bp = snapshot.bp;
+    lp = snapshot.lp;
+    vol = snapshot.vol;
+    enabled = snapshot.enabled;
+    filt = snapshot.filt;
+}
+
 void Filter::writeFC_LO(unsigned char fc_lo)
 {
     fc = (fc & 0x7f8) | (fc_lo & 0x007);
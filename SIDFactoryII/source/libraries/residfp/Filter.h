@@ -119,6 +119,28 @@ public:
 
     virtual ~Filter() {}
 
+    /**
+     * State of the filter, without the model tables.
+     */
+    struct Snapshot
+    {
+        unsigned short* currentGain;
+        unsigned short* currentMixer;
+        unsigned short* currentSummer;
+        unsigned short* currentResonance;
+        int Vhp;
+        int Vbp;
+        int Vlp;
+        int ve;
+        unsigned int fc;
+        bool filt1, filt2, filt3, filtE;
+        bool voice3off;
+        bool hp, bp, lp;
+        unsigned char vol;
+        bool enabled;
+        unsigned char filt;
+    };
+
     /**
      * SID clocking - 1 cycle
      *
@@ -141,6 +163,20 @@ public:
      */
     void reset();
 
+    /**
+     * Save the state, to restore it into a filter of the same model.
+     *
+     * @param snapshot the snapshot to save to
+     */
+    void saveSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * Restore a state saved with saveSnapshot().
+     *
+     * @param snapshot the snapshot to restore from
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
+
     /**
      * Write Frequency Cutoff Low register.
      *
@@ -72,4 +72,25 @@ void Filter6581::setFilterCurve(double curvePosition)
     updatedCenterFrequency();
 }
 
+void Filter6581::copyState(const Filter6581& source)
+{
+    Filter::operator=(source);
+    hpIntegrator->copyState(*source.hpIntegrator);
+    bpIntegrator->copyState(*source.bpIntegrator);
+}
+
+void Filter6581::saveSnapshot(Snapshot& snapshot) const
+{
+    Filter::saveSnapshot(snapshot.filter);
+    hpIntegrator->saveSnapshot(snapshot.hpIntegrator);
+    bpIntegrator->saveSnapshot(snapshot.bpIntegrator);
+}
+
+void Filter6581::restoreSnapshot(const Snapshot& snapshot)
+{
+    Filter::restoreSnapshot(snapshot.filter);
+    hpIntegrator->restoreSnapshot(snapshot.hpIntegrator);
+    bpIntegrator->restoreSnapshot(snapshot.bpIntegrator);
+}
+
 } // namespace reSIDfp
@@ -29,6 +29,7 @@
 
 #include "Filter.h"
 #include "FilterModelConfig.h"
+#include "Integrator.h"
 
 //#include "sidcxx11.h"
 
@@ -378,6 +379,37 @@ public:
      * @param curvePosition 0 .. 1, where 0 sets center frequency high ("light") and 1 sets it low ("dark"), default is 0.5
      */
     void setFilterCurve(double curvePosition);
+
+    /**
+     * Copy the state of another filter. The filter curve is not copied.
+     *
+     * @param source the filter to copy from
+     */
+    void copyState(const Filter6581& source);
+
+    /**
+     * State of the filter and its integrators.
+     */
+    struct Snapshot
+    {
+        Filter::Snapshot filter;
+        Integrator::Snapshot hpIntegrator;
+        Integrator::Snapshot bpIntegrator;
+    };
+
+    /**
+     * Save the state, to restore it into a filter with the same filter curve.
+     *
+     * @param snapshot the snapshot to save to
+     */
+    void saveSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * Restore a state saved with saveSnapshot().
+     *
+     * @param snapshot the snapshot to restore from
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
 };
 
 } // namespace reSIDfp
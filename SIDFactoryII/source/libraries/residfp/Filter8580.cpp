@@ -98,4 +98,28 @@ void Filter8580::setFilterCurve(double curvePosition)
     bpIntegrator->setV(cp);
 }
 
+void Filter8580::copyState(const Filter8580& source)
+{
+    Filter::operator=(source);
+    cp = source.cp;
+    hpIntegrator->copyState(*source.hpIntegrator);
+    bpIntegrator->copyState(*source.bpIntegrator);
+}
+
+void Filter8580::saveSnapshot(Snapshot& snapshot) const
+{
+    Filter::saveSnapshot(snapshot.filter);
+    snapshot.cp = cp;
+    hpIntegrator->saveSnapshot(snapshot.hpIntegrator);
+    bpIntegrator->saveSnapshot(snapshot.bpIntegrator);
+}
+
+void Filter8580::restoreSnapshot(const Snapshot& snapshot)
+{
+    Filter::restoreSnapshot(snapshot.filter);
+    cp = snapshot.cp;
+    hpIntegrator->restoreSnapshot(snapshot.hpIntegrator);
+    bpIntegrator->restoreSnapshot(snapshot.bpIntegrator);
+}
+
 } // namespace reSIDfp
@@ -344,6 +344,38 @@ public:
      * @param curvePosition 0 .. 1, where 0 sets center frequency high ("light") and 1 sets it low ("dark"), default is 0.5
      */
     void setFilterCurve(double curvePosition);
+
+    /**
+     * Copy the state of another filter.
+     *
+     * @param source the filter to copy from
+     */
+    void copyState(const Filter8580& source);
+
+    /**
+     * State of the filter and its integrators.
+     */
+    struct Snapshot
+    {
+        Filter::Snapshot filter;
+        double cp;
+        Integrator8580::Snapshot hpIntegrator;
+        Integrator8580::Snapshot bpIntegrator;
+    };
+
+    /**
+     * Save the state, to restore it into another filter.
+     *
+     * @param snapshot the snapshot to save to
+     */
+    void saveSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * Restore a state saved with saveSnapshot().
+     *
+     * @param snapshot the snapshot to restore from
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
 };
 
 } // namespace reSIDfp
@@ -27,6 +27,7 @@
 
 #include "Integrator.h"
 #include "OpAmp.h"
+#include "TableCache.h"
 
 namespace reSIDfp
 {
@@ -124,6 +125,46 @@ FilterModelConfig::FilterModelConfig() :
 {
     dac.kinkedDac(MOS6581);
 
+    // Allocate the lookup tables, which are read from the cache or calculated.
+
+    std::vector<TableCache::Table> tables;
+
+    for (int i = 0; i < 5; i++)
+    {
+        const unsigned int size = (2 + i) << 16;
+        summer[i] = new unsigned short[size];
+        tables.push_back({ summer[i], size });
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+        const unsigned int size = (i == 0) ? 1 : i << 16;
+        mixer[i] = new unsigned short[size];
+        tables.push_back({ mixer[i], size });
+    }
+
+    for (int n8 = 0; n8 < 16; n8++)
+    {
+        gain[n8] = new unsigned short[1 << 16];
+        tables.push_back({ gain[n8], 1 << 16 });
+    }
+
+    tables.push_back({ vcr_kVg, 1 << 16 });
+    tables.push_back({ vcr_n_Ids_term, 1 << 16 });
+    tables.push_back({ opamp_rev, 1 << 16 });
+
+    const double parameters[] = { C, Vdd, Vth, Ut, k, uCox, WL_vcr, vmin, vmax };
+    const unsigned int key = TableCache::hash(parameters, sizeof(parameters), TableCache::hash(opamp_voltage, sizeof(opamp_voltage)));
+
+    if (!TableCache::load("filter6581.tables", key, tables))
+    {
+        buildTables();
+        TableCache::save("filter6581.tables", key, tables);
+    }
+}
+
+void FilterModelConfig::buildTables()
+{
     // Convert op-amp voltage transfer to 16 bit values.
 
     Spline::Point scaled_voltage[OPAMP_SIZE];
@@ -164,7 +205,6 @@ FilterModelConfig::FilterModelConfig() :
         const int size = idiv << 16;
         const double n = idiv;
         opampModel.reset();
-        summer[i] = new unsigned short[size];
 
         for (int vi = 0; vi < size; vi++)
         {
@@ -186,7 +226,6 @@ FilterModelConfig::FilterModelConfig() :
         const int size = (i == 0) ? 1 : i << 16;
         const double n = i * 8.0 / 6.0;
         opampModel.reset();
-        mixer[i] = new unsigned short[size];
 
         for (int vi = 0; vi < size; vi++)
         {
@@ -207,7 +246,6 @@ FilterModelConfig::FilterModelConfig() :
         const int size = 1 << 16;
         const double n = n8 / 8.0;
         opampModel.reset();
-        gain[n8] = new unsigned short[size];
 
         for (int vi = 0; vi < size; vi++)
         {
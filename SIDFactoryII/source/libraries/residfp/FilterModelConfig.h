@@ -108,6 +108,8 @@ private:
     FilterModelConfig();
     ~FilterModelConfig();
 
+    void buildTables();
+
 public:
     static FilterModelConfig* getInstance();
 
@@ -26,6 +26,7 @@
 
 #include "Integrator8580.h"
 #include "OpAmp.h"
+#include "TableCache.h"
 
 namespace reSIDfp
 {
@@ -135,6 +136,48 @@ FilterModelConfig8580::FilterModelConfig8580() :
     denorm(vmax - vmin),
     norm(1.0 / denorm),
     N16(norm * ((1 << 16) - 1))
+{
+    // Allocate the lookup tables, which are read from the cache or calculated.
+
+    std::vector<TableCache::Table> tables;
+
+    for (int i = 0; i < 5; i++)
+    {
+        const unsigned int size = (2 + i) << 16;
+        summer[i] = new unsigned short[size];
+        tables.push_back({ summer[i], size });
+    }
+
+    for (int i = 0; i < 8; i++)
+    {
+        const unsigned int size = (i == 0) ? 1 : i << 16;
+        mixer[i] = new unsigned short[size];
+        tables.push_back({ mixer[i], size });
+    }
+
+    for (int n8 = 0; n8 < 16; n8++)
+    {
+        gain_vol[n8] = new unsigned short[1 << 16];
+        gain_res[n8] = new unsigned short[1 << 16];
+        tables.push_back({ gain_vol[n8], 1 << 16 });
+        tables.push_back({ gain_res[n8], 1 << 16 });
+    }
+
+    tables.push_back({ opamp_rev, 1 << 16 });
+
+    const double parameters[] = { Vdd, Vth, vmin, vmax };
+    unsigned int key = TableCache::hash(opamp_voltage, sizeof(opamp_voltage));
+    key = TableCache::hash(resGain, sizeof(resGain), key);
+    key = TableCache::hash(parameters, sizeof(parameters), key);
+
+    if (!TableCache::load("filter8580.tables", key, tables))
+    {
+        buildTables();
+        TableCache::save("filter8580.tables", key, tables);
+    }
+}
+
+void FilterModelConfig8580::buildTables()
 {
     // Convert op-amp voltage transfer to 16 bit values.
 
@@ -175,7 +218,6 @@ FilterModelConfig8580::FilterModelConfig8580() :
         const int size = idiv << 16;
         const double n = idiv;
         opampModel.reset();
-        summer[i] = new unsigned short[size];
 
         for (int vi = 0; vi < size; vi++)
         {
@@ -197,7 +239,6 @@ FilterModelConfig8580::FilterModelConfig8580() :
         const int size = (i == 0) ? 1 : i << 16;
         const double n = i * 8.0 / 6.0;
         opampModel.reset();
-        mixer[i] = new unsigned short[size];
 
         for (int vi = 0; vi < size; vi++)
         {
@@ -217,7 +258,6 @@ FilterModelConfig8580::FilterModelConfig8580() :
         const int size = 1 << 16;
         const double n = n8 / 8.0;
         opampModel.reset();
-        gain_vol[n8] = new unsigned short[size];
 
         for (int vi = 0; vi < size; vi++)
         {
@@ -237,7 +277,6 @@ FilterModelConfig8580::FilterModelConfig8580() :
     {
         const int size = 1 << 16;
         opampModel.reset();
-        gain_res[n8] = new unsigned short[size];
 
         for (int vi = 0; vi < size; vi++)
         {
@@ -86,6 +86,8 @@ private:
     FilterModelConfig8580();
     ~FilterModelConfig8580();
 
+    void buildTables();
+
 public:
     static FilterModelConfig8580* getInstance();
 
@@ -179,6 +179,40 @@ public:
     void setVw(unsigned short Vw) { Vddt_Vw_2 = ((kVddt - Vw) * (kVddt - Vw)) >> 1; }
 
     int solve(int vi);
+
+    /**
+     * Copy the state of another integrator, built from the same filter model.
+     */
+    void copyState(const Integrator& source)
+    {
+        Vddt_Vw_2 = source.Vddt_Vw_2;
+        vx = source.vx;
+        vc = source.vc;
+    }
+
+    /**
+     * State of the integrator, as copied by copyState().
+     */
+    struct Snapshot
+    {
+        unsigned int Vddt_Vw_2;
+        int vx;
+        int vc;
+    };
+
+    void saveSnapshot(Snapshot& snapshot) const
+    {
+        snapshot.Vddt_Vw_2 = Vddt_Vw_2;
+        snapshot.vx = vx;
+        snapshot.vc = vc;
+    }
+
+    void restoreSnapshot(const Snapshot& snapshot)
+    {
+        Vddt_Vw_2 = snapshot.Vddt_Vw_2;
+        vx = snapshot.vx;
+        vc = snapshot.vc;
+    }
 };
 
 } // namespace reSIDfp
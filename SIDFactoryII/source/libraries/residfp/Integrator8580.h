@@ -105,6 +105,44 @@ public:
     }
 
     int solve(int vi) const;
+
+    /**
+     * Copy the state of another integrator, built from the same filter model.
+     */
+    void copyState(const Integrator8580& source)
+    {
+        vx = source.vx;
+        vc = source.vc;
+        nVgt = source.nVgt;
+        n_dac = source.n_dac;
+    }
+
+    /**
+     * State of the integrator, as copied by copyState().
+     */
+    struct Snapshot
+    {
+        int vx;
+        int vc;
+        unsigned short nVgt;
+        unsigned short n_dac;
+    };
+
+    void saveSnapshot(Snapshot& snapshot) const
+    {
+        snapshot.vx = vx;
+        snapshot.vc = vc;
+        snapshot.nVgt = nVgt;
+        snapshot.n_dac = n_dac;
+    }
+
+    void restoreSnapshot(const Snapshot& snapshot)
+    {
+        vx = snapshot.vx;
+        vc = snapshot.vc;
+        nVgt = snapshot.nVgt;
+        n_dac = snapshot.n_dac;
+    }
 };
 
 } // namespace reSIDfp
@@ -24,6 +24,7 @@
 
 #include "SID.h"
 
+#include <cassert>
 #include <limits>
 
 #include "array.h"
@@ -65,7 +66,8 @@ SID::SID() :
     externalFilter(new ExternalFilter()),
     resampler(nullptr),
     potX(new Potentiometer()),
-    potY(new Potentiometer())
+    potY(new Potentiometer()),
+    voiceTap(nullptr)
 {
     voice[0].reset(new Voice());
     voice[1].reset(new Voice());
@@ -184,6 +186,76 @@ void SID::reset()
     voiceSync(false);
 }
 
+void SID::copyState(const SID& source)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        voice[i]->copyState(*source.voice[i]);
+    }
+
+    filter6581->copyState(*source.filter6581);
+    filter8580->copyState(*source.filter8580);
+    filter = source.filter == source.filter6581.get() ? static_cast<Filter*>(filter6581.get()) : static_cast<Filter*>(filter8580.get());
+
+    *externalFilter = *source.externalFilter;
+
+    if (resampler.get() && source.resampler.get())
+    {
+        resampler->copyState(*source.resampler);
+    }
+
+    busValueTtl = source.busValueTtl;
+    modelTTL = source.modelTTL;
+    nextVoiceSync = source.nextVoiceSync;
+    model = source.model;
+    busValue = source.busValue;
+}
+
+void SID::saveSnapshot(Snapshot& snapshot) const
+{
+    for (int i = 0; i < 3; i++)
+    {
+        voice[i]->saveSnapshot(snapshot.voice[i]);
+    }
+
+    filter6581->saveSnapshot(snapshot.filter6581);
+    filter8580->saveSnapshot(snapshot.filter8580);
+    externalFilter->saveSnapshot(snapshot.externalFilter);
+
+    if (resampler.get())
+    {
+        resampler->savePhase(snapshot.resamplerPhase);
+    }
+
+    snapshot.busValueTtl = busValueTtl;
+    snapshot.nextVoiceSync = nextVoiceSync;
+    snapshot.model = model;
+    snapshot.busValue = busValue;
+}
+
+void SID::restoreSnapshot(const Snapshot& snapshot)
+{
+    assert(snapshot.model == model);
+
+    for (int i = 0; i < 3; i++)
+    {
+        voice[i]->restoreSnapshot(snapshot.voice[i]);
+    }
+
+    filter6581->restoreSnapshot(snapshot.filter6581);
+    filter8580->restoreSnapshot(snapshot.filter8580);
+    externalFilter->restoreSnapshot(snapshot.externalFilter);
+
+    if (resampler.get())
+    {
+        resampler->restorePhase(snapshot.resamplerPhase);
+    }
+
+    busValueTtl = snapshot.busValueTtl;
+    nextVoiceSync = snapshot.nextVoiceSync;
+    busValue = snapshot.busValue;
+}
+
 void SID::input(int value)
 {
     filter6581->input(value);
@@ -363,10 +435,37 @@ void SID::setSamplingParameters(double clockFrequency, SamplingMethod method, do
     }
 }
 
+int SID::clock(const RegisterWrite* writes, unsigned int count, unsigned int cycles, short* buf)
+{
+    unsigned int cycle = 0;
+    int s = 0;
+
+    for (const RegisterWrite* write_it = writes; write_it != writes + count; ++write_it)
+    {
+        if (write_it->cycle > cycle)
+        {
+            s += clock(write_it->cycle - cycle, buf + s);
+            cycle = write_it->cycle;
+        }
+
+        write(write_it->offset, write_it->value);
+    }
+
+    if (cycles > cycle)
+    {
+        s += clock(cycles - cycle, buf + s);
+    }
+
+    return s;
+}
+
 void SID::clockSilent(unsigned int cycles)
 {
     ageBusValue(cycles);
 
+    // keep the output samples on the same cycles as when clocked with audio
+    resampler->skip(cycles);
+
     while (cycles != 0)
     {
         int delta_t = std::min(nextVoiceSync, cycles);
@@ -384,7 +483,10 @@ void SID::clockSilent(unsigned int cycles)
                 voice[1]->wave()->output(voice[0]->wave());
                 voice[2]->wave()->output(voice[1]->wave());
 
-                // clock ENV3 only
+                // clock all envelope generators, so that voices sound at
+                // the right level when audio-producing clocking resumes
+                voice[0]->envelope()->clock();
+                voice[1]->envelope()->clock();
                 voice[2]->envelope()->clock();
             }
 
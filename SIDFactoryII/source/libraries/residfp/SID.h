@@ -26,6 +26,11 @@
 #include <memory>
 
 #include "siddefs-fp.h"
+#include "Voice.h"
+#include "Filter6581.h"
+#include "Filter8580.h"
+#include "ExternalFilter.h"
+#include "resample/Resampler.h"
 
 //#include "sidcxx11.h"
 
@@ -38,6 +43,7 @@ class Filter8580;
 class ExternalFilter;
 class Potentiometer;
 class Voice;
+class VoiceTap;
 class Resampler;
 
 /**
@@ -54,6 +60,16 @@ public:
     const char* getMessage() const { return message; }
 };
 
+/**
+ * Register write, at a cycle relative to the start of a batched clock call.
+ */
+struct RegisterWrite
+{
+    unsigned int cycle;
+    unsigned char offset;
+    unsigned char value;
+};
+
 /**
  * MOS6581/MOS8580 emulation.
  */
@@ -105,6 +121,9 @@ private:
     /// Flags for muted channels
     bool muted[3];
 
+    /// Recorder of the voice outputs, if any
+    VoiceTap* voiceTap;
+
 private:
     /**
      * Age the bus value and zero it if it's TTL has expired.
@@ -150,6 +169,49 @@ public:
      */
     void reset();
 
+    /**
+     * Copy the emulation state of another SID, to continue clocking from
+     * where it is. Both SIDs must have the same sampling parameters.
+     * Settings like filter curves and muted voices are not copied.
+     *
+     * @param source the SID to copy from
+     */
+    void copyState(const SID& source);
+
+    /**
+     * Compact snapshot of the emulation state. Unlike a SID copied with
+     * copyState(), it holds none of the tables of the chip model, and of
+     * the resampler only its output phase.
+     */
+    struct Snapshot
+    {
+        Voice::Snapshot voice[3];
+        Filter6581::Snapshot filter6581;
+        Filter8580::Snapshot filter8580;
+        ExternalFilter::Snapshot externalFilter;
+        int resamplerPhase[Resampler::MaxPasses];
+        int busValueTtl;
+        unsigned int nextVoiceSync;
+        ChipModel model;
+        unsigned char busValue;
+    };
+
+    /**
+     * Save the emulation state to a snapshot.
+     *
+     * @param snapshot the snapshot to save to
+     */
+    void saveSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * Restore the emulation state from a snapshot saved by a SID of the same
+     * chip model and sampling parameters. The sample history of the resampler
+     * is cleared, so clock with audio output for a while before using it.
+     *
+     * @param snapshot the snapshot to restore from
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
+
     /**
      * 16-bit input (EXT IN). Write 16-bit sample to audio input. NB! The caller
      * is responsible for keeping the value within 16 bits. Note that to mix in
@@ -198,6 +260,15 @@ public:
      */
     void mute(int channel, bool enable) { muted[channel] = enable; }
 
+    /**
+     * Record the outputs of the voices, before they are filtered, while
+     * clocking with audio output. The tap is owned by the caller and
+     * is not copied with the state.
+     *
+     * @param tap the voice tap, or nullptr to stop recording
+     */
+    void setVoiceTap(VoiceTap* tap) { voiceTap = tap; }
+
     /**
      * Setting of SID sampling parameters.
      *
@@ -234,13 +305,27 @@ public:
      */
     int clock(unsigned int cycles, short* buf);
 
+    /**
+     * Clock SID forward through a list of register writes, applying each
+     * write at its cycle. Produces the same output as alternating calls to
+     * clock() and write(), in a single call.
+     *
+     * @param writes register writes, ordered by cycle
+     * @param count number of register writes
+     * @param cycles c64 clocks to clock, not less than the cycle of the last write
+     * @param buf audio output buffer
+     * @return number of samples produced
+     */
+    int clock(const RegisterWrite* writes, unsigned int count, unsigned int cycles, short* buf);
+
     /**
      * Clock SID forward with no audio production.
      *
      * _Warning_:
-     * You can't mix this method of clocking with the audio-producing
-     * clock() because components that don't affect OSC3/ENV3 are not
-     * emulated.
+     * Mixing this method of clocking with the audio-producing clock()
+     * is only approximate, because the filter is not emulated.
+     * The waveform and envelope generators are, and the resampler keeps
+     * its output phase, but its sample history is not refilled.
      *
      * @param cycles c64 clocks to clock.
      */
@@ -277,6 +362,7 @@ public:
 #include "Filter.h"
 #include "ExternalFilter.h"
 #include "Voice.h"
+#include "VoiceTap.h"
 #include "resample/Resampler.h"
 
 namespace reSIDfp
@@ -304,6 +390,11 @@ int SID::output() const
     const int v2 = voice[1]->output(voice[0]->wave());
     const int v3 = voice[2]->output(voice[1]->wave());
 
+    if (unlikely(voiceTap != nullptr))
+    {
+        voiceTap->input(v1, v2, v3);
+    }
+
     return externalFilter->clock(filter->clock(v1, v2, v3));
 }
 
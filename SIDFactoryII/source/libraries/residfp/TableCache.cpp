@@ -0,0 +1,179 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "TableCache.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace reSIDfp
+{
+
+/**
+ * Cache file layout, in native byte order:
+ *
+ *     "RSFC", format version, key, table count, checksum of the tables
+ *     size of each table
+ *     data of each table
+ */
+const char MAGIC[4] = { 'R', 'S', 'F', 'C' };
+const unsigned int FORMAT_VERSION = 1;
+const unsigned int HEADER_WORDS = 4;
+
+/**
+ * Fletcher style checksum of the table values, to detect a damaged file.
+ * Much faster than hashing the bytes, which would take a good part
+ * of the time saved by reading the tables.
+ */
+static void addChecksum(const unsigned short* data, unsigned int size, unsigned int& sum1, unsigned int& sum2)
+{
+    for (unsigned int i = 0; i < size; i++)
+    {
+        sum1 += data[i];
+        sum2 += sum1;
+    }
+}
+
+std::string TableCache::directory;
+
+void TableCache::setDirectory(const std::string& path)
+{
+    directory = path;
+}
+
+bool TableCache::load(const char* name, unsigned int key, const std::vector<Table>& tables)
+{
+    if (directory.empty())
+    {
+        return false;
+    }
+
+    FILE* file = fopen((directory + name).c_str(), "rb");
+
+    if (file == nullptr)
+    {
+        return false;
+    }
+
+    char magic[4];
+    unsigned int header[HEADER_WORDS];
+
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1
+        && memcmp(magic, MAGIC, sizeof(MAGIC)) == 0
+        && fread(header, sizeof(header), 1, file) == 1
+        && header[0] == FORMAT_VERSION
+        && header[1] == key
+        && header[2] == tables.size();
+
+    for (size_t i = 0; ok && i < tables.size(); i++)
+    {
+        unsigned int size;
+        ok = fread(&size, sizeof(size), 1, file) == 1 && size == tables[i].size;
+    }
+
+    unsigned int sum1 = 0;
+    unsigned int sum2 = 0;
+
+    for (size_t i = 0; ok && i < tables.size(); i++)
+    {
+        const size_t bytes = tables[i].size * sizeof(unsigned short);
+        ok = fread(tables[i].data, 1, bytes, file) == bytes;
+
+        if (ok)
+        {
+            addChecksum(tables[i].data, tables[i].size, sum1, sum2);
+        }
+    }
+
+    fclose(file);
+
+    return ok && (sum1 ^ (sum2 << 16 | sum2 >> 16)) == header[3];
+}
+
+void TableCache::save(const char* name, unsigned int key, const std::vector<Table>& tables)
+{
+    if (directory.empty())
+    {
+        return;
+    }
+
+    unsigned int sum1 = 0;
+    unsigned int sum2 = 0;
+
+    for (size_t i = 0; i < tables.size(); i++)
+    {
+        addChecksum(tables[i].data, tables[i].size, sum1, sum2);
+    }
+
+    const unsigned int header[HEADER_WORDS] = { FORMAT_VERSION, key, static_cast<unsigned int>(tables.size()), sum1 ^ (sum2 << 16 | sum2 >> 16) };
+
+    // Write to a temporary file and rename it, so another process never reads a partly written cache
+    const std::string path = directory + name;
+    const std::string temporary_path = path + ".tmp";
+
+    FILE* file = fopen(temporary_path.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        return;
+    }
+
+    bool ok = fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1
+        && fwrite(header, sizeof(header), 1, file) == 1;
+
+    for (size_t i = 0; ok && i < tables.size(); i++)
+    {
+        ok = fwrite(&tables[i].size, sizeof(tables[i].size), 1, file) == 1;
+    }
+
+    for (size_t i = 0; ok && i < tables.size(); i++)
+    {
+        const size_t bytes = tables[i].size * sizeof(unsigned short);
+        ok = fwrite(tables[i].data, 1, bytes, file) == bytes;
+    }
+
+    ok = fclose(file) == 0 && ok;
+
+    if (ok)
+    {
+        // Rename does not replace an existing file on every platform
+        remove(path.c_str());
+        ok = rename(temporary_path.c_str(), path.c_str()) == 0;
+    }
+
+    if (!ok)
+    {
+        remove(temporary_path.c_str());
+    }
+}
+
+unsigned int TableCache::hash(const void* data, size_t size, unsigned int seed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+    unsigned int result = seed;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        result = (result ^ bytes[i]) * 16777619u;
+    }
+
+    return result;
+}
+
+} // namespace reSIDfp
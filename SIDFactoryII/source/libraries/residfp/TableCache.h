@@ -0,0 +1,91 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TABLECACHE_H
+#define TABLECACHE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace reSIDfp
+{
+
+/**
+ * Stores lookup tables that are expensive to calculate in files, so they
+ * can be read back by the next process instead of calculated again.
+ *
+ * A cache file is identified by its name and a key, which is a hash of the
+ * parameters the tables are calculated from. A file with another key, other
+ * table sizes or a bad checksum is ignored, and replaced when the tables
+ * are saved again.
+ */
+class TableCache
+{
+public:
+    struct Table
+    {
+        unsigned short* data;
+        unsigned int size;
+    };
+
+private:
+    static std::string directory;
+
+public:
+    /**
+     * Set the directory of the cache files. With an empty directory, which
+     * is the default, the cache is disabled.
+     *
+     * @param path directory, ending with a path separator
+     */
+    static void setDirectory(const std::string& path);
+
+    /**
+     * Read the tables from a cache file.
+     *
+     * @param name name of the cache file
+     * @param key hash of the parameters the tables are calculated from
+     * @param tables tables to read, allocated to their size
+     * @return true if the tables were read
+     */
+    static bool load(const char* name, unsigned int key, const std::vector<Table>& tables);
+
+    /**
+     * Write the tables to a cache file. Failing to write is not an error,
+     * the tables are calculated again next time.
+     *
+     * @param name name of the cache file
+     * @param key hash of the parameters the tables are calculated from
+     * @param tables tables to write
+     */
+    static void save(const char* name, unsigned int key, const std::vector<Table>& tables);
+
+    /**
+     * FNV-1a hash, for building the key.
+     *
+     * @param data data to hash
+     * @param size size of the data in bytes
+     * @param seed hash of the data before it
+     */
+    static unsigned int hash(const void* data, size_t size, unsigned int seed = 2166136261u);
+};
+
+} // namespace reSIDfp
+
+#endif
@@ -76,6 +76,48 @@ public:
 
     EnvelopeGenerator* envelope() const { return envelopeGenerator.get(); }
 
+    /**
+     * Copy the state of another voice.
+     *
+     * @param source the voice to copy from
+     */
+    void copyState(const Voice& source)
+    {
+        *waveformGenerator = *source.waveformGenerator;
+        *envelopeGenerator = *source.envelopeGenerator;
+    }
+
+    /**
+     * State of the voice, without the model tables.
+     */
+    struct Snapshot
+    {
+        WaveformGenerator::Snapshot waveformGenerator;
+        EnvelopeGenerator::Snapshot envelopeGenerator;
+    };
+
+    /**
+     * Save the state, to restore it into a voice of the same chip model.
+     *
+     * @param snapshot the snapshot to save to
+     */
+    void saveSnapshot(Snapshot& snapshot) const
+    {
+        waveformGenerator->saveSnapshot(snapshot.waveformGenerator);
+        envelopeGenerator->saveSnapshot(snapshot.envelopeGenerator);
+    }
+
+    /**
+     * Restore a state saved with saveSnapshot().
+     *
+     * @param snapshot the snapshot to restore from
+     */
+    void restoreSnapshot(const Snapshot& snapshot)
+    {
+        waveformGenerator->restoreSnapshot(snapshot.waveformGenerator);
+        envelopeGenerator->restoreSnapshot(snapshot.envelopeGenerator);
+    }
+
     /**
      * Write control register.
      *
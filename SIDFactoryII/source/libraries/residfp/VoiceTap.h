@@ -0,0 +1,143 @@
+/*
+ * This file is part of libsidplayfp, a SID player engine.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef VOICETAP_H
+#define VOICETAP_H
+
+#include "siddefs-fp.h"
+
+namespace reSIDfp
+{
+
+/**
+ * Records the outputs of the three voices, before they are mixed and
+ * filtered, at a lower sample frequency than the clock frequency.
+ *
+ * Each recorded sample is the average of the voice outputs over the cycles
+ * since the previous sample, scaled to 16 bits. The samples of the three
+ * voices are interleaved in the buffer. Recording stops when the buffer is
+ * full, the caller provides a new buffer before each clock call.
+ */
+class VoiceTap
+{
+private:
+    /// Cycles per sample, in 16.16 fixed point.
+    const int cyclesPerSample;
+
+    /// Cycles since the last sample, in 16.16 fixed point.
+    int cycleCount;
+
+    /// Number of cycles summed.
+    int sumCount;
+
+    /// Sum of the voice outputs since the last sample.
+    int sum[3];
+
+    short* buffer;
+    unsigned int bufferSize;
+    unsigned int bufferPosition;
+
+private:
+    static short toSample(int value, int count)
+    {
+        // The waveform DAC output is offset by the zero level of the model, which makes
+        // the voice output range about [-2496*255, 3200*255] for both models together
+        const int sample = value / count >> 5;
+        return static_cast<short>(sample < -32768 ? -32768 : (sample > 32767 ? 32767 : sample));
+    }
+
+public:
+    /**
+     * Constructor.
+     *
+     * @param clockFrequency System clock frequency at Hz
+     * @param samplingFrequency Sample frequency of the recorded voices,
+     * not less than clockFrequency / 4000 to keep the sums in range
+     */
+    VoiceTap(double clockFrequency, double samplingFrequency) :
+        cyclesPerSample(static_cast<int>(clockFrequency / samplingFrequency * 65536.0 + 0.5)),
+        buffer(nullptr),
+        bufferSize(0),
+        bufferPosition(0)
+    {
+        reset();
+    }
+
+    /**
+     * Set the buffer to record into.
+     *
+     * @param buf buffer of three interleaved values per sample
+     * @param size size of the buffer in samples
+     */
+    void setBuffer(short* buf, unsigned int size)
+    {
+        buffer = buf;
+        bufferSize = size;
+        bufferPosition = 0;
+    }
+
+    /**
+     * Get the number of samples recorded since the buffer was set.
+     */
+    unsigned int getSampleCount() const { return bufferPosition; }
+
+    /**
+     * Forget the cycles summed for the next sample.
+     */
+    void reset()
+    {
+        cycleCount = 0;
+        sumCount = 0;
+        sum[0] = sum[1] = sum[2] = 0;
+    }
+
+    /**
+     * Input the voice outputs of a cycle.
+     */
+    RESID_INLINE
+    void input(int v1, int v2, int v3)
+    {
+        sum[0] += v1;
+        sum[1] += v2;
+        sum[2] += v3;
+        sumCount++;
+
+        cycleCount += 1 << 16;
+
+        if (unlikely(cycleCount >= cyclesPerSample))
+        {
+            cycleCount -= cyclesPerSample;
+
+            if (likely(bufferPosition < bufferSize))
+            {
+                short* sample = buffer + bufferPosition * 3;
+                sample[0] = toSample(sum[0], sumCount);
+                sample[1] = toSample(sum[1], sumCount);
+                sample[2] = toSample(sum[2], sumCount);
+                bufferPosition++;
+            }
+
+            sumCount = 0;
+            sum[0] = sum[1] = sum[2] = 0;
+        }
+    }
+};
+
+} // namespace reSIDfp
+
+#endif
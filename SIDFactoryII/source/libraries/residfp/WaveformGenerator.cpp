@@ -296,4 +296,54 @@ void WaveformGenerator::reset()
     floating_output_ttl = 0;
 }
 
+void WaveformGenerator::saveSnapshot(Snapshot& snapshot) const
+{
+    snapshot.wave = wave;
+    snapshot.pw = pw;
+    snapshot.shift_register = shift_register;
+    snapshot.shift_pipeline = shift_pipeline;
+    snapshot.ring_msb_mask = ring_msb_mask;
+    snapshot.no_noise = no_noise;
+    snapshot.noise_output = noise_output;
+    snapshot.no_noise_or_noise_output = no_noise_or_noise_output;
+    snapshot.no_pulse = no_pulse;
+    snapshot.pulse_output = pulse_output;
+    snapshot.waveform = waveform;
+    snapshot.floating_output_ttl = floating_output_ttl;
+    snapshot.waveform_output = waveform_output;
+    snapshot.accumulator = accumulator;
+    snapshot.freq = freq;
+    snapshot.tri_saw_pipeline = tri_saw_pipeline;
+    snapshot.osc3 = osc3;
+    snapshot.shift_register_reset = shift_register_reset;
+    snapshot.test = test;
+    snapshot.sync = sync;
+    snapshot.msb_rising = msb_rising;
+}
+
+void WaveformGenerator::restoreSnapshot(const Snapshot& snapshot)
+{
+    wave = snapshot.wave;
+    pw = snapshot.pw;
+    shift_register = snapshot.shift_register;
+    shift_pipeline = snapshot.shift_pipeline;
+    ring_msb_mask = snapshot.ring_msb_mask;
+    no_noise = snapshot.no_noise;
+    noise_output = snapshot.noise_output;
+    no_noise_or_noise_output = snapshot.no_noise_or_noise_output;
+    no_pulse = snapshot.no_pulse;
+    pulse_output = snapshot.pulse_output;
+    waveform = snapshot.waveform;
+    floating_output_ttl = snapshot.floating_output_ttl;
+    waveform_output = snapshot.waveform_output;
+    accumulator = snapshot.accumulator;
+    freq = snapshot.freq;
+    tri_saw_pipeline = snapshot.tri_saw_pipeline;
+    osc3 = snapshot.osc3;
+    shift_register_reset = snapshot.shift_register_reset;
+    test = snapshot.test;
+    sync = snapshot.sync;
+    msb_rising = snapshot.msb_rising;
+}
+
 } // namespace reSIDfp
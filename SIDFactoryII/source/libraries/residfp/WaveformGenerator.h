@@ -152,6 +152,35 @@ private:
 
     void set_noise_output();
 
+public:
+    /**
+     * State of the waveform generator, without the model tables.
+     */
+    struct Snapshot
+    {
+        short* wave;
+        unsigned int pw;
+        unsigned int shift_register;
+        int shift_pipeline;
+        unsigned int ring_msb_mask;
+        unsigned int no_noise;
+        unsigned int noise_output;
+        unsigned int no_noise_or_noise_output;
+        unsigned int no_pulse;
+        unsigned int pulse_output;
+        unsigned int waveform;
+        int floating_output_ttl;
+        unsigned int waveform_output;
+        unsigned int accumulator;
+        unsigned int freq;
+        unsigned int tri_saw_pipeline;
+        unsigned int osc3;
+        int shift_register_reset;
+        bool test;
+        bool sync;
+        bool msb_rising;
+    };
+
 public:
     void setWaveformModels(matrix_t* models);
 
@@ -247,6 +276,20 @@ public:
      */
     void reset();
 
+    /**
+     * Save the state, to restore it into a waveform generator of the same chip model.
+     *
+     * @param snapshot the snapshot to save to
+     */
+    void saveSnapshot(Snapshot& snapshot) const;
+
+    /**
+     * Restore a state saved with saveSnapshot().
+     *
+     * @param snapshot the snapshot to restore from
+     */
+    void restoreSnapshot(const Snapshot& snapshot);
+
     /**
      * 12-bit waveform output as an analogue float value.
      *
@@ -36,6 +36,10 @@ protected:
 
     Resampler() {}
 
+public:
+    /// Most passes of a resampler, each with an output phase of its own
+    static const int MaxPasses = 2;
+
 public:
     virtual ~Resampler() {}
 
@@ -64,6 +68,36 @@ public:
     }
 
     virtual void reset() = 0;
+
+    /**
+     * Copy the state of another resampler, created with the same sampling parameters.
+     *
+     * @param source the resampler to copy from
+     */
+    virtual void copyState(const Resampler& source) = 0;
+
+    /**
+     * Advance the output phase over a number of input samples without producing output.
+     * The sample history is left stale, it is refilled by the following calls to input().
+     *
+     * @param count number of input samples to skip
+     * @return number of output samples skipped
+     */
+    virtual int skip(unsigned int count) = 0;
+
+    /**
+     * Save the output phase of each pass, which is the state of the resampler apart from its sample history.
+     *
+     * @param phase array of MaxPasses phases to save to
+     */
+    virtual void savePhase(int* phase) const = 0;
+
+    /**
+     * Restore an output phase saved with savePhase(), and clear the sample history.
+     *
+     * @param phase array of MaxPasses phases to restore from
+     */
+    virtual void restorePhase(const int* phase) = 0;
 };
 
 } // namespace reSIDfp
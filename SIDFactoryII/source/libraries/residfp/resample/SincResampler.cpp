@@ -35,8 +35,12 @@
 #  include "config.h"
 #endif
 
-#ifdef HAVE_MMINTRIN_H
-#  include <mmintrin.h>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#  define HAVE_X86_SIMD
+#  include <immintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
 #endif
 
 namespace reSIDfp
@@ -87,28 +91,85 @@ double I0(double x)
  * @param bLength length of the sinc buffer
  * @return convolved result
  */
-int convolve(const short* a, const short* b, int bLength)
+int convolveScalar(const short* a, const short* b, int bLength)
 {
-#ifdef HAVE_MMINTRIN_H
-    __m64 acc = _mm_setzero_si64();
+    int out = 0;
+
+    for (int i = 0; i < bLength; i++)
+    {
+        out += *a++ * *b++;
+    }
+
+    return (out + (1 << 14)) >> 15;
+}
+
+#ifdef HAVE_X86_SIMD
 
-    const int n = bLength / 4;
+/*
+ * The SIMD kernels multiply pairs of samples into 32 bit sums and add them
+ * with wrap around, so the result is bit identical to the scalar loop.
+ */
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("sse2")))
+#endif
+int convolveSSE2(const short* a, const short* b, int bLength)
+{
+    __m128i acc = _mm_setzero_si128();
+
+    const int n = bLength / 8;
 
     for (int i = 0; i < n; i++)
     {
-        const __m64 tmp = _mm_madd_pi16(*(__m64*)a, *(__m64*)b);
-        acc = _mm_add_pi16(acc, tmp);
-        a += 4;
-        b += 4;
+        const __m128i tmp = _mm_madd_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(a)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b)));
+        acc = _mm_add_epi32(acc, tmp);
+        a += 8;
+        b += 8;
     }
 
-    int out = _mm_cvtsi64_si32(acc) + _mm_cvtsi64_si32(_mm_srli_si64(acc, 32));
-    _mm_empty();
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
 
-    bLength &= 3;
-#else
-    int out = 0;
+    int out = _mm_cvtsi128_si32(acc);
+
+    bLength &= 7;
+
+    for (int i = 0; i < bLength; i++)
+    {
+        out += *a++ * *b++;
+    }
+
+    return (out + (1 << 14)) >> 15;
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((target("avx2")))
 #endif
+int convolveAVX2(const short* a, const short* b, int bLength)
+{
+    __m256i acc = _mm256_setzero_si256();
+
+    const int n = bLength / 16;
+
+    for (int i = 0; i < n; i++)
+    {
+        const __m256i tmp = _mm256_madd_epi16(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b)));
+        acc = _mm256_add_epi32(acc, tmp);
+        a += 16;
+        b += 16;
+    }
+
+    __m128i acc128 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc128 = _mm_add_epi32(acc128, _mm_shuffle_epi32(acc128, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    int out = _mm_cvtsi128_si32(acc128);
+
+    bLength &= 15;
 
     for (int i = 0; i < bLength; i++)
     {
@@ -118,6 +179,76 @@ int convolve(const short* a, const short* b, int bLength)
     return (out + (1 << 14)) >> 15;
 }
 
+bool hasSSE2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#else
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#endif
+}
+
+bool hasAVX2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#else
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // AVX2 also needs the operating system to save the ymm registers
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#endif
+}
+
+#endif // HAVE_X86_SIMD
+
+std::vector<ConvolveKernel> getSIMDConvolveKernels()
+{
+    std::vector<ConvolveKernel> kernels;
+
+#ifdef HAVE_X86_SIMD
+    if (hasSSE2())
+        kernels.push_back({ "SSE2", convolveSSE2 });
+
+    if (hasAVX2())
+        kernels.push_back({ "AVX2", convolveAVX2 });
+#endif
+
+    return kernels;
+}
+
+/**
+ * Select the fastest convolution kernel supported by the CPU.
+ */
+convolve_t selectConvolve()
+{
+#ifdef HAVE_X86_SIMD
+    if (hasAVX2())
+        return convolveAVX2;
+
+    if (hasSSE2())
+        return convolveSSE2;
+#endif
+
+    return convolveScalar;
+}
+
+const convolve_t convolve = selectConvolve();
+
 int SincResampler::fir(int subcycle)
 {
     // Find the first of the nearest fir tables close to the phase
@@ -272,4 +403,34 @@ void SincResampler::reset()
     sampleOffset = 0;
 }
 
+void SincResampler::copyState(const Resampler& source)
+{
+    const SincResampler& sincSource = static_cast<const SincResampler&>(source);
+
+    assert(firTable == sincSource.firTable);
+
+    memcpy(sample, sincSource.sample, sizeof(sample));
+    sampleIndex = sincSource.sampleIndex;
+    sampleOffset = sincSource.sampleOffset;
+    outputValue = sincSource.outputValue;
+}
+
+int SincResampler::skip(unsigned int count)
+{
+    int skipped = 0;
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        if (sampleOffset < 1024)
+        {
+            sampleOffset += cyclesPerSample;
+            skipped++;
+        }
+
+        sampleOffset -= 1024;
+    }
+
+    return skipped;
+}
+
 } // namespace reSIDfp
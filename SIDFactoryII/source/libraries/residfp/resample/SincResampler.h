@@ -27,6 +27,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 
 #include "../array.h"
 
@@ -36,6 +37,28 @@
 namespace reSIDfp
 {
 
+typedef int (*convolve_t)(const short* a, const short* b, int bLength);
+
+/**
+ * A convolution kernel of the resampler.
+ */
+struct ConvolveKernel
+{
+    const char* name;
+    convolve_t convolve;
+};
+
+/**
+ * Calculate convolution with sample and sinc, one product at a time.
+ * All other kernels must return the same result.
+ */
+int convolveScalar(const short* a, const short* b, int bLength);
+
+/**
+ * Get the SIMD convolution kernels the CPU supports, so they can be checked against convolveScalar.
+ */
+std::vector<ConvolveKernel> getSIMDConvolveKernels();
+
 /**
  * This is the theoretically correct (and computationally intensive) audio sample generation.
  * The samples are generated by resampling to the specified sampling frequency.
@@ -108,6 +131,18 @@ public:
     int output() const override { return outputValue; }
 
     void reset() override;
+
+    void copyState(const Resampler& source) override;
+
+    int skip(unsigned int count) override;
+
+    void savePhase(int* phase) const override { phase[0] = sampleOffset; }
+
+    void restorePhase(const int* phase) override
+    {
+        reset();
+        sampleOffset = phase[0];
+    }
 };
 
 } // namespace reSIDfp
@@ -76,6 +76,31 @@ public:
         s1->reset();
         s2->reset();
     }
+
+    void copyState(const Resampler& source) override
+    {
+        const TwoPassSincResampler& twoPassSource = static_cast<const TwoPassSincResampler&>(source);
+
+        s1->copyState(*twoPassSource.s1);
+        s2->copyState(*twoPassSource.s2);
+    }
+
+    int skip(unsigned int count) override
+    {
+        return s2->skip(static_cast<unsigned int>(s1->skip(count)));
+    }
+
+    void savePhase(int* phase) const override
+    {
+        s1->savePhase(phase);
+        s2->savePhase(phase + 1);
+    }
+
+    void restorePhase(const int* phase) override
+    {
+        s1->restorePhase(phase);
+        s2->restorePhase(phase + 1);
+    }
 };
 
 } // namespace reSIDfp
@@ -82,6 +82,41 @@ public:
         sampleOffset = 0;
         cachedSample = 0;
     }
+
+    void copyState(const Resampler& source) override
+    {
+        const ZeroOrderResampler& zeroOrderSource = static_cast<const ZeroOrderResampler&>(source);
+
+        cachedSample = zeroOrderSource.cachedSample;
+        sampleOffset = zeroOrderSource.sampleOffset;
+        outputValue = zeroOrderSource.outputValue;
+    }
+
+    int skip(unsigned int count) override
+    {
+        int skipped = 0;
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            if (sampleOffset < 1024)
+            {
+                sampleOffset += cyclesPerSample;
+                skipped++;
+            }
+
+            sampleOffset -= 1024;
+        }
+
+        return skipped;
+    }
+
+    void savePhase(int* phase) const override { phase[0] = sampleOffset; }
+
+    void restorePhase(const int* phase) override
+    {
+        reset();
+        sampleOffset = phase[0];
+    }
 };
 
 } // namespace reSIDfp
@@ -0,0 +1,160 @@
+#include "component_cpu_profile.h"
+
+#include "foundation/graphics/textfield.h"
+#include "foundation/input/mouse.h"
+#include "foundation/input/keyboard.h"
+
+#include "runtime/editor/cursor_control.h"
+#include "runtime/editor/datasources/datasource_cpuprofiler.h"
+#include "runtime/editor/display_state.h"
+
+#include "SDL_keycode.h"
+#include "foundation/base/assert.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace Foundation;
+
+namespace Editor
+{
+	ComponentCPUProfile::ComponentCPUProfile(int inID, int inGroupID, Undo* inUndo, std::shared_ptr<DataSourceCPUProfiler> inDataSource, Foundation::TextField* inTextField, int inX, int inY, int inWidth, int inHeight)
+		: ComponentBase(inID, inGroupID, inUndo, inTextField, inX, inY, inWidth, inHeight)
+		, m_DataSource(inDataSource)
+		, m_TopVisible(0)
+		, m_ResetRequested(false)
+	{
+		FOUNDATION_ASSERT(inDataSource != nullptr);
+		FOUNDATION_ASSERT(inTextField != nullptr);
+	}
+
+	ComponentCPUProfile::~ComponentCPUProfile()
+	{
+
+	}
+
+	//----------------------------------------------------------------------------------------------------------------------------------------
+
+	bool ComponentCPUProfile::ConsumeInput(const Foundation::Keyboard& inKeyboard, CursorControl& inCursorControl, ComponentsManager& inComponentsManager)
+	{
+		if (m_HasControl)
+		{
+			for (const auto& key_event : inKeyboard.GetKeyEventList())
+			{
+				switch (key_event)
+				{
+				case SDLK_UP:
+					if (m_TopVisible > 0)
+						--m_TopVisible;
+					return true;
+				case SDLK_DOWN:
+					++m_TopVisible;
+					return true;
+				case SDLK_HOME:
+					m_TopVisible = 0;
+					return true;
+				case SDLK_DELETE:
+					m_ResetRequested = true;
+					return true;
+				default:
+					break;
+				}
+			}
+		}
+
+		return false;
+	}
+
+
+	bool ComponentCPUProfile::ConsumeInput(const Foundation::Mouse& inMouse, bool inModifierKeyMask, CursorControl& inCursorControl, ComponentsManager& inComponentsManager)
+	{
+		return false;
+	}
+
+
+	bool ComponentCPUProfile::ConsumeNonExclusiveInput(const Foundation::Mouse& inMouse)
+	{
+		return false;
+	}
+
+
+	//----------------------------------------------------------------------------------------------------------------------------------------
+
+	void ComponentCPUProfile::Refresh(const DisplayState& inDisplayState)
+	{
+		if (m_RequireRefresh && m_TextField->IsEnabled())
+		{
+			m_DataSource->Lock();
+
+			if (m_ResetRequested)
+			{
+				m_DataSource->Reset();
+				m_ResetRequested = false;
+			}
+			else
+				m_DataSource->Refresh();
+
+			m_DataSource->Unlock();
+
+			const bool is_uppercase = inDisplayState.IsHexUppercase();
+			const unsigned int execute_count = std::max(m_DataSource->GetExecuteCount(), 1u);
+			const unsigned int row_count = static_cast<unsigned int>(std::max(m_Dimensions.m_Height - 2, 0));
+			const unsigned int routine_count = static_cast<unsigned int>(m_DataSource->GetSize());
+
+			if (m_TopVisible + row_count > routine_count)
+				m_TopVisible = routine_count > row_count ? routine_count - row_count : 0;
+
+			m_TextField->ClearText(m_Position.m_X, m_Position.m_Y, m_Dimensions.m_Width, m_Dimensions.m_Height);
+
+			{
+				std::stringstream stream;
+				stream << "Updates: " << m_DataSource->GetExecuteCount()
+					<< "  Avg: " << std::fixed << std::setprecision(1) << static_cast<double>(m_DataSource->GetTotalCycles()) / execute_count;
+
+				m_TextField->Print(m_Position.m_X, m_Position.m_Y, stream.str());
+			}
+
+			m_TextField->Print(m_Position.m_X, m_Position.m_Y + 1, "Addr Calls/upd  Cyc/upd  Peak  Self");
+
+			for (unsigned int i = 0; i < row_count && m_TopVisible + i < routine_count; ++i)
+			{
+				const Emulation::CPUProfiler::Routine& routine = (*m_DataSource)[m_TopVisible + i];
+				const int y = m_Position.m_Y + 2 + static_cast<int>(i);
+
+				std::stringstream stream;
+				stream << std::fixed << std::setprecision(2) << std::setw(9) << static_cast<double>(routine.m_CallCount) / execute_count
+					<< std::setprecision(1) << std::setw(9) << static_cast<double>(routine.m_InclusiveCycles) / execute_count
+					<< std::setw(6) << routine.m_PeakInclusiveCycles
+					<< std::setw(6) << static_cast<unsigned int>(routine.m_ExclusiveCycles / execute_count);
+
+				m_TextField->PrintHexValue(m_Position.m_X, y, is_uppercase, routine.m_Address);
+				m_TextField->Print(m_Position.m_X + 5, y, stream.str());
+			}
+		}
+	}
+
+
+	void ComponentCPUProfile::HandleDataChange()
+	{
+		if (m_HasDataChange)
+			m_HasDataChange = false;
+	}
+
+
+	void ComponentCPUProfile::PullDataFromSource(const bool inFromUndo)
+	{
+	}
+
+
+	void ComponentCPUProfile::ExecuteInsertDeleteRule(const DriverInfo::TableInsertDeleteRule& inRule, int inSourceTableID, int inIndexPre, int inIndexPost)
+	{
+
+	}
+
+
+	void ComponentCPUProfile::ExecuteAction(int inActionInput)
+	{
+
+	}
+}
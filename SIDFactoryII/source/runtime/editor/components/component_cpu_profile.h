@@ -0,0 +1,42 @@
+#pragma once
+
+#include "component_base.h"
+
+#include <memory>
+
+namespace Foundation
+{
+	class TextField;
+}
+
+namespace Editor
+{
+	class CursorControl;
+	class ScreenBase;
+	class DataSourceCPUProfiler;
+
+	// Lists the routines of the driver, by the number of cycles spend in them, from the CPU profiler
+	class ComponentCPUProfile final : public ComponentBase
+	{
+	public:
+		ComponentCPUProfile(int inID, int inGroupID, Undo* inUndo, std::shared_ptr<DataSourceCPUProfiler> inDataSource, Foundation::TextField* inTextField, int inX, int inY, int inWidth, int inHeight);
+		~ComponentCPUProfile();
+
+		bool ConsumeInput(const Foundation::Keyboard& inKeyboard, CursorControl& inCursorControl, ComponentsManager& inComponentsManager) override;
+		bool ConsumeInput(const Foundation::Mouse& inMouse, bool inModifierKeyMask, CursorControl& inCursorControl, ComponentsManager& inComponentsManager) override;
+		bool ConsumeNonExclusiveInput(const Foundation::Mouse& inMouse) override;
+
+		void Refresh(const DisplayState& inDisplayState) override;
+		void HandleDataChange() override;
+		void PullDataFromSource(const bool inFromUndo) override;
+
+		void ExecuteInsertDeleteRule(const DriverInfo::TableInsertDeleteRule& inRule, int inSourceTableID, int inIndexPre, int inIndexPost) override;
+		void ExecuteAction(int inActionInput) override;
+
+	private:
+		std::shared_ptr<DataSourceCPUProfiler> m_DataSource;
+
+		unsigned int m_TopVisible;
+		bool m_ResetRequested;
+	};
+}
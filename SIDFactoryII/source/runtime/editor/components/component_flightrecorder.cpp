@@ -166,14 +166,14 @@ namespace Editor
 
 			const int visible_row_count = m_Dimensions.m_Height - 4;
 
-			m_DataSource->Lock();
-
 			if (m_DataSource->IsRecording())
 			{
 				const int newest_recording_index = static_cast<int>(m_DataSource->GetNewestRecordingIndex());
 				m_CursorPos = newest_recording_index > visible_row_count ? (newest_recording_index - visible_row_count) : 0;
 			}
 
+			m_DataSource->PullFrames(m_CursorPos, visible_row_count);
+
 			auto print_channel = [&](int x, int y, int channel, const Emulation::FlightRecorder::Frame& frame_data)
 			{
 				const int sid_index = 7 * channel;
@@ -237,8 +237,6 @@ namespace Editor
 					print_filter(x + 85, y, frame_data);
 				}
 			}
-
-			m_DataSource->Unlock();
 		}
 	}
 
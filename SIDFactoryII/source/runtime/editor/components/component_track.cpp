@@ -66,7 +66,7 @@ namespace Editor
 		"B-"
 	};
 
-	int GetSequenceLength(std::vector<std::shared_ptr<DataSourceSequence>>& inDataSourceSequenceList, unsigned char inSequenceIndex, int inFallbackReturnSize)
+	int GetSequenceLength(const std::vector<std::shared_ptr<DataSourceSequence>>& inDataSourceSequenceList, unsigned char inSequenceIndex, int inFallbackReturnSize)
 	{
 		if (inSequenceIndex < 0x80)
 			return inDataSourceSequenceList[inSequenceIndex]->GetLength();
@@ -129,6 +129,7 @@ namespace Editor
 		, m_CursorPos(0)
 		, m_EventPos(0xffffffff)
 		, m_MaxEventPos(0)
+		, m_OrderListEventPositionsSummaryChangeCount(0)
 		, m_FirstValidOrderListIndex(0)
 		, m_FirstValidSequenceIndex(0)
 		, m_HasFirstValid(false)
@@ -448,29 +449,10 @@ namespace Editor
 
 					if (current_instrument == 0xff)
 					{
-						// We didn't find the current instrument
-						unsigned orderlist_index_highligh_check = orderlist_index;
-
-						while (orderlist_index_highligh_check > 0 && current_instrument == 0xff)
-						{
-							--orderlist_index_highligh_check;
-
-							DataSourceOrderList::Entry& order_list_entry = (*m_DataSourceOrderList)[orderlist_index_highligh_check];
-							const std::shared_ptr<DataSourceSequence>& sequence = m_DataSourceSequenceList[order_list_entry.m_SequenceIndex];
-
-							if (sequence->GetLength() > 0)
-							{
-								for (int i = static_cast<int>(sequence->GetLength()); i >= 0; --i)
-								{
-									const DataSourceSequence::Event& event = (*sequence)[i];
-									if ((event.m_Instrument & 0xe0) == 0xa0)
-									{
-										current_instrument = event.m_Instrument & 0x1f;
-										break;
-									}
-								}
-							}
-						}
+						// We didn't find the current instrument, so it is the last one set by the entries before
+						const unsigned char instrument_before = GetOrderListInstrumentBefore(orderlist_index);
+						if (instrument_before != 0)
+							current_instrument = instrument_before & 0x1f;
 					}
 				}
 
@@ -664,7 +646,6 @@ namespace Editor
 		m_EventPos = inEventPos;
 		m_TopEventPos = inEventPos - m_FocusRow.m_RowsAbove;
 
-		bool found_event_pos = false;
 		bool found_top_event_pos = false;
 
 		if (m_TopEventPos <= 0)
@@ -682,33 +663,21 @@ namespace Editor
 		}
 		else
 		{
-			int event_pos = 0;
-
-			for (unsigned int i = 0; i < m_DataSourceOrderList->GetLength(); ++i)
+			if (!found_top_event_pos)
 			{
-				unsigned char sequence_index = (*m_DataSourceOrderList)[i].m_SequenceIndex;
-				int sequence_length = GetSequenceLength(m_DataSourceSequenceList, sequence_index, 1);
+				const int top_order_list_index = FindOrderListIndexAtEventPos(m_TopEventPos);
 
-				int next_event_pos = event_pos + sequence_length;
-
-				if (!found_top_event_pos && m_TopEventPos >= event_pos && m_TopEventPos < next_event_pos)
+				if (top_order_list_index >= 0)
 				{
-					found_top_event_pos = true;
-
-					m_FirstValidOrderListIndex = i;
-					m_FirstValidSequenceIndex = m_TopEventPos - event_pos;
+					m_FirstValidOrderListIndex = top_order_list_index;
+					m_FirstValidSequenceIndex = m_TopEventPos - GetOrderListEventPos(top_order_list_index);
 				}
+			}
 
-				if (!found_event_pos && m_EventPos >= event_pos && m_EventPos < next_event_pos)
-				{
-					found_event_pos = true;
-					SetEventPosDetails(i, m_EventPos - event_pos, inForceOrderListIndexChangeEvent);
+			const int order_list_index = FindOrderListIndexAtEventPos(m_EventPos);
 
-					break;
-				}
-
-				event_pos = next_event_pos;
-			}
+			if (order_list_index >= 0)
+				SetEventPosDetails(order_list_index, m_EventPos - GetOrderListEventPos(order_list_index), inForceOrderListIndexChangeEvent);
 
 			m_HasFirstValid = true;
 		}
@@ -726,27 +695,14 @@ namespace Editor
 
 	int ComponentTrack::GetEventPositionAtTopOfCurrentSequence() const
 	{
-		int event_pos = 0;
-
-		for (unsigned int i = 0; i < m_DataSourceOrderList->GetLength(); ++i)
-		{
-			const unsigned char transposition = (*m_DataSourceOrderList)[i].m_Transposition;
-			const unsigned char sequence_index = (*m_DataSourceOrderList)[i].m_SequenceIndex;
-
-			if (transposition == 0xff || transposition == 0xfe)
-				break;
-
-			const std::shared_ptr<DataSourceSequence>& sequence = m_DataSourceSequenceList[sequence_index];
+		const int order_list_index = FindOrderListIndexAtEventPos(m_EventPos);
 
-			const int next_event_pos = event_pos + sequence->GetLength();
-
-			if (m_EventPos >= event_pos && m_EventPos < next_event_pos)
-				break;
+		if (order_list_index >= 0 && (*m_DataSourceOrderList)[order_list_index].m_Transposition < 0xfe)
+			return GetOrderListEventPos(order_list_index);
 
-			event_pos = next_event_pos;
-		}
-
-		return event_pos;
+		// The end of the order list, where the sequences end
+		const unsigned int order_list_length = m_DataSourceOrderList->GetLength();
+		return order_list_length > 0 ? GetOrderListEventPos(order_list_length - 1) : 0;
 	}
 
 	//--------------------------------------------------------------------------------------------------
@@ -847,16 +803,9 @@ namespace Editor
 		if (loop_index == 0)
 			return 0;
 
-		int event_position = 0;
-		for (int i = 0; i < loop_index; ++i)
-		{
-			const auto& entry = (*m_DataSourceOrderList)[i];
-			FOUNDATION_ASSERT(entry.m_Transposition < 0xfe);
-			const int sequence_length = m_DataSourceSequenceList[entry.m_SequenceIndex]->GetLength();
-			event_position += sequence_length;
-		}
+		FOUNDATION_ASSERT((*m_DataSourceOrderList)[loop_index - 1].m_Transposition < 0xfe);
 
-		return event_position;
+		return GetOrderListEventPos(loop_index);
 	}
 
 
@@ -890,32 +839,9 @@ namespace Editor
 
 				if (event_position.m_IsValid)
 				{
+					// We didn't find the current instrument, so it is the last one set by the entries before
 					if (event_position.m_CurrentInstrument == 0)
-					{
-						// We didn't find the current instrument
-						unsigned orderlist_index_highligh_check = event_pos_details.OrderListIndex();
-
-						while (orderlist_index_highligh_check > 0 && event_position.m_CurrentInstrument == 0x00)
-						{
-							--orderlist_index_highligh_check;
-
-							DataSourceOrderList::Entry& order_list_entry = (*m_DataSourceOrderList)[orderlist_index_highligh_check];
-							const std::shared_ptr<DataSourceSequence>& sequence = m_DataSourceSequenceList[order_list_entry.m_SequenceIndex];
-
-							if (sequence->GetLength() > 0)
-							{
-								for (int i = static_cast<int>(sequence->GetLength()); i >= 0; --i)
-								{
-									const DataSourceSequence::Event& event = (*sequence)[i];
-									if ((event.m_Instrument & 0xe0) == 0xa0)
-									{
-										event_position.m_CurrentInstrument = event.m_Instrument;
-										break;
-									}
-								}
-							}
-						}
-					}
+						event_position.m_CurrentInstrument = GetOrderListInstrumentBefore(event_pos_details.OrderListIndex());
 
 					outOrderListIndices.push_back(
 						{
@@ -1839,6 +1765,8 @@ namespace Editor
 	void ComponentTrack::UpdateMaxEventPos()
 	{
 		m_MaxEventPos = ComponentTrackUtils::GetMaxEventPosition(m_DataSourceOrderList, m_DataSourceSequenceList);
+
+		UpdateOrderListEventPositions();
 	}
 
 
@@ -2442,36 +2370,13 @@ namespace Editor
 		int bottom = m_IsMarkingArea ? std::max(m_MarkingFromEventPos, m_MarkingToEventPos) : m_EventPos;
 
 		// Find sequence and index of top position
-		int find_event_pos = top;
-		int event_pos = 0;
-
-		int orderlist_index = 0;
-		int sequence_event_pos = 0;
+		const int orderlist_index_at_top = FindOrderListIndexAtEventPos(top);
 
-		bool found = false;
-		
-		for (unsigned int i = 0; i < m_DataSourceOrderList->GetLength(); ++i)
+		if (orderlist_index_at_top >= 0)
 		{
-			unsigned char sequence_index = (*m_DataSourceOrderList)[i].m_SequenceIndex;
+			int orderlist_index = orderlist_index_at_top;
+			int sequence_event_pos = top - GetOrderListEventPos(orderlist_index_at_top);
 
-			const std::shared_ptr<DataSourceSequence>& sequence = m_DataSourceSequenceList[sequence_index];
-
-			int next_event_pos = event_pos + sequence->GetLength();
-
-			if (find_event_pos >= event_pos && find_event_pos < next_event_pos)
-			{
-				orderlist_index = i;
-				sequence_event_pos = find_event_pos - event_pos;
-
-				found = true;
-				break;
-			}
-
-			event_pos = next_event_pos;
-		}
-
-		if(found)
-		{
 			std::vector<DataSourceSequence::Event> events_copy;
 
 			for (int event_pos = top; event_pos <= bottom; ++event_pos)
@@ -2661,8 +2566,6 @@ namespace Editor
 	{
 		EventPosDetails details;
 
-		int event_pos = 0;
-
 		if (inEventPos >= m_MaxEventPos && m_MaxEventPos > 0)
 		{
 			const int loop_event_pos = GetLoopEventPosition();
@@ -2675,22 +2578,10 @@ namespace Editor
 			}
 		}
 
-		for (unsigned int i = 0; i < m_DataSourceOrderList->GetLength(); ++i)
-		{
-			unsigned char sequence_index = (*m_DataSourceOrderList)[i].m_SequenceIndex;
-			const std::shared_ptr<DataSourceSequence>& sequence = m_DataSourceSequenceList[sequence_index];
-
-			int next_event_pos = event_pos + sequence->GetLength();
-
-			if (inEventPos >= event_pos && inEventPos < next_event_pos)
-			{
-				details.Set(i, static_cast<unsigned int>(inEventPos - event_pos));
-
-				break;
-			}
+		const int order_list_index = FindOrderListIndexAtEventPos(inEventPos);
 
-			event_pos = next_event_pos;
-		}
+		if (order_list_index >= 0)
+			details.Set(order_list_index, static_cast<unsigned int>(inEventPos - GetOrderListEventPos(order_list_index)));
 
 		return details;
 	}
@@ -2706,6 +2597,109 @@ namespace Editor
 		return details.SequenceIndex() == 0;
 	}
 
+	//--------------------------------------------------------------------------------------------------
+
+	void ComponentTrack::UpdateOrderListEventPositions() const
+	{
+		const unsigned int order_list_length = m_DataSourceOrderList->GetLength();
+		const unsigned int previous_length = m_OrderListEventPositions.empty() ? 0 : static_cast<unsigned int>(m_OrderListEventPositions.size()) - 1;
+
+		m_OrderListEventPositions.resize(order_list_length + 1);
+
+		auto get_last_instrument = [&](unsigned char inSequenceIndex) -> unsigned char
+		{
+			return inSequenceIndex < 0x80 ? m_DataSourceSequenceList[inSequenceIndex]->GetSummary().m_LastInstrument : 0;
+		};
+
+		// The entries before the first one that changed start where they did. The end of the order list spans the
+		// length of the sequence its value refers to, or a single event if it refers to none
+		unsigned int i = 0;
+
+		for (; i < order_list_length && i < previous_length; ++i)
+		{
+			const unsigned char sequence_index = (*m_DataSourceOrderList)[i].m_SequenceIndex;
+			const OrderListEventPos& event_pos = m_OrderListEventPositions[i];
+
+			if (event_pos.m_SequenceIndex != sequence_index
+				|| event_pos.m_SequenceLength != static_cast<unsigned int>(GetSequenceLength(m_DataSourceSequenceList, sequence_index, 1))
+				|| event_pos.m_LastInstrument != get_last_instrument(sequence_index))
+				break;
+		}
+
+		int event_pos = m_OrderListEventPositions[i].m_EventPos;
+		unsigned char instrument_before = m_OrderListEventPositions[i].m_InstrumentBefore;
+
+		for (; i < order_list_length; ++i)
+		{
+			const unsigned char sequence_index = (*m_DataSourceOrderList)[i].m_SequenceIndex;
+			const unsigned int sequence_length = static_cast<unsigned int>(GetSequenceLength(m_DataSourceSequenceList, sequence_index, 1));
+			const unsigned char last_instrument = get_last_instrument(sequence_index);
+
+			m_OrderListEventPositions[i] = { event_pos, sequence_index, sequence_length, last_instrument, instrument_before };
+			event_pos += sequence_length;
+
+			if (last_instrument != 0)
+				instrument_before = last_instrument;
+		}
+
+		m_OrderListEventPositions[order_list_length] = { event_pos, 0, 0, 0, instrument_before };
+		m_OrderListEventPositionsSummaryChangeCount = DataSourceSequence::GetSummaryChangeCount();
+	}
+
+
+	void ComponentTrack::RequireOrderListEventPositions() const
+	{
+		if (m_OrderListEventPositions.size() != m_DataSourceOrderList->GetLength() + 1 || m_OrderListEventPositionsSummaryChangeCount != DataSourceSequence::GetSummaryChangeCount())
+			UpdateOrderListEventPositions();
+	}
+
+
+	int ComponentTrack::FindOrderListIndexAtEventPos(int inEventPos) const
+	{
+		RequireOrderListEventPositions();
+
+		// The last entry starting at or before the event position, which is after any empty entries starting there too
+		const auto it = std::upper_bound(m_OrderListEventPositions.begin(), m_OrderListEventPositions.end(), inEventPos, [](int inValue, const OrderListEventPos& inEntry) { return inValue < inEntry.m_EventPos; });
+
+		if (it == m_OrderListEventPositions.begin() || it == m_OrderListEventPositions.end())
+			return -1;
+
+		const int order_list_index = static_cast<int>(it - m_OrderListEventPositions.begin()) - 1;
+
+		// The entry itself may have been edited before the order list is reported as changed
+		if (m_OrderListEventPositions[order_list_index].m_SequenceIndex != (*m_DataSourceOrderList)[order_list_index].m_SequenceIndex)
+		{
+			UpdateOrderListEventPositions();
+			return FindOrderListIndexAtEventPos(inEventPos);
+		}
+
+		return order_list_index;
+	}
+
+
+	int ComponentTrack::GetOrderListEventPos(unsigned int inOrderListIndex) const
+	{
+		RequireOrderListEventPositions();
+
+		FOUNDATION_ASSERT(inOrderListIndex < m_OrderListEventPositions.size());
+
+		return m_OrderListEventPositions[inOrderListIndex].m_EventPos;
+	}
+
+
+	unsigned char ComponentTrack::GetOrderListInstrumentBefore(unsigned int inOrderListIndex) const
+	{
+		RequireOrderListEventPositions();
+
+		FOUNDATION_ASSERT(inOrderListIndex < m_OrderListEventPositions.size());
+
+		// The entry itself may have been edited before the order list is reported as changed
+		if (m_OrderListEventPositions[inOrderListIndex].m_SequenceIndex != (*m_DataSourceOrderList)[inOrderListIndex].m_SequenceIndex)
+			UpdateOrderListEventPositions();
+
+		return m_OrderListEventPositions[inOrderListIndex].m_InstrumentBefore;
+	}
+
 
 
 	void ComponentTrack::AddUndoStep()
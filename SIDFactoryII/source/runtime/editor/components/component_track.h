@@ -61,6 +61,15 @@ namespace Editor
 			unsigned int m_SequenceIndex;
 		};
 
+		struct OrderListEventPos
+		{
+			int m_EventPos;
+			unsigned char m_SequenceIndex;
+			unsigned int m_SequenceLength;
+			unsigned char m_LastInstrument;			// Of the entry's sequence, $a0 - $bf or 0 for none
+			unsigned char m_InstrumentBefore;		// The last instrument set by the entries before, $a0 - $bf or 0 for none
+		};
+
 		struct KeyHookContext
 		{
 			ComponentsManager& m_ComponentsManager;
@@ -262,6 +271,13 @@ namespace Editor
 		EventPosDetails GetEventPosDetails(int inEventPos) const;
 		bool IsEventPosStartOfSequence(int inEventPos) const;
 
+		// Order list event positions
+		void UpdateOrderListEventPositions() const;
+		void RequireOrderListEventPositions() const;
+		int FindOrderListIndexAtEventPos(int inEventPos) const;
+		int GetOrderListEventPos(unsigned int inOrderListIndex) const;
+		unsigned char GetOrderListInstrumentBefore(unsigned int inOrderListIndex) const;
+
 		// Undo
 		void AddUndoStep();
 		void AddUndoRecentModificationStep(bool inLockCPU);
@@ -294,6 +310,12 @@ namespace Editor
 		int m_EventPosOrderListIndex;
 		int m_EventPosSequenceIndex;
 
+		// The event position at which each order list entry starts, and after the last entry where the next would start,
+		// with the instrument set before it. Entries are found at an event position by a binary search, and the positions
+		// are updated from the first entry that changed when the order list or the summary of a sequence changes
+		mutable std::vector<OrderListEventPos> m_OrderListEventPositions;
+		mutable unsigned int m_OrderListEventPositionsSummaryChangeCount;
+
 		// Order list input focus
 		bool m_FocusModeOrderList;
 		bool m_TakingOrderListInput;
@@ -357,36 +379,14 @@ namespace Editor
 		int bottom = m_IsMarkingArea ? std::max(m_MarkingFromEventPos, m_MarkingToEventPos) : m_EventPos;
 
 		// Find sequence and index of top position
-		int find_event_pos = top;
-		int event_pos = 0;
-
-		int orderlist_index = 0;
-		int sequence_event_pos = 0;
-
-		bool found = false;
-
-		for (unsigned int i = 0; i < m_DataSourceOrderList->GetLength(); ++i)
-		{
-			unsigned char sequence_index = (*m_DataSourceOrderList)[i].m_SequenceIndex;
-			const std::shared_ptr<DataSourceSequence>& sequence = m_DataSourceSequenceList[sequence_index];
-
-			int next_event_pos = event_pos + sequence->GetLength();
-
-			if (find_event_pos >= event_pos && find_event_pos < next_event_pos)
-			{
-				orderlist_index = i;
-				sequence_event_pos = find_event_pos - event_pos;
-
-				found = true;
-				break;
-			}
+		const int orderlist_index_at_top = FindOrderListIndexAtEventPos(top);
 
-			event_pos = next_event_pos;
-		}
-
-		if (!found)
+		if (orderlist_index_at_top < 0)
 			return std::vector<unsigned char>();
 
+		int orderlist_index = orderlist_index_at_top;
+		int sequence_event_pos = top - GetOrderListEventPos(orderlist_index_at_top);
+
 		std::vector<AlteredSequenceEvent> altered_sequence_events;
 
 		const auto is_sequence_event_already_altered = [&](unsigned char inSequenceIndex, int inSequenceEventPos)
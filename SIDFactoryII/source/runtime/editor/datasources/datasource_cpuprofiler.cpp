@@ -0,0 +1,77 @@
+#include "datasource_cpuprofiler.h"
+#include "foundation/base/assert.h"
+
+namespace Editor
+{
+	DataSourceCPUProfiler::DataSourceCPUProfiler(Emulation::CPUProfiler* inCPUProfiler)
+		: m_CPUProfiler(inCPUProfiler)
+		, m_ExecuteCount(0)
+		, m_TotalCycles(0)
+	{
+
+	}
+
+
+	DataSourceCPUProfiler::~DataSourceCPUProfiler()
+	{
+
+	}
+
+
+	void DataSourceCPUProfiler::Lock()
+	{
+		FOUNDATION_ASSERT(m_CPUProfiler != nullptr);
+		m_CPUProfiler->Lock();
+	}
+
+
+	void DataSourceCPUProfiler::Unlock()
+	{
+		FOUNDATION_ASSERT(m_CPUProfiler != nullptr);
+		m_CPUProfiler->Unlock();
+	}
+
+
+	void DataSourceCPUProfiler::Refresh()
+	{
+		FOUNDATION_ASSERT(m_CPUProfiler != nullptr);
+
+		m_ExecuteCount = m_CPUProfiler->GetExecuteCount();
+		m_TotalCycles = m_CPUProfiler->GetTotalCycles();
+		m_Routines = m_CPUProfiler->GetRoutines();
+	}
+
+
+	void DataSourceCPUProfiler::Reset()
+	{
+		FOUNDATION_ASSERT(m_CPUProfiler != nullptr);
+
+		m_CPUProfiler->Reset();
+		Refresh();
+	}
+
+
+	const Emulation::CPUProfiler::Routine& DataSourceCPUProfiler::operator [](unsigned int inIndex) const
+	{
+		FOUNDATION_ASSERT(inIndex < m_Routines.size());
+		return m_Routines[inIndex];
+	}
+
+
+	const int DataSourceCPUProfiler::GetSize() const
+	{
+		return static_cast<int>(m_Routines.size());
+	}
+
+
+	unsigned int DataSourceCPUProfiler::GetExecuteCount() const
+	{
+		return m_ExecuteCount;
+	}
+
+
+	unsigned long long DataSourceCPUProfiler::GetTotalCycles() const
+	{
+		return m_TotalCycles;
+	}
+}
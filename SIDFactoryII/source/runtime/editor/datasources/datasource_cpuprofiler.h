@@ -0,0 +1,38 @@
+#pragma once
+
+#include "idatasource.h"
+#include "runtime/emulation/cpuprofiler.h"
+
+#include <vector>
+
+namespace Editor
+{
+	class DataSourceCPUProfiler : public IDataSource
+	{
+	public:
+		DataSourceCPUProfiler(Emulation::CPUProfiler* inCPUProfiler);
+		virtual ~DataSourceCPUProfiler();
+
+		void Lock();
+		void Unlock();
+
+		// Copies the current state of the profiler, must be called while locked
+		void Refresh();
+		void Reset();
+
+		const Emulation::CPUProfiler::Routine& operator [](unsigned int inIndex) const;
+		const int GetSize() const override;
+
+		unsigned int GetExecuteCount() const;
+		unsigned long long GetTotalCycles() const;
+
+		bool PushDataToSource() override { return true; }
+
+	protected:
+		Emulation::CPUProfiler* m_CPUProfiler;
+
+		unsigned int m_ExecuteCount;
+		unsigned long long m_TotalCycles;
+		std::vector<Emulation::CPUProfiler::Routine> m_Routines;
+	};
+}
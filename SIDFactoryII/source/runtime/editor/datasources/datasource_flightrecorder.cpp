@@ -5,8 +5,9 @@ namespace Editor
 {
 	DataSourceFlightRecorder::DataSourceFlightRecorder(Emulation::FlightRecorder* inFlightRecorder)
 		: m_FlightRecorder(inFlightRecorder)
+		, m_FirstFrameIndex(0)
 	{
-
+		m_EmptyFrame.Reset();
 	}
 
 
@@ -16,17 +17,13 @@ namespace Editor
 	}
 
 
-	void DataSourceFlightRecorder::Lock()
+	void DataSourceFlightRecorder::PullFrames(unsigned int inFirstIndex, unsigned int inCount)
 	{
 		FOUNDATION_ASSERT(m_FlightRecorder != nullptr);
-		m_FlightRecorder->Lock();
-	}
-
 
-	void DataSourceFlightRecorder::Unlock()
-	{
-		FOUNDATION_ASSERT(m_FlightRecorder != nullptr);
-		m_FlightRecorder->Unlock();
+		m_FirstFrameIndex = inFirstIndex;
+		m_Frames.resize(inCount);
+		m_Frames.resize(m_FlightRecorder->CopyFrames(inFirstIndex, inCount, m_Frames.data()));
 	}
 
 	
@@ -35,10 +32,13 @@ namespace Editor
 		FOUNDATION_ASSERT(m_FlightRecorder != nullptr);
 		FOUNDATION_ASSERT(inIndex < m_FlightRecorder->GetCapacity());
 
-		return m_FlightRecorder->GetFrame(inIndex);
+		if (inIndex < m_FirstFrameIndex || inIndex - m_FirstFrameIndex >= m_Frames.size())
+			return m_EmptyFrame;
+
+		return m_Frames[inIndex - m_FirstFrameIndex];
 	}
 
-	const Emulation::FlightRecorder::Frame& DataSourceFlightRecorder::GetMostRecentFrame() const
+	Emulation::FlightRecorder::Frame DataSourceFlightRecorder::GetMostRecentFrame() const
 	{
 		FOUNDATION_ASSERT(m_FlightRecorder != nullptr);
 		FOUNDATION_ASSERT(m_FlightRecorder->GetCapacity() > 0);
@@ -2,6 +2,7 @@
 
 #include "idatasource.h"
 #include "runtime/execution/flightrecorder.h"
+#include <vector>
 
 namespace Editor
 {
@@ -11,11 +12,12 @@ namespace Editor
 		DataSourceFlightRecorder(Emulation::FlightRecorder* inFlightRecorder);
 		virtual ~DataSourceFlightRecorder();
 
-		void Lock();
-		void Unlock();
+		// Copy a range of frames from the flight recorder, which is read by the index operator until the next pull.
+		// Frames outside of the range, or not recorded yet, read as empty frames
+		void PullFrames(unsigned int inFirstIndex, unsigned int inCount);
 
 		const Emulation::FlightRecorder::Frame& operator [](unsigned int inIndex) const;
-		const Emulation::FlightRecorder::Frame& GetMostRecentFrame() const;
+		Emulation::FlightRecorder::Frame GetMostRecentFrame() const;
 		const int GetSize() const override;
 		const bool IsRecording() const;
 		const unsigned int GetNewestRecordingIndex() const;
@@ -24,5 +26,9 @@ namespace Editor
 
 	protected:
 		Emulation::FlightRecorder* m_FlightRecorder;
+
+		unsigned int m_FirstFrameIndex;
+		std::vector<Emulation::FlightRecorder::Frame> m_Frames;
+		Emulation::FlightRecorder::Frame m_EmptyFrame;
 	};
 }
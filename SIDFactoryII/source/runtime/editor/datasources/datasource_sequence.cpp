@@ -2,6 +2,7 @@
 #include "runtime/emulation/cpumemory.h"
 #include "runtime/editor/driver/driver_info.h"
 #include "runtime/editor/driver/driver_state.h"
+#include <algorithm>
 #include <cstring>
 #include "foundation/base/assert.h"
 
@@ -9,6 +10,15 @@ namespace Editor
 {
     const unsigned int DataSourceSequence::MaxEventCount = 1024;
 
+	unsigned int DataSourceSequence::ms_SummaryChangeCount = 0;
+
+	static const unsigned short NotPacked = 0xffff;
+
+	// Events are compared in blocks first, as most of them are the same after an edit
+	static const unsigned int CompareBlockSize = 32;
+
+	static_assert(sizeof(DataSourceSequence::Event) == 3, "Events are compared as bytes");
+
 	DataSourceSequence::DataSourceSequence(
 		Emulation::CPUMemory* inCPUMemory,
 		const Editor::DriverInfo& inDriverInfo,
@@ -24,10 +34,21 @@ namespace Editor
 		, m_Length(0)
 		, m_PackedSize(0)
 		, m_PackingErrorState(false)
+		, m_PackedEventCount(0)
+		, m_InternalPackedSize(0)
+		, m_HasPackedEvents(false)
+		, m_BufferChangeOffset(0)
+		, m_SourceChangeOffset(0)
+		, m_IsSummaryValid(false)
 	{
 		m_Events = new Event[MaxEventCount];
 		m_InternalBuffer = new unsigned char[MaxEventCount * 3];
 
+		m_PackedEvents = new Event[MaxEventCount];
+		m_PackedEventOffsets = new unsigned short[MaxEventCount];
+		m_PackBuffer = new unsigned char[MaxEventCount * 3];
+		m_PackEventOffsets = new unsigned short[MaxEventCount];
+
 		ClearEvents();
 
 		PullDataFromSource();
@@ -41,10 +62,21 @@ namespace Editor
 		, m_Length(inOther.m_Length)
 		, m_PackedSize(inOther.m_PackedSize)
 		, m_PackingErrorState(inOther.m_PackingErrorState)
+		, m_PackedEventCount(0)
+		, m_InternalPackedSize(0)
+		, m_HasPackedEvents(false)
+		, m_BufferChangeOffset(0)
+		, m_SourceChangeOffset(0)
+		, m_IsSummaryValid(false)
 	{
 		m_Events = new Event[MaxEventCount];
 		m_InternalBuffer = new unsigned char[MaxEventCount * 3];
 
+		m_PackedEvents = new Event[MaxEventCount];
+		m_PackedEventOffsets = new unsigned short[MaxEventCount];
+		m_PackBuffer = new unsigned char[MaxEventCount * 3];
+		m_PackEventOffsets = new unsigned short[MaxEventCount];
+
 		for (int i = 0; i < MaxEventCount; ++i)
 			m_Events[i] = inOther.m_Events[i];
 	}
@@ -53,6 +85,11 @@ namespace Editor
 	{
 		delete[] m_Events;
 		delete[] m_InternalBuffer;
+
+		delete[] m_PackedEvents;
+		delete[] m_PackedEventOffsets;
+		delete[] m_PackBuffer;
+		delete[] m_PackEventOffsets;
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -63,6 +100,7 @@ namespace Editor
 			m_Events[i] = inRhs.m_Events[i];
 
 		m_Length = inRhs.m_Length;
+		InvalidateSummary();
 	}
 
 	DataSourceSequence::Event& DataSourceSequence::operator[](int inIndex)
@@ -105,10 +143,11 @@ namespace Editor
 					{
 						int change_from = 256;
 
-						for (int j = 0; j < m_DataSize; ++j)
+						// The buffer is the same as the source before the lowest offset changed since the last push
+						for (int j = static_cast<int>(m_SourceChangeOffset); j < m_DataSize; ++j)
 						{
 							const char new_data = m_Data[j];
-							const char old_data = (*m_CPUMemory)[m_SourceAddress + j];
+							const char old_data = m_CPUMemory->GetByte(m_SourceAddress + j);
 
 							if((new_data & 0xe0) == 0x80 || (old_data & 0xe0) == 0x80)
 							{
@@ -131,6 +170,8 @@ namespace Editor
 		if(may_push_sequence_data)
 		{
 			m_CPUMemory->SetData(m_SourceAddress, m_Data, m_DataSize);
+			m_SourceChangeOffset = m_DataSize;
+
 			return true;
 		}
 
@@ -151,7 +192,14 @@ namespace Editor
 	void DataSourceSequence::SetLength(unsigned int inLength)
 	{
 		FOUNDATION_ASSERT(inLength <= MaxEventCount);
+
 		m_Length = inLength;
+		InvalidateSummary();
+	}
+
+	unsigned int DataSourceSequence::GetSummaryChangeCount()
+	{
+		return ms_SummaryChangeCount;
 	}
 
 
@@ -166,6 +214,8 @@ namespace Editor
 		m_CPUMemory->GetData(m_SourceAddress, m_Data, m_DataSize);
 		m_CPUMemory->Unlock();
 
+		m_SourceChangeOffset = m_DataSize;
+
 		ClearEvents();
 		Unpack();
 	}
@@ -173,11 +223,10 @@ namespace Editor
 
 	void DataSourceSequence::ClearEvents()
 	{
-		m_LastCommandSet = 0xff;
-		m_LastInstrumentSet = 0xff;
-
 		for (int i = 0; i < MaxEventCount; ++i)
 			m_Events[i].Clear();
+
+		InvalidateSummary();
 	}
 
 	//------------------------------------------------------------------------------------------------------------------
@@ -215,7 +264,6 @@ namespace Editor
 			if (value >= 0xc0)	// Command
 			{
 				m_Events[event_index].m_Command = value;
-				m_LastCommandSet = value & 0x3f;
 				value = m_Data[i++];
 
 				FOUNDATION_ASSERT(i < 0x100);
@@ -226,7 +274,6 @@ namespace Editor
 			if (value >= 0xa0) // Instrument
 			{
 				m_Events[event_index].m_Instrument = value;
-				m_LastInstrumentSet = value & 0x1f;
 				value = m_Data[i++];
 
 				FOUNDATION_ASSERT(i < 0x100);
@@ -264,105 +311,257 @@ namespace Editor
 
 		m_Length = event_index;
 		m_PackingErrorState = false;
+
+		// The next pack encodes all events, as the data may not be packed the way the editor packs it
+		m_HasPackedEvents = false;
+		m_BufferChangeOffset = 0;
+
+		InvalidateSummary();
+	}
+
+
+	const DataSourceSequence::Summary& DataSourceSequence::GetSummary() const
+	{
+		if (!m_IsSummaryValid)
+		{
+			m_Summary.m_Length = m_Length;
+			m_Summary.m_LastInstrument = 0;
+			m_Summary.m_LastCommand = 0;
+
+			// Events that are part of the duration of the event before set neither
+			for (unsigned int i = m_Length; i > 0 && (m_Summary.m_LastInstrument == 0 || m_Summary.m_LastCommand == 0); --i)
+			{
+				const Event& event = m_Events[i - 1];
+
+				if (m_Summary.m_LastInstrument == 0 && event.m_Instrument >= 0xa0)
+					m_Summary.m_LastInstrument = event.m_Instrument;
+				if (m_Summary.m_LastCommand == 0 && event.m_Command >= 0xc0)
+					m_Summary.m_LastCommand = event.m_Command;
+			}
+
+			m_IsSummaryValid = true;
+		}
+
+		return m_Summary;
+	}
+
+
+	void DataSourceSequence::InvalidateSummary()
+	{
+		m_IsSummaryValid = false;
+		++ms_SummaryChangeCount;
 	}
 
 
 	unsigned char DataSourceSequence::GetLastInstrumentSet() const
 	{
-		return m_LastInstrumentSet;
+		const Summary& summary = GetSummary();
+		return summary.m_LastInstrument != 0 ? summary.m_LastInstrument & 0x1f : 0xff;
 	}
 
 
 	unsigned char DataSourceSequence::GetLastCommandSet() const
 	{
-		return m_LastCommandSet;
+		const Summary& summary = GetSummary();
+		return summary.m_LastCommand != 0 ? summary.m_LastCommand & 0x3f : 0xff;
 	}
 
 
 	DataSourceSequence::PackResult DataSourceSequence::Pack()
 	{
-		m_LastCommandSet = 0xff;
-		m_LastInstrumentSet = 0xff;
-
-		int packIndex = 0;
-		int lastDuration = -1;
+		// Find the events changed since the last pack, as the events before and after them that are the same
+		unsigned int first_changed_index = 0;
+		unsigned int unchanged_tail_count = 0;
 
-		for (unsigned int i = 0; i < m_Length; ++i)
+		if (m_HasPackedEvents)
 		{
-			unsigned char instrument = m_Events[i].m_Instrument;
-			unsigned char command = m_Events[i].m_Command;
-			unsigned char note = m_Events[i].m_Note;
+			const unsigned int common_count = std::min(m_Length, m_PackedEventCount);
 
-			// Look for next event
-			int duration = 0;
+			while (first_changed_index + CompareBlockSize <= common_count && memcmp(&m_Events[first_changed_index], &m_PackedEvents[first_changed_index], CompareBlockSize * sizeof(Event)) == 0)
+				first_changed_index += CompareBlockSize;
+			while (first_changed_index < common_count && !(m_Events[first_changed_index] != m_PackedEvents[first_changed_index]))
+				++first_changed_index;
 
-			for (unsigned int j = i + 1; j < m_Length; ++j)
+			const unsigned int tail_count = common_count - first_changed_index;
+
+			while (unchanged_tail_count + CompareBlockSize <= tail_count
+				&& memcmp(&m_Events[m_Length - unchanged_tail_count - CompareBlockSize], &m_PackedEvents[m_PackedEventCount - unchanged_tail_count - CompareBlockSize], CompareBlockSize * sizeof(Event)) == 0)
+				unchanged_tail_count += CompareBlockSize;
+			while (unchanged_tail_count < tail_count && !(m_Events[m_Length - 1 - unchanged_tail_count] != m_PackedEvents[m_PackedEventCount - 1 - unchanged_tail_count]))
+				++unchanged_tail_count;
+		}
+
+		if (!m_HasPackedEvents || first_changed_index < m_Length || m_Length != m_PackedEventCount)
+		{
+			// Encode from the packed event before the first change, as the change can extend or end its duration
+			unsigned int begin_index = 0;
+
+			if (m_HasPackedEvents && first_changed_index > 0)
 			{
-				if (m_Events[j].m_Instrument != 0x80 || m_Events[j].m_Command != 0x80)
-					break;
+				begin_index = first_changed_index - 1;
 
-				if (note == 0)
-				{
-					if (m_Events[j].m_Note != 0)
-						break;
-				}
-				else
+				while (m_PackedEventOffsets[begin_index] == NotPacked)
+					--begin_index;
+			}
+
+			const int begin_offset = begin_index > 0 ? m_PackedEventOffsets[begin_index] : 0;
+			const int event_count_change = static_cast<int>(m_Length) - static_cast<int>(m_PackedEventCount);
+			const unsigned int changed_end_index = m_Length - unchanged_tail_count;
+
+			int last_duration = begin_index > 0 ? GetPackedDurationBefore(begin_index) : -1;
+			int pack_size = 0;
+
+			unsigned int index = begin_index;
+			unsigned int resume_packed_index = m_PackedEventCount;
+
+			while (index < m_Length)
+			{
+				// After the changes, the rest is packed as in the last pack once an event starts where one started in
+				// the last pack, with the same duration before it
+				if (m_HasPackedEvents && index >= changed_end_index)
 				{
-					if (m_Events[j].m_Note != 0x7e)
+					const unsigned int packed_index = index - event_count_change;
+
+					if (m_PackedEventOffsets[packed_index] != NotPacked && GetPackedDurationBefore(packed_index) == last_duration)
+					{
+						resume_packed_index = packed_index;
 						break;
+					}
 				}
 
-				duration++;
+				m_PackEventOffsets[index - begin_index] = static_cast<unsigned short>(begin_offset + pack_size);
 
-				if (duration >= 0x0f)
-					break;
-			}
+				const unsigned int event_count = PackEvent(index, last_duration, m_PackBuffer, pack_size);
 
-			bool bTieNote = (instrument == 0x90);
+				for (unsigned int i = 1; i < event_count; ++i)
+					m_PackEventOffsets[index - begin_index + i] = NotPacked;
 
-			if (command != 0x80)
-			{
-				m_InternalBuffer[packIndex++] = command;
-				m_LastCommandSet = command & 0x3f;
-			}
-			if (instrument >= 0xa0)
-			{
-				m_InternalBuffer[packIndex++] = instrument;
-				m_LastInstrumentSet = instrument & 0x1f;
+				index += event_count;
 			}
 
-			if (lastDuration != duration || bTieNote)
+			// Move the rest of the last pack, then insert the encoded events before it
+			if (resume_packed_index < m_PackedEventCount)
 			{
-				m_InternalBuffer[packIndex++] = static_cast<unsigned char>((duration | 0x80) | (bTieNote ? 0x10 : 0x00));
-				lastDuration = duration;
+				const int resume_offset = m_PackedEventOffsets[resume_packed_index];
+				const int offset_change = begin_offset + pack_size - resume_offset;
+
+				memmove(&m_InternalBuffer[resume_offset + offset_change], &m_InternalBuffer[resume_offset], m_InternalPackedSize - resume_offset);
+				memmove(&m_PackedEventOffsets[index], &m_PackedEventOffsets[resume_packed_index], (m_PackedEventCount - resume_packed_index) * sizeof(unsigned short));
+
+				if (offset_change != 0)
+				{
+					for (unsigned int i = index; i < m_Length; ++i)
+					{
+						if (m_PackedEventOffsets[i] != NotPacked)
+							m_PackedEventOffsets[i] = static_cast<unsigned short>(m_PackedEventOffsets[i] + offset_change);
+					}
+				}
+
+				m_InternalPackedSize += offset_change;
 			}
+			else
+				m_InternalPackedSize = begin_offset + pack_size;
+
+			memcpy(&m_InternalBuffer[begin_offset], m_PackBuffer, pack_size);
+			memcpy(&m_PackedEventOffsets[begin_index], m_PackEventOffsets, (index - begin_index) * sizeof(unsigned short));
+
+			// Without a change of the event count, the events after the changes are where they were
+			const unsigned int copy_end_index = event_count_change == 0 ? changed_end_index : m_Length;
+			std::copy(&m_Events[first_changed_index], &m_Events[copy_end_index], &m_PackedEvents[first_changed_index]);
 
-			m_InternalBuffer[packIndex++] = note;
+			m_PackedEventCount = m_Length;
+			m_HasPackedEvents = true;
+			InvalidateSummary();
 
-			i += duration;
+			m_BufferChangeOffset = std::min(m_BufferChangeOffset, static_cast<unsigned int>(begin_offset));
 		}
 
+		const int packIndex = m_InternalPackedSize;
+
 		// Create a buffer of the exact size of the packed data and copy the data into it
 		m_PackingErrorState = !(packIndex > 0 && packIndex < 0xff);
 
 		if(!m_PackingErrorState)
 		{
+			unsigned char* packed_data = new unsigned char[packIndex + 1];
+
+			memcpy(packed_data, m_InternalBuffer, packIndex);
+
 			// Insert end mark
-			m_InternalBuffer[packIndex++] = 0x7f;
+			packed_data[packIndex] = 0x7f;
 
-			unsigned char* packed_data = new unsigned char[packIndex];
+			return PackResult(packed_data, packIndex + 1);
+		}
+
+		return PackResult();
+	}
 
-			for (int i = 0; i < packIndex; i++)
-				packed_data[i] = m_InternalBuffer[i];
 
-			m_PackingErrorState = false;
+	unsigned int DataSourceSequence::PackEvent(unsigned int inIndex, int& ioLastDuration, unsigned char* outData, int& ioPackIndex) const
+	{
+		const unsigned char instrument = m_Events[inIndex].m_Instrument;
+		const unsigned char command = m_Events[inIndex].m_Command;
+		const unsigned char note = m_Events[inIndex].m_Note;
+
+		// Look for next event
+		int duration = 0;
+
+		for (unsigned int j = inIndex + 1; j < m_Length; ++j)
+		{
+			if (m_Events[j].m_Instrument != 0x80 || m_Events[j].m_Command != 0x80)
+				break;
 
-			return PackResult(packed_data, packIndex);
+			if (note == 0)
+			{
+				if (m_Events[j].m_Note != 0)
+					break;
+			}
+			else
+			{
+				if (m_Events[j].m_Note != 0x7e)
+					break;
+			}
+
+			duration++;
+
+			if (duration >= 0x0f)
+				break;
 		}
 
-		return PackResult();
+		const bool bTieNote = (instrument == 0x90);
+
+		if (command != 0x80)
+			outData[ioPackIndex++] = command;
+		if (instrument >= 0xa0)
+			outData[ioPackIndex++] = instrument;
+
+		if (ioLastDuration != duration || bTieNote)
+		{
+			outData[ioPackIndex++] = static_cast<unsigned char>((duration | 0x80) | (bTieNote ? 0x10 : 0x00));
+			ioLastDuration = duration;
+		}
+
+		outData[ioPackIndex++] = note;
+
+		return static_cast<unsigned int>(duration) + 1;
 	}
 
+
+	int DataSourceSequence::GetPackedDurationBefore(unsigned int inIndex) const
+	{
+		// The duration of the packed event before, which is the last duration written before the event
+		if (inIndex == 0)
+			return -1;
+
+		unsigned int previous_index = inIndex - 1;
+
+		while (m_PackedEventOffsets[previous_index] == NotPacked)
+			--previous_index;
+
+		return static_cast<int>(inIndex - previous_index) - 1;
+	}
+
+
 	void DataSourceSequence::SendPackedDataToBuffer(const PackResult& inPackResult)
 	{
 		FOUNDATION_ASSERT(inPackResult.m_DataLength <= m_DataSize);
@@ -371,6 +570,9 @@ namespace Editor
 		memcpy(m_Data, &*inPackResult.m_Data, inPackResult.m_DataLength);
 
 		m_PackedSize = inPackResult.m_DataLength;
+
+		m_SourceChangeOffset = std::min(m_SourceChangeOffset, m_BufferChangeOffset);
+		m_BufferChangeOffset = m_DataSize;
 	}
 
 
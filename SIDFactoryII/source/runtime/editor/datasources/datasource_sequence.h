@@ -33,6 +33,11 @@ namespace Editor
 				m_Note = inRhs.m_Note;
 			}
 
+			bool operator!=(const Event& inRhs) const
+			{
+				return m_Instrument != inRhs.m_Instrument || m_Command != inRhs.m_Command || m_Note != inRhs.m_Note;
+			}
+
 			void Clear()
 			{
 				m_Instrument = 0x80;
@@ -69,6 +74,15 @@ namespace Editor
 			int m_DataLength;
 		};
 
+		// What the whole sequence leads to when it has been played, as needed when looking back through the order list.
+		// The length in events is also the number of ticks the sequence plays for
+		struct Summary
+		{
+			unsigned int m_Length;
+			unsigned char m_LastInstrument;		// Event value $a0 - $bf of the last instrument set, or 0 for none
+			unsigned char m_LastCommand;		// Event value $c0 - $ff of the last command set, or 0 for none
+		};
+
 		DataSourceSequence(
 			Emulation::CPUMemory* inCPUMemory, 
 			const Editor::DriverInfo& inDriverInfo,
@@ -91,6 +105,11 @@ namespace Editor
 		unsigned int GetLength() const;
 		void SetLength(unsigned int inLength);
 
+		// Changes whenever the summary of any sequence may have changed, which includes its length, so what has been worked
+		// out from the summaries can be checked to be current
+		static unsigned int GetSummaryChangeCount();
+
+		const Summary& GetSummary() const;
 		unsigned char GetLastInstrumentSet() const;
 		unsigned char GetLastCommandSet() const;
 
@@ -104,6 +123,10 @@ namespace Editor
 	private:
 
 		void Unpack();
+		void InvalidateSummary();
+
+		unsigned int PackEvent(unsigned int inIndex, int& ioLastDuration, unsigned char* outData, int& ioPackIndex) const;
+		int GetPackedDurationBefore(unsigned int inIndex) const;
 
 		const Editor::DriverInfo& m_DriverInfo;
 		const Editor::DriverState& m_DriverState;
@@ -112,12 +135,31 @@ namespace Editor
 		unsigned int m_Length;		
 		Event* m_Events;
 
-		unsigned char m_LastInstrumentSet;
-		unsigned char m_LastCommandSet;
+		static unsigned int ms_SummaryChangeCount;
 
 		unsigned char* m_InternalBuffer;
 		unsigned int m_PackedSize;
 
+		// The events as of the last pack, which is in the internal buffer without the end mark, and the offset in it of
+		// each event that is packed. Events that are part of the duration of the event before are not packed. A pack
+		// only encodes the events from the first change until the encoding is the same as in the last pack again
+		Event* m_PackedEvents;
+		unsigned short* m_PackedEventOffsets;
+		unsigned int m_PackedEventCount;
+		int m_InternalPackedSize;
+		bool m_HasPackedEvents;
+
+		unsigned char* m_PackBuffer;
+		unsigned short* m_PackEventOffsets;
+
+		// Lowest offset at which the packed data may differ from the buffer, and the buffer from the source
+		unsigned int m_BufferChangeOffset;
+		unsigned int m_SourceChangeOffset;
+
 		bool m_PackingErrorState;
+
+		// Made when asked for, and again after the events have been packed with a change, unpacked or replaced
+		mutable Summary m_Summary;
+		mutable bool m_IsSummaryValid;
 	};
 }
@@ -6,11 +6,16 @@
 #include "foundation/input/mouse.h"
 
 #include "runtime/editor/components_manager.h"
+#include "runtime/editor/components/component_cpu_profile.h"
 #include "runtime/editor/components/component_memory_view.h"
+#include "runtime/editor/datasources/datasource_cpuprofiler.h"
 #include "runtime/editor/datasources/datasource_table_memory_view.h"
 #include "runtime/editor/driver/driver_info.h"
 #include "runtime/emulation/cpumemory.h"
+#include "runtime/emulation/cpuprofiler.h"
+#include "runtime/execution/executionhandler.h"
 
+#include "utils/global.h"
 #include "utils/keyhook.h"
 
 using namespace Foundation;
@@ -22,9 +27,10 @@ namespace Editor
 	const int DebugViews::ComponentBaseID = 0x8000;
 	const int DebugViews::ComponentGroupID = 8;
 
-	DebugViews::DebugViews(Viewport* inViewport, ComponentsManager* inComponentsManager, CPUMemory* inCPUMemory, const Foundation::Extent& inMainTextFieldDimensions, std::shared_ptr<const DriverInfo> inDriverInfo)
+	DebugViews::DebugViews(Viewport* inViewport, ComponentsManager* inComponentsManager, CPUMemory* inCPUMemory, ExecutionHandler* inExecutionHandler, const Foundation::Extent& inMainTextFieldDimensions, std::shared_ptr<const DriverInfo> inDriverInfo)
 		: m_Enabled(false)
 		, m_CPUMemory(inCPUMemory)
+		, m_ExecutionHandler(inExecutionHandler)
 		, m_Viewport(inViewport)
 		, m_ComponentsManager(inComponentsManager)
 		, m_DriverInfo(inDriverInfo)
@@ -39,6 +45,14 @@ namespace Editor
 
 		m_TextField->ColorAreaBackground(Color::DarkBlue);
 
+		// The cpu profile is shown to the left of the memory view
+		m_ProfileTextField = m_Viewport->CreateTextField(view_width, view_height, 8 * (inMainTextFieldDimensions.m_Width - 2 * view_width - 2), 2 * 16);
+		m_ProfileTextField->SetEnable(false);
+
+		m_ProfileTextField->ColorAreaBackground(Color::DarkBlue);
+
+		m_CPUProfiler = std::make_unique<CPUProfiler>(&Global::instance().GetPlatform());
+
 		CreateViews(inComponentsManager);
 
 		// Create key hooks for testing
@@ -52,6 +66,10 @@ namespace Editor
 
 	DebugViews::~DebugViews()
 	{
+		if (m_Enabled)
+			m_ExecutionHandler->SetCPUProfiler(nullptr);
+
+		m_Viewport->Destroy(m_ProfileTextField);
 		m_Viewport->Destroy(m_TextField);
 	}
 
@@ -62,6 +80,17 @@ namespace Editor
 		{
 			m_Enabled = inEnabled;
 			m_TextField->SetEnable(inEnabled);
+			m_ProfileTextField->SetEnable(inEnabled);
+
+			if (inEnabled)
+			{
+				m_CPUProfiler->Lock();
+				m_CPUProfiler->Reset();
+				m_CPUProfiler->Unlock();
+			}
+
+			m_ExecutionHandler->SetCPUProfiler(inEnabled ? m_CPUProfiler.get() : nullptr);
+
 			m_ComponentsManager->SetGroupEnabledForInput(ComponentGroupID, true);
 			// m_ComponentsManager->SetGroupEnabledForTabbing(ComponentGroupID);
 		}
@@ -161,5 +190,21 @@ namespace Editor
 			);
 
 		inComponentsManager->AddComponent(m_ComponentMemoryView);
+
+		const Extent profile_dimensions = m_ProfileTextField->GetDimensions();
+
+		m_ComponentCPUProfile = std::make_shared<ComponentCPUProfile>
+			(
+				ComponentBaseID + 1,
+				ComponentGroupID,
+				nullptr,
+				std::make_shared<DataSourceCPUProfiler>(m_CPUProfiler.get()),
+				m_ProfileTextField,
+				1, 1,
+				profile_dimensions.m_Width - 2,
+				profile_dimensions.m_Height - 2
+			);
+
+		inComponentsManager->AddComponent(m_ComponentCPUProfile);
 	}
 }
\ No newline at end of file
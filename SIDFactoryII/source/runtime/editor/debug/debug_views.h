@@ -15,6 +15,8 @@ namespace Foundation
 namespace Emulation
 {
 	class CPUMemory;
+	class CPUProfiler;
+	class ExecutionHandler;
 }
 
 namespace Utility
@@ -28,11 +30,12 @@ namespace Editor
 	class DriverInfo;
 	class ComponentsManager;
 	class ComponentMemoryView;
+	class ComponentCPUProfile;
 
 	class DebugViews final
 	{
 	public:
-		DebugViews(Foundation::Viewport* inViewport, ComponentsManager* inComponentsManager, Emulation::CPUMemory* inCPUMemory, const Foundation::Extent& inMainTextFieldDimensions, std::shared_ptr<const DriverInfo> inDriverInfo);
+		DebugViews(Foundation::Viewport* inViewport, ComponentsManager* inComponentsManager, Emulation::CPUMemory* inCPUMemory, Emulation::ExecutionHandler* inExecutionHandler, const Foundation::Extent& inMainTextFieldDimensions, std::shared_ptr<const DriverInfo> inDriverInfo);
 		~DebugViews();
 
 		void SetEnabled(bool inEnabled);
@@ -54,12 +57,18 @@ namespace Editor
 		std::shared_ptr<const DriverInfo> m_DriverInfo;
 
 		Emulation::CPUMemory* m_CPUMemory;
+		Emulation::ExecutionHandler* m_ExecutionHandler;
 		Foundation::Viewport* m_Viewport;
 		Foundation::TextField* m_TextField;
+		Foundation::TextField* m_ProfileTextField;
+
+		// The profiler is only attached to the CPU, while the debug views are enabled
+		std::unique_ptr<Emulation::CPUProfiler> m_CPUProfiler;
 
 		ComponentsManager* m_ComponentsManager;
 
 		std::shared_ptr<ComponentMemoryView> m_ComponentMemoryView;
+		std::shared_ptr<ComponentCPUProfile> m_ComponentCPUProfile;
 		//std::vector<Utility::KeyHook<bool(void)>> m_KeyHookTests;
 		std::vector<int> m_KeyHookTestValues;
 
@@ -375,7 +375,7 @@ namespace Editor
 
 			while (address < bottom_address)
 			{
-				const unsigned char opcode = inCPUMemory[address];
+				const unsigned char opcode = inCPUMemory.GetByte(address);
 				const unsigned char opcode_size = Emulation::CPUmos6510::GetOpcodeByteSize(opcode);
 				const unsigned char opcode_cycles = Emulation::CPUmos6510::GetOpcodeCycles(opcode);
 			
@@ -10,6 +10,7 @@ namespace Editor
 		, m_EventHighlight( { 0, 4 })
 		, m_FollowPlayMode(false)
 		, m_PreventSequenceEdit(false)
+		, m_SIDModelAudition(false)
 	{
 	}
 
@@ -24,6 +25,8 @@ namespace Editor
 			return false;
 		if (m_FollowPlayMode != inOther.m_FollowPlayMode)
 			return false;
+		if (m_SIDModelAudition != inOther.m_SIDModelAudition)
+			return false;
 
 		return true;
 	}
@@ -115,4 +118,14 @@ namespace Editor
 	{
 		m_PreventSequenceEdit = inPreventSequenceEdit;
 	}
+
+	bool EditState::IsSIDModelAuditionEnabled() const
+	{
+		return m_SIDModelAudition;
+	}
+
+	void EditState::SetSIDModelAudition(bool inEnabled)
+	{
+		m_SIDModelAudition = inEnabled;
+	}
 }
\ No newline at end of file
@@ -51,6 +51,9 @@ namespace Editor
 		bool IsPreventingSequenceEdit() const;
 		void SetPreventSequenceEdit(bool inPreventSequenceEdit);
 
+		bool IsSIDModelAuditionEnabled() const;
+		void SetSIDModelAudition(bool inEnabled);
+
 	private:
 		bool m_SequenceHighlightingEnabled;
 
@@ -60,6 +63,7 @@ namespace Editor
 
 		bool m_FollowPlayMode;
 		bool m_PreventSequenceEdit;
+		bool m_SIDModelAudition;
 
 		EventHighlight m_EventHighlight;
 	};
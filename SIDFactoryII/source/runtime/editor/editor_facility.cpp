@@ -16,6 +16,7 @@
 #include "runtime/editor/driver/driver_info.h"
 #include "runtime/editor/driver/driver_utils.h"
 #include "runtime/editor/editor_types.h"
+#include "runtime/editor/journal/edit_journal.h"
 #include "runtime/editor/keys/keyhook_setup.h"
 #include "runtime/editor/overlay_control.h"
 #include "runtime/editor/packer/packer.h"
@@ -61,6 +62,7 @@ using namespace fs;
 namespace Editor
 {
 	const unsigned int EditorFacility::DefaultDialogWidth = 100;
+	const int EditorFacility::JournalRecordInterval = 1000;
 
 	EditorFacility::EditorFacility(Viewport* inViewport)
 		: m_Viewport(inViewport)
@@ -69,6 +71,10 @@ namespace Editor
 		, m_RequestedScreen(nullptr)
 		, m_FlipOverlayState(false)
 		, m_SelectedColorScheme(0)
+		, m_IsJournalRecoveryOffered(false)
+		, m_JournalRecordTicks(0)
+		, m_JournalCheckpointTicks(0)
+		, m_JournalCheckpointInterval(0)
 	{
 
 		ConfigFile& config = Global::instance().GetConfig();
@@ -122,6 +128,14 @@ namespace Editor
 		sid_configuration.m_eModel = SID_MODEL_6581;
 		sid_configuration.m_nSampleFrequency = sid_sample_frequency;
 
+		// Additional sid chips, for drivers with 6 or 9 voices
+		sid_configuration.m_nSIDCount = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.SIDCount", 1);
+		const std::vector<int> sid_addresses = GetConfigurationValues<ConfigValueInt>(config, "Sound.Emulation.SIDAddress", {});
+		for (size_t i = 0; i < sid_addresses.size() && i < SID_MAX_COUNT; ++i)
+			sid_configuration.m_aSIDAddress[i] = static_cast<unsigned short>(sid_addresses[i]);
+		sid_configuration.m_nOutputChannelCount = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.Stereo", 0) != 0 ? 2 : 1;
+		sid_configuration.m_bClockInParallel = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Emulation.ParallelClock", 0) != 0;
+
 		m_SIDProxy = new SIDProxy(sid_configuration);
 		m_CPUMemory = new CPUMemory(0x10000, &platform);
 		m_CPU = new CPUmos6510();
@@ -130,7 +144,8 @@ namespace Editor
 
 		// Create audio stream
 		const int audio_buffer_size = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Buffer.Size", 256);
-		m_AudioStream = new AudioStream(sid_sample_frequency, 16, std::max<const int>(audio_buffer_size, 0x80), m_ExecutionHandler);
+		const bool audio_float = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Output.Float", 0) != 0;
+		m_AudioStream = new AudioStream(sid_sample_frequency, audio_float ? 32 : 16, m_SIDProxy->GetOutputChannelCount(), std::max<const int>(audio_buffer_size, 0x80), m_ExecutionHandler);
 
 		// Create the main text field
 		m_TextField = m_Viewport->CreateTextField(m_Viewport->GetClientWidth() / TextField::font_width, m_Viewport->GetClientHeight() / TextField::font_height, 0, 0);
@@ -202,11 +217,31 @@ namespace Editor
 		// Apply additional configuration to the edit screen
 		m_EditScreen->SetAdditionalConfiguration(
 			GetSingleConfigurationValue<ConfigValueInt>(config, "Editor.Driver.ConvertLegacyColors", 0) != 0);
+
+		// Create the edit journal, after finding what is left by a session that did not exit
+		if (GetSingleConfigurationValue<ConfigValueInt>(config, "Editor.Journal", 1) != 0)
+		{
+			const std::string journal_folder = platform.Storage_GetConfigHomePath();
+
+			m_JournalRecovery = EditJournal::FindRecovery(journal_folder, platform);
+			m_EditJournal = std::make_unique<EditJournal>(journal_folder, platform);
+			m_EditScreen->SetOnUndoStepHandler([&]() { JournalRecord(); });
+
+			m_JournalCheckpointInterval = 1000 * std::max(GetSingleConfigurationValue<ConfigValueInt>(config, "Editor.Journal.CheckpointInterval", 60), 1);
+		}
 	}
 
 	EditorFacility::~EditorFacility()
 	{
+		// Exiting normally leaves nothing to recover. A journal offered for recovery that was not answered is left for
+		// the next session
+		if (m_EditJournal != nullptr)
+			m_EditJournal->Remove();
+
+		m_EditJournal = nullptr;
+
 		m_AudioStream->Stop();
+		m_ExecutionHandler->StopEmulationThread();
 
 		m_Viewport->Destroy(m_TextField);
 
@@ -288,6 +323,7 @@ namespace Editor
 			}
 		}
 
+		m_ExecutionHandler->StartEmulationThread();
 		m_AudioStream->Start();
 		m_ExecutionHandler->Start();
 	}
@@ -309,6 +345,9 @@ namespace Editor
 		// Check screen status
 		HandleScreenState();
 
+		// Record edits that were not added to the undo, and offer recovery when the editor is shown
+		UpdateJournal(inDeltaTicks);
+
 		// Handle component updates
 		if (m_CurrentScreen != nullptr)
 		{
@@ -525,36 +564,10 @@ namespace Editor
 
 			if (driver_info->IsValid())
 			{
-				m_DriverInfo->GetAuxilaryDataCollection().Reset();
-				m_DriverInfo = driver_info;
-
-				// Copy the data to the emulated memory
-				m_CPUMemory->Lock();
-				m_CPUMemory->Clear();
-				m_CPUMemory->SetData(c64_file->GetTopAddress(), c64_file->GetData(), c64_file->GetDataSize());
-				m_CPUMemory->Unlock();
-
-				// Init the execution handler
-				m_ExecutionHandler->SetInitVector(m_DriverInfo->GetDriverCommon().m_InitAddress);
-				m_ExecutionHandler->SetStopVector(m_DriverInfo->GetDriverCommon().m_StopAddress);
-				m_ExecutionHandler->SetUpdateVector(m_DriverInfo->GetDriverCommon().m_UpdateAddress);
-
-				// Give the first song a default name, if it hasn't one and is the only song in the loaded file
-				EditorUtils::UpdateSongNameOfSingleSongPackages(*m_DriverInfo);
-				EditorUtils::AddMissingPlayerMarkerLayers(*m_DriverInfo);
-
-
-				// Store name of last read file
-				SetLastSavedPathAndFilename(inPathAndFilename);
-
-				// Flush undo after load
-				m_EditScreen->FlushUndo();
-
-				// Flush copy/paste
-				CopyPaste::Instance().Flush();
+				SetMusicData(driver_info, *c64_file, inPathAndFilename);
 
-				// Notify overlay
-				m_OverlayControl->OnChange(*m_DriverInfo);
+				if (IsJournaling())
+					JournalCheckpoint(*CreateSaveFile(), true);
 			}
 
 			delete[] static_cast<char*>(data);
@@ -622,35 +635,11 @@ namespace Editor
 
 				if (driver_info->IsValid())
 				{
-					m_DriverInfo->GetAuxilaryDataCollection().Reset();
-					m_DriverInfo = driver_info;
+					SetMusicData(driver_info, *inC64File, inPathAndFilename);
 
-					// Copy the data to the emulated memory
-					m_CPUMemory->Lock();
-					m_CPUMemory->Clear();
-					m_CPUMemory->SetData(inC64File->GetTopAddress(), inC64File->GetData(), inC64File->GetDataSize());
-					m_CPUMemory->Unlock();
-
-					// Init the execution handler
-					m_ExecutionHandler->SetInitVector(m_DriverInfo->GetDriverCommon().m_InitAddress);
-					m_ExecutionHandler->SetStopVector(m_DriverInfo->GetDriverCommon().m_StopAddress);
-					m_ExecutionHandler->SetUpdateVector(m_DriverInfo->GetDriverCommon().m_UpdateAddress);
-
-					// Give the first song a default name, if it hasn't one and is the only song in the loaded file
-					EditorUtils::UpdateSongNameOfSingleSongPackages(*m_DriverInfo);
-					EditorUtils::AddMissingPlayerMarkerLayers(*m_DriverInfo);
-
-					// Store name of last read file
-					SetLastSavedPathAndFilename(inPathAndFilename);
-
-					// Flush undo after load
-					m_EditScreen->FlushUndo();
-
-					// Flush copy/paste
-					CopyPaste::Instance().Flush();
-
-					// Notify overlay
-					m_OverlayControl->OnChange(*m_DriverInfo);
+					// The converted song is not saved as a file that can be loaded yet
+					if (IsJournaling())
+						JournalCheckpoint(*CreateSaveFile(), false);
 
 					inSuccesfullConversionAction();
 					return;
@@ -691,32 +680,7 @@ namespace Editor
 	{
 		if (m_DriverInfo->IsValid())
 		{
-			m_CPUMemory->Lock();
-
-			const unsigned short top_of_file_address = m_DriverInfo->GetTopAddress();
-			const unsigned short end_of_file_address = DriverUtils::GetEndOfMusicDataAddress(*m_DriverInfo, reinterpret_cast<const Emulation::IMemoryRandomReadAccess&>(*m_CPUMemory));
-			const unsigned short data_size = end_of_file_address - top_of_file_address;
-
-			unsigned char* data = new unsigned char[data_size];
-			m_CPUMemory->GetData(top_of_file_address, data, data_size);
-			m_CPUMemory->Unlock();
-			std::shared_ptr<Utility::C64File> file = Utility::C64File::CreateFromData(top_of_file_address, data, data_size);
-			delete[] data;
-
-			Utility::C64FileWriter file_writer(*file, end_of_file_address, true);
-
-			const unsigned short irq_vector = file_writer.GetWriteAddress();
-			DriverUtils::InsertIRQ(*m_DriverInfo, file_writer);
-
-			const unsigned short auxilary_data_vector = file_writer.GetWriteAddress();
-			m_DriverInfo->GetAuxilaryDataCollection().Save(file_writer);
-
-			// Adjust IRQ and auxiliary data vectors in file
-			const unsigned short driver_init_vector = m_DriverInfo->GetDriverCommon().m_InitAddress;
-			(*file)[driver_init_vector - 2] = static_cast<unsigned char>(irq_vector & 0xff);
-			(*file)[driver_init_vector - 1] = static_cast<unsigned char>(irq_vector >> 8);
-			(*file)[driver_init_vector - 5] = static_cast<unsigned char>(auxilary_data_vector & 0xff);
-			(*file)[driver_init_vector - 4] = static_cast<unsigned char>(auxilary_data_vector >> 8);
+			std::shared_ptr<Utility::C64File> file = CreateSaveFile();
 
 			// Save to disk
 			if (!Utility::WriteFile(inPathAndFilename, file))
@@ -724,6 +688,9 @@ namespace Editor
 
 			SetLastSavedPathAndFilename(inPathAndFilename);
 
+			if (IsJournaling())
+				JournalCheckpoint(*file, true);
+
 			return true;
 		}
 
@@ -731,6 +698,75 @@ namespace Editor
 	}
 
 
+	std::shared_ptr<Utility::C64File> EditorFacility::CreateSaveFile()
+	{
+		FOUNDATION_ASSERT(m_DriverInfo->IsValid());
+
+		m_CPUMemory->Lock();
+
+		const unsigned short top_of_file_address = m_DriverInfo->GetTopAddress();
+		const unsigned short end_of_file_address = DriverUtils::GetEndOfMusicDataAddress(*m_DriverInfo, reinterpret_cast<const Emulation::IMemoryRandomReadAccess&>(*m_CPUMemory));
+		const unsigned short data_size = end_of_file_address - top_of_file_address;
+
+		unsigned char* data = new unsigned char[data_size];
+		m_CPUMemory->GetData(top_of_file_address, data, data_size);
+		m_CPUMemory->Unlock();
+		std::shared_ptr<Utility::C64File> file = Utility::C64File::CreateFromData(top_of_file_address, data, data_size);
+		delete[] data;
+
+		Utility::C64FileWriter file_writer(*file, end_of_file_address, true);
+
+		const unsigned short irq_vector = file_writer.GetWriteAddress();
+		DriverUtils::InsertIRQ(*m_DriverInfo, file_writer);
+
+		const unsigned short auxilary_data_vector = file_writer.GetWriteAddress();
+		m_DriverInfo->GetAuxilaryDataCollection().Save(file_writer);
+
+		// Adjust IRQ and auxiliary data vectors in file
+		const unsigned short driver_init_vector = m_DriverInfo->GetDriverCommon().m_InitAddress;
+		(*file)[driver_init_vector - 2] = static_cast<unsigned char>(irq_vector & 0xff);
+		(*file)[driver_init_vector - 1] = static_cast<unsigned char>(irq_vector >> 8);
+		(*file)[driver_init_vector - 5] = static_cast<unsigned char>(auxilary_data_vector & 0xff);
+		(*file)[driver_init_vector - 4] = static_cast<unsigned char>(auxilary_data_vector >> 8);
+
+		return file;
+	}
+
+
+	void EditorFacility::SetMusicData(const std::shared_ptr<DriverInfo>& inDriverInfo, const Utility::C64File& inC64File, const std::string& inPathAndFilename)
+	{
+		m_DriverInfo->GetAuxilaryDataCollection().Reset();
+		m_DriverInfo = inDriverInfo;
+
+		// Copy the data to the emulated memory
+		m_CPUMemory->Lock();
+		m_CPUMemory->Clear();
+		m_CPUMemory->SetData(inC64File.GetTopAddress(), inC64File.GetData(), inC64File.GetDataSize());
+		m_CPUMemory->Unlock();
+
+		// Init the execution handler
+		m_ExecutionHandler->SetInitVector(m_DriverInfo->GetDriverCommon().m_InitAddress);
+		m_ExecutionHandler->SetStopVector(m_DriverInfo->GetDriverCommon().m_StopAddress);
+		m_ExecutionHandler->SetUpdateVector(m_DriverInfo->GetDriverCommon().m_UpdateAddress);
+
+		// Give the first song a default name, if it hasn't one and is the only song in the loaded file
+		EditorUtils::UpdateSongNameOfSingleSongPackages(*m_DriverInfo);
+		EditorUtils::AddMissingPlayerMarkerLayers(*m_DriverInfo);
+
+		// Store name of last read file
+		SetLastSavedPathAndFilename(inPathAndFilename);
+
+		// Flush undo after load
+		m_EditScreen->FlushUndo();
+
+		// Flush copy/paste
+		CopyPaste::Instance().Flush();
+
+		// Notify overlay
+		m_OverlayControl->OnChange(*m_DriverInfo);
+	}
+
+
 	bool EditorFacility::SavePackedFile(const std::string& inFileName)
 	{
 		if (m_PackedData != nullptr)
@@ -781,7 +817,9 @@ namespace Editor
 					inAuthor,
 					inCopyright,
 					hardware_preferences.GetSIDModel() == AuxilaryDataHardwarePreferences::MOS6581,
-					hardware_preferences.GetRegion() == AuxilaryDataHardwarePreferences::PAL);
+					hardware_preferences.GetRegion() == AuxilaryDataHardwarePreferences::PAL,
+					m_SIDProxy->GetSIDCount() > 1 ? m_SIDProxy->GetSIDAddress(1) : 0,
+					m_SIDProxy->GetSIDCount() > 2 ? m_SIDProxy->GetSIDAddress(2) : 0);
 
 				const unsigned char* psid_data = psid_file.GetData();
 
@@ -1138,6 +1176,128 @@ namespace Editor
 	}
 
 
+	//------------------------------------------------------------------------------------------------------------
+
+	bool EditorFacility::IsJournaling() const
+	{
+		return m_EditJournal != nullptr && m_JournalRecovery == nullptr;
+	}
+
+
+	void EditorFacility::JournalCheckpoint(Utility::C64File& inFile, bool inIsSaved)
+	{
+		FOUNDATION_ASSERT(IsJournaling());
+
+		// Only the memory after the driver is recorded, as the driver changes its own variables while playing
+		const DriverInfo::Descriptor& descriptor = m_DriverInfo->GetDescriptor();
+		const unsigned short music_data_address = static_cast<unsigned short>(descriptor.m_DriverCodeTop + descriptor.m_DriverSize);
+
+		m_EditJournal->Checkpoint(inFile, m_LastSF2PathAndFilename, inIsSaved, music_data_address, *m_CPUMemory);
+
+		m_JournalCheckpointTicks = 0;
+	}
+
+
+	void EditorFacility::JournalRecord()
+	{
+		if (IsJournaling())
+			m_EditJournal->Record(*m_CPUMemory);
+	}
+
+
+	void EditorFacility::UpdateJournal(int inDeltaTicks)
+	{
+		if (m_EditJournal == nullptr)
+			return;
+
+		if (m_JournalRecovery != nullptr)
+		{
+			if (!m_IsJournalRecoveryOffered && m_CurrentScreen == m_EditScreen.get())
+			{
+				m_IsJournalRecoveryOffered = true;
+
+				auto on_recover = [&]()
+				{
+					std::shared_ptr<EditJournal::Recovery> recovery = m_JournalRecovery;
+					m_JournalRecovery = nullptr;
+
+					RecoverFromJournal(*recovery);
+					EditJournal::RemoveRecovery(*recovery);
+				};
+
+				auto on_discard = [&]()
+				{
+					EditJournal::RemoveRecovery(*m_JournalRecovery);
+					m_JournalRecovery = nullptr;
+
+					if (m_DriverInfo->IsValid())
+						JournalCheckpoint(*CreateSaveFile(), true);
+				};
+
+				const std::string message = "The editor did not exit normally while editing " + m_JournalRecovery->m_PathAndFilename + ". Do you want to recover the unsaved work?";
+				m_EditScreen->GetComponentsManager().StartDialog(std::make_shared<DialogMessageYesNo>("Recover unsaved work", message, DefaultDialogWidth, on_recover, on_discard));
+			}
+
+			return;
+		}
+
+		if (!m_DriverInfo->IsValid())
+			return;
+
+		// Edits are recorded when they are added to the undo, which is before the next edit. The last edit, and edits
+		// not added to the undo, are recorded here
+		m_JournalRecordTicks += inDeltaTicks;
+
+		if (m_JournalRecordTicks >= JournalRecordInterval)
+		{
+			m_JournalRecordTicks = 0;
+			JournalRecord();
+		}
+
+		// A checkpoint drops the records before it, and holds the auxiliary data, which is not recorded
+		m_JournalCheckpointTicks += inDeltaTicks;
+
+		if (m_JournalCheckpointTicks >= m_JournalCheckpointInterval)
+		{
+			std::shared_ptr<Utility::C64File> file = CreateSaveFile();
+
+			if (!m_EditJournal->IsCheckpoint(*file))
+				JournalCheckpoint(*file, false);
+
+			m_JournalCheckpointTicks = 0;
+		}
+	}
+
+
+	void EditorFacility::RecoverFromJournal(const EditJournal::Recovery& inRecovery)
+	{
+		std::shared_ptr<DriverInfo> driver_info = std::make_shared<DriverInfo>();
+		std::shared_ptr<Utility::C64File> c64_file = Utility::C64File::CreateFromPRGData(inRecovery.m_PRGData.data(), static_cast<unsigned int>(inRecovery.m_PRGData.size()));
+
+		if (c64_file != nullptr)
+			driver_info->Parse(*c64_file);
+
+		if (!driver_info->IsValid())
+		{
+			Logging::instance().Warning("The journal %s could not be recovered.", inRecovery.m_JournalPathAndFilename.c_str());
+
+			if (m_DriverInfo->IsValid())
+				JournalCheckpoint(*CreateSaveFile(), true);
+
+			return;
+		}
+
+		SetMusicData(driver_info, *c64_file, inRecovery.m_PathAndFilename);
+
+		const unsigned int record_count = EditJournal::ApplyRecovery(inRecovery, *m_CPUMemory);
+		Logging::instance().Info("Recovered %s from the journal, with %d of %d records.", inRecovery.m_PathAndFilename.c_str(), record_count, static_cast<int>(inRecovery.m_Differences.size()));
+
+		JournalCheckpoint(*CreateSaveFile(), false);
+
+		m_EditScreen->SetActivationMessage("Recovered unsaved work!");
+		ForceRequestScreen(m_EditScreen.get());
+	}
+
 	void EditorFacility::SetLastSavedPathAndFilename(const std::string& inLastSavedPathAndFilename)
 	{
 		m_LastSF2PathAndFilename = inLastSavedPathAndFilename;
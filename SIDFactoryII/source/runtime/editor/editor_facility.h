@@ -4,6 +4,7 @@
 #include "runtime/editor/display_state.h"
 #include "runtime/editor/driver/driver_info.h"
 #include "runtime/editor/edit_state.h"
+#include "runtime/editor/journal/edit_journal.h"
 #include "runtime/editor/keys/keyhook_setup.h"
 #include "runtime/editor/overlay_control.h"
 #include "utils/keyhookstore.h"
@@ -66,6 +67,8 @@ namespace Editor
 		void OnWindowResized();
 
 	private:
+		static const int JournalRecordInterval;
+
 		void Reconfigure(unsigned int inReconfigureOption);
 		void UpdateOverlayEnableDisable();
 
@@ -79,6 +82,8 @@ namespace Editor
 		bool LoadFileForImport(const std::string& inPathAndFilename, std::shared_ptr<DriverInfo>& outDriverInfo, std::shared_ptr<Utility::C64File>& outC64File);
 		bool LoadAndConvertFile(const std::string& inPathAndFilename, ScreenBase* inCallerScreen, std::function<void()> inSuccesfullConversionAction);
 		bool SaveFile(const std::string& inSavename);
+		std::shared_ptr<Utility::C64File> CreateSaveFile();
+		void SetMusicData(const std::shared_ptr<DriverInfo>& inDriverInfo, const Utility::C64File& inC64File, const std::string& inPathAndFilename);
 		bool SavePackedFile(const std::string& inSavename);
 		bool SavePackedFileToSID(ScreenBase* inCallerScreen, const std::string& inSavename);
 
@@ -101,6 +106,12 @@ namespace Editor
 		void DoSavePacked(ScreenBase* inCallerScreen, const std::string& inSelectedFilename);
 		void DoSavePackedToSID(ScreenBase* inCallerScreen, const std::string& inSelectedFilename);
 
+		bool IsJournaling() const;
+		void JournalCheckpoint(Utility::C64File& inFile, bool inIsSaved);
+		void JournalRecord();
+		void UpdateJournal(int inDeltaTicks);
+		void RecoverFromJournal(const EditJournal::Recovery& inRecovery);
+
 		void SetLastSavedPathAndFilename(const std::string& inLastSavedPathAndFilename);
 		std::string ConfigureColorsFromScheme(int inSchemeIndex, Foundation::Viewport& inViewport);
 
@@ -143,5 +154,13 @@ namespace Editor
 		std::unique_ptr<ScreenConvert> m_ConvertScreen;
 
 		std::shared_ptr<Utility::C64File> m_PackedData;
+
+		// Journal of the edits, which is not written to while the recovery from the journal of a previous session is offered
+		std::unique_ptr<EditJournal> m_EditJournal;
+		std::shared_ptr<EditJournal::Recovery> m_JournalRecovery;
+		bool m_IsJournalRecoveryOffered;
+		int m_JournalRecordTicks;
+		int m_JournalCheckpointTicks;
+		int m_JournalCheckpointInterval;
 	};
 }
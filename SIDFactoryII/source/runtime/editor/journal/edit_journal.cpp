@@ -0,0 +1,464 @@
+#include "runtime/editor/journal/edit_journal.h"
+#include "runtime/emulation/cpumemory.h"
+#include "utils/c64file.h"
+#include "utils/memorydifference.h"
+
+#include "foundation/base/assert.h"
+#include "foundation/platform/ifilelock.h"
+#include "foundation/platform/iplatform.h"
+#include "libraries/ghc/fs_std.h"
+
+#include <cstring>
+#include <system_error>
+
+namespace Editor
+{
+	// Journal file layout, in native byte order:
+	//
+	//     "SF2J", format version, flags, address of the recorded memory, size of the song path, size of the checkpoint,
+	//     checksum of the path and the checkpoint
+	//     song path
+	//     checkpoint, as prg data
+	//
+	// followed by the records:
+	//
+	//     size of the difference, checksum of the difference
+	//     difference
+	static const char Magic[4] = { 'S', 'F', '2', 'J' };
+	static const unsigned int FormatVersion = 1;
+	static const unsigned int HeaderWordCount = 6;
+	static const unsigned int FlagIsSaved = 1;
+
+	static const unsigned int MemorySize = 0x10000;
+
+	static const std::string JournalFilePrefix = "journal_";
+	static const std::string JournalFileExtension = ".sf2j";
+	static const std::string LockFileExtension = ".lock";
+	static const std::string TemporaryFileExtension = ".tmp";
+
+	// FNV-1a hash
+	static unsigned int GetChecksum(const unsigned char* inData, size_t inSize, unsigned int inSeed = 2166136261u)
+	{
+		unsigned int result = inSeed;
+
+		for (size_t i = 0; i < inSize; ++i)
+			result = (result ^ inData[i]) * 16777619u;
+
+		return result;
+	}
+
+	static void AppendWord(std::vector<unsigned char>& ioData, unsigned int inValue)
+	{
+		const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&inValue);
+		ioData.insert(ioData.end(), bytes, bytes + sizeof(inValue));
+	}
+
+
+	static void RemoveJournalFiles(const std::string& inPathAndFilename)
+	{
+		remove(inPathAndFilename.c_str());
+		remove((inPathAndFilename + TemporaryFileExtension).c_str());
+	}
+
+
+	EditJournal::EditJournal(const std::string& inFolder, const Foundation::IPlatform& inPlatform)
+		: m_Platform(inPlatform)
+		, m_PathAndFilename(inFolder + JournalFilePrefix + std::to_string(inPlatform.OS_GetProcessID()) + JournalFileExtension)
+		, m_LockPathAndFilename(m_PathAndFilename + LockFileExtension)
+		, m_AddressBegin(0)
+		, m_StopWorker(false)
+		, m_File(nullptr)
+	{
+		m_Thread = std::thread(&EditJournal::WorkerThread, this);
+	}
+
+
+	EditJournal::~EditJournal()
+	{
+		// The worker finishes the jobs in the queue before it stops
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_StopWorker = true;
+		}
+
+		m_JobAdded.notify_one();
+		m_Thread.join();
+
+		CloseFile();
+
+		if (m_Lock != nullptr)
+		{
+			m_Lock = nullptr;
+			remove(m_LockPathAndFilename.c_str());
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	std::shared_ptr<EditJournal::Recovery> EditJournal::Read(const std::string& inPathAndFilename)
+	{
+		FILE* file = fopen(inPathAndFilename.c_str(), "rb");
+
+		if (file == nullptr)
+			return nullptr;
+
+		std::shared_ptr<Recovery> recovery = std::make_shared<Recovery>();
+
+		char magic[4];
+		unsigned int header[HeaderWordCount];
+
+		bool ok = fread(magic, sizeof(magic), 1, file) == 1
+			&& memcmp(magic, Magic, sizeof(Magic)) == 0
+			&& fread(header, sizeof(header), 1, file) == 1
+			&& header[0] == FormatVersion
+			&& header[2] < MemorySize
+			&& header[3] <= 0x1000
+			&& header[4] > 2 && header[4] <= MemorySize + 2;
+
+		if (ok)
+		{
+			std::vector<char> path(header[3]);
+			recovery->m_PRGData.resize(header[4]);
+
+			ok = fread(path.data(), 1, path.size(), file) == path.size()
+				&& fread(recovery->m_PRGData.data(), 1, recovery->m_PRGData.size(), file) == recovery->m_PRGData.size()
+				&& GetChecksum(recovery->m_PRGData.data(), recovery->m_PRGData.size(), GetChecksum(reinterpret_cast<const unsigned char*>(path.data()), path.size())) == header[5];
+
+			recovery->m_PathAndFilename = std::string(path.begin(), path.end());
+			recovery->m_IsSaved = (header[1] & FlagIsSaved) != 0;
+			recovery->m_AddressBegin = static_cast<unsigned short>(header[2]);
+		}
+
+		// Records are read until the first one that was not completely written
+		while (ok)
+		{
+			unsigned int record_header[2];
+
+			if (fread(record_header, sizeof(record_header), 1, file) != 1 || record_header[0] > 2 * MemorySize)
+				break;
+
+			std::vector<unsigned char> difference(record_header[0]);
+
+			if (fread(difference.data(), 1, difference.size(), file) != difference.size() || GetChecksum(difference.data(), difference.size()) != record_header[1])
+				break;
+
+			recovery->m_Differences.push_back(std::move(difference));
+		}
+
+		fclose(file);
+
+		return ok ? recovery : nullptr;
+	}
+
+
+	std::shared_ptr<EditJournal::Recovery> EditJournal::FindRecovery(const std::string& inFolder, const Foundation::IPlatform& inPlatform)
+	{
+		std::vector<std::string> journal_paths;
+
+		std::error_code ec;
+		for (const fs::directory_entry& entry : fs::directory_iterator(inFolder, ec))
+		{
+			const std::string filename = entry.path().filename().string();
+
+			if (filename.size() > JournalFilePrefix.size() + JournalFileExtension.size()
+				&& filename.compare(0, JournalFilePrefix.size(), JournalFilePrefix) == 0
+				&& filename.compare(filename.size() - JournalFileExtension.size(), JournalFileExtension.size(), JournalFileExtension) == 0)
+				journal_paths.push_back(entry.path().string());
+		}
+
+		std::shared_ptr<Recovery> most_recent_recovery;
+		fs::file_time_type most_recent_time;
+
+		for (const std::string& journal_path : journal_paths)
+		{
+			// The lock is held by the editor writing the journal for as long as it runs
+			std::shared_ptr<Foundation::IFileLock> lock = inPlatform.Storage_LockFile(journal_path + LockFileExtension);
+
+			if (lock == nullptr)
+				continue;
+
+			std::shared_ptr<Recovery> recovery = Read(journal_path);
+
+			if (recovery == nullptr || (recovery->m_IsSaved && recovery->m_Differences.empty()))
+			{
+				RemoveJournalFiles(journal_path);
+
+				lock = nullptr;
+				remove((journal_path + LockFileExtension).c_str());
+
+				continue;
+			}
+
+			recovery->m_JournalPathAndFilename = journal_path;
+			recovery->m_Lock = lock;
+
+			// Journals that are not offered now are offered in a later session
+			const fs::file_time_type time = fs::last_write_time(journal_path, ec);
+
+			if (most_recent_recovery == nullptr || time > most_recent_time)
+			{
+				most_recent_recovery = recovery;
+				most_recent_time = time;
+			}
+		}
+
+		return most_recent_recovery;
+	}
+
+
+	void EditJournal::RemoveRecovery(Recovery& ioRecovery)
+	{
+		FOUNDATION_ASSERT(ioRecovery.m_Lock != nullptr);
+
+		RemoveJournalFiles(ioRecovery.m_JournalPathAndFilename);
+
+		// The lock file is removed after the lock is released, as it can not be removed while it is open on every platform
+		ioRecovery.m_Lock = nullptr;
+		remove((ioRecovery.m_JournalPathAndFilename + LockFileExtension).c_str());
+	}
+
+
+	unsigned int EditJournal::ApplyRecovery(const Recovery& inRecovery, Emulation::CPUMemory& inCPUMemory)
+	{
+		const unsigned int size = MemorySize - inRecovery.m_AddressBegin;
+
+		std::vector<unsigned char> data(size);
+		std::vector<unsigned char> applied_data(size);
+
+		inCPUMemory.Lock();
+		inCPUMemory.GetData(inRecovery.m_AddressBegin, data.data(), size);
+
+		unsigned int applied_count = 0;
+
+		for (const std::vector<unsigned char>& difference : inRecovery.m_Differences)
+		{
+			applied_data = data;
+
+			if (!Utility::ApplyMemoryDifference(difference, applied_data.data(), size))
+				break;
+
+			data.swap(applied_data);
+			++applied_count;
+		}
+
+		inCPUMemory.SetData(inRecovery.m_AddressBegin, data.data(), size);
+		inCPUMemory.Unlock();
+
+		return applied_count;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	const std::string& EditJournal::GetPathAndFilename() const
+	{
+		return m_PathAndFilename;
+	}
+
+
+	void EditJournal::Checkpoint(Utility::C64File& inFile, const std::string& inSongPathAndFilename, bool inIsSaved, unsigned short inAddressBegin, Emulation::CPUMemory& inCPUMemory)
+	{
+		// Taken at the first checkpoint, as a journal left by an earlier process with the same identifier is locked
+		// until it has been recovered or discarded
+		if (m_Lock == nullptr)
+		{
+			m_Lock = m_Platform.Storage_LockFile(m_LockPathAndFilename);
+
+			if (m_Lock == nullptr)
+				return;
+		}
+
+		unsigned char* prg_data = inFile.GetDataCopyAsPRG();
+		m_CheckpointPRGData.assign(prg_data, prg_data + inFile.GetPRGDataSize());
+		delete[] prg_data;
+
+		// The memory as it is after loading the checkpoint
+		m_AddressBegin = inAddressBegin;
+		m_Image.assign(MemorySize - inAddressBegin, 0);
+		m_EditData.resize(m_Image.size());
+		m_MemorySnapshot = nullptr;
+
+		const unsigned int file_begin = inFile.GetTopAddress();
+		const unsigned int file_end = file_begin + inFile.GetDataSize();
+
+		if (file_end > inAddressBegin)
+		{
+			const unsigned int copy_begin = file_begin > inAddressBegin ? file_begin : inAddressBegin;
+			memcpy(&m_Image[copy_begin - inAddressBegin], inFile.GetData() + (copy_begin - file_begin), file_end - copy_begin);
+		}
+
+		std::vector<unsigned char> data(Magic, Magic + sizeof(Magic));
+
+		AppendWord(data, FormatVersion);
+		AppendWord(data, inIsSaved ? FlagIsSaved : 0);
+		AppendWord(data, inAddressBegin);
+		AppendWord(data, static_cast<unsigned int>(inSongPathAndFilename.size()));
+		AppendWord(data, static_cast<unsigned int>(m_CheckpointPRGData.size()));
+
+		const unsigned char* path = reinterpret_cast<const unsigned char*>(inSongPathAndFilename.data());
+		AppendWord(data, GetChecksum(m_CheckpointPRGData.data(), m_CheckpointPRGData.size(), GetChecksum(path, inSongPathAndFilename.size())));
+
+		data.insert(data.end(), path, path + inSongPathAndFilename.size());
+		data.insert(data.end(), m_CheckpointPRGData.begin(), m_CheckpointPRGData.end());
+
+		AddJob(JobType::Checkpoint, std::move(data));
+
+		Record(inCPUMemory);
+	}
+
+
+	bool EditJournal::IsCheckpoint(Utility::C64File& inFile) const
+	{
+		if (inFile.GetPRGDataSize() != m_CheckpointPRGData.size())
+			return false;
+
+		unsigned char* prg_data = inFile.GetDataCopyAsPRG();
+		const bool is_checkpoint = memcmp(prg_data, m_CheckpointPRGData.data(), m_CheckpointPRGData.size()) == 0;
+		delete[] prg_data;
+
+		return is_checkpoint;
+	}
+
+
+	bool EditJournal::Record(Emulation::CPUMemory& inCPUMemory)
+	{
+		if (m_Image.empty())
+			return false;
+
+		const unsigned int size = static_cast<unsigned int>(m_Image.size());
+
+		// Outside of the pages written since the previous record, the memory is the same as the image
+		inCPUMemory.Lock();
+
+		if (m_MemorySnapshot != nullptr)
+			m_EditRanges = inCPUMemory.GetRangesChangedSince(*m_MemorySnapshot, m_AddressBegin, size);
+		else
+			m_EditRanges.assign(1, { 0, size });
+
+		for (const auto& range : m_EditRanges)
+			inCPUMemory.GetData(m_AddressBegin + range.first, &m_EditData[range.first], range.second - range.first);
+
+		m_MemorySnapshot = inCPUMemory.CreateSnapshot();
+		inCPUMemory.Unlock();
+
+		Utility::EncodeMemoryDifference(m_EditData.data(), m_Image.data(), m_EditRanges, m_DifferenceData);
+
+		for (const auto& range : m_EditRanges)
+			memcpy(&m_Image[range.first], &m_EditData[range.first], range.second - range.first);
+
+		if (m_DifferenceData.empty())
+			return false;
+
+		std::vector<unsigned char> data;
+		data.reserve(2 * sizeof(unsigned int) + m_DifferenceData.size());
+
+		AppendWord(data, static_cast<unsigned int>(m_DifferenceData.size()));
+		AppendWord(data, GetChecksum(m_DifferenceData.data(), m_DifferenceData.size()));
+		data.insert(data.end(), m_DifferenceData.begin(), m_DifferenceData.end());
+
+		AddJob(JobType::Record, std::move(data));
+
+		return true;
+	}
+
+
+	void EditJournal::Remove()
+	{
+		m_Image.clear();
+		m_MemorySnapshot = nullptr;
+		m_CheckpointPRGData.clear();
+
+		AddJob(JobType::Remove, std::vector<unsigned char>());
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void EditJournal::AddJob(JobType inType, std::vector<unsigned char>&& inData)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Jobs.push_back({ inType, std::move(inData) });
+		}
+
+		m_JobAdded.notify_one();
+	}
+
+
+	void EditJournal::WorkerThread()
+	{
+		while (true)
+		{
+			Job job;
+
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_JobAdded.wait(lock, [this]() { return m_StopWorker || !m_Jobs.empty(); });
+
+				if (m_Jobs.empty())
+					break;
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+			}
+
+			switch (job.m_Type)
+			{
+			case JobType::Checkpoint:
+				WriteCheckpoint(job.m_Data);
+				break;
+			case JobType::Record:
+				// Flushed for each record, so only the record being written can be lost if the application crashes
+				if (m_File != nullptr && fwrite(job.m_Data.data(), 1, job.m_Data.size(), m_File) == job.m_Data.size())
+					fflush(m_File);
+				break;
+			case JobType::Remove:
+				CloseFile();
+				RemoveJournalFiles(m_PathAndFilename);
+				break;
+			}
+		}
+	}
+
+
+	void EditJournal::WriteCheckpoint(const std::vector<unsigned char>& inData)
+	{
+		CloseFile();
+
+		// Write to a temporary file and rename it over the journal, which replaces it in one step, so there is always a
+		// complete journal if the application crashes or writing fails
+		const std::string temporary_path = m_PathAndFilename + TemporaryFileExtension;
+
+		FILE* file = fopen(temporary_path.c_str(), "wb");
+
+		if (file == nullptr)
+			return;
+
+		bool ok = fwrite(inData.data(), 1, inData.size(), file) == inData.size();
+		ok = fclose(file) == 0 && ok;
+
+		if (ok)
+		{
+			std::error_code ec;
+			fs::rename(temporary_path, m_PathAndFilename, ec);
+
+			ok = !ec;
+		}
+
+		if (!ok)
+		{
+			remove(temporary_path.c_str());
+			return;
+		}
+
+		m_File = fopen(m_PathAndFilename.c_str(), "ab");
+	}
+
+
+	void EditJournal::CloseFile()
+	{
+		if (m_File != nullptr)
+		{
+			fclose(m_File);
+			m_File = nullptr;
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "runtime/emulation/cpumemory.h"
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Utility
+{
+	class C64File;
+}
+
+namespace Foundation
+{
+	class IFileLock;
+	class IPlatform;
+}
+
+namespace Editor
+{
+	// Keeps a file from which the music data can be recovered after a crash. The file starts with a checkpoint, which is
+	// the song as it would be saved, followed by a record for each edit with the difference of the music data to the
+	// previous record. Records are appended and flushed on a worker thread, and a record that was not completely written
+	// is ignored by the recovery. A new checkpoint replaces the file, which drops all records before it.
+	//
+	// Each running editor has its own journal in the folder, named by its process, and holds a lock on a file next to it
+	// for as long as it runs. A journal that can be locked by another editor was left by an editor that is no longer
+	// running, and is offered for recovery
+	class EditJournal final
+	{
+	public:
+		struct Recovery
+		{
+			std::string m_PathAndFilename;
+			std::vector<unsigned char> m_PRGData;
+			bool m_IsSaved;
+
+			unsigned short m_AddressBegin;
+			std::vector<std::vector<unsigned char>> m_Differences;
+
+			// The journal read, which stays locked while the recovery is kept
+			std::string m_JournalPathAndFilename;
+			std::shared_ptr<Foundation::IFileLock> m_Lock;
+		};
+
+		EditJournal(const std::string& inFolder, const Foundation::IPlatform& inPlatform);
+		~EditJournal();
+
+		// Returns nullptr if there is no journal at the path, or if it has no checkpoint
+		static std::shared_ptr<Recovery> Read(const std::string& inPathAndFilename);
+
+		// Returns the most recent journal in the folder left by an editor that is no longer running, or nullptr if there is
+		// none with anything to recover. Such journals with nothing to recover are removed
+		static std::shared_ptr<Recovery> FindRecovery(const std::string& inFolder, const Foundation::IPlatform& inPlatform);
+
+		// Removes the journal the recovery was read from, once it has been recovered or discarded
+		static void RemoveRecovery(Recovery& ioRecovery);
+
+		// Applies the records to the memory, which must hold the checkpoint as loaded. Returns the number of records applied
+		static unsigned int ApplyRecovery(const Recovery& inRecovery, Emulation::CPUMemory& inCPUMemory);
+
+		const std::string& GetPathAndFilename() const;
+
+		// The file is the song as it is saved, and the memory from the address on is recorded by the following records.
+		// The memory is recorded immediately, as it can differ from the file as loaded. Nothing is written if the lock of
+		// the journal can not be taken
+		void Checkpoint(Utility::C64File& inFile, const std::string& inSongPathAndFilename, bool inIsSaved, unsigned short inAddressBegin, Emulation::CPUMemory& inCPUMemory);
+		bool IsCheckpoint(Utility::C64File& inFile) const;
+
+		// Returns false if the memory did not change since the previous record
+		bool Record(Emulation::CPUMemory& inCPUMemory);
+
+		// Removes the file, nothing is recorded until the next checkpoint
+		void Remove();
+
+	private:
+		enum class JobType : int
+		{
+			Checkpoint,
+			Record,
+			Remove
+		};
+
+		struct Job
+		{
+			JobType m_Type;
+			std::vector<unsigned char> m_Data;
+		};
+
+		void AddJob(JobType inType, std::vector<unsigned char>&& inData);
+
+		void WorkerThread();
+		void WriteCheckpoint(const std::vector<unsigned char>& inData);
+		void CloseFile();
+
+		const Foundation::IPlatform& m_Platform;
+
+		const std::string m_PathAndFilename;
+		const std::string m_LockPathAndFilename;
+		std::shared_ptr<Foundation::IFileLock> m_Lock;
+
+		// Memory from the address on, as of the last record, and the CPU memory at that record. A record only copies and
+		// compares the pages written since then
+		unsigned short m_AddressBegin;
+		std::vector<unsigned char> m_Image;
+		std::shared_ptr<const Emulation::CPUMemory::Snapshot> m_MemorySnapshot;
+		std::vector<unsigned char> m_EditData;
+		std::vector<std::pair<unsigned int, unsigned int>> m_EditRanges;
+		std::vector<unsigned char> m_DifferenceData;
+
+		std::vector<unsigned char> m_CheckpointPRGData;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_JobAdded;
+		std::deque<Job> m_Jobs;
+		bool m_StopWorker;
+
+		// Only used by the worker thread
+		FILE* m_File;
+
+		std::thread m_Thread;
+	};
+}
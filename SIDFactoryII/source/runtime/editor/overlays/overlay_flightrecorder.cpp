@@ -6,7 +6,9 @@
 #include "runtime/editor/components_manager.h"
 #include "runtime/editor/components/component_flightrecorder.h"
 #include "runtime/editor/datasources/datasource_flightrecorder.h"
+#include "runtime/emulation/sid/sidproxy.h"
 #include "runtime/execution/executionhandler.h"
+#include "runtime/editor/visualizer_components/visualizer_component_voice_scope.h"
 #include "runtime/editor/visualizer_components/vizualizer_component_emulation_state.h"
 #include "utils/usercolors.h"
 
@@ -18,13 +20,15 @@ namespace Editor
 {
 	const int OverlayFlightRecorder::ComponentBaseID = 0x100;
 	const int OverlayFlightRecorder::ComponentGroupID = 4;
+	const int OverlayFlightRecorder::VoiceScopeSampleFrequency = 15000;
 
 
-	OverlayFlightRecorder::OverlayFlightRecorder(Foundation::Viewport* inViewport, ComponentsManager* inComponentsManager, Emulation::CPUMemory* inCPUMemory, Emulation::ExecutionHandler* inExecutionHandler, const Foundation::Extent& inMainTextFieldDimensions)
+	OverlayFlightRecorder::OverlayFlightRecorder(Foundation::Viewport* inViewport, ComponentsManager* inComponentsManager, Emulation::CPUMemory* inCPUMemory, Emulation::ExecutionHandler* inExecutionHandler, Emulation::SIDProxy* inSIDProxy, const Foundation::Extent& inMainTextFieldDimensions)
 		: m_Viewport(inViewport)
 		, m_ComponentsManager(inComponentsManager)
 		, m_CPUMemory(inCPUMemory)	
 		, m_ExecutionHandler(inExecutionHandler)
+		, m_SIDProxy(inSIDProxy)
 		, m_Enabled(false)
 	{
 		const unsigned int margin_h = 4;
@@ -45,8 +49,12 @@ namespace Editor
 
 	OverlayFlightRecorder::~OverlayFlightRecorder()
 	{
+		if (m_Enabled)
+			SetVoiceTapEnabled(false);
+
 		m_Viewport->Destroy(m_TextField);
 		m_Viewport->Destroy(m_DrawField);
+		m_Viewport->Destroy(m_VoiceScopeDrawField);
 	}
 
 
@@ -58,7 +66,11 @@ namespace Editor
 
 			m_TextField->SetEnable(inEnabled);
 			m_DrawField->SetEnable(inEnabled);
+			m_VoiceScopeDrawField->SetEnable(inEnabled);
 			m_VisualizerEmulationState->SetEnabled(inEnabled);
+			m_VisualizerVoiceScope->SetEnabled(inEnabled);
+
+			SetVoiceTapEnabled(inEnabled);
 
 			m_ComponentsManager->SetGroupEnabledForInput(ComponentGroupID, m_Enabled);
 			m_ComponentsManager->SetGroupEnabledForTabbing(m_Enabled ? ComponentGroupID : 0);
@@ -116,5 +128,33 @@ namespace Editor
 		m_VisualizerEmulationState->SetEnabled(false);
 
 		m_ComponentsManager->AddVisualizerComponent(m_VisualizerEmulationState);
+
+		// Create voice scope draw field, above the emulation state
+		const int voice_scope_draw_field_y = draw_field_y - draw_field_height - draw_field_margin_y;
+
+		m_VoiceScopeDrawField = m_Viewport->CreateDrawField(draw_field_width, draw_field_height, draw_field_x, voice_scope_draw_field_y);
+		m_VoiceScopeDrawField->SetEnable(false);
+
+		m_VisualizerVoiceScope = std::make_shared<VisualizerComponentVoiceScope>(
+			0,
+			m_VoiceScopeDrawField,
+			0,
+			0,
+			draw_field_width,
+			draw_field_height,
+			m_SIDProxy);
+
+		m_VisualizerVoiceScope->SetEnabled(false);
+
+		m_ComponentsManager->AddVisualizerComponent(m_VisualizerVoiceScope);
+	}
+
+
+	void OverlayFlightRecorder::SetVoiceTapEnabled(bool inEnabled)
+	{
+		// The voice taps only cost emulation time while the scope is visible
+		m_ExecutionHandler->Lock();
+		m_SIDProxy->SetVoiceTapSampleFrequency(inEnabled ? VoiceScopeSampleFrequency : 0);
+		m_ExecutionHandler->Unlock();
 	}
 }
\ No newline at end of file
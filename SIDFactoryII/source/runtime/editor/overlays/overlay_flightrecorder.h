@@ -17,6 +17,7 @@ namespace Emulation
 {
 	class CPUMemory;
 	class ExecutionHandler;
+	class SIDProxy;
 }
 
 namespace Editor
@@ -25,11 +26,12 @@ namespace Editor
 	class ComponentsManager;
 	class ComponentFlightRecorderView;
 	class VisualizerComponentEmulationState;
+	class VisualizerComponentVoiceScope;
 
 	class OverlayFlightRecorder
 	{
 	public:
-		OverlayFlightRecorder(Foundation::Viewport* inViewport, ComponentsManager* inComponentsManager, Emulation::CPUMemory* inCPUMemory, Emulation::ExecutionHandler* inExecutionHandler, const Foundation::Extent& inMainTextFieldDimensions);
+		OverlayFlightRecorder(Foundation::Viewport* inViewport, ComponentsManager* inComponentsManager, Emulation::CPUMemory* inCPUMemory, Emulation::ExecutionHandler* inExecutionHandler, Emulation::SIDProxy* inSIDProxy, const Foundation::Extent& inMainTextFieldDimensions);
 		~OverlayFlightRecorder();
 
 		void SetEnabled(bool inEnabled);
@@ -37,18 +39,25 @@ namespace Editor
 
 	private:
 		void AddComponents();
+		void SetVoiceTapEnabled(bool inEnabled);
 
 		bool m_Enabled;
 
 		Emulation::ExecutionHandler* m_ExecutionHandler;
 		Emulation::CPUMemory* m_CPUMemory;
+		Emulation::SIDProxy* m_SIDProxy;
 		Foundation::Viewport* m_Viewport;
 		Foundation::TextField* m_TextField;
 		Foundation::DrawField* m_DrawField;
+		Foundation::DrawField* m_VoiceScopeDrawField;
 
 		ComponentsManager* m_ComponentsManager;
 
 		std::shared_ptr<VisualizerComponentEmulationState> m_VisualizerEmulationState;
+		std::shared_ptr<VisualizerComponentVoiceScope> m_VisualizerVoiceScope;
+
+		// Sample frequency of the voice taps, a PAL frame of samples fills the width of the scope
+		static const int VoiceScopeSampleFrequency;
 
 		static const int ComponentBaseID;
 		static const int ComponentGroupID;
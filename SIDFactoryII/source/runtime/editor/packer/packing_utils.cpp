@@ -34,7 +34,7 @@ namespace Editor
 
 		while (address < bottom_address)
 		{
-			const unsigned char opcode = inCPUMemory[address];
+			const unsigned char opcode = inCPUMemory.GetByte(address);
 			const unsigned char opcode_size = Emulation::CPUmos6510::GetOpcodeByteSize(opcode);
 			const Emulation::CPUmos6510::AddressingMode opcode_addressing_mode = Emulation::CPUmos6510::GetOpcodeAddressingMode(opcode);
 
@@ -42,7 +42,7 @@ namespace Editor
 			{
 				FOUNDATION_ASSERT(opcode_size == 2);
 
-				const unsigned char zp = inCPUMemory[address + 1];
+				const unsigned char zp = inCPUMemory.GetByte(address + 1);
 				if (zp < zp_lowest)
 					zp_lowest = zp;
 				if (zp > zp_highest)
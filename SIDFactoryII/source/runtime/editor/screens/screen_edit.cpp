@@ -41,7 +41,9 @@
 #include "runtime/emulation/cpumemory.h"
 #include "runtime/emulation/sid/sidproxy.h"
 #include "runtime/emulation/sid/sidproxydefines.h"
+#include "runtime/execution/emulationstate.h"
 #include "runtime/execution/executionhandler.h"
+#include "runtime/execution/keyframecache.h"
 
 #include "utils/delegate.h"
 #include "utils/keyhook.h"
@@ -117,6 +119,8 @@ namespace Editor
 		, m_ConvertLegacyDriverTableDefaultColors(false)
 		, m_ActivationFocusOnComponent(false)
 		, m_StopEmulationIfDriverStops(true)
+		, m_LatencyProbe(false)
+		, m_KeyframeCacheUpdateTicks(0)
 	{
 	}
 
@@ -178,6 +182,9 @@ namespace Editor
 
 		m_ExecutionHandler->Unlock();
 
+		// Audition the other SID model, if it was enabled when the screen was left
+		m_ExecutionHandler->SetSIDModelAudition(m_EditState.IsSIDModelAuditionEnabled());
+
 		// Get the write order and cycle timing from the driver
 		const auto SIDWriteInfoList = DriverUtils::GetSIDWriteInformationFromDriver(*m_CPUMemory, *m_DriverInfo);
 
@@ -185,7 +192,7 @@ namespace Editor
 			Utility::Logging::instance().Info("Write to address $d4%02x at cycle offset: %02x", SIDWriteInfo.m_AddressLow, SIDWriteInfo.m_CycleOffset); 
 
 		// Create debug views
-		m_DebugViews = std::make_unique<DebugViews>(m_Viewport, &*m_ComponentsManager, m_CPUMemory, m_MainTextField->GetDimensions(), m_DriverInfo);
+		m_DebugViews = std::make_unique<DebugViews>(m_Viewport, &*m_ComponentsManager, m_CPUMemory, m_ExecutionHandler, m_MainTextField->GetDimensions(), m_DriverInfo);
 
 		// Set SID factory text for a couple of seconds
 		auto mouse_button_octave = [&](Foundation::Mouse::Button inMouseButton, int inKeyboardModifiers)
@@ -229,7 +236,7 @@ namespace Editor
 		m_ActivationMessage = "";
 
 		// Create flight recorder overlay
-		m_OverlayFlightRecorder = std::make_shared<OverlayFlightRecorder>(m_Viewport, &*m_ComponentsManager, m_CPUMemory, m_ExecutionHandler, m_MainTextField->GetDimensions());
+		m_OverlayFlightRecorder = std::make_shared<OverlayFlightRecorder>(m_Viewport, &*m_ComponentsManager, m_CPUMemory, m_ExecutionHandler, m_SIDProxy, m_MainTextField->GetDimensions());
 
 		// Set post update callback from emulation context
 		m_ExecutionHandler->SetPostUpdateCallback([&](CPUMemory* inCPUMemory) { OnDriverPostUpdate(inCPUMemory); });
@@ -245,6 +252,11 @@ namespace Editor
 
 		m_PlaybackCurrentEventPos = -1;
 
+		// Start playing the song through in the background
+		m_KeyframeCache = std::make_unique<KeyframeCache>(*m_DriverInfo, &Utility::Global::instance().GetPlatform());
+		m_KeyframeCacheUpdateTicks = 0;
+		UpdateKeyframeCache();
+
 		// Reset edit state
 		m_EditState.SetSelectedInstrument(static_cast<char>(m_InstrumentTableComponent->GetSelectedRow()));
 	}
@@ -261,6 +273,9 @@ namespace Editor
 		// Remove post update callback (dependencies are going to be removed after, so this will avoid tearing down the application)
 		m_ExecutionHandler->SetPostUpdateCallback(nullptr);
 
+		// Other screens may change the configuration of the SID proxy, which the audition chips must match
+		m_ExecutionHandler->SetSIDModelAudition(false);
+
 		// Restore muted tracks
 		RestoreSIDOffsetData();
 
@@ -281,6 +296,9 @@ namespace Editor
 		// Dereference debug views
 		m_DebugViews = nullptr;
 
+		// Stop the playthrough of the keyframe cache
+		m_KeyframeCache = nullptr;
+
 		// Clear the components manager
 		m_ComponentsManager->Clear();
 
@@ -373,8 +391,28 @@ namespace Editor
 		}
 		m_ExecutionHandler->Unlock();
 
+		Emulation::ExecutionHandler::LatencyProbeResult latency;
+
+		if (m_LatencyProbe && m_ExecutionHandler->GetLatencyProbeResult(latency))
+		{
+			char text[128];
+			snprintf(text, sizeof(text), " Note latency: %.1f ms (key to driver %.1f ms, driver to audio %.1f ms, audio device %.1f ms)", latency.GetTotal(), latency.m_KeyToUpdate, latency.m_UpdateToOutput, latency.m_DeviceLatency);
+
+			SetStatusBarMessage(text, 5000);
+			Logging::instance().Info("%s", text + 1);
+		}
+
 		m_ComponentsManager->Update(inDeltaTick, m_CPUMemory);
 
+		// Let the keyframe cache catch up with edits now and then
+		m_KeyframeCacheUpdateTicks += inDeltaTick;
+
+		if (m_KeyframeCacheUpdateTicks > 1000)
+		{
+			UpdateKeyframeCache();
+			m_KeyframeCacheUpdateTicks = 0;
+		}
+
 		// Update play timer
 		const bool is_playing = m_DriverState.GetPlayState() == Editor::DriverState::PlayState::Playing;
 		if (is_playing)
@@ -450,6 +488,16 @@ namespace Editor
 		{
 			m_ComponentsManager->SetComponentInFocus(inComponentID);
 		});
+		m_Undo->SetOnStepHandler(m_UndoStepCallback);
+	}
+
+
+	void ScreenEdit::SetOnUndoStepHandler(std::function<void(void)> inHandler)
+	{
+		m_UndoStepCallback = inHandler;
+
+		if (m_Undo != nullptr)
+			m_Undo->SetOnStepHandler(inHandler);
 	}
 
 	//------------------------------------------------------------------------------------------------------------
@@ -485,6 +533,9 @@ namespace Editor
 						m_DriverState.SetPlayNote(current_play_note);
 
 						m_LastPlayNoteKeyInput = new_note;
+
+						if (m_LatencyProbe)
+							m_ExecutionHandler->ArmLatencyProbe();
 					}
 				}
 			}
@@ -523,6 +574,8 @@ namespace Editor
 		m_InstrumentTableDataSource->PushDataToSource();
 		m_CPUMemory->Unlock();
 
+		UpdateKeyframeCache();
+
 		const unsigned char song_index = m_DriverInfo->GetAuxilaryDataCollection().GetSongs().GetSelectedSong();
 		m_ExecutionHandler->QueueInit(song_index);
 		SetStatusPlaying(true);
@@ -534,14 +587,70 @@ namespace Editor
 
 	void ScreenEdit::DoPlay(unsigned int inEventPos)
 	{
-		DoRestoreMuteState();
-
 		// Push instruments data to emulation memory
 		m_CPUMemory->Lock();
 		m_InstrumentTableDataSource->PushDataToSource();
 		m_CPUMemory->Unlock();
 
+		UpdateKeyframeCache();
+
+		// Continue from the state of a playthrough of the song, if it has reached the event position, and seek the frames
+		// from it to the event position
+		unsigned int seek_frame_count = 0;
+		std::shared_ptr<const EmulationState> state = m_KeyframeCache != nullptr ? m_KeyframeCache->Seek(static_cast<int>(inEventPos), seek_frame_count) : nullptr;
+
+		if (state != nullptr)
+		{
+			// Keep the emulation from capturing a frame between the restore and the start of the seek
+			m_ExecutionHandler->Lock();
+
+			m_ExecutionHandler->QueueRestoreState(state);
+
+			// The state is played with all channels audible
+			for (unsigned char i = 0; i < m_DriverInfo->GetMusicData().m_TrackCount; ++i)
+			{
+				if (m_TracksComponent->IsMuted(i))
+					m_ExecutionHandler->QueueMuteChannel(i, [&, i](Emulation::CPUMemory* inCPUMemory) { OnDriverPostApplyChannelMuteState(inCPUMemory, i); });
+			}
+
+			if (seek_frame_count > 0)
+				m_ExecutionHandler->QueueSeek(seek_frame_count, nullptr);
+
+			SetStatusPlaying(true);
+
+			m_LastPlaybackStartEventPos = inEventPos;
+			m_PlaybackCurrentEventPos = state->m_EventPosition;
+
+			m_ExecutionHandler->Unlock();
+
+			return;
+		}
+
+		DoRestoreMuteState();
+
 		const unsigned char song_index = m_DriverInfo->GetAuxilaryDataCollection().GetSongs().GetSelectedSong();
+
+		// Otherwise play the song from the start up to the event position without audio output, if the event position can be followed
+		if (inEventPos > 0 && m_DriverInfo->GetDriverCommon().m_TempoCounterAddress != 0)
+		{
+			// Keep the emulation from capturing a frame between the init and the start of the seek
+			m_ExecutionHandler->Lock();
+
+			m_ExecutionHandler->QueueInit(song_index);
+			m_ExecutionHandler->QueueSeek(KeyframeCache::MaxFrameCount, [&, inEventPos](Emulation::CPUMemory* inCPUMemory)
+			{
+				return m_PlaybackCurrentEventPos + 1 >= static_cast<int>(inEventPos) || !IsPlaying();
+			});
+			SetStatusPlaying(true);
+
+			m_LastPlaybackStartEventPos = inEventPos;
+			m_PlaybackCurrentEventPos = -1;
+
+			m_ExecutionHandler->Unlock();
+
+			return;
+		}
+
 		m_ExecutionHandler->QueueInit(song_index, [&, inEventPos](Emulation::CPUMemory* inCPUMemory) { OnDriverPostInitPlayFromEventPos(inCPUMemory, inEventPos); });
 		SetStatusPlaying(true);
 
@@ -617,6 +726,19 @@ namespace Editor
 	}
 
 
+	void ScreenEdit::UpdateKeyframeCache()
+	{
+		if (m_KeyframeCache == nullptr)
+			return;
+
+		const unsigned char song_index = m_DriverInfo->GetAuxilaryDataCollection().GetSongs().GetSelectedSong();
+
+		m_CPUMemory->Lock();
+		m_KeyframeCache->Update(*m_CPUMemory, song_index, m_SIDProxy->GetConfiguration(), m_TracksComponent->GetMaxEventPosition());
+		m_CPUMemory->Unlock();
+	}
+
+
 	bool ScreenEdit::IsPlaying() const
 	{
 		return m_DriverState.GetPlayState() == Editor::DriverState::PlayState::Playing;
@@ -738,12 +860,18 @@ namespace Editor
 
 			hardware_preferences.SetSIDModel(sid_model);
 
-			m_ExecutionHandler->Lock();
+			const SIDModel model = sid_model == AuxilaryDataHardwarePreferences::SIDModel::MOS6581 ? SID_MODEL_6581 : SID_MODEL_8580;
 
-			m_SIDProxy->SetModel(sid_model == AuxilaryDataHardwarePreferences::SIDModel::MOS6581 ? SID_MODEL_6581 : SID_MODEL_8580);
-			m_SIDProxy->ApplySettings();
+			// While auditioning, the other model is already running alongside and takes over without a reset
+			if (!m_ExecutionHandler->SwitchAuditionModel(model))
+			{
+				m_ExecutionHandler->Lock();
 
-			m_ExecutionHandler->Unlock();
+				m_SIDProxy->SetModel(model);
+				m_SIDProxy->ApplySettings();
+
+				m_ExecutionHandler->Unlock();
+			}
 		}
 		else
 		{
@@ -753,15 +881,28 @@ namespace Editor
 
 			hardware_preferences.SetRegion(hardware_region);
 
+			// The audition chips are created again for the new environment
+			m_ExecutionHandler->SetSIDModelAudition(false);
 			m_ExecutionHandler->Lock();
 
 			m_SIDProxy->SetEnvironment(hardware_region == AuxilaryDataHardwarePreferences::Region::PAL ? SID_ENVIRONMENT_PAL : SID_ENVIRONMENT_NTSC);
 			m_SIDProxy->ApplySettings();
 
 			m_ExecutionHandler->Unlock();
+			m_ExecutionHandler->SetSIDModelAudition(m_EditState.IsSIDModelAuditionEnabled());
 		}
 	}
 
+	void ScreenEdit::DoToggleSIDModelAudition()
+	{
+		const bool enable_audition = !m_EditState.IsSIDModelAuditionEnabled();
+
+		m_EditState.SetSIDModelAudition(enable_audition);
+		m_ExecutionHandler->SetSIDModelAudition(enable_audition);
+
+		SetStatusBarMessage(enable_audition ? " SID model A/B audition enabled, toggling the SID model switches instantly" : " SID model A/B audition disabled", 2500);
+	}
+
 	void ScreenEdit::DoToggleContextHighlight()
 	{
 		m_EditState.SetSequenceHighlighting(!m_EditState.IsSequenceHighlightingEnabled());
@@ -1597,10 +1738,10 @@ namespace Editor
 
 				if (tempo_counter_address != 0)
 				{
-					const unsigned char driver_state_value = (*inCPUMemory)[driver_state_address];
+					const unsigned char driver_state_value = inCPUMemory->GetByte(driver_state_address);
 					if (driver_state_value == 0x80)
 					{
-						const unsigned char tempo_counter_value = (*inCPUMemory)[tempo_counter_address];
+						const unsigned char tempo_counter_value = inCPUMemory->GetByte(tempo_counter_address);
 
 						if (tempo_counter_value == 0)
 							++m_PlaybackCurrentEventPos;
@@ -1665,6 +1806,9 @@ namespace Editor
 					}
 
 					m_LastPlayNote = new_note;
+
+					if (m_LatencyProbe && new_note != -1)
+						m_ExecutionHandler->MarkLatencyProbe();
 				}
 			}
 			break;
@@ -1680,7 +1824,6 @@ namespace Editor
 		if (is_playing != inIsPlaying)
 		{
 			auto* flight_recorder = m_ExecutionHandler->GetFlightRecorder();
-			flight_recorder->Lock();
 
 			if (inIsPlaying)
 			{
@@ -1706,8 +1849,6 @@ namespace Editor
 				m_DriverState.SetPlayState(Editor::DriverState::PlayState::Stopped);
 				m_ComponentsManager->Update(0, m_CPUMemory);
 			}
-
-			flight_recorder->Unlock();
 		}
 	}
 
@@ -1749,6 +1890,7 @@ namespace Editor
 
 		ConfigFile& config = Global::instance().GetConfig();
 		m_StopEmulationIfDriverStops = GetSingleConfigurationValue<ConfigValueInt>(config, "Playback.StopEmulationIfDriverStops", true);
+		m_LatencyProbe = GetSingleConfigurationValue<ConfigValueInt>(config, "Sound.Output.LatencyProbe", 0) != 0;
 	}
 
 
@@ -1886,6 +2028,12 @@ namespace Editor
 			return true;
 		} });
 
+		m_KeyHooks.push_back({ "Key.ScreenEdit.ToggleSIDModelAudition", m_KeyHookStore, [&]()
+		{
+			DoToggleSIDModelAudition();
+			return true;
+		} });
+
 		m_KeyHooks.push_back({ "Key.ScreenEdit.LoadSong", m_KeyHookStore, [&]()
 		{
 			DoStop();
@@ -19,6 +19,7 @@ namespace Emulation
 {
 	class CPUMemory;
 	class ExecutionHandler;
+	class KeyframeCache;
 	class SIDProxy;
 }
 
@@ -107,6 +108,7 @@ namespace Editor
 		void SetActivationTableFocusID(int inFocusComponentID, int inSelectedRow);
 		void SetStatusBarMessage(const std::string& inMessage, int inDisplayDuration);
 		void FlushUndo();
+		void SetOnUndoStepHandler(std::function<void(void)> inHandler);
 
 	private:
 		bool ConsumeInputNotePlay(const Foundation::Keyboard& inKeyboard);
@@ -120,6 +122,8 @@ namespace Editor
 		void DoRestoreMuteState();
 		void DoMoveToEventPositionOfSelectedMarker();
 
+		void UpdateKeyframeCache();
+
 		bool IsPlaying() const;
 
 		void DoSpaceBarFromTable(bool inPressed, bool inForceApplyCommand);
@@ -130,6 +134,7 @@ namespace Editor
 		void DoToggleSharpFlat();
 		void DoOctaveChange(bool inUp);
 		void DoToggleSIDModelAndRegion(bool inToggleRegion);
+		void DoToggleSIDModelAudition();
 		void DoToggleContextHighlight();
 		void DoToggleFollowPlay();
 		void DoIncrementInstrumentIndex();
@@ -188,6 +193,7 @@ namespace Editor
 		std::function<void(unsigned short, unsigned char)> m_PackCallback;
 		std::function<void(void)> m_ToggleShowOverlay;
 		std::function<void(unsigned int)> m_ConfigReconfigure;
+		std::function<void(void)> m_UndoStepCallback;
 
 		// Dynamic key codes
 		std::vector<Utility::KeyHook<bool(DynamicKeysContext&)>> m_DynamicKeyHooks;
@@ -257,6 +263,13 @@ namespace Editor
 		int m_PlaybackCurrentEventPos;
 		bool m_StopEmulationIfDriverStops;
 
+		// Measure the time from a note key press until the note is heard
+		bool m_LatencyProbe;
+
+		// Emulation states of the selected song, for playback from an event position
+		std::unique_ptr<Emulation::KeyframeCache> m_KeyframeCache;
+		int m_KeyframeCacheUpdateTicks;
+
 		// Added configuration
 		bool m_ConvertLegacyDriverTableDefaultColors;
 
@@ -24,10 +24,11 @@ namespace Editor
 		, m_EditState(inEditState)
 		, m_DriverState(inDriverState)
 		, m_AuxilaryDataPlayMarkers(inAuxilaryDataCollection)
+		, m_CachedSIDModelAudition(false)
 	{
 		m_TextSectionOctave = std::make_shared<TextSection>(12, inOctaveMousePressCallback);
 		m_TextSectionSharpFlat = std::make_shared<TextSection>(15, inSharpFlatMousePressCallback);
-		m_TextSectionSID = std::make_shared<TextSection>(19, inSIDMousePressCallback);
+		m_TextSectionSID = std::make_shared<TextSection>(23, inSIDMousePressCallback);
 		m_TextSectionContextHighlight = std::make_shared<TextSection>(18, inContextHighlightMousePressCallback);
 		m_TextSectionFollowPlay = std::make_shared<TextSection>(15, inFollowPlayerMousePressCallback);
 
@@ -65,15 +66,19 @@ namespace Editor
 		const AuxilaryDataHardwarePreferences::SIDModel sid_model = hardware_preferences.GetSIDModel();
 		const AuxilaryDataHardwarePreferences::Region region = hardware_preferences.GetRegion();
 		
-		if (sid_model != m_CachedSIDModel || region != m_CachedRegion || inNeedUpdate)
+		const bool sid_model_audition = m_EditState.IsSIDModelAuditionEnabled();
+		
+		if (sid_model != m_CachedSIDModel || region != m_CachedRegion || sid_model_audition != m_CachedSIDModelAudition || inNeedUpdate)
 		{
 			std::string sid_region_string = (region == AuxilaryDataHardwarePreferences::Region::PAL ? "PAL" : "NTSC");
 			std::string sid_model_string = (sid_model == AuxilaryDataHardwarePreferences::SIDModel::MOS6581 ? "6581" : "8580");
+			std::string sid_audition_string = (sid_model_audition ? " A/B" : "");
 			
-			m_TextSectionSID->SetText(" SID: " + sid_model_string + " (" + sid_region_string + ")");
+			m_TextSectionSID->SetText(" SID: " + sid_model_string + " (" + sid_region_string + ")" + sid_audition_string);
 
 			m_CachedSIDModel = sid_model;
 			m_CachedRegion = region;
+			m_CachedSIDModelAudition = sid_model_audition;
 
 			m_NeedRefresh = true;
 		}
@@ -59,5 +59,6 @@ namespace Editor
 		AuxilaryDataEditingPreferences::NotationMode m_CachedNotationMode;
 		AuxilaryDataHardwarePreferences::SIDModel m_CachedSIDModel;
 		AuxilaryDataHardwarePreferences::Region m_CachedRegion;
+		bool m_CachedSIDModelAudition;
 	};
 }
\ No newline at end of file
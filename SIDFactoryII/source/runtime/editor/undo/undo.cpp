@@ -2,11 +2,16 @@
 #include "runtime/editor/undo/undostep.h"
 #include "runtime/editor/undo/undo_componentdata/undo_componentdata.h"
 #include "runtime/editor/undo/undo_datasource/undo_datasource.h"
-#include "runtime/editor/undo/undo_datasource/undo_datasource.h"
 #include "runtime/editor/driver/driver_info.h"
 #include "runtime/editor/auxilarydata/auxilary_data_collection.h"
 #include "runtime/editor/auxilarydata/auxilary_data_table_text.h"
 #include "runtime/emulation/cpumemory.h"
+#include "utils/config/configtypes.h"
+#include "utils/configfile.h"
+#include "utils/global.h"
+#include "utils/memorydifference.h"
+#include <algorithm>
+#include <cstring>
 #include <memory>
 #include "foundation/base/assert.h"
 #include "foundation/graphics/textfield.h"
@@ -18,21 +23,32 @@ namespace Editor
 		, m_DriverInfo(inDriverInfo)
 		, m_DataSnapshotAddressBegin(inDriverInfo.GetDescriptor().m_DriverCodeTop + inDriverInfo.GetDescriptor().m_DriverSize)
 		, m_DataSnapshotSize(0x10000 - m_DataSnapshotAddressBegin)
-		, m_Begin(0)
 		, m_End(0)
+		, m_SnapshotIndex(0)
+		, m_ByteCount(0)
 	{
+		using namespace Utility;
+
+		const int budget_kilobytes = GetSingleConfigurationValue<Config::ConfigValueInt>(Global::instance().GetConfig(), "Editor.Undo.MemoryBudget", 4096);
+		m_ByteBudget = static_cast<size_t>(std::max(budget_kilobytes, 64)) << 10;
+
+		m_Snapshot.resize(m_DataSnapshotSize);
+		m_EditData.resize(m_DataSnapshotSize);
+		m_NeighbourData.resize(m_DataSnapshotSize);
 	}
 
 
 	void Undo::Clear()
 	{
-		for (auto& step : m_UndoSteps)
-			step = nullptr;
-		//for (auto& step : m_UndoStepsRecentEdits)
-		//	step = nullptr;
+		m_UndoSteps.clear();
 
-		m_Begin = 0;
 		m_End = 0;
+		m_SnapshotIndex = 0;
+		m_MemorySnapshot = nullptr;
+		m_ByteCount = 0;
+
+		if (m_StepHandler != nullptr)
+			m_StepHandler();
 	}
 
 
@@ -42,91 +58,87 @@ namespace Editor
 	}
 
 
-	bool Undo::HasUndoStep() const
+	void Undo::SetOnStepHandler(std::function<void()> inHandler)
 	{
-		return m_Begin != m_End;
+		m_StepHandler = inHandler;
 	}
 
 
-	bool Undo::HasRedoStep() const
+	bool Undo::HasUndoStep() const
 	{
-		unsigned int next_end = m_End + 1;
-
-		if (next_end >= m_UndoSteps.size())
-			next_end = 0;
+		return m_End > 0;
+	}
 
-		if (m_Begin == next_end)
-			return false;
 
-		return m_UndoSteps[next_end] != nullptr;
+	bool Undo::HasRedoStep() const
+	{
+		return m_End + 1 < m_UndoSteps.size();
 	}
 
 
 	void Undo::AddMostRecentEdit(bool inLockCPU, const std::shared_ptr<UndoComponentData>& inComponentUndoData, std::function<void(const UndoComponentData&, CursorControl&)> inRestorePostFunction)
 	{
-		FOUNDATION_ASSERT(m_End < m_UndoSteps.size());
+		FOUNDATION_ASSERT(m_End <= m_UndoSteps.size());
 
-		unsigned char* data = new unsigned char[m_DataSnapshotSize];
 		auto& data_source = inComponentUndoData->GetDataSource();
 
 		if (inLockCPU)
 			m_CPUMemory.Lock();
 
 		GetDataForUndo(data_source);
-		//m_CPUMemory.GetData(m_DataSnapshotAddressBegin, static_cast<void*>(data), m_DataSnapshotSize);
 
 		if (inLockCPU)
 			m_CPUMemory.Unlock();
 
-		m_UndoSteps[m_End] = std::make_shared<UndoStep>(data, inComponentUndoData, inRestorePostFunction);
-
 		FlushForwardUndoSteps();
+		SetStep(std::make_shared<UndoStep>(inComponentUndoData, inRestorePostFunction));
+
+		RemoveOldestSteps();
+
+		if (m_StepHandler != nullptr)
+			m_StepHandler();
 	}
 
 
 	void Undo::AddUndo(const std::shared_ptr<UndoComponentData>& inComponentUndoData, std::function<void(const UndoComponentData&, CursorControl&)> inRestorePostFunction)
 	{
-		FOUNDATION_ASSERT(m_End < m_UndoSteps.size());
+		FOUNDATION_ASSERT(m_End <= m_UndoSteps.size());
 
-		unsigned char* data = new unsigned char[m_DataSnapshotSize];
 		auto& data_source = inComponentUndoData->GetDataSource();
 
 		m_CPUMemory.Lock();
 		GetDataForUndo(data_source);
-		//m_CPUMemory.GetData(m_DataSnapshotAddressBegin, static_cast<void*>(data), m_DataSnapshotSize);
 		m_CPUMemory.Unlock();
 
-		//m_UndoStepsRecentEdits[m_End] = m_UndoSteps[m_End];
-		m_UndoSteps[m_End] = std::make_shared<UndoStep>(data, inComponentUndoData, inRestorePostFunction);
+		SetStep(std::make_shared<UndoStep>(inComponentUndoData, inRestorePostFunction));
 
 		++m_End;
-		if (m_End == m_UndoSteps.size())
-			m_End = 0;
 
-		if (m_End == m_Begin)
-		{
-			++m_Begin;
-			if (m_Begin == m_UndoSteps.size())
-				m_Begin = 0;
-		}
+		if (m_End < m_UndoSteps.size())
+			MoveSnapshotToStep(m_End);
+
+		RemoveOldestSteps();
+
+		if (m_StepHandler != nullptr)
+			m_StepHandler();
 	}
 
 
 	void Undo::FlushForwardUndoSteps()
 	{
-		unsigned int i = m_End + 1;
-
-		while (true)
+		while (m_UndoSteps.size() > m_End + 1)
 		{
-			if (i == m_UndoSteps.size())
-				i = 0;
-			if (i == m_Begin)
-				break;
+			m_ByteCount -= m_UndoSteps.back()->GetDifference().size() + StepOverheadByteCount;
+			m_UndoSteps.pop_back();
+		}
 
-			m_UndoSteps[i] = nullptr;
-			//m_UndoStepsRecentEdits[i] = nullptr;
+		// The current step is the newest now, so there is no next step to have a difference to
+		if (m_End < m_UndoSteps.size())
+		{
+			UndoStep& newest_step = *m_UndoSteps.back();
 
-			++i;
+			m_ByteCount -= newest_step.GetDifference().size();
+			newest_step.SetDifference(std::vector<unsigned char>());
 		}
 	}
 
@@ -135,53 +147,28 @@ namespace Editor
 	{
 		FOUNDATION_ASSERT(HasUndoStep());
 
-		int new_end = static_cast<int>(m_End) - 1;
+		const unsigned int new_end = m_End - 1;
 
-		if (new_end < 0)
-			new_end = static_cast<int>(m_UndoSteps.size() - 1);
+		MoveSnapshotToStep(new_end);
 
-		FOUNDATION_ASSERT(m_UndoSteps[new_end] != nullptr);
+		UndoStep& step = *m_UndoSteps[new_end];
 
-		const unsigned char* restore_data = m_UndoSteps[new_end]->GetData();
-		//const unsigned char* resent_edit_restore_data = m_UndoStepsRecentEdits[new_end] != nullptr ? m_UndoStepsRecentEdits[new_end]->GetData() : nullptr;
-		const unsigned char* resent_edit_restore_data = nullptr; 
-
-		if (restore_data != nullptr || resent_edit_restore_data != nullptr)
-		{
-			m_CPUMemory.Lock();
-
-//			if (resent_edit_restore_data != nullptr)
-//			{
-//				const auto& component_data = m_UndoStepsRecentEdits[new_end]->GetComponentData();
-//				const auto& data_source = component_data.GetDataSource();
-//				RestoreDataFromUndo(data_source);
-//
-//				//m_CPUMemory.SetData(m_DataSnapshotAddressBegin, static_cast<const void*>(resent_edit_restore_data), m_DataSnapshotSize);
-//			}
-			if (restore_data != nullptr)
-			{
-				const auto& component_data = m_UndoSteps[new_end]->GetComponentData();
-				const auto& data_source = component_data.GetDataSource();
-				RestoreDataFromUndo(data_source);
-
-				//m_CPUMemory.SetData(m_DataSnapshotAddressBegin, static_cast<const void*>(restore_data), m_DataSnapshotSize);
-			}
-
-			m_CPUMemory.Unlock();
-		}
+		m_CPUMemory.Lock();
+		RestoreDataFromUndo(step.GetComponentData().GetDataSource());
+		m_CPUMemory.Unlock();
 
-		const int component_id = m_UndoSteps[new_end]->GetComponentData().m_ComponentID;
-		const int component_group_id = m_UndoSteps[new_end]->GetComponentData().m_ComponentGroupID;
+		const int component_id = step.GetComponentData().m_ComponentID;
+		const int component_group_id = step.GetComponentData().m_ComponentGroupID;
 
 		if (m_RestoredStepComponentHandler != nullptr)
 			m_RestoredStepComponentHandler(component_id, component_group_id);
 
-		//if (m_UndoStepsRecentEdits[new_end] != nullptr)
-		//	m_UndoStepsRecentEdits[new_end]->OnRestored(inCursorControl);
+		step.OnRestored(inCursorControl);
 
-		m_UndoSteps[new_end]->OnRestored(inCursorControl);
+		m_End = new_end;
 
-		m_End = static_cast<unsigned int>(new_end);
+		if (m_StepHandler != nullptr)
+			m_StepHandler();
 
 		return component_id;
 	}
@@ -191,77 +178,60 @@ namespace Editor
 	{
 		FOUNDATION_ASSERT(HasRedoStep());
 
-		unsigned int new_end = m_End + 1;
-
-		if (new_end >= m_UndoSteps.size())
-			new_end = 0;
+		const unsigned int new_end = m_End + 1;
 
-		FOUNDATION_ASSERT(m_UndoSteps[new_end] != nullptr);
+		MoveSnapshotToStep(new_end);
 
-		const unsigned char* restore_data = m_UndoSteps[new_end]->GetData();
-		//const unsigned char* resent_edit_restore_data = m_UndoStepsRecentEdits[new_end] != nullptr ? m_UndoStepsRecentEdits[new_end]->GetData() : nullptr;
-		const unsigned char* resent_edit_restore_data = nullptr;
-
-		if (restore_data != nullptr || resent_edit_restore_data != nullptr)
-		{
-			m_CPUMemory.Lock();
-
-//			if (resent_edit_restore_data != nullptr)
-//			{
-//				const auto& component_data = m_UndoStepsRecentEdits[new_end]->GetComponentData();
-//				const auto& data_source = component_data.GetDataSource();
-//				RestoreDataFromUndo(data_source);
-//
-//				//m_CPUMemory.SetData(m_DataSnapshotAddressBegin, static_cast<const void*>(resent_edit_restore_data), m_DataSnapshotSize);
-//			}
-			if (restore_data != nullptr)
-			{
-				const auto& component_data = m_UndoSteps[new_end]->GetComponentData();
-				const auto& data_source = component_data.GetDataSource();
-				RestoreDataFromUndo(data_source);
-
-				//m_CPUMemory.SetData(m_DataSnapshotAddressBegin, static_cast<const void*>(restore_data), m_DataSnapshotSize);
-			}
+		UndoStep& step = *m_UndoSteps[new_end];
 
-			m_CPUMemory.Unlock();
-		}
+		m_CPUMemory.Lock();
+		RestoreDataFromUndo(step.GetComponentData().GetDataSource());
+		m_CPUMemory.Unlock();
 
-		const int component_id = m_UndoSteps[new_end]->GetComponentData().m_ComponentID;
-		const int component_group_id = m_UndoSteps[new_end]->GetComponentData().m_ComponentGroupID;
+		const int component_id = step.GetComponentData().m_ComponentID;
+		const int component_group_id = step.GetComponentData().m_ComponentGroupID;
 
 		if (m_RestoredStepComponentHandler != nullptr)
 			m_RestoredStepComponentHandler(component_id, component_group_id);
 
-		//if (m_UndoStepsRecentEdits[new_end] != nullptr)
-		//	m_UndoStepsRecentEdits[new_end]->OnRestored(inCursorControl);
-
-		m_UndoSteps[new_end]->OnRestored(inCursorControl);
+		step.OnRestored(inCursorControl);
 
 		m_End = new_end;
 
+		if (m_StepHandler != nullptr)
+			m_StepHandler();
+
 		return component_id;
 	}
 
 
 	void Undo::PrintDebug(Foundation::TextField& inTextField)
 	{
-		inTextField.PrintHexValue(0, 0, false, static_cast<unsigned short>(m_Begin));
-		inTextField.PrintHexValue(0, 1, false, static_cast<unsigned short>(m_End));
+		inTextField.PrintHexValue(0, 0, false, static_cast<unsigned short>(m_End));
+		inTextField.PrintHexValue(0, 1, false, static_cast<unsigned short>(m_UndoSteps.size()));
+		inTextField.Print(0, 2, Foundation::Color::White, std::to_string(m_ByteCount) + " / " + std::to_string(m_ByteBudget));
 
-		for (size_t i = 0; i < m_UndoSteps.size(); ++i)
+		for (size_t i = 0; i < m_UndoSteps.size() && i < 64; ++i)
 		{
-			std::string text = std::to_string(reinterpret_cast<unsigned long>(m_UndoSteps[i].get()));
-			inTextField.Print(5, i, Foundation::Color::White, text);
+			std::string text = std::to_string(m_UndoSteps[i]->GetDifference().size());
+			inTextField.Print(0, static_cast<int>(i) + 3, i == m_SnapshotIndex ? Foundation::Color::Yellow : Foundation::Color::White, text);
 		}
 	}
 
 
 	void Undo::GetDataForUndo(UndoDataSource& inData)
 	{
-		// CPU Memory
-		unsigned char* data = new unsigned char[m_DataSnapshotSize];
-		m_CPUMemory.GetData(m_DataSnapshotAddressBegin, static_cast<void*>(data), m_DataSnapshotSize);
-		inData.SetCPUMemoryData(data);
+		// CPU Memory, which only is copied while locked. Outside of the pages written since the memory snapshot, the memory
+		// is the same as the memory of the current step. The difference to the other steps is made afterwards
+		if (m_MemorySnapshot != nullptr)
+			m_EditRanges = m_CPUMemory.GetRangesChangedSince(*m_MemorySnapshot, m_DataSnapshotAddressBegin, m_DataSnapshotSize);
+		else
+			m_EditRanges.assign(1, { 0, m_DataSnapshotSize });
+
+		for (const auto& range : m_EditRanges)
+			m_CPUMemory.GetData(m_DataSnapshotAddressBegin + range.first, static_cast<void*>(&m_EditData[range.first]), range.second - range.first);
+
+		m_MemorySnapshot = m_CPUMemory.CreateSnapshot();
 
 		// Auxiliary data table text
 		const auto& table_text = m_DriverInfo.GetAuxilaryDataCollection().GetTableText();
@@ -271,11 +241,139 @@ namespace Editor
 
 	void Undo::RestoreDataFromUndo(const UndoDataSource& inData)
 	{
-		// CPU Memory
-		m_CPUMemory.SetData(m_DataSnapshotAddressBegin, static_cast<const void*>(inData.GetCPUMemoryData()), m_DataSnapshotSize);
+		// CPU Memory, of the step the snapshot has been moved to. Only the pages that differ are written, so that the next
+		// edit does not copy the others again
+		m_CPUMemory.GetData(m_DataSnapshotAddressBegin, static_cast<void*>(m_EditData.data()), m_DataSnapshotSize);
+
+		const unsigned int data_end = m_DataSnapshotAddressBegin + m_DataSnapshotSize;
+
+		for (unsigned int address = m_DataSnapshotAddressBegin; address < data_end;)
+		{
+			const unsigned int page_end = std::min((address / Emulation::CPUMemory::PageSize + 1) * Emulation::CPUMemory::PageSize, data_end);
+			const unsigned int offset = address - m_DataSnapshotAddressBegin;
+
+			if (memcmp(&m_EditData[offset], &m_Snapshot[offset], page_end - address) != 0)
+				m_CPUMemory.SetData(address, static_cast<const void*>(&m_Snapshot[offset]), page_end - address);
+
+			address = page_end;
+		}
+
+		m_MemorySnapshot = m_CPUMemory.CreateSnapshot();
 
 		// Auxiliary data table text
 		auto& table_text = m_DriverInfo.GetAuxilaryDataCollection().GetTableText();
 		table_text = inData.GetAuxilaryDataTableText();
 	}
-}
\ No newline at end of file
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void Undo::SetStep(const std::shared_ptr<UndoStep>& inStep)
+	{
+		const unsigned int step_count = static_cast<unsigned int>(m_UndoSteps.size());
+
+		FOUNDATION_ASSERT(m_End <= step_count);
+
+		if (m_End == step_count)
+		{
+			// The newest step gets the difference to the new step
+			if (step_count > 0)
+			{
+				FOUNDATION_ASSERT(m_SnapshotIndex == step_count - 1);
+				SetStepDifference(*m_UndoSteps.back(), m_Snapshot.data(), m_EditData.data(), m_EditRanges);
+			}
+
+			m_UndoSteps.push_back(inStep);
+		}
+		else
+		{
+			// Replace the current step, which is the step of the snapshot. The differences from the previous step and
+			// to the next step are made again with the memory of the new step, which is completed for this
+			FOUNDATION_ASSERT(m_SnapshotIndex == m_End);
+
+			const std::vector<std::pair<unsigned int, unsigned int>> full_range = { { 0, m_DataSnapshotSize } };
+			unsigned int copy_begin = 0;
+
+			for (const auto& range : m_EditRanges)
+			{
+				std::copy(m_Snapshot.begin() + copy_begin, m_Snapshot.begin() + range.first, m_EditData.begin() + copy_begin);
+				copy_begin = range.second;
+			}
+
+			std::copy(m_Snapshot.begin() + copy_begin, m_Snapshot.end(), m_EditData.begin() + copy_begin);
+
+			if (m_End > 0)
+			{
+				UndoStep& previous_step = *m_UndoSteps[m_End - 1];
+
+				m_NeighbourData = m_Snapshot;
+				Utility::ApplyMemoryDifference(previous_step.GetDifference(), m_NeighbourData.data(), m_DataSnapshotSize);
+				SetStepDifference(previous_step, m_NeighbourData.data(), m_EditData.data(), full_range);
+			}
+
+			if (m_End + 1 < step_count)
+			{
+				m_NeighbourData = m_Snapshot;
+				Utility::ApplyMemoryDifference(m_UndoSteps[m_End]->GetDifference(), m_NeighbourData.data(), m_DataSnapshotSize);
+				SetStepDifference(*inStep, m_EditData.data(), m_NeighbourData.data(), full_range);
+			}
+
+			m_ByteCount -= m_UndoSteps[m_End]->GetDifference().size() + StepOverheadByteCount;
+			m_UndoSteps[m_End] = inStep;
+		}
+
+		m_ByteCount += StepOverheadByteCount;
+
+		for (const auto& range : m_EditRanges)
+			std::copy(m_EditData.begin() + range.first, m_EditData.begin() + range.second, m_Snapshot.begin() + range.first);
+
+		m_SnapshotIndex = m_End;
+	}
+
+
+	void Undo::SetStepDifference(UndoStep& inStep, const unsigned char* inData, const unsigned char* inNextData, const std::vector<std::pair<unsigned int, unsigned int>>& inRanges)
+	{
+		Utility::EncodeMemoryDifference(inData, inNextData, inRanges, m_DifferenceData);
+
+		m_ByteCount -= inStep.GetDifference().size();
+		m_ByteCount += m_DifferenceData.size();
+
+		// Copied to a vector of its size, as the steps are kept for long
+		inStep.SetDifference(std::vector<unsigned char>(m_DifferenceData.begin(), m_DifferenceData.end()));
+	}
+
+
+	void Undo::MoveSnapshotToStep(unsigned int inIndex)
+	{
+		FOUNDATION_ASSERT(inIndex < m_UndoSteps.size());
+
+		// The CPU memory is not the same as the memory of the step, until it is restored
+		if (inIndex != m_SnapshotIndex)
+			m_MemorySnapshot = nullptr;
+
+		while (m_SnapshotIndex > inIndex)
+		{
+			--m_SnapshotIndex;
+			Utility::ApplyMemoryDifference(m_UndoSteps[m_SnapshotIndex]->GetDifference(), m_Snapshot.data(), m_DataSnapshotSize);
+		}
+
+		while (m_SnapshotIndex < inIndex)
+		{
+			Utility::ApplyMemoryDifference(m_UndoSteps[m_SnapshotIndex]->GetDifference(), m_Snapshot.data(), m_DataSnapshotSize);
+			++m_SnapshotIndex;
+		}
+	}
+
+
+	void Undo::RemoveOldestSteps()
+	{
+		// The step before the current step is kept, so the last edit can always be undone
+		while (m_ByteCount > m_ByteBudget && m_End > 1)
+		{
+			m_ByteCount -= m_UndoSteps.front()->GetDifference().size() + StepOverheadByteCount;
+			m_UndoSteps.pop_front();
+
+			--m_End;
+			--m_SnapshotIndex;
+		}
+	}
+}
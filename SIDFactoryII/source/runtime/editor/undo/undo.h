@@ -1,19 +1,17 @@
 #pragma once
 
-#include <array>
+#include "runtime/emulation/cpumemory.h"
+#include <deque>
 #include <memory>
 #include <functional>
+#include <utility>
+#include <vector>
 
 namespace Foundation
 {
 	class TextField;
 }
 
-namespace Emulation
-{
-	class CPUMemory;
-}
-
 namespace Editor
 {
 	class DriverInfo;
@@ -22,6 +20,11 @@ namespace Editor
 	class UndoComponentData;
 	class UndoDataSource;
 
+	// The memory of each step is stored as the XOR difference to the memory of the next step, in runs of changed bytes,
+	// and only the memory of the current step is kept in full. Moving one step applies a single difference. The oldest
+	// steps are dropped when the steps take more than the memory budget.
+	//
+	// An edit only copies and compares the pages of memory written since the memory of the current step was copied
 	class Undo final
 	{
 	public:
@@ -30,6 +33,9 @@ namespace Editor
 		void Clear();
 		void SetOnRestoredStepComponentHandler(std::function<void(int, int)> inHandler);
 
+		// Called after a step was added, undone or redone, or the steps were cleared
+		void SetOnStepHandler(std::function<void()> inHandler);
+
 		bool HasUndoStep() const;
 		bool HasRedoStep() const;
 
@@ -43,10 +49,18 @@ namespace Editor
 		void PrintDebug(Foundation::TextField& inTextField);
 	
 	private:
+		// Bytes counted for a step besides its difference
+		static const size_t StepOverheadByteCount = 256;
+
 		void GetDataForUndo(UndoDataSource& inData);
 		void RestoreDataFromUndo(const UndoDataSource& inData);
 
-		unsigned int m_Begin;
+		void SetStep(const std::shared_ptr<UndoStep>& inStep);
+		void SetStepDifference(UndoStep& inStep, const unsigned char* inData, const unsigned char* inNextData, const std::vector<std::pair<unsigned int, unsigned int>>& inRanges);
+		void MoveSnapshotToStep(unsigned int inIndex);
+		void RemoveOldestSteps();
+
+		// Index of the current step, the step at which the next step is set
 		unsigned int m_End;
 
 		unsigned short m_DataSnapshotAddressBegin;
@@ -55,9 +69,27 @@ namespace Editor
 		Emulation::CPUMemory& m_CPUMemory;
 		DriverInfo& m_DriverInfo;
 
-		std::array<std::shared_ptr<UndoStep>, 256> m_UndoSteps;
-		//std::array<std::shared_ptr<UndoStep>, 256> m_UndoStepsRecentEdits;
+		// Steps from the oldest to the newest
+		std::deque<std::shared_ptr<UndoStep>> m_UndoSteps;
+
+		// Memory of the current step, or of the newest step if there is no current step yet
+		std::vector<unsigned char> m_Snapshot;
+		unsigned int m_SnapshotIndex;
+
+		// The CPU memory when it was the same as the memory of the current step, or nullptr if it is not known to be
+		std::shared_ptr<const Emulation::CPUMemory::Snapshot> m_MemorySnapshot;
+
+		// Memory of the edit being added, in the ranges written since the memory snapshot, and of a neighbouring step
+		// while its difference is changed
+		std::vector<unsigned char> m_EditData;
+		std::vector<std::pair<unsigned int, unsigned int>> m_EditRanges;
+		std::vector<unsigned char> m_NeighbourData;
+		std::vector<unsigned char> m_DifferenceData;
+
+		size_t m_ByteCount;
+		size_t m_ByteBudget;
 
 		std::function<void(int, int)> m_RestoredStepComponentHandler;
+		std::function<void()> m_StepHandler;
 	};
 }
\ No newline at end of file
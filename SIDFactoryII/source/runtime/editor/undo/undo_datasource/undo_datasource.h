@@ -7,16 +7,6 @@ namespace Editor
 	class UndoDataSource
 	{
 	public:
-		void SetCPUMemoryData(unsigned char* inData)
-		{
-			m_CPUMemoryData = inData;
-		}
-
-		const unsigned char* GetCPUMemoryData() const
-		{
-			return m_CPUMemoryData;
-		}
-
 		void SetAuxilaryDataTableText(const AuxilaryDataTableText& inSource)
 		{
 			m_AuxilaryDataTableTextData = inSource;
@@ -28,7 +18,6 @@ namespace Editor
 		}
 
 	private:
-		unsigned char* m_CPUMemoryData;
 		AuxilaryDataTableText m_AuxilaryDataTableTextData;
 	};
 }
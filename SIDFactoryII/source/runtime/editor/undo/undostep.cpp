@@ -3,23 +3,26 @@
 
 namespace Editor
 {
-	UndoStep::UndoStep(unsigned char* inData, const std::shared_ptr<UndoComponentData>& inComponentUndoData, std::function<void(const UndoComponentData&, CursorControl&)> inRestorePostFunction)
-		: m_Data(inData)
-		, m_ComponentData(inComponentUndoData)
+	UndoStep::UndoStep(const std::shared_ptr<UndoComponentData>& inComponentUndoData, std::function<void(const UndoComponentData&, CursorControl&)> inRestorePostFunction)
+		: m_ComponentData(inComponentUndoData)
 		, m_RestorePostExecution(inRestorePostFunction)
 	{
-		FOUNDATION_ASSERT(inData != nullptr);
+		FOUNDATION_ASSERT(inComponentUndoData != nullptr);
 	}
 
 	UndoStep::~UndoStep()
 	{
-        delete[] m_Data;
 	}
 
-	const unsigned char* UndoStep::GetData() const
+	const std::vector<unsigned char>& UndoStep::GetDifference() const
 	{
-		FOUNDATION_ASSERT(m_Data != nullptr);
-		return m_Data;
+		return m_Difference;
+	}
+
+
+	void UndoStep::SetDifference(std::vector<unsigned char>&& inDifference)
+	{
+		m_Difference = std::move(inDifference);
 	}
 
 
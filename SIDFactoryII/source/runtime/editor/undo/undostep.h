@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 namespace Editor
 {
@@ -11,19 +12,22 @@ namespace Editor
 	{
 	public:
 		UndoStep() = delete;
-		UndoStep(unsigned char* inData, const std::shared_ptr<UndoComponentData>& inComponentUndoData, std::function<void(const UndoComponentData&, CursorControl&)> inRestorePostFunction);
+		UndoStep(const std::shared_ptr<UndoComponentData>& inComponentUndoData, std::function<void(const UndoComponentData&, CursorControl&)> inRestorePostFunction);
 
 		~UndoStep();
 
-		const unsigned char* GetData() const;
+		// Difference between the memory of this step and the memory of the next step, empty for the newest step
+		const std::vector<unsigned char>& GetDifference() const;
+		void SetDifference(std::vector<unsigned char>&& inDifference);
+
 		void OnRestored(CursorControl& inCursorControl);
 
 		const UndoComponentData& GetComponentData() const;
 
 	private:
-		unsigned char* m_Data;
+		std::vector<unsigned char> m_Difference;
 
 		std::shared_ptr<UndoComponentData> m_ComponentData;
 		std::function<void(const UndoComponentData&, CursorControl&)> m_RestorePostExecution;
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,125 @@
+#include "visualizer_component_voice_scope.h"
+
+#include "foundation/graphics/drawfield.h"
+#include "runtime/emulation/sid/sidproxy.h"
+#include "utils/usercolors.h"
+
+#include <algorithm>
+
+using namespace Foundation;
+using namespace Utility;
+
+namespace Editor
+{
+	VisualizerComponentVoiceScope::VisualizerComponentVoiceScope(
+		int inID,
+		Foundation::DrawField* inDrawField,
+		int inX,
+		int inY,
+		int inWidth,
+		int inHeight,
+		Emulation::SIDProxy* inSIDProxy
+	)
+		: VisualizerComponentBase(inID, inDrawField, inX, inY, inWidth, inHeight)
+		, m_SIDProxy(inSIDProxy)
+	{
+	}
+
+
+	VisualizerComponentVoiceScope::~VisualizerComponentVoiceScope()
+	{
+
+	}
+
+
+	bool VisualizerComponentVoiceScope::ConsumeNonExclusiveInput(const Foundation::Mouse& inMouse)
+	{
+		return false;
+	}
+
+
+	void VisualizerComponentVoiceScope::Refresh(const DisplayState& inDisplayState)
+	{
+		if (m_Enabled)
+		{
+			const Color color_background = ToColor(UserColor::FlightRecorderVisualizerBackground);
+			const Color color_center_line = ToColor(UserColor::FlightRecorderVisualizerHorizontalLine1);
+			const Color color_separator_line = ToColor(UserColor::FlightRecorderVisualizerHorizontalLine2);
+			const Color color_wave = ToColor(UserColor::FlightRecorderVisualizerCPUUsageLow);
+
+			ReadVoiceTap();
+
+			m_DrawField->DrawBox(color_background, 0, 0, m_Dimensions.m_Width, m_Dimensions.m_Height);
+
+			const int lane_height = m_Dimensions.m_Height / 3;
+			const int sample_count = static_cast<int>(m_History.size() / 3);
+
+			for (unsigned int voice = 0; voice < 3; ++voice)
+			{
+				const int lane_top = static_cast<int>(voice) * lane_height;
+				const int lane_center = lane_top + lane_height / 2;
+				const int amplitude = lane_height / 2 - 1;
+
+				if (voice > 0)
+					m_DrawField->DrawHorizontalLine(color_separator_line, 0, m_Dimensions.m_Width, lane_top);
+
+				m_DrawField->DrawHorizontalLine(color_center_line, 0, m_Dimensions.m_Width, lane_center);
+
+				if (sample_count < m_Dimensions.m_Width)
+					continue;
+
+				const unsigned int first_sample = FindTrigger(voice);
+
+				int previous_y = 0;
+
+				for (int x = 0; x < m_Dimensions.m_Width; ++x)
+				{
+					const int value = m_History[(first_sample + x) * 3 + voice];
+					const int y = lane_center - value * amplitude / 32768;
+
+					if (x > 0)
+						m_DrawField->DrawLine(color_wave, x - 1, previous_y, x, y);
+
+					previous_y = y;
+				}
+			}
+		}
+	}
+
+
+	void VisualizerComponentVoiceScope::ReadVoiceTap()
+	{
+		const unsigned int available_count = m_SIDProxy->GetVoiceTapReadAvailable(0);
+
+		if (available_count == 0)
+			return;
+
+		m_ReadBuffer.resize(available_count * 3);
+
+		const unsigned int read_count = m_SIDProxy->ReadVoiceTap(0, &m_ReadBuffer[0], available_count);
+		m_History.insert(m_History.end(), m_ReadBuffer.begin(), m_ReadBuffer.begin() + read_count * 3);
+
+		// Twice the width is kept, so a trigger can be searched for in the older half
+		const size_t history_size = static_cast<size_t>(m_Dimensions.m_Width) * 2 * 3;
+
+		if (m_History.size() > history_size)
+			m_History.erase(m_History.begin(), m_History.end() - history_size);
+	}
+
+
+	unsigned int VisualizerComponentVoiceScope::FindTrigger(unsigned int inVoice) const
+	{
+		// Start at the newest rising zero crossing, that leaves a full width of samples to draw, to keep periodic waves
+		// in place. Without one, the newest samples are drawn
+		const unsigned int sample_count = static_cast<unsigned int>(m_History.size() / 3);
+		const unsigned int last_start = sample_count - static_cast<unsigned int>(m_Dimensions.m_Width);
+
+		for (unsigned int i = last_start; i > 0; --i)
+		{
+			if (m_History[(i - 1) * 3 + inVoice] < 0 && m_History[i * 3 + inVoice] >= 0)
+				return i;
+		}
+
+		return last_start;
+	}
+}
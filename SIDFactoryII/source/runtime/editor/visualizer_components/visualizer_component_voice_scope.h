@@ -0,0 +1,42 @@
+#pragma once
+
+#include "visualizer_component_base.h"
+#include <vector>
+
+namespace Emulation
+{
+	class SIDProxy;
+}
+
+namespace Editor
+{
+	// Oscilloscope of the three voices of the first SID chip, before they are mixed and filtered, drawn from the
+	// voice taps of the SID proxy. The taps must be enabled while the component is enabled
+	class VisualizerComponentVoiceScope : public VisualizerComponentBase
+	{
+	public:
+		VisualizerComponentVoiceScope(
+			int inID,
+			Foundation::DrawField* inDrawField,
+			int inX,
+			int inY,
+			int inWidth,
+			int inHeight,
+			Emulation::SIDProxy* inSIDProxy
+		);
+		virtual ~VisualizerComponentVoiceScope();
+
+		bool ConsumeNonExclusiveInput(const Foundation::Mouse& inMouse) override;
+		void Refresh(const DisplayState& inDisplayState) override;
+
+	private:
+		void ReadVoiceTap();
+		unsigned int FindTrigger(unsigned int inVoice) const;
+
+		Emulation::SIDProxy* m_SIDProxy;
+
+		// The newest samples of the voices, three interleaved values per sample
+		std::vector<short> m_History;
+		std::vector<short> m_ReadBuffer;
+	};
+}
@@ -59,8 +59,6 @@ namespace Editor
 
 			m_DrawField->DrawBox(color_cpu_usage_background, 0, 0, m_Dimensions.m_Width, m_Dimensions.m_Height);
 
-			m_DataSource->Lock();
-
 			const auto fetch_cycle_value = [&](int inIndex) -> const int
 			{
 				const int cycle_count = (*m_DataSource)[inIndex].m_nCyclesSpend;
@@ -80,8 +78,6 @@ namespace Editor
 				int y = (1 + i) * 16;
 				m_DrawField->DrawHorizontalLine((i & 1) == 1 ? color_cpu_usage_horizontal_line_1 : color_cpu_usage_horizontal_line_2, 0, m_Dimensions.m_Width, m_Dimensions.m_Height - y);
 			}
-
-			m_DataSource->Unlock();
 		}
 	}
 
@@ -93,6 +89,11 @@ namespace Editor
 		unsigned int index = m_DataSource->GetNewestRecordingIndex();
 		unsigned int size = static_cast<unsigned int>(m_DataSource->GetSize());
 
+		const unsigned int width = static_cast<unsigned int>(m_Dimensions.m_Width);
+		const unsigned int first_index = index + 1 >= width ? index + 1 - width : 0;
+
+		m_DataSource->PullFrames(first_index, index + 1 - first_index);
+
 		for (int i = 0; i < m_Dimensions.m_Width; ++i)
 		{
 			const int scan_lines = inValueFunction(index);
@@ -28,6 +28,11 @@ namespace Emulation
 
 	//------------------------------------------------------------------------------------------------------
 
+	void CPUFrameCapture::AddCaptureRange(unsigned short usCaptureRangeBegin, unsigned short usCaptureRangeEnd)
+	{
+		m_aAdditionalCaptureRanges.push_back(std::make_pair(usCaptureRangeBegin, usCaptureRangeEnd));
+	}
+
 	void CPUFrameCapture::Capture(unsigned short inStartAddress, unsigned char inAccumulatorValue)
 	{
 		// Set program counter
@@ -38,8 +43,7 @@ namespace Emulation
 		m_CPU->SetSuspended(false);
 
 		// Execute instructions until suspending!
-		while (!m_CPU->IsSuspended() && static_cast<unsigned int>(m_CPU->CycleCounterGetCurrent()) < m_uiMaxCycles)
-			m_CPU->ExecuteInstruction();
+		m_CPU->Execute(static_cast<int>(m_uiMaxCycles));
 
 		// Record the number of cycles spend on the executing code before the CPU was suspended!
 		m_uiCyclesSpend = static_cast<unsigned int>(m_CPU->CycleCounterGetCurrent());
@@ -48,10 +52,37 @@ namespace Emulation
 		m_ReachedMaxCycleCount = m_uiCyclesSpend >= m_uiMaxCycles;
 	}
 
+	void CPUFrameCapture::DiscardWrites()
+	{
+		m_aWrites.clear();
+		m_uiCurrentRead = 0;
+	}
+
+	void CPUFrameCapture::Restart()
+	{
+		m_CPU->Reset();
+
+		DiscardWrites();
+
+		m_uiCyclesSpend = 0;
+		m_ReachedMaxCycleCount = false;
+	}
+
 	void CPUFrameCapture::Write(unsigned short usAddress, unsigned char ucVal, int iCycle)
 	{
 		if (usAddress >= m_usCaptureRangeBegin && usAddress <= m_usCaptureRangeEnd)
 			m_aWrites.push_back(WriteCapture(usAddress, ucVal, iCycle));
+		else
+		{
+			for (const auto& range : m_aAdditionalCaptureRanges)
+			{
+				if (usAddress >= range.first && usAddress <= range.second)
+				{
+					m_aWrites.push_back(WriteCapture(usAddress, ucVal, iCycle));
+					break;
+				}
+			}
+		}
 	}
 
 	const CPUFrameCapture::WriteCapture& CPUFrameCapture::GetNext()
@@ -2,6 +2,7 @@
 #define __CPUFRAME_H__
 
 #include "icpuwritecallback.h"
+#include <utility>
 #include <vector>
 
 namespace Emulation
@@ -37,8 +38,17 @@ namespace Emulation
 		CPUFrameCapture(CPUmos6510* pCPU, unsigned short usCaptureAddressRangeBegin, unsigned short usCaptureAddressRangeEnd, unsigned int inMaxCycles);
 		~CPUFrameCapture();
 
+		// Capture writes to another range as well, for instance the registers of an additional SID chip
+		void AddCaptureRange(unsigned short usCaptureAddressRangeBegin, unsigned short usCaptureAddressRangeEnd);
+
 		void Capture(unsigned short inStartAddress, unsigned char inAccumulatorValue);
 
+		// Discard the writes captured so far, for instance when the state of the SID chips is replaced
+		void DiscardWrites();
+
+		// Start capturing the next frame, as if the frame capture was created again
+		void Restart();
+
 		virtual void Write(unsigned short usAddress, unsigned char ucVal, int iCycle);
 
 		unsigned int GetCyclesSpend() const { return m_uiCyclesSpend; }
@@ -57,6 +67,8 @@ namespace Emulation
 		unsigned short m_usCaptureRangeBegin;
 		unsigned short m_usCaptureRangeEnd;
 
+		std::vector<std::pair<unsigned short, unsigned short>> m_aAdditionalCaptureRanges;
+
 		unsigned int m_uiCurrentRead;
 
 		unsigned int m_uiMaxCycles;
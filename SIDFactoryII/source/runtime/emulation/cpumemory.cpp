@@ -1,6 +1,7 @@
 #include "cpumemory.h"
 
 #include "foundation/base/assert.h"
+#include <algorithm>
 #include <string.h>
 
 namespace Emulation
@@ -8,7 +9,9 @@ namespace Emulation
 	CPUMemory::CPUMemory(unsigned int nSize, Foundation::IPlatform* inPlatform)
 		: m_nSize(nSize)
 		, m_LockRefCount(0)
-		, m_MemorySnapshot(nullptr)
+		, m_DirtyPages((nSize + PageSize - 1) / PageSize, 1)
+		, m_PageGenerations((nSize + PageSize - 1) / PageSize, 0)
+		, m_Generation(0)
 	{
 		FOUNDATION_ASSERT(inPlatform != nullptr);
 
@@ -22,8 +25,7 @@ namespace Emulation
 	{
 		m_Mutex = nullptr;
 
-		delete m_Memory;
-		delete m_MemorySnapshot;
+		delete[] m_Memory;
 	}
 
 	//------------------------------------------------------------------------------------------------------------------------------
@@ -53,27 +55,140 @@ namespace Emulation
 	{
 		FOUNDATION_ASSERT(m_Memory != nullptr);
 		memset(m_Memory, 0, m_nSize);
+
+		NotifyWriteRange(0, m_nSize);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------------------
 
-	void CPUMemory::TakeSnapshot()
+	std::shared_ptr<const CPUMemory::Snapshot> CPUMemory::CreateSnapshot()
 	{
 		FOUNDATION_ASSERT(m_Memory != nullptr);
-		FOUNDATION_ASSERT(m_MemorySnapshot == nullptr);
 		FOUNDATION_ASSERT(m_LockRefCount > 0);
 
-		m_MemorySnapshot = new unsigned char[m_nSize];
-		memcpy(m_MemorySnapshot, m_Memory, m_nSize);
+		std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+
+		++m_Generation;
+
+		snapshot->m_Generation = m_Generation;
+		snapshot->m_Pages.resize(m_DirtyPages.size());
+
+		for (unsigned int i = 0; i < m_DirtyPages.size(); ++i)
+		{
+			if (m_DirtyPages[i] == 0 && m_LastSnapshot != nullptr)
+			{
+				snapshot->m_Pages[i] = m_LastSnapshot->m_Pages[i];
+				continue;
+			}
+
+			const unsigned int address = i * PageSize;
+			const unsigned int length = std::min(PageSize, m_nSize - address);
+
+			std::shared_ptr<Page> page = std::make_shared<Page>();
+			page->fill(0);
+			memcpy(page->data(), &m_Memory[address], length);
+
+			snapshot->m_Pages[i] = page;
+
+			m_DirtyPages[i] = 0;
+			m_PageGenerations[i] = m_Generation;
+		}
+
+		m_LastSnapshot = snapshot;
+
+		return snapshot;
 	}
 
-	void CPUMemory::RestoreFromSnapshot()
+	void CPUMemory::RestoreSnapshot(const Snapshot& inSnapshot)
 	{
 		FOUNDATION_ASSERT(m_Memory != nullptr);
-		FOUNDATION_ASSERT(m_MemorySnapshot != nullptr);
 		FOUNDATION_ASSERT(m_LockRefCount > 0);
+		FOUNDATION_ASSERT(inSnapshot.m_Pages.size() == m_DirtyPages.size());
+		FOUNDATION_ASSERT(inSnapshot.m_Generation <= m_Generation);
+
+		// After restoring the last snapshot the memory is the same as it, so no page is dirty anymore
+		const bool is_last_snapshot = inSnapshot.m_Generation == m_Generation;
+
+		for (unsigned int i = 0; i < m_DirtyPages.size(); ++i)
+		{
+			if (!IsPageChangedSince(i, inSnapshot))
+				continue;
+
+			const unsigned int address = i * PageSize;
+			const unsigned int length = std::min(PageSize, m_nSize - address);
 
-		memcpy(m_Memory, m_MemorySnapshot, m_nSize);
+			memcpy(&m_Memory[address], inSnapshot.m_Pages[i]->data(), length);
+
+			NotifyWriteRange(address, length);
+
+			if (is_last_snapshot)
+				m_DirtyPages[i] = 0;
+		}
+	}
+
+	std::vector<unsigned int> CPUMemory::GetPagesChangedSince(const Snapshot& inSnapshot) const
+	{
+		std::vector<unsigned int> pages;
+
+		for (unsigned int i = 0; i < m_DirtyPages.size(); ++i)
+		{
+			if (IsPageChangedSince(i, inSnapshot))
+				pages.push_back(i);
+		}
+
+		return pages;
+	}
+
+	bool CPUMemory::IsPageChangedSince(unsigned int inPage, const Snapshot& inSnapshot) const
+	{
+		FOUNDATION_ASSERT(inPage < m_DirtyPages.size());
+
+		return m_DirtyPages[inPage] != 0 || m_PageGenerations[inPage] > inSnapshot.m_Generation;
+	}
+
+	std::vector<std::pair<unsigned int, unsigned int>> CPUMemory::GetRangesChangedSince(const Snapshot& inSnapshot, unsigned int inAddress, unsigned int inLength) const
+	{
+		FOUNDATION_ASSERT(inAddress + inLength <= m_nSize);
+
+		std::vector<std::pair<unsigned int, unsigned int>> ranges;
+
+		if (inLength == 0)
+			return ranges;
+
+		const unsigned int end_address = inAddress + inLength;
+		const unsigned int last_page = (end_address - 1) / PageSize;
+
+		for (unsigned int i = inAddress / PageSize; i <= last_page; ++i)
+		{
+			if (!IsPageChangedSince(i, inSnapshot))
+				continue;
+
+			const unsigned int begin = std::max(i * PageSize, inAddress) - inAddress;
+			const unsigned int end = std::min((i + 1) * PageSize, end_address) - inAddress;
+
+			if (!ranges.empty() && ranges.back().second == begin)
+				ranges.back().second = end;
+			else
+				ranges.push_back({ begin, end });
+		}
+
+		return ranges;
+	}
+
+	//------------------------------------------------------------------------------------------------------------------------------
+
+	void CPUMemory::TakeSnapshot()
+	{
+		FOUNDATION_ASSERT(m_MemorySnapshot == nullptr);
+
+		m_MemorySnapshot = CreateSnapshot();
+	}
+
+	void CPUMemory::RestoreFromSnapshot()
+	{
+		FOUNDATION_ASSERT(m_MemorySnapshot != nullptr);
+
+		RestoreSnapshot(*m_MemorySnapshot);
 	}
 
 	void CPUMemory::FlushSnapshot()
@@ -81,7 +196,6 @@ namespace Emulation
 		FOUNDATION_ASSERT(m_MemorySnapshot != nullptr);
 		FOUNDATION_ASSERT(m_LockRefCount > 0);
 
-		delete[] m_MemorySnapshot;
 		m_MemorySnapshot = nullptr;
 	}
 
@@ -109,13 +223,10 @@ namespace Emulation
 	{
 		FOUNDATION_ASSERT(inDestinationBuffer != nullptr);
 		FOUNDATION_ASSERT(m_Memory != nullptr);
-		FOUNDATION_ASSERT(inAddress < m_nSize + inDestinationBufferByteCount);
+		FOUNDATION_ASSERT(inAddress + inDestinationBufferByteCount <= m_nSize);
 		FOUNDATION_ASSERT(m_LockRefCount > 0);
 
-		unsigned char* pDest = (unsigned char*)inDestinationBuffer;
-
-		for (unsigned int i = 0; i < inDestinationBufferByteCount; i++)
-			pDest[i] = m_Memory[inAddress + i];
+		memcpy(inDestinationBuffer, &m_Memory[inAddress], inDestinationBufferByteCount);
 	}
 
 	//------------------------------------------------------------------------------------------------------------------------------
@@ -127,6 +238,8 @@ namespace Emulation
 		FOUNDATION_ASSERT(m_LockRefCount > 0);
 
 		m_Memory[nAddress] = ucByte;
+
+		NotifyWrite(nAddress);
 	}
 
 	void CPUMemory::SetWord(unsigned int nAddress, unsigned short usWord)
@@ -137,6 +250,8 @@ namespace Emulation
 
 		m_Memory[nAddress] = (unsigned char)(usWord & 0x00ff);
 		m_Memory[nAddress + 1] = (unsigned char)((usWord & 0xff00) >> 8);
+
+		NotifyWriteRange(nAddress, 2);
 	}
 
 	void CPUMemory::SetData(unsigned int nAddress, const void* pSourceBuffer, unsigned int nSourceBufferByteCount)
@@ -146,10 +261,9 @@ namespace Emulation
 		FOUNDATION_ASSERT(nAddress + nSourceBufferByteCount <= m_nSize);
 		FOUNDATION_ASSERT(m_LockRefCount > 0);
 
-		unsigned char* pSrc = (unsigned char*)pSourceBuffer;
+		memcpy(&m_Memory[nAddress], pSourceBuffer, nSourceBufferByteCount);
 
-		for (unsigned int i = 0; i < nSourceBufferByteCount; i++)
-			m_Memory[nAddress + i] = pSrc[i];
+		NotifyWriteRange(nAddress, nSourceBufferByteCount);
 	}
 
 	void CPUMemory::Copy(unsigned int inSourceAddress, unsigned int inLength, unsigned int inDestinationAddress)
@@ -159,7 +273,9 @@ namespace Emulation
 		FOUNDATION_ASSERT(inDestinationAddress < m_nSize);
 		FOUNDATION_ASSERT(inDestinationAddress + inLength <= m_nSize);
 
-		memcpy(&m_Memory[inDestinationAddress], &m_Memory[inSourceAddress], inLength);
+		memmove(&m_Memory[inDestinationAddress], &m_Memory[inSourceAddress], inLength);
+
+		NotifyWriteRange(inDestinationAddress, inLength);
 	}
 
 
@@ -168,7 +284,23 @@ namespace Emulation
 		FOUNDATION_ASSERT(inAddress < m_nSize);
 		FOUNDATION_ASSERT(inAddress + inLength < m_nSize);
 
-		for (unsigned int i = 0; i < inLength; ++i)
-			m_Memory[inAddress + i] = inValue;
+		memset(&m_Memory[inAddress], inValue, inLength);
+
+		NotifyWriteRange(inAddress, inLength);
+	}
+
+	//------------------------------------------------------------------------------------------------------------------------------
+
+	void CPUMemory::NotifyWriteRange(unsigned int inAddress, unsigned int inLength)
+	{
+		FOUNDATION_ASSERT(inAddress + inLength <= m_nSize);
+
+		if (inLength == 0)
+			return;
+
+		const unsigned int first_page = inAddress / PageSize;
+		const unsigned int last_page = (inAddress + inLength - 1) / PageSize;
+
+		memset(&m_DirtyPages[first_page], 1, last_page - first_page + 1);
 	}
 }
\ No newline at end of file
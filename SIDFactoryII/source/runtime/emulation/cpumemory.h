@@ -5,6 +5,10 @@
 #include "foundation/platform/iplatform.h"
 #include "foundation/platform/imutex.h"
 #include "runtime/emulation/imemoryrandomreadaccess.h"
+#include <array>
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace Emulation
 {
@@ -13,6 +17,20 @@ namespace Emulation
 	class CPUMemory : public IMemoryRandomReadAccess
 	{
 	public:
+		static const unsigned int PageSize = 0x100;
+
+		typedef std::array<unsigned char, PageSize> Page;
+
+		// A copy of the memory. Pages that have not been written since the previous snapshot of the same memory are
+		// shared with it, so taking a snapshot only copies the pages written in between
+		struct Snapshot
+		{
+			unsigned char GetByte(unsigned int inAddress) const { return (*m_Pages[inAddress / PageSize])[inAddress % PageSize]; }
+
+			unsigned int m_Generation;
+			std::vector<std::shared_ptr<const Page>> m_Pages;
+		};
+
 		CPUMemory(unsigned int inSize, Foundation::IPlatform* inPlatform);
 		~CPUMemory();
 
@@ -25,12 +43,16 @@ namespace Emulation
 			return m_Memory[inAddress];
 		}
 
+		// Any access through the non const operator is considered a write and marks the page as written. Read through
+		// the const operator or GetByte instead
 		unsigned char& operator[](int inAddress)
 		{
 			FOUNDATION_ASSERT(inAddress >= 0);
 			FOUNDATION_ASSERT(inAddress < (int)m_nSize);
 			FOUNDATION_ASSERT(m_LockRefCount);
 
+			NotifyWrite(static_cast<unsigned int>(inAddress));
+
 			return m_Memory[inAddress];
 		}
 
@@ -42,6 +64,23 @@ namespace Emulation
 
 		void Clear();
 
+		unsigned int GetPageCount() const { return static_cast<unsigned int>(m_DirtyPages.size()); }
+
+		std::shared_ptr<const Snapshot> CreateSnapshot();
+		void RestoreSnapshot(const Snapshot& inSnapshot);
+
+		// Indices of the pages written since the snapshot was taken. A page may have been written with the values it
+		// already had
+		std::vector<unsigned int> GetPagesChangedSince(const Snapshot& inSnapshot) const;
+		bool IsPageChangedSince(unsigned int inPage, const Snapshot& inSnapshot) const;
+
+		// The pages changed since the snapshot within a range of memory, as ranges of offsets from its address given as
+		// the first offset and the offset after the range. Adjacent pages are merged into one range
+		std::vector<std::pair<unsigned int, unsigned int>> GetRangesChangedSince(const Snapshot& inSnapshot, unsigned int inAddress, unsigned int inLength) const;
+
+		// Pages marked as written since the last snapshot. The CPU cores mark the pages they write through this
+		unsigned char* GetDirtyPages() { return m_DirtyPages.data(); }
+
 		void TakeSnapshot();
 		void RestoreFromSnapshot();
 		void FlushSnapshot();
@@ -57,6 +96,11 @@ namespace Emulation
 		void Copy(unsigned int inSourceAddress, unsigned int inLength, unsigned int inDestinationAddress);
 		void Set(unsigned char inValue, unsigned int inAddress, unsigned int inLength);
 
+		inline void NotifyWrite(unsigned int inAddress)
+		{
+			m_DirtyPages[inAddress / PageSize] = 1;
+		}
+
 		unsigned int GetAddress(const void* inMemoryOffsetPointer) const 
 		{
 			unsigned int iAddress = static_cast<unsigned int>(static_cast<const unsigned char*>(inMemoryOffsetPointer) - m_Memory);
@@ -68,13 +112,23 @@ namespace Emulation
 		};
 
 	private:
+		void NotifyWriteRange(unsigned int inAddress, unsigned int inLength);
+
 		std::shared_ptr<Foundation::IMutex> m_Mutex;
 
 		int m_LockRefCount;
 
 		unsigned int m_nSize;
 		unsigned char* m_Memory;
-		unsigned char* m_MemorySnapshot;
+
+		// Write tracking per page. A dirty page has been written since the last snapshot, and the generation of a page
+		// is the generation of the first snapshot taken after it was last written
+		std::vector<unsigned char> m_DirtyPages;
+		std::vector<unsigned int> m_PageGenerations;
+		unsigned int m_Generation;
+		std::shared_ptr<const Snapshot> m_LastSnapshot;
+
+		std::shared_ptr<const Snapshot> m_MemorySnapshot;
 	};
 }
 
@@ -1,4 +1,5 @@
 #include "cpumos6510.h"
+#include "cpuprofiler.h"
 
 namespace Emulation
 {
@@ -326,6 +327,7 @@ namespace Emulation
 	//------------------------------------------------------------------------------------------------------------------------------
 
 	CPUmos6510::CPUmos6510()
+		: m_Profiler(nullptr)
 	{
 		m_State.Reset();
 	}
@@ -342,6 +344,36 @@ namespace Emulation
 	}
 
 
+	void CPUmos6510::ExecuteProfiled(int inCycleLimit)
+	{
+		FOUNDATION_ASSERT(m_Profiler != nullptr);
+
+		if (!m_State.IsValid() || m_State.IsSuspended())
+			return;
+
+		const CPUMemory& memory = m_State.GetMemory();
+
+		m_Profiler->Lock();
+		m_Profiler->BeginExecute(m_State.m_PC);
+
+		while (!m_State.IsSuspended() && m_State.GetCycle() < inCycleLimit)
+		{
+			const unsigned short address = m_State.m_PC;
+			const unsigned char opcode = memory.GetByte(address);
+			const int cycle = m_State.GetCycle();
+
+			ExecuteInstruction();
+
+			m_Profiler->Record(address, opcode, static_cast<unsigned int>(m_State.GetCycle() - cycle), m_State.m_PC);
+		}
+
+		m_Profiler->EndExecute(m_State.IsSuspended());
+		m_Profiler->Unlock();
+	}
+
+
+#if defined(_SF2_CPU_TABLE_DISPATCH)
+
 	short CPUmos6510::ExecuteInstruction()
 	{
 		if(m_State.IsValid() && !m_State.IsSuspended())
@@ -371,6 +403,21 @@ namespace Emulation
 	}
 
 
+	void CPUmos6510::Execute(int inCycleLimit)
+	{
+		if (m_Profiler != nullptr)
+		{
+			ExecuteProfiled(inCycleLimit);
+			return;
+		}
+
+		while (!IsSuspended() && m_State.GetCycle() < inCycleLimit)
+			ExecuteInstruction();
+	}
+
+#endif //_SF2_CPU_TABLE_DISPATCH
+
+
 	const unsigned char CPUmos6510::GetOpcodeByteSize(const unsigned char inOpcode) 
 	{
 		return ms_aInstructions[inOpcode].m_ucSize;
@@ -1301,7 +1348,9 @@ namespace Emulation
 	// Addressing modes
 	void* CPUmos6510::imm(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
-		void *adr = (void*)&ioState.GetMemory()[ioState.m_PC+1];
+		// The operand is only read, so it does not mark the code page written
+		const CPUMemory& rMemory = ioState.GetMemory();
+		void *adr = (void*)&rMemory[ioState.m_PC+1];
 
 		ioState.m_PC += 2;
 
@@ -1311,7 +1360,7 @@ namespace Emulation
 	void* CPUmos6510::zp(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
-		void *adr = (void*)&rMemory[rMemory[ioState.m_PC+1]];
+		void *adr = (void*)&rMemory[rMemory.GetByte(ioState.m_PC+1)];
 
 		ioState.m_PC += 2;
 
@@ -1321,7 +1370,7 @@ namespace Emulation
 	void* CPUmos6510::zpx(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
-		void *adr = (void*)&rMemory[((rMemory[ioState.m_PC+1] + ioState.m_RegX) & 0xff)];
+		void *adr = (void*)&rMemory[((rMemory.GetByte(ioState.m_PC+1) + ioState.m_RegX) & 0xff)];
 
 		ioState.m_PC += 2;
 
@@ -1332,7 +1381,7 @@ namespace Emulation
 	void* CPUmos6510::zpy(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
-		void *adr = (void*)&rMemory[((rMemory[ioState.m_PC+1] + ioState.m_RegY) & 0xff)];
+		void *adr = (void*)&rMemory[((rMemory.GetByte(ioState.m_PC+1) + ioState.m_RegY) & 0xff)];
 
 		ioState.m_PC += 2;
 
@@ -1342,19 +1391,19 @@ namespace Emulation
 	void* CPUmos6510::izx(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
-		unsigned short zp = (unsigned short)(rMemory[ioState.m_PC+1] + ioState.m_RegX) & 0xff;
+		unsigned short zp = (unsigned short)(rMemory.GetByte(ioState.m_PC+1) + ioState.m_RegX) & 0xff;
 
 		ioState.m_PC += 2;
 
-		return (void*)&rMemory[(unsigned short)rMemory[zp] | (((unsigned short)rMemory[(zp+1) & 0xff]) << 8)];
+		return (void*)&rMemory[(unsigned short)rMemory.GetByte(zp) | (((unsigned short)rMemory.GetByte((zp+1) & 0xff)) << 8)];
 	}
 
 	void* CPUmos6510::izy(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
 		
-		unsigned short zp = (unsigned short)(rMemory[ioState.m_PC+1]);
-		unsigned short base_target_address = ((unsigned short)rMemory[zp] | (((unsigned short)rMemory[(zp + 1) & 0xff]) << 8));
+		unsigned short zp = (unsigned short)(rMemory.GetByte(ioState.m_PC+1));
+		unsigned short base_target_address = ((unsigned short)rMemory.GetByte(zp) | (((unsigned short)rMemory.GetByte((zp + 1) & 0xff)) << 8));
 		unsigned short target_address = base_target_address + ioState.m_RegY;
 
 		outAddedCycles = ((base_target_address & 0xff00) != (target_address & 0xff00)) ? 1 : 0;
@@ -1367,7 +1416,7 @@ namespace Emulation
 	void* CPUmos6510::abs(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
-		void *ret = (void*)&rMemory[((unsigned short)rMemory[ioState.m_PC+1] | (((unsigned short)rMemory[ioState.m_PC+2]) << 8))];
+		void *ret = (void*)&rMemory[((unsigned short)rMemory.GetByte(ioState.m_PC+1) | (((unsigned short)rMemory.GetByte(ioState.m_PC+2)) << 8))];
 
 		ioState.m_PC += 3;
 
@@ -1379,7 +1428,7 @@ namespace Emulation
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
 
-		unsigned short target_address = ((unsigned short)rMemory[ioState.m_PC + 1] | (((unsigned short)rMemory[ioState.m_PC + 2]) << 8)) + ioState.m_RegX;
+		unsigned short target_address = ((unsigned short)rMemory.GetByte(ioState.m_PC + 1) | (((unsigned short)rMemory.GetByte(ioState.m_PC + 2)) << 8)) + ioState.m_RegX;
 		outAddedCycles = ((target_address & 0xff00) != (ioState.m_PC & 0xff00)) ? 1 : 0;
 
 		ioState.m_PC += 3;
@@ -1391,7 +1440,7 @@ namespace Emulation
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
 
-		unsigned short target_address = ((unsigned short)rMemory[ioState.m_PC + 1] | (((unsigned short)rMemory[ioState.m_PC + 2]) << 8)) + ioState.m_RegY;
+		unsigned short target_address = ((unsigned short)rMemory.GetByte(ioState.m_PC + 1) | (((unsigned short)rMemory.GetByte(ioState.m_PC + 2)) << 8)) + ioState.m_RegY;
 		outAddedCycles = ((target_address & 0xff00) != (ioState.m_PC & 0xff00)) ? 1 : 0;
 
 		ioState.m_PC += 3;
@@ -1404,17 +1453,17 @@ namespace Emulation
 	{
 		CPUMemory& rMemory = ioState.GetMemory();
 
-		unsigned short adrL = (unsigned short)rMemory[ioState.m_PC+1];
-		unsigned short adrH = (((unsigned short)rMemory[ioState.m_PC+2]) << 8);
+		unsigned short adrL = (unsigned short)rMemory.GetByte(ioState.m_PC+1);
+		unsigned short adrH = (((unsigned short)rMemory.GetByte(ioState.m_PC+2)) << 8);
 
 		ioState.m_PC += 3;
 
-		return (void*)&rMemory[((unsigned short)rMemory[adrL | adrH] | (((unsigned short)rMemory[((adrL + 1) & 0xff) | adrH]) << 8))];
+		return (void*)&rMemory[((unsigned short)rMemory.GetByte(adrL | adrH) | (((unsigned short)rMemory.GetByte(((adrL + 1) & 0xff) | adrH)) << 8))];
 	}
 
 	void* CPUmos6510::rel(CPUmos6510::State& ioState, int& outAddedCycles)
 	{
-		CPUMemory& rMemory = ioState.GetMemory();
+		const CPUMemory& rMemory = ioState.GetMemory();
 
 		char r = (char)rMemory[ioState.m_PC+1];
 		unsigned short target_address = (unsigned short)(ioState.m_PC + 2 + (short)r);
@@ -6,6 +6,8 @@
 
 namespace Emulation
 {
+	class CPUProfiler;
+
 	class CPUmos6510
 	{
 	public:
@@ -39,6 +41,17 @@ namespace Emulation
 			am_REL
 		};
 
+		// Registers, to save and restore the state of the CPU between executions
+		struct Registers
+		{
+			unsigned char m_A;
+			unsigned char m_X;
+			unsigned char m_Y;
+			unsigned char m_SP;
+			unsigned char m_Status;
+			unsigned short m_PC;
+		};
+
 	private:
 		// State of the CPU
 		class State
@@ -48,6 +61,7 @@ namespace Emulation
 			~State();
 
 			void SetWriteCallback(ICPUWriteCallback* pCallback) { m_WriteCallback = pCallback; }
+			ICPUWriteCallback* GetWriteCallback() const { return m_WriteCallback; }
 
 			void Reset();
 			void SetMemory(CPUMemory* pMemory) { m_Memory = pMemory; }
@@ -75,7 +89,7 @@ namespace Emulation
 				if(m_Memory != nullptr)
 				{
 					m_SP++;
-					return (*m_Memory)[0x0100 + m_SP];
+					return m_Memory->GetByte(0x0100 + m_SP);
 				}
 
 				return 0;
@@ -277,6 +291,22 @@ namespace Emulation
 			return m_State.m_PC;
 		}
 
+		// Registers
+		inline Registers GetRegisters() const
+		{
+			return { m_State.m_RegA, m_State.m_RegX, m_State.m_RegY, m_State.m_SP, m_State.m_Status, m_State.m_PC };
+		}
+
+		inline void SetRegisters(const Registers& inRegisters)
+		{
+			m_State.m_RegA = inRegisters.m_A;
+			m_State.m_RegX = inRegisters.m_X;
+			m_State.m_RegY = inRegisters.m_Y;
+			m_State.m_SP = inRegisters.m_SP;
+			m_State.m_Status = inRegisters.m_Status;
+			m_State.m_PC = inRegisters.m_PC;
+		}
+
 		// Write callback
 		inline void SetWriteCallback(ICPUWriteCallback* pCallback)
 		{
@@ -286,14 +316,37 @@ namespace Emulation
 		// Execution
 		short ExecuteInstruction();
 
+		// Execute instructions until the CPU is suspended or the cycle counter has reached the limit
+		void Execute(int inCycleLimit);
+
+		// Profiling. While a profiler is set, Execute steps through the instructions one at a time and records them
+		inline void SetProfiler(CPUProfiler* inProfiler)
+		{
+			m_Profiler = inProfiler;
+		}
+
+		inline CPUProfiler* GetProfiler() const
+		{
+			return m_Profiler;
+		}
+
 		// Opcode
 		static const unsigned char GetOpcodeByteSize(const unsigned char inOpcode);
 		static const AddressingMode GetOpcodeAddressingMode(const unsigned char inOpcode);
 		static const unsigned char GetOpcodeCycles(const unsigned char inOpcode);
 
 	private:
+		void ExecuteProfiled(int inCycleLimit);
+
+#if !defined(_SF2_CPU_TABLE_DISPATCH)
+		// Switch dispatched core, see cpumos6510_switchcore.cpp
+		short Run(int inCycleLimit, bool inSingleInstruction);
+#endif
+
 		// CPU State
 		State m_State;
+
+		CPUProfiler* m_Profiler;
 	};
 }
 
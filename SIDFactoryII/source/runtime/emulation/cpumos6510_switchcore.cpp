@@ -0,0 +1,543 @@
+#include "cpumos6510.h"
+
+// Switch dispatched interpreter core. The registers are kept in locals while running, and the addressing modes are
+// inlined per opcode. It reproduces the behaviour of the table dispatched core exactly, including cycle counts and
+// flag results that differ from real hardware, so that both cores produce identical output.
+// Define _SF2_CPU_TABLE_DISPATCH to build with the table dispatched core instead.
+
+#if !defined(_SF2_CPU_TABLE_DISPATCH)
+
+#include <limits>
+
+namespace Emulation
+{
+	namespace
+	{
+		const unsigned char FlagN = 1 << CPUmos6510::SF_N;
+		const unsigned char FlagV = 1 << CPUmos6510::SF_V;
+		const unsigned char FlagD = 1 << CPUmos6510::SF_D;
+		const unsigned char FlagI = 1 << CPUmos6510::SF_I;
+		const unsigned char FlagZ = 1 << CPUmos6510::SF_Z;
+		const unsigned char FlagC = 1 << CPUmos6510::SF_C;
+
+		//------------------------------------------------------------------------------------------------------------------------------
+		// Addressing modes
+
+		inline unsigned char Fetch(const unsigned char* inMemory, unsigned short inPC, unsigned short inOffset)
+		{
+			return inMemory[static_cast<unsigned short>(inPC + inOffset)];
+		}
+
+		inline unsigned short AddressIMM(unsigned short inPC)
+		{
+			return static_cast<unsigned short>(inPC + 1);
+		}
+
+		inline unsigned short AddressZP(const unsigned char* inMemory, unsigned short inPC)
+		{
+			return Fetch(inMemory, inPC, 1);
+		}
+
+		inline unsigned short AddressZPI(const unsigned char* inMemory, unsigned short inPC, unsigned char inIndex)
+		{
+			return (Fetch(inMemory, inPC, 1) + inIndex) & 0xff;
+		}
+
+		inline unsigned short AddressABS(const unsigned char* inMemory, unsigned short inPC)
+		{
+			return static_cast<unsigned short>(Fetch(inMemory, inPC, 1) | (Fetch(inMemory, inPC, 2) << 8));
+		}
+
+		// Absolute indexed. The page crossing is checked against the program counter, like the table core does
+		inline unsigned short AddressABI(const unsigned char* inMemory, unsigned short inPC, unsigned char inIndex, int& outAddedCycles)
+		{
+			const unsigned short address = static_cast<unsigned short>(AddressABS(inMemory, inPC) + inIndex);
+			outAddedCycles = (address & 0xff00) != (inPC & 0xff00) ? 1 : 0;
+
+			return address;
+		}
+
+		inline unsigned short AddressIZX(const unsigned char* inMemory, unsigned short inPC, unsigned char inX)
+		{
+			const unsigned short zp = (Fetch(inMemory, inPC, 1) + inX) & 0xff;
+			return static_cast<unsigned short>(inMemory[zp] | (inMemory[(zp + 1) & 0xff] << 8));
+		}
+
+		inline unsigned short AddressIZY(const unsigned char* inMemory, unsigned short inPC, unsigned char inY, int& outAddedCycles)
+		{
+			const unsigned short zp = Fetch(inMemory, inPC, 1);
+			const unsigned short base_address = static_cast<unsigned short>(inMemory[zp] | (inMemory[(zp + 1) & 0xff] << 8));
+			const unsigned short address = static_cast<unsigned short>(base_address + inY);
+			outAddedCycles = (base_address & 0xff00) != (address & 0xff00) ? 1 : 0;
+
+			return address;
+		}
+
+		inline unsigned short AddressIND(const unsigned char* inMemory, unsigned short inPC)
+		{
+			const unsigned short address_low = Fetch(inMemory, inPC, 1);
+			const unsigned short address_high = Fetch(inMemory, inPC, 2) << 8;
+
+			return static_cast<unsigned short>(inMemory[address_low | address_high] | (inMemory[((address_low + 1) & 0xff) | address_high] << 8));
+		}
+
+		// Relative. The page crossing cycle is added whether the branch is taken or not, like the table core does
+		inline unsigned short AddressREL(const unsigned char* inMemory, unsigned short inPC, int& outAddedCycles)
+		{
+			const signed char offset = static_cast<signed char>(Fetch(inMemory, inPC, 1));
+			const unsigned short address = static_cast<unsigned short>(inPC + 2 + offset);
+			outAddedCycles = (address & 0xff00) != (inPC & 0xff00) ? 1 : 0;
+
+			return address;
+		}
+
+		//------------------------------------------------------------------------------------------------------------------------------
+		// Operations
+
+		inline void UpdateNZ(unsigned char& ioStatus, unsigned char inValue)
+		{
+			ioStatus = (ioStatus & ~(FlagN | FlagZ)) | (inValue == 0 ? FlagZ : 0) | ((inValue & 0x80) != 0 ? FlagN : 0);
+		}
+
+		inline void AddWithCarry(unsigned char& ioStatus, unsigned char& ioA, unsigned char inValue)
+		{
+			const unsigned short result = ioA + inValue + ((ioStatus & FlagC) != 0 ? 1 : 0);
+
+			ioStatus &= ~(FlagC | FlagV);
+			ioStatus |= (result & 0xff00) != 0 ? FlagC : 0;
+			ioStatus |= ((ioA ^ result) & 0x80) != 0 ? FlagV : 0;
+
+			ioA = static_cast<unsigned char>(result);
+			UpdateNZ(ioStatus, ioA);
+		}
+
+		inline void SubtractWithCarry(unsigned char& ioStatus, unsigned char& ioA, unsigned char inValue)
+		{
+			const unsigned short result = static_cast<unsigned short>(ioA - (inValue + ((ioStatus & FlagC) != 0 ? 0 : 1)));
+
+			ioStatus &= ~(FlagC | FlagV);
+			ioStatus |= (result & 0xff00) == 0 ? FlagC : 0;
+			ioStatus |= ((ioA ^ result) & 0x80) != 0 ? FlagV : 0;
+
+			ioA = static_cast<unsigned char>(result);
+			UpdateNZ(ioStatus, ioA);
+		}
+
+		// Carry is taken from bit 7 of the difference, like the table core does
+		inline void Compare(unsigned char& ioStatus, unsigned char inRegister, unsigned char inValue)
+		{
+			const unsigned short result = static_cast<unsigned short>(inRegister - inValue);
+
+			ioStatus &= ~(FlagN | FlagZ | FlagC);
+
+			if (result == 0)
+				ioStatus |= FlagZ | FlagC;
+			else
+				ioStatus |= (result & 0x80) == 0 ? FlagC : FlagN;
+		}
+
+		// CPX and CPY have the carry inverted compared to CMP, like the table core does
+		inline void CompareXY(unsigned char& ioStatus, unsigned char inRegister, unsigned char inValue)
+		{
+			const unsigned char result = static_cast<unsigned char>(inRegister - inValue);
+
+			ioStatus &= ~(FlagN | FlagZ | FlagC);
+
+			if (result == 0)
+				ioStatus |= FlagZ;
+			else if ((result & 0x80) != 0)
+				ioStatus |= FlagC | FlagN;
+		}
+
+		// INX and INY never set the zero flag, like the table core does
+		inline void IncrementXY(unsigned char& ioStatus, unsigned char& ioRegister)
+		{
+			++ioRegister;
+			ioStatus = (ioStatus & ~(FlagN | FlagZ)) | ((ioRegister & 0x80) != 0 ? FlagN : 0);
+		}
+
+		inline unsigned char ShiftLeft(unsigned char& ioStatus, unsigned char inValue)
+		{
+			const unsigned char result = static_cast<unsigned char>(inValue << 1);
+
+			ioStatus = (ioStatus & ~FlagC) | ((inValue & 0x80) != 0 ? FlagC : 0);
+			UpdateNZ(ioStatus, result);
+
+			return result;
+		}
+
+		inline unsigned char RotateLeft(unsigned char& ioStatus, unsigned char inValue)
+		{
+			const unsigned char result = static_cast<unsigned char>((inValue << 1) | ((ioStatus & FlagC) != 0 ? 0x01 : 0));
+
+			ioStatus = (ioStatus & ~FlagC) | ((inValue & 0x80) != 0 ? FlagC : 0);
+			UpdateNZ(ioStatus, result);
+
+			return result;
+		}
+
+		inline unsigned char ShiftRight(unsigned char& ioStatus, unsigned char inValue)
+		{
+			const unsigned char result = inValue >> 1;
+
+			ioStatus = (ioStatus & ~FlagC) | ((inValue & 0x01) != 0 ? FlagC : 0);
+			UpdateNZ(ioStatus, result);
+
+			return result;
+		}
+
+		inline unsigned char RotateRight(unsigned char& ioStatus, unsigned char inValue)
+		{
+			const unsigned char result = (inValue >> 1) | ((ioStatus & FlagC) != 0 ? 0x80 : 0);
+
+			ioStatus = (ioStatus & ~FlagC) | ((inValue & 0x01) != 0 ? FlagC : 0);
+			UpdateNZ(ioStatus, result);
+
+			return result;
+		}
+
+		inline void BitTest(unsigned char& ioStatus, unsigned char inA, unsigned char inValue)
+		{
+			ioStatus &= ~(FlagN | FlagV | FlagZ);
+			ioStatus |= (inValue & 0x80) != 0 ? FlagN : 0;
+			ioStatus |= (inValue & 0x40) != 0 ? FlagV : 0;
+			ioStatus |= (inA & inValue) == 0 ? FlagZ : 0;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------------------------
+
+	short CPUmos6510::ExecuteInstruction()
+	{
+		return Run(std::numeric_limits<int>::max(), true);
+	}
+
+	void CPUmos6510::Execute(int inCycleLimit)
+	{
+		if (m_Profiler != nullptr)
+			ExecuteProfiled(inCycleLimit);
+		else
+			Run(inCycleLimit, false);
+	}
+
+	short CPUmos6510::Run(int inCycleLimit, bool inSingleInstruction)
+	{
+		if (!m_State.IsValid() || m_State.IsSuspended())
+			return 0;
+
+		CPUMemory& cpu_memory = m_State.GetMemory();
+		FOUNDATION_ASSERT(cpu_memory.GetSize() == 0x10000);
+
+		unsigned char* memory = &cpu_memory[0];
+		unsigned char* dirty_pages = cpu_memory.GetDirtyPages();
+		ICPUWriteCallback* write_callback = m_State.GetWriteCallback();
+
+		unsigned char a = m_State.m_RegA;
+		unsigned char x = m_State.m_RegX;
+		unsigned char y = m_State.m_RegY;
+		unsigned char sp = m_State.m_SP;
+		unsigned char p = m_State.m_Status;
+		unsigned short pc = m_State.m_PC;
+
+		int cycle = m_State.GetCycle();
+		int base_cycles = 0;
+		bool suspended = false;
+
+		// Any write to the memory marks its page as written
+		auto modify = [&](unsigned short inAddress, unsigned char inValue)
+		{
+			memory[inAddress] = inValue;
+			dirty_pages[inAddress / CPUMemory::PageSize] = 1;
+		};
+
+		auto write = [&](unsigned short inAddress, unsigned char inValue)
+		{
+			modify(inAddress, inValue);
+
+			if (write_callback != nullptr)
+				write_callback->Write(inAddress, inValue, cycle);
+		};
+
+		auto push = [&](unsigned char inValue)
+		{
+			modify(0x0100 + sp, inValue);
+			--sp;
+		};
+
+		auto pull = [&]() -> unsigned char
+		{
+			++sp;
+			return memory[0x0100 + sp];
+		};
+
+		while (!suspended && cycle < inCycleLimit)
+		{
+			const unsigned char opcode = memory[pc];
+			int added_cycles = 0;
+
+			base_cycles = ms_aInstructions[opcode].m_ucBaseCycles;
+
+			auto branch = [&](bool inCondition)
+			{
+				const unsigned short address = AddressREL(memory, pc, added_cycles);
+				pc += 2;
+
+				if (inCondition)
+				{
+					pc = address;
+					++added_cycles;
+				}
+			};
+
+			switch (opcode)
+			{
+			// ORA
+			case 0x01: a |= memory[AddressIZX(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x05: a |= memory[AddressZP(memory, pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x09: a |= memory[AddressIMM(pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x0d: a |= memory[AddressABS(memory, pc)]; UpdateNZ(p, a); pc += 3; break;
+			case 0x11: a |= memory[AddressIZY(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x15: a |= memory[AddressZPI(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x19: a |= memory[AddressABI(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+			case 0x1d: a |= memory[AddressABI(memory, pc, x, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+
+			// AND
+			case 0x21: a &= memory[AddressIZX(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x25: a &= memory[AddressZP(memory, pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x29: a &= memory[AddressIMM(pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x2d: a &= memory[AddressABS(memory, pc)]; UpdateNZ(p, a); pc += 3; break;
+			case 0x31: a &= memory[AddressIZY(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x35: a &= memory[AddressZPI(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x39: a &= memory[AddressABI(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+			case 0x3d: a &= memory[AddressABI(memory, pc, x, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+
+			// EOR
+			case 0x41: a ^= memory[AddressIZX(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x45: a ^= memory[AddressZP(memory, pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x49: a ^= memory[AddressIMM(pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x4d: a ^= memory[AddressABS(memory, pc)]; UpdateNZ(p, a); pc += 3; break;
+			case 0x51: a ^= memory[AddressIZY(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x55: a ^= memory[AddressZPI(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0x59: a ^= memory[AddressABI(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+			case 0x5d: a ^= memory[AddressABI(memory, pc, x, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+
+			// ADC
+			case 0x61: AddWithCarry(p, a, memory[AddressIZX(memory, pc, x)]); pc += 2; break;
+			case 0x65: AddWithCarry(p, a, memory[AddressZP(memory, pc)]); pc += 2; break;
+			case 0x69: AddWithCarry(p, a, memory[AddressIMM(pc)]); pc += 2; break;
+			case 0x6d: AddWithCarry(p, a, memory[AddressABS(memory, pc)]); pc += 3; break;
+			case 0x71: AddWithCarry(p, a, memory[AddressIZY(memory, pc, y, added_cycles)]); pc += 2; break;
+			case 0x75: AddWithCarry(p, a, memory[AddressZPI(memory, pc, x)]); pc += 2; break;
+			case 0x79: AddWithCarry(p, a, memory[AddressABI(memory, pc, y, added_cycles)]); pc += 3; break;
+			case 0x7d: AddWithCarry(p, a, memory[AddressABI(memory, pc, x, added_cycles)]); pc += 3; break;
+
+			// SBC
+			case 0xe1: SubtractWithCarry(p, a, memory[AddressIZX(memory, pc, x)]); pc += 2; break;
+			case 0xe5: SubtractWithCarry(p, a, memory[AddressZP(memory, pc)]); pc += 2; break;
+			case 0xe9: SubtractWithCarry(p, a, memory[AddressIMM(pc)]); pc += 2; break;
+			case 0xed: SubtractWithCarry(p, a, memory[AddressABS(memory, pc)]); pc += 3; break;
+			case 0xf1: SubtractWithCarry(p, a, memory[AddressIZY(memory, pc, y, added_cycles)]); pc += 2; break;
+			case 0xf5: SubtractWithCarry(p, a, memory[AddressZPI(memory, pc, x)]); pc += 2; break;
+			case 0xf9: SubtractWithCarry(p, a, memory[AddressABI(memory, pc, y, added_cycles)]); pc += 3; break;
+			case 0xfd: SubtractWithCarry(p, a, memory[AddressABI(memory, pc, x, added_cycles)]); pc += 3; break;
+
+			// CMP
+			case 0xc1: Compare(p, a, memory[AddressIZX(memory, pc, x)]); pc += 2; break;
+			case 0xc5: Compare(p, a, memory[AddressZP(memory, pc)]); pc += 2; break;
+			case 0xc9: Compare(p, a, memory[AddressIMM(pc)]); pc += 2; break;
+			case 0xcd: Compare(p, a, memory[AddressABS(memory, pc)]); pc += 3; break;
+			case 0xd1: Compare(p, a, memory[AddressIZY(memory, pc, y, added_cycles)]); pc += 2; break;
+			case 0xd5: Compare(p, a, memory[AddressZPI(memory, pc, x)]); pc += 2; break;
+			case 0xd9: Compare(p, a, memory[AddressABI(memory, pc, y, added_cycles)]); pc += 3; break;
+			case 0xdd: Compare(p, a, memory[AddressABI(memory, pc, x, added_cycles)]); pc += 3; break;
+
+			// CPX, CPY
+			case 0xe0: CompareXY(p, x, memory[AddressIMM(pc)]); pc += 2; break;
+			case 0xe4: CompareXY(p, x, memory[AddressZP(memory, pc)]); pc += 2; break;
+			case 0xec: CompareXY(p, x, memory[AddressABS(memory, pc)]); pc += 3; break;
+			case 0xc0: CompareXY(p, y, memory[AddressIMM(pc)]); pc += 2; break;
+			case 0xc4: CompareXY(p, y, memory[AddressZP(memory, pc)]); pc += 2; break;
+			case 0xcc: CompareXY(p, y, memory[AddressABS(memory, pc)]); pc += 3; break;
+
+			// BIT
+			case 0x24: BitTest(p, a, memory[AddressZP(memory, pc)]); pc += 2; break;
+			case 0x2c: BitTest(p, a, memory[AddressABS(memory, pc)]); pc += 3; break;
+
+			// LDA
+			case 0xa1: a = memory[AddressIZX(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0xa5: a = memory[AddressZP(memory, pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0xa9: a = memory[AddressIMM(pc)]; UpdateNZ(p, a); pc += 2; break;
+			case 0xad: a = memory[AddressABS(memory, pc)]; UpdateNZ(p, a); pc += 3; break;
+			case 0xb1: a = memory[AddressIZY(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 2; break;
+			case 0xb5: a = memory[AddressZPI(memory, pc, x)]; UpdateNZ(p, a); pc += 2; break;
+			case 0xb9: a = memory[AddressABI(memory, pc, y, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+			case 0xbd: a = memory[AddressABI(memory, pc, x, added_cycles)]; UpdateNZ(p, a); pc += 3; break;
+
+			// LDX
+			case 0xa2: x = memory[AddressIMM(pc)]; UpdateNZ(p, x); pc += 2; break;
+			case 0xa6: x = memory[AddressZP(memory, pc)]; UpdateNZ(p, x); pc += 2; break;
+			case 0xae: x = memory[AddressABS(memory, pc)]; UpdateNZ(p, x); pc += 3; break;
+			case 0xb6: x = memory[AddressZPI(memory, pc, y)]; UpdateNZ(p, x); pc += 2; break;
+			case 0xbe: x = memory[AddressABI(memory, pc, y, added_cycles)]; UpdateNZ(p, x); pc += 3; break;
+
+			// LDY
+			case 0xa0: y = memory[AddressIMM(pc)]; UpdateNZ(p, y); pc += 2; break;
+			case 0xa4: y = memory[AddressZP(memory, pc)]; UpdateNZ(p, y); pc += 2; break;
+			case 0xac: y = memory[AddressABS(memory, pc)]; UpdateNZ(p, y); pc += 3; break;
+			case 0xb4: y = memory[AddressZPI(memory, pc, x)]; UpdateNZ(p, y); pc += 2; break;
+			case 0xbc: y = memory[AddressABI(memory, pc, x, added_cycles)]; UpdateNZ(p, y); pc += 3; break;
+
+			// STA
+			case 0x81: write(AddressIZX(memory, pc, x), a); pc += 2; break;
+			case 0x85: write(AddressZP(memory, pc), a); pc += 2; break;
+			case 0x8d: write(AddressABS(memory, pc), a); pc += 3; break;
+			case 0x91: write(AddressIZY(memory, pc, y, added_cycles), a); pc += 2; break;
+			case 0x95: write(AddressZPI(memory, pc, x), a); pc += 2; break;
+			case 0x99: write(AddressABI(memory, pc, y, added_cycles), a); pc += 3; break;
+			case 0x9d: write(AddressABI(memory, pc, x, added_cycles), a); pc += 3; break;
+
+			// STX, STY
+			case 0x86: write(AddressZP(memory, pc), x); pc += 2; break;
+			case 0x8e: write(AddressABS(memory, pc), x); pc += 3; break;
+			case 0x96: write(AddressZPI(memory, pc, y), x); pc += 2; break;
+			case 0x84: write(AddressZP(memory, pc), y); pc += 2; break;
+			case 0x8c: write(AddressABS(memory, pc), y); pc += 3; break;
+			case 0x94: write(AddressZPI(memory, pc, x), y); pc += 2; break;
+
+			// DEC, INC
+			case 0xc6: { const unsigned short address = AddressZP(memory, pc); const unsigned char value = memory[address] - 1; UpdateNZ(p, value); write(address, value); pc += 2; } break;
+			case 0xce: { const unsigned short address = AddressABS(memory, pc); const unsigned char value = memory[address] - 1; UpdateNZ(p, value); write(address, value); pc += 3; } break;
+			case 0xd6: { const unsigned short address = AddressZPI(memory, pc, x); const unsigned char value = memory[address] - 1; UpdateNZ(p, value); write(address, value); pc += 2; } break;
+			case 0xde: { const unsigned short address = AddressABI(memory, pc, x, added_cycles); const unsigned char value = memory[address] - 1; UpdateNZ(p, value); write(address, value); pc += 3; } break;
+			case 0xe6: { const unsigned short address = AddressZP(memory, pc); const unsigned char value = memory[address] + 1; UpdateNZ(p, value); write(address, value); pc += 2; } break;
+			case 0xee: { const unsigned short address = AddressABS(memory, pc); const unsigned char value = memory[address] + 1; UpdateNZ(p, value); write(address, value); pc += 3; } break;
+			case 0xf6: { const unsigned short address = AddressZPI(memory, pc, x); const unsigned char value = memory[address] + 1; UpdateNZ(p, value); write(address, value); pc += 2; } break;
+			case 0xfe: { const unsigned short address = AddressABI(memory, pc, x, added_cycles); const unsigned char value = memory[address] + 1; UpdateNZ(p, value); write(address, value); pc += 3; } break;
+
+			// DEX, DEY, INX, INY
+			case 0xca: --x; UpdateNZ(p, x); pc += 1; break;
+			case 0x88: --y; UpdateNZ(p, y); pc += 1; break;
+			case 0xe8: IncrementXY(p, x); pc += 1; break;
+			case 0xc8: IncrementXY(p, y); pc += 1; break;
+
+			// Shifts and rotations. Writing the result back to memory does not go through the write callback, like the table core does
+			case 0x0a: a = ShiftLeft(p, a); pc += 1; break;
+			case 0x06: { const unsigned short address = AddressZP(memory, pc); modify(address, ShiftLeft(p, memory[address])); pc += 2; } break;
+			case 0x0e: { const unsigned short address = AddressABS(memory, pc); modify(address, ShiftLeft(p, memory[address])); pc += 3; } break;
+			case 0x16: { const unsigned short address = AddressZPI(memory, pc, x); modify(address, ShiftLeft(p, memory[address])); pc += 2; } break;
+			case 0x1e: { const unsigned short address = AddressABI(memory, pc, x, added_cycles); modify(address, ShiftLeft(p, memory[address])); pc += 3; } break;
+
+			case 0x2a: a = RotateLeft(p, a); pc += 1; break;
+			case 0x26: { const unsigned short address = AddressZP(memory, pc); modify(address, RotateLeft(p, memory[address])); pc += 2; } break;
+			case 0x2e: { const unsigned short address = AddressABS(memory, pc); modify(address, RotateLeft(p, memory[address])); pc += 3; } break;
+			case 0x36: { const unsigned short address = AddressZPI(memory, pc, x); modify(address, RotateLeft(p, memory[address])); pc += 2; } break;
+			case 0x3e: { const unsigned short address = AddressABI(memory, pc, x, added_cycles); modify(address, RotateLeft(p, memory[address])); pc += 3; } break;
+
+			case 0x4a: a = ShiftRight(p, a); pc += 1; break;
+			case 0x46: { const unsigned short address = AddressZP(memory, pc); modify(address, ShiftRight(p, memory[address])); pc += 2; } break;
+			case 0x4e: { const unsigned short address = AddressABS(memory, pc); modify(address, ShiftRight(p, memory[address])); pc += 3; } break;
+			case 0x56: { const unsigned short address = AddressZPI(memory, pc, x); modify(address, ShiftRight(p, memory[address])); pc += 2; } break;
+			case 0x5e: { const unsigned short address = AddressABI(memory, pc, x, added_cycles); modify(address, ShiftRight(p, memory[address])); pc += 3; } break;
+
+			case 0x6a: a = RotateRight(p, a); pc += 1; break;
+			case 0x66: { const unsigned short address = AddressZP(memory, pc); modify(address, RotateRight(p, memory[address])); pc += 2; } break;
+			case 0x6e: { const unsigned short address = AddressABS(memory, pc); modify(address, RotateRight(p, memory[address])); pc += 3; } break;
+			case 0x76: { const unsigned short address = AddressZPI(memory, pc, x); modify(address, RotateRight(p, memory[address])); pc += 2; } break;
+			case 0x7e: { const unsigned short address = AddressABI(memory, pc, x, added_cycles); modify(address, RotateRight(p, memory[address])); pc += 3; } break;
+
+			// Transfers
+			case 0xaa: x = a; UpdateNZ(p, x); pc += 1; break;
+			case 0x8a: a = x; UpdateNZ(p, a); pc += 1; break;
+			case 0xa8: y = a; UpdateNZ(p, y); pc += 1; break;
+			case 0x98: a = y; UpdateNZ(p, a); pc += 1; break;
+			case 0xba: x = sp; UpdateNZ(p, x); pc += 1; break;
+			case 0x9a: sp = x; pc += 1; break;
+
+			// Stack
+			case 0x48: push(a); pc += 1; break;
+			case 0x68: a = pull(); UpdateNZ(p, a); pc += 1; break;
+			case 0x08: push(p); pc += 1; break;
+			case 0x28: p = pull(); pc += 1; break;
+
+			// Branches
+			case 0x10: branch((p & FlagN) == 0); break;
+			case 0x30: branch((p & FlagN) != 0); break;
+			case 0x50: branch((p & FlagV) == 0); break;
+			case 0x70: branch((p & FlagV) != 0); break;
+			case 0x90: branch((p & FlagC) == 0); break;
+			case 0xb0: branch((p & FlagC) != 0); break;
+			case 0xd0: branch((p & FlagZ) == 0); break;
+			case 0xf0: branch((p & FlagZ) != 0); break;
+
+			// Jumps and subroutines. The return address pushed by JSR is the address of the next instruction
+			case 0x20:
+				{
+					const unsigned short address = AddressABS(memory, pc);
+					pc += 3;
+					push(static_cast<unsigned char>(pc & 0xff));
+					push(static_cast<unsigned char>(pc >> 8));
+					pc = address;
+				}
+				break;
+			case 0x60:
+				pc += 1;
+				if (sp != 0x00)
+				{
+					const unsigned short address_high = pull();
+					pc = static_cast<unsigned short>((address_high << 8) | pull());
+				}
+				else
+					suspended = true;
+				break;
+			case 0x40:
+				{
+					p = pull();
+					const unsigned short address_high = pull();
+					pc = static_cast<unsigned short>((address_high << 8) | pull());
+				}
+				break;
+			case 0x4c: pc = AddressABS(memory, pc); break;
+			case 0x6c: pc = AddressIND(memory, pc); break;
+
+			// Flags
+			case 0x18: p &= ~FlagC; pc += 1; break;
+			case 0x38: p |= FlagC; pc += 1; break;
+			case 0xd8: p &= ~FlagD; pc += 1; break;
+			case 0xf8: p |= FlagD; pc += 1; break;
+			case 0x58: p &= ~FlagI; pc += 1; break;
+			case 0x78: p |= FlagI; pc += 1; break;
+			case 0xb8: p &= ~FlagV; pc += 1; break;
+
+			case 0xea: pc += 1; break;
+
+			// BRK and all illegal opcodes, which suspend the CPU
+			default:
+				pc += 1;
+				push(static_cast<unsigned char>(pc & 0xff));
+				push(static_cast<unsigned char>(pc >> 8));
+				push(p);
+				pc = 0xfffe;
+				suspended = true;
+				break;
+			}
+
+			cycle += base_cycles + added_cycles;
+
+			if (inSingleInstruction)
+				break;
+		}
+
+		m_State.m_RegA = a;
+		m_State.m_RegX = x;
+		m_State.m_RegY = y;
+		m_State.m_SP = sp;
+		m_State.m_Status = p;
+		m_State.m_PC = pc;
+		m_State.SetCycle(cycle);
+		m_State.SetSuspended(suspended);
+
+		return static_cast<short>(base_cycles);
+	}
+}
+
+#endif //_SF2_CPU_TABLE_DISPATCH
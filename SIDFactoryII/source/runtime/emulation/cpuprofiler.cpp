@@ -0,0 +1,278 @@
+#include "cpuprofiler.h"
+
+#include "foundation/base/assert.h"
+#include "foundation/platform/imutex.h"
+#include "foundation/platform/iplatform.h"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace Emulation
+{
+	namespace
+	{
+		const unsigned char OpcodeJSR = 0x20;
+		const unsigned char OpcodeRTS = 0x60;
+
+		const unsigned int ReportAddressCount = 32;
+
+		struct HexAddress
+		{
+			unsigned short m_Address;
+		};
+
+		std::ostream& operator<<(std::ostream& inStream, const HexAddress& inAddress)
+		{
+			const std::ios_base::fmtflags flags = inStream.flags();
+			const char fill = inStream.fill();
+
+			inStream << '$' << std::hex << std::setw(4) << std::setfill('0') << inAddress.m_Address;
+
+			inStream.flags(flags);
+			inStream.fill(fill);
+
+			return inStream;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	CPUProfiler::CPUProfiler(Foundation::IPlatform* inPlatform)
+		: m_ExecuteCount(0)
+		, m_TotalCycles(0)
+		, m_OverflowDepth(0)
+		, m_AddressCounters(0x10000)
+	{
+		m_Mutex = inPlatform->CreateMutex();
+		m_Stack.reserve(MaxStackDepth);
+	}
+
+	CPUProfiler::~CPUProfiler()
+	{
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void CPUProfiler::Lock()
+	{
+		m_Mutex->Lock();
+	}
+
+	void CPUProfiler::Unlock()
+	{
+		m_Mutex->Unlock();
+	}
+
+	void CPUProfiler::Reset()
+	{
+		m_ExecuteCount = 0;
+		m_TotalCycles = 0;
+		m_OverflowDepth = 0;
+
+		std::fill(m_AddressCounters.begin(), m_AddressCounters.end(), AddressCounter());
+
+		m_Routines.clear();
+		m_Calls.clear();
+		m_Stack.clear();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void CPUProfiler::BeginExecute(unsigned short inAddress)
+	{
+		// The CPU may be executing in steps, in which case the routines entered are still on the stack
+		if (m_Stack.empty())
+		{
+			++m_ExecuteCount;
+			Enter(inAddress, inAddress);
+		}
+	}
+
+	void CPUProfiler::EndExecute(bool inIsSuspended)
+	{
+		if (inIsSuspended)
+		{
+			while (!m_Stack.empty())
+				Leave();
+
+			m_OverflowDepth = 0;
+		}
+	}
+
+	void CPUProfiler::Record(unsigned short inAddress, unsigned char inOpcode, unsigned int inCycles, unsigned short inNextAddress)
+	{
+		FOUNDATION_ASSERT(!m_Stack.empty());
+
+		AddressCounter& address_counter = m_AddressCounters[inAddress];
+
+		address_counter.m_Cycles += inCycles;
+		++address_counter.m_HitCount;
+
+		m_TotalCycles += inCycles;
+		m_Stack.back().m_Routine->m_ExclusiveCycles += inCycles;
+
+		if (inOpcode == OpcodeJSR)
+			Enter(m_Stack.back().m_Routine->m_Address, inNextAddress);
+		else if (inOpcode == OpcodeRTS)
+		{
+			if (m_OverflowDepth > 0)
+				--m_OverflowDepth;
+			else if (m_Stack.size() > 1)
+				Leave();
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	std::vector<CPUProfiler::Routine> CPUProfiler::GetRoutines() const
+	{
+		std::vector<Routine> routines;
+		routines.reserve(m_Routines.size());
+
+		for (const auto& routine : m_Routines)
+			routines.push_back(routine.second);
+
+		std::sort(routines.begin(), routines.end(), [](const Routine& inA, const Routine& inB)
+		{
+			return inA.m_InclusiveCycles != inB.m_InclusiveCycles ? inA.m_InclusiveCycles > inB.m_InclusiveCycles : inA.m_Address < inB.m_Address;
+		});
+
+		return routines;
+	}
+
+	std::vector<CPUProfiler::Call> CPUProfiler::GetCalls() const
+	{
+		std::vector<Call> calls;
+		calls.reserve(m_Calls.size());
+
+		for (const auto& call : m_Calls)
+			calls.push_back(call.second);
+
+		std::sort(calls.begin(), calls.end(), [](const Call& inA, const Call& inB)
+		{
+			return inA.m_InclusiveCycles != inB.m_InclusiveCycles ? inA.m_InclusiveCycles > inB.m_InclusiveCycles : inA.m_CalleeAddress < inB.m_CalleeAddress;
+		});
+
+		return calls;
+	}
+
+	void CPUProfiler::WriteReport(std::ostream& inStream) const
+	{
+		const double execute_count = static_cast<double>(std::max(m_ExecuteCount, 1u));
+		const double total_cycles = static_cast<double>(std::max(m_TotalCycles, 1ull));
+
+		const std::vector<Routine> routines = GetRoutines();
+		const std::vector<Call> calls = GetCalls();
+
+		inStream << "Executions: " << m_ExecuteCount << ", cycles: " << m_TotalCycles
+			<< ", average cycles per execution: " << std::fixed << std::setprecision(1) << m_TotalCycles / execute_count << std::endl
+			<< std::endl;
+
+		inStream << "Routine    Calls     Inclusive  Per exec.   Peak     Exclusive  Excl. %" << std::endl;
+
+		for (const Routine& routine : routines)
+		{
+			inStream << HexAddress{ routine.m_Address }
+				<< std::setw(10) << routine.m_CallCount
+				<< std::setw(14) << routine.m_InclusiveCycles
+				<< std::setw(11) << std::setprecision(1) << routine.m_InclusiveCycles / execute_count
+				<< std::setw(7) << routine.m_PeakInclusiveCycles
+				<< std::setw(14) << routine.m_ExclusiveCycles
+				<< std::setw(8) << std::setprecision(2) << 100.0 * routine.m_ExclusiveCycles / total_cycles << std::endl;
+		}
+
+		inStream << std::endl << "Call graph (caller -> callee, calls, inclusive cycles)" << std::endl;
+
+		for (const Routine& routine : routines)
+		{
+			bool has_calls = false;
+
+			for (const Call& call : calls)
+			{
+				if (call.m_CallerAddress != routine.m_Address)
+					continue;
+
+				if (!has_calls)
+					inStream << HexAddress{ routine.m_Address } << std::endl;
+
+				inStream << "  -> " << HexAddress{ call.m_CalleeAddress }
+					<< std::setw(10) << call.m_CallCount
+					<< std::setw(14) << call.m_InclusiveCycles << std::endl;
+
+				has_calls = true;
+			}
+		}
+
+		std::vector<unsigned short> addresses;
+
+		for (unsigned int i = 0; i < 0x10000; ++i)
+		{
+			if (m_AddressCounters[i].m_HitCount > 0)
+				addresses.push_back(static_cast<unsigned short>(i));
+		}
+
+		std::sort(addresses.begin(), addresses.end(), [this](unsigned short inA, unsigned short inB)
+		{
+			return m_AddressCounters[inA].m_Cycles != m_AddressCounters[inB].m_Cycles ? m_AddressCounters[inA].m_Cycles > m_AddressCounters[inB].m_Cycles : inA < inB;
+		});
+
+		inStream << std::endl << "Address    Hits        Cycles  Cycles %" << std::endl;
+
+		for (unsigned int i = 0; i < addresses.size() && i < ReportAddressCount; ++i)
+		{
+			const AddressCounter& address_counter = m_AddressCounters[addresses[i]];
+
+			inStream << HexAddress{ addresses[i] }
+				<< std::setw(9) << address_counter.m_HitCount
+				<< std::setw(14) << address_counter.m_Cycles
+				<< std::setw(10) << std::setprecision(2) << 100.0 * address_counter.m_Cycles / total_cycles << std::endl;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void CPUProfiler::Enter(unsigned short inCallerAddress, unsigned short inAddress)
+	{
+		// Code that leaves routines without RTS, by manipulating the stack, would grow the stack forever
+		if (m_Stack.size() >= MaxStackDepth)
+		{
+			++m_OverflowDepth;
+			return;
+		}
+
+		Routine& routine = m_Routines[inAddress];
+
+		routine.m_Address = inAddress;
+		++routine.m_CallCount;
+
+		// The code passed to the CPU for execution has no caller
+		Call* call = nullptr;
+
+		if (!m_Stack.empty())
+		{
+			call = &m_Calls[(static_cast<unsigned int>(inCallerAddress) << 16) | inAddress];
+
+			call->m_CallerAddress = inCallerAddress;
+			call->m_CalleeAddress = inAddress;
+			++call->m_CallCount;
+		}
+
+		m_Stack.push_back({ &routine, call, m_TotalCycles });
+	}
+
+	void CPUProfiler::Leave()
+	{
+		FOUNDATION_ASSERT(!m_Stack.empty());
+
+		const StackEntry& entry = m_Stack.back();
+		const unsigned long long inclusive_cycles = m_TotalCycles - entry.m_EntryCycles;
+
+		entry.m_Routine->m_InclusiveCycles += inclusive_cycles;
+		entry.m_Routine->m_PeakInclusiveCycles = std::max(entry.m_Routine->m_PeakInclusiveCycles, static_cast<unsigned int>(inclusive_cycles));
+
+		if (entry.m_Call != nullptr)
+			entry.m_Call->m_InclusiveCycles += inclusive_cycles;
+
+		m_Stack.pop_back();
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace Foundation
+{
+	class IPlatform;
+	class IMutex;
+}
+
+namespace Emulation
+{
+	// Accumulates the cycles spend by the CPU, for each address and for each routine called with JSR. The code passed
+	// to the CPU for execution (ie. the driver update) is counted as a routine of its own. A routine ends when it
+	// returns with RTS, or when the CPU is suspended.
+	class CPUProfiler final
+	{
+	public:
+		struct AddressCounter
+		{
+			unsigned long long m_Cycles = 0;
+			unsigned int m_HitCount = 0;
+		};
+
+		struct Routine
+		{
+			unsigned short m_Address = 0;
+			unsigned int m_CallCount = 0;
+			unsigned long long m_InclusiveCycles = 0;	// Including the routines called from the routine
+			unsigned long long m_ExclusiveCycles = 0;
+			unsigned int m_PeakInclusiveCycles = 0;		// Highest inclusive cycle count of a single call
+		};
+
+		struct Call
+		{
+			unsigned short m_CallerAddress = 0;
+			unsigned short m_CalleeAddress = 0;
+			unsigned int m_CallCount = 0;
+			unsigned long long m_InclusiveCycles = 0;
+		};
+
+		CPUProfiler(Foundation::IPlatform* inPlatform);
+		~CPUProfiler();
+
+		void Lock();
+		void Unlock();
+
+		void Reset();
+
+		// Called by the CPU, while locked
+		void BeginExecute(unsigned short inAddress);
+		void EndExecute(bool inIsSuspended);
+		void Record(unsigned short inAddress, unsigned char inOpcode, unsigned int inCycles, unsigned short inNextAddress);
+
+		// Number of times code has been passed to the CPU for execution
+		unsigned int GetExecuteCount() const { return m_ExecuteCount; }
+		unsigned long long GetTotalCycles() const { return m_TotalCycles; }
+
+		const AddressCounter& GetAddressCounter(unsigned short inAddress) const { return m_AddressCounters[inAddress]; }
+
+		// Sorted by inclusive cycles, highest first
+		std::vector<Routine> GetRoutines() const;
+		std::vector<Call> GetCalls() const;
+
+		// Writes a flat report of the routines, followed by the call graph and the most expensive addresses
+		void WriteReport(std::ostream& inStream) const;
+
+	private:
+		struct StackEntry
+		{
+			Routine* m_Routine;
+			Call* m_Call;
+			unsigned long long m_EntryCycles;
+		};
+
+		void Enter(unsigned short inCallerAddress, unsigned short inAddress);
+		void Leave();
+
+		static const unsigned int MaxStackDepth = 0x100;
+
+		std::shared_ptr<Foundation::IMutex> m_Mutex;
+
+		unsigned int m_ExecuteCount;
+		unsigned long long m_TotalCycles;
+
+		// Number of routines entered while the stack was full, their RTS must not leave the routines on the stack
+		unsigned int m_OverflowDepth;
+
+		std::vector<AddressCounter> m_AddressCounters;
+		std::unordered_map<unsigned short, Routine> m_Routines;
+		std::unordered_map<unsigned int, Call> m_Calls;
+		std::vector<StackEntry> m_Stack;
+	};
+}
@@ -0,0 +1,185 @@
+#include "sidaudition.h"
+#include "runtime/environmentdefines.h"
+
+#include "foundation/base/assert.h"
+
+#include <algorithm>
+
+namespace Emulation
+{
+	SIDAudition::SIDAudition(const SIDProxy& inSIDProxy, const std::vector<SIDModel>& inModels)
+		: m_Generation(0)
+		, m_WorkersBusy(0)
+		, m_StopWorkers(false)
+		, m_Writes(nullptr)
+		, m_Cycles(0)
+	{
+		for (SIDModel model : inModels)
+		{
+			FOUNDATION_ASSERT(model != inSIDProxy.GetModel());
+
+			SIDConfiguration configuration = inSIDProxy.GetConfiguration();
+			configuration.m_eModel = model;
+
+			m_Workers.push_back(std::make_unique<Worker>());
+			m_Workers.back()->m_SIDProxy = std::make_unique<SIDProxy>(configuration);
+		}
+
+		Synchronize(inSIDProxy);
+
+		for (std::unique_ptr<Worker>& worker : m_Workers)
+			worker->m_Thread = std::thread(&SIDAudition::WorkerThread, this, std::ref(*worker), m_Generation);
+	}
+
+	SIDAudition::~SIDAudition()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_StopWorkers = true;
+		}
+
+		m_FrameStart.notify_all();
+
+		for (std::unique_ptr<Worker>& worker : m_Workers)
+			worker->m_Thread.join();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	int SIDAudition::FindModel(SIDModel inModel) const
+	{
+		for (size_t i = 0; i < m_Workers.size(); ++i)
+		{
+			if (m_Workers[i]->m_SIDProxy->GetModel() == inModel)
+				return static_cast<int>(i);
+		}
+
+		return -1;
+	}
+
+	void SIDAudition::Synchronize(const SIDProxy& inSIDProxy)
+	{
+		for (std::unique_ptr<Worker>& worker : m_Workers)
+			CopyState(inSIDProxy, *worker->m_SIDProxy);
+	}
+
+	void SIDAudition::Exchange(int inIndex, SIDProxy& ioSIDProxy)
+	{
+		FOUNDATION_ASSERT(inIndex >= 0 && inIndex < static_cast<int>(m_Workers.size()));
+
+		SIDProxy& audition_proxy = *m_Workers[inIndex]->m_SIDProxy;
+
+		const SIDModel audible_model = ioSIDProxy.GetModel();
+		const SIDModel audition_model = audition_proxy.GetModel();
+
+		SIDProxyState& audible_state = GetModelState(audible_model);
+		SIDProxyState& audition_state = GetModelState(audition_model);
+
+		ioSIDProxy.SaveState(audible_state);
+		audition_proxy.SaveState(audition_state);
+
+		ioSIDProxy.ChangeModel(audition_model);
+		audition_proxy.ChangeModel(audible_model);
+
+		const bool is_restored = ioSIDProxy.RestoreState(audition_state) && audition_proxy.RestoreState(audible_state);
+		FOUNDATION_ASSERT(is_restored);
+		(void)is_restored;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void SIDAudition::StartFrame(const std::vector<SIDWrite>& inWrites, int inCycles)
+	{
+		FOUNDATION_ASSERT(m_WorkersBusy == 0);
+
+		if (m_Workers.empty())
+			return;
+
+		// A driver exceeding the cycle window extends the frame
+		const int cycles = std::max(inCycles, inWrites.empty() ? 0 : inWrites.back().m_iCycle);
+		const SIDConfiguration& configuration = m_Workers.front()->m_SIDProxy->GetConfiguration();
+		const double cycles_per_second = configuration.m_eEnvironment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SECOND_PAL : EMULATION_CYCLES_PER_SECOND_NTSC;
+		const size_t buffer_size = (static_cast<size_t>(cycles * configuration.m_nSampleFrequency / cycles_per_second) + 16) * configuration.m_nOutputChannelCount;
+
+		for (std::unique_ptr<Worker>& worker : m_Workers)
+		{
+			if (worker->m_SampleBuffer.size() < buffer_size)
+				worker->m_SampleBuffer.resize(buffer_size);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			m_Writes = &inWrites;
+			m_Cycles = inCycles;
+			m_WorkersBusy = static_cast<int>(m_Workers.size());
+			++m_Generation;
+		}
+
+		m_FrameStart.notify_all();
+	}
+
+	void SIDAudition::FinishFrame()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_FrameDone.wait(lock, [this]() { return m_WorkersBusy == 0; });
+
+		m_Writes = nullptr;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void SIDAudition::CopyState(const SIDProxy& inSource, SIDProxy& outTarget)
+	{
+		const SIDModel target_model = outTarget.GetModel();
+		SIDProxyState& state = GetModelState(inSource.GetModel());
+
+		inSource.SaveState(state);
+
+		outTarget.ChangeModel(inSource.GetModel());
+
+		const bool is_restored = outTarget.RestoreState(state);
+		FOUNDATION_ASSERT(is_restored);
+		(void)is_restored;
+
+		outTarget.ChangeModel(target_model);
+	}
+
+	SIDProxyState& SIDAudition::GetModelState(SIDModel inModel)
+	{
+		FOUNDATION_ASSERT(inModel == SID_MODEL_6581 || inModel == SID_MODEL_8580);
+
+		return m_ModelStates[inModel];
+	}
+
+	void SIDAudition::WorkerThread(Worker& inWorker, unsigned int inGeneration)
+	{
+		while (true)
+		{
+			const std::vector<SIDWrite>* writes = nullptr;
+			int cycles = 0;
+
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_FrameStart.wait(lock, [this, inGeneration]() { return m_StopWorkers || m_Generation != inGeneration; });
+
+				if (m_StopWorkers)
+					break;
+
+				inGeneration = m_Generation;
+				writes = m_Writes;
+				cycles = m_Cycles;
+			}
+
+			// The output is not heard, but clocking with output keeps the filters and resamplers in their audible state
+			inWorker.m_SIDProxy->ClockFrame(*writes, cycles, &inWorker.m_SampleBuffer[0], static_cast<int>(inWorker.m_SampleBuffer.size()));
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+
+				if (--m_WorkersBusy == 0)
+					m_FrameDone.notify_one();
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "sidproxy.h"
+#include "sidproxydefines.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Emulation
+{
+	// Runs SID proxies with other models next to the SID proxy that is heard, each on a worker thread, and clocks
+	// them through every frame with the same writes. Their chips are in the state the audible chips would be in with
+	// their model, so the audible proxy can exchange model and state with one of them between two frames, which
+	// switches the model that is heard without resetting or restarting anything.
+	//
+	// A proxy continuing from the state of the audible proxy takes the filter state of its model from the audible
+	// chips, which do not clock that filter. The filter settles within a few frames of clocking, so until then the
+	// output of the proxy may differ from the model's own output by a short transient.
+	class SIDAudition final
+	{
+	public:
+		// The proxies have the configuration of the audible proxy, with each of the models, and continue from its state
+		SIDAudition(const SIDProxy& inSIDProxy, const std::vector<SIDModel>& inModels);
+		~SIDAudition();
+
+		// Returns the index of the proxy with the model, or -1 if there is none
+		int FindModel(SIDModel inModel) const;
+
+		// Continue all proxies from the state of the audible proxy, after it was reset or restored. A proxy is not in
+		// the state of its model until it was clocked through a few frames, see above
+		void Synchronize(const SIDProxy& inSIDProxy);
+
+		// Exchange the model and the state of the audible proxy with the proxy at the index
+		void Exchange(int inIndex, SIDProxy& ioSIDProxy);
+
+		// Clock all proxies through a frame on their worker threads. The writes must not change until the frame is
+		// finished, which waits for the worker threads
+		void StartFrame(const std::vector<SIDWrite>& inWrites, int inCycles);
+		void FinishFrame();
+
+	private:
+		struct Worker
+		{
+			std::unique_ptr<SIDProxy> m_SIDProxy;
+			std::vector<short> m_SampleBuffer;
+			std::thread m_Thread;
+		};
+
+		void CopyState(const SIDProxy& inSource, SIDProxy& outTarget);
+		SIDProxyState& GetModelState(SIDModel inModel);
+		void WorkerThread(Worker& inWorker, unsigned int inGeneration);
+
+		std::vector<std::unique_ptr<Worker>> m_Workers;
+
+		// Saved states for copying between the proxies, one for each model, as a state holds chips of one configuration
+		SIDProxyState m_ModelStates[SID_MODEL_8580 + 1];
+
+		std::mutex m_Mutex;
+		std::condition_variable m_FrameStart;
+		std::condition_variable m_FrameDone;
+		unsigned int m_Generation;
+		int m_WorkersBusy;
+		bool m_StopWorkers;
+
+		const std::vector<SIDWrite>* m_Writes;
+		int m_Cycles;
+	};
+}
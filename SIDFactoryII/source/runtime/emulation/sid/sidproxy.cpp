@@ -1,34 +1,104 @@
 #include "sidproxy.h"
+#include "sidproxysnapshot.h"
 #include "runtime/environmentdefines.h"
 
 #include "libraries/residfp/SID.h"
+#include "libraries/residfp/TableCache.h"
+#include "libraries/residfp/VoiceTap.h"
 
 #include "foundation/base/assert.h"
+#include "foundation/platform/iplatform.h"
 
 #include "utils/configfile.h"
 #include "utils/global.h"
 #include "utils/logging.h"
+#include "utils/spscringbuffer.h"
+#include "utils/wavefilestreamwriter.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace Utility;
 
 namespace Emulation
 {
+	namespace
+	{
+		// Let reSIDfp read its filter tables from files in the config folder, instead of calculating them on startup
+		bool ConfigureTableCache()
+		{
+			if (GetSingleConfigurationValue<Utility::Config::ConfigValueInt>(Global::instance().GetConfig(), "Sound.Emulation.TableCache", 1) != 0)
+				reSIDfp::TableCache::setDirectory(Global::instance().GetPlatform().Storage_GetConfigHomePath());
+
+			return true;
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	SIDProxyState::SIDProxyState()
+	{
+	}
+
+	SIDProxyState::~SIDProxyState()
+	{
+	}
+
+	bool SIDProxyState::IsEmpty() const
+	{
+		return m_apSID[0] == nullptr;
+	}
+
+	const SIDConfiguration& SIDProxyState::GetConfiguration() const
+	{
+		return m_sConfiguration;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool SIDProxySnapshot::IsEmpty() const
+	{
+		return m_aSID.empty();
+	}
+
+	const SIDConfiguration& SIDProxySnapshot::GetConfiguration() const
+	{
+		return m_sConfiguration;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
 	SIDProxy::SIDProxy(const SIDConfiguration& sConfiguration)
 		: m_sConfiguration(sConfiguration)
+		, m_uiClockGeneration(0)
+		, m_nClockThreadsBusy(0)
+		, m_bStopClockThreads(false)
+		, m_nClockCycles(0)
 		, m_SampleCounter(0)
+		, m_dFilter6581Curve(0.5)
+		, m_dFilter8580Curve(0.5)
+		, m_nVoiceTapSampleFrequency(0)
+		, m_bVoiceTapsSuspended(false)
 	{
-		// Create instance of reSid
-		m_pSID = new reSIDfp::SID();
+		for (int i = 0; i < SID_MAX_COUNT; ++i)
+		{
+			m_apSID[i] = nullptr;
+			m_anSIDSampleCount[i] = 0;
+		}
+
+		static const bool table_cache_configured = ConfigureTableCache();
+		(void)table_cache_configured;
 
-		// Apply settings
+		// Apply settings, this creates the instances of reSid
 		ApplySettings();
 	}
 
 	SIDProxy::~SIDProxy()
 	{
-		delete m_pSID;
+		StopClockThreads();
+
+		for (reSIDfp::SID* pSID : m_apSID)
+			delete pSID;
 	}
 
 	//------------------------------------------------------------------------------------------------------------
@@ -85,6 +155,37 @@ namespace Emulation
 		return m_sConfiguration.m_nSampleFrequency;
 	}
 
+
+	int SIDProxy::GetSIDCount() const
+	{
+		return m_sConfiguration.m_nSIDCount;
+	}
+
+
+	unsigned short SIDProxy::GetSIDAddress(int nSIDIndex) const
+	{
+		FOUNDATION_ASSERT(nSIDIndex >= 0 && nSIDIndex < m_sConfiguration.m_nSIDCount);
+		return m_sConfiguration.m_aSIDAddress[nSIDIndex];
+	}
+
+
+	int SIDProxy::GetOutputChannelCount() const
+	{
+		return m_sConfiguration.m_nOutputChannelCount;
+	}
+
+
+	int SIDProxy::GetSIDIndex(unsigned short usAddress) const
+	{
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+		{
+			if (static_cast<unsigned short>(usAddress - m_sConfiguration.m_aSIDAddress[i]) < 0x20)
+				return i;
+		}
+
+		return -1;
+	}
+
 	//------------------------------------------------------------------------------------------------------------
 
 	void SIDProxy::SetConfiguration(const SIDConfiguration& sConfiguration)
@@ -102,146 +203,524 @@ namespace Emulation
 	{
 		using namespace reSIDfp;
 
-		if (m_pSID != nullptr)
+		// The clock threads are restarted below, if they are still needed with the new settings
+		StopClockThreads();
+
+		if (m_sConfiguration.m_nSIDCount < 1 || m_sConfiguration.m_nSIDCount > SID_MAX_COUNT)
 		{
-			// Reset the sid
-			m_pSID->reset();
+			Logging::instance().Warning("SID count %d is out of range. Limiting to 1 to %d", m_sConfiguration.m_nSIDCount, SID_MAX_COUNT);
+			m_sConfiguration.m_nSIDCount = std::min(std::max(m_sConfiguration.m_nSIDCount, 1), SID_MAX_COUNT);
+		}
 
-			const double passband = 20000.0;
+		if (m_sConfiguration.m_nOutputChannelCount != 1 && m_sConfiguration.m_nOutputChannelCount != 2)
+		{
+			Logging::instance().Warning("Output channel count %d is not supported. Using mono", m_sConfiguration.m_nOutputChannelCount);
+			m_sConfiguration.m_nOutputChannelCount = 1;
+		}
 
-			double filter_8580_curve = GetSingleConfigurationValue<Utility::Config::ConfigValueFloat>(Global::instance().GetConfig(), "Sound.Emulation.8580.FilterCurve", 0.5);
-			if (filter_8580_curve < 0.0)
-			{
-				Logging::instance().Warning("Sound.Emulation.8580.FilterCurve %f is lower than 0. Limiting to 0", filter_8580_curve);
-				filter_8580_curve = 0.0;
-			}
-			if (filter_8580_curve > 1.0)
+		// Create or delete instances of reSid, to match the number of SID chips
+		for (int i = 0; i < SID_MAX_COUNT; ++i)
+		{
+			if (i < m_sConfiguration.m_nSIDCount && m_apSID[i] == nullptr)
+				m_apSID[i] = new SID();
+			else if (i >= m_sConfiguration.m_nSIDCount && m_apSID[i] != nullptr)
 			{
-				Logging::instance().Warning("Sound.Emulation.8580.FilterCurve %f is higher than 1.0. Limiting to 1.0", filter_8580_curve);
-				filter_8580_curve = 1.0;
+				delete m_apSID[i];
+				m_apSID[i] = nullptr;
 			}
+		}
 
-			double filter_6581_curve = GetSingleConfigurationValue<Utility::Config::ConfigValueFloat>(Global::instance().GetConfig(), "Sound.Emulation.6581.FilterCurve", 0.5);
-			if (filter_6581_curve < 0.0)
-			{
-				Logging::instance().Warning("Sound.Emulation.6581.FilterCurve %f is lower than 0.0 Limiting to 0.0", filter_6581_curve);
-				filter_6581_curve = 0.0;
-			}
-			if (filter_6581_curve > 1.0)
-			{
-				Logging::instance().Warning("Sound.Emulation.6581.FilterCurve %f is higher than 1.0. Limiting to 1.0", filter_6581_curve);
-				filter_6581_curve = 1.0;
-			}
+		double filter_8580_curve = GetSingleConfigurationValue<Utility::Config::ConfigValueFloat>(Global::instance().GetConfig(), "Sound.Emulation.8580.FilterCurve", 0.5);
+		if (filter_8580_curve < 0.0)
+		{
+			Logging::instance().Warning("Sound.Emulation.8580.FilterCurve %f is lower than 0. Limiting to 0", filter_8580_curve);
+			filter_8580_curve = 0.0;
+		}
+		if (filter_8580_curve > 1.0)
+		{
+			Logging::instance().Warning("Sound.Emulation.8580.FilterCurve %f is higher than 1.0. Limiting to 1.0", filter_8580_curve);
+			filter_8580_curve = 1.0;
+		}
 
-			m_pSID->setSamplingParameters(
-				static_cast<double>(m_sConfiguration.m_eEnvironment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SECOND_PAL : EMULATION_CYCLES_PER_SECOND_NTSC),
-				m_sConfiguration.m_eSampleMethod != SIDSampleMethod::SID_SAMPLE_METHOD_RESAMPLE_INTERPOLATE ? SamplingMethod::DECIMATE : SamplingMethod::RESAMPLE,
-				static_cast<double>(m_sConfiguration.m_nSampleFrequency),
-				passband);
+		double filter_6581_curve = GetSingleConfigurationValue<Utility::Config::ConfigValueFloat>(Global::instance().GetConfig(), "Sound.Emulation.6581.FilterCurve", 0.5);
+		if (filter_6581_curve < 0.0)
+		{
+			Logging::instance().Warning("Sound.Emulation.6581.FilterCurve %f is lower than 0.0 Limiting to 0.0", filter_6581_curve);
+			filter_6581_curve = 0.0;
+		}
+		if (filter_6581_curve > 1.0)
+		{
+			Logging::instance().Warning("Sound.Emulation.6581.FilterCurve %f is higher than 1.0. Limiting to 1.0", filter_6581_curve);
+			filter_6581_curve = 1.0;
+		}
+
+		m_dFilter6581Curve = filter_6581_curve;
+		m_dFilter8580Curve = filter_8580_curve;
+
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			ConfigureSID(m_apSID[i]);
+
+		ConfigureVoiceTaps();
+
+		Logging::instance().Info("Sound.Emulation.6581.FilterCurve set to %f", filter_6581_curve);
+		Logging::instance().Info("Sound.Emulation.8580.FilterCurve set to %f", filter_8580_curve);
+
+		if (m_sConfiguration.m_bClockInParallel && m_sConfiguration.m_nSIDCount > 1)
+			StartClockThreads();
+	}
+
+	void SIDProxy::ChangeModel(SIDModel eModel)
+	{
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
+
+		m_sConfiguration.m_eModel = eModel;
+
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			m_apSID[i]->setChipModel(eModel == SID_MODEL_6581 ? reSIDfp::ChipModel::MOS6581 : reSIDfp::ChipModel::MOS8580);
+	}
+
+	void SIDProxy::ConfigureSID(reSIDfp::SID* pSID) const
+	{
+		using namespace reSIDfp;
+
+		// The resampler needs the passband below half the sample frequency, so it is lowered for sample frequencies
+		// below 44 kHz (as libsidplayfp does)
+		const double dSampleFrequency = static_cast<double>(m_sConfiguration.m_nSampleFrequency);
+		const double passband = dSampleFrequency > 44000.0 ? 20000.0 : dSampleFrequency * 0.45;
+
+		// Reset the sid
+		pSID->reset();
+
+		pSID->setSamplingParameters(
+			static_cast<double>(m_sConfiguration.m_eEnvironment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SECOND_PAL : EMULATION_CYCLES_PER_SECOND_NTSC),
+			m_sConfiguration.m_eSampleMethod != SIDSampleMethod::SID_SAMPLE_METHOD_RESAMPLE_INTERPOLATE ? SamplingMethod::DECIMATE : SamplingMethod::RESAMPLE,
+			dSampleFrequency,
+			passband);
+
+		pSID->setChipModel(m_sConfiguration.m_eModel == SID_MODEL_6581 ? ChipModel::MOS6581 : ChipModel::MOS8580);
+		pSID->setFilter8580Curve(m_dFilter8580Curve);
+		pSID->setFilter6581Curve(m_dFilter6581Curve);
+	}
+
+	void SIDProxy::ConfigureVoiceTaps()
+	{
+		const double dCyclesPerSecond = m_sConfiguration.m_eEnvironment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SECOND_PAL : EMULATION_CYCLES_PER_SECOND_NTSC;
+
+		for (int i = 0; i < SID_MAX_COUNT; ++i)
+		{
+			const bool bHasVoiceTap = m_nVoiceTapSampleFrequency > 0 && i < m_sConfiguration.m_nSIDCount;
 
-			m_pSID->setChipModel(m_sConfiguration.m_eModel == SID_MODEL_6581 ? ChipModel::MOS6581 : ChipModel::MOS8580);
-			m_pSID->setFilter8580Curve(filter_8580_curve);
-			m_pSID->setFilter6581Curve(filter_6581_curve);
+			// The tap sums the cycles of a sample, the clock frequency can change with the environment
+			m_apVoiceTap[i] = bHasVoiceTap ? std::make_unique<reSIDfp::VoiceTap>(dCyclesPerSecond, static_cast<double>(m_nVoiceTapSampleFrequency)) : nullptr;
 
-			Logging::instance().Info("Sound.Emulation.6581.FilterCurve set to %f", filter_6581_curve);
-			Logging::instance().Info("Sound.Emulation.8580.FilterCurve set to %f", filter_8580_curve);
+			// Half a second of samples, for a reader that only reads once in a while
+			if (!bHasVoiceTap)
+				m_apVoiceTapRingBuffer[i] = nullptr;
+			else if (m_apVoiceTapRingBuffer[i] == nullptr)
+				m_apVoiceTapRingBuffer[i] = std::make_unique<TSPSCRingBuffer<short>>(static_cast<unsigned int>(m_nVoiceTapSampleFrequency / 2) * 3);
+
+			if (m_apSID[i] != nullptr)
+				m_apSID[i]->setVoiceTap(m_bVoiceTapsSuspended ? nullptr : m_apVoiceTap[i].get());
 		}
 	}
 
 	//------------------------------------------------------------------------------------------------------------
 
-	void SIDProxy::StartRecordToFile(const std::string& inFileName)
+	void SIDProxy::SetVoiceTapSampleFrequency(int nSampleFrequency)
 	{
-		FOUNDATION_ASSERT(m_FileName.empty());
-		m_FileName = inFileName;
+		FOUNDATION_ASSERT(nSampleFrequency == 0 || nSampleFrequency >= 1000);
+
+		if (nSampleFrequency != m_nVoiceTapSampleFrequency)
+		{
+			m_nVoiceTapSampleFrequency = nSampleFrequency;
+
+			// Samples of the previous sample frequency are dropped
+			for (auto& pRingBuffer : m_apVoiceTapRingBuffer)
+				pRingBuffer = nullptr;
+
+			ConfigureVoiceTaps();
+		}
 	}
 
-	void SIDProxy::StopRecordToFile()
+	int SIDProxy::GetVoiceTapSampleFrequency() const
+	{
+		return m_nVoiceTapSampleFrequency;
+	}
+
+	unsigned int SIDProxy::GetVoiceTapReadAvailable(int nSIDIndex) const
+	{
+		FOUNDATION_ASSERT(nSIDIndex >= 0 && nSIDIndex < SID_MAX_COUNT);
+
+		const TSPSCRingBuffer<short>* pRingBuffer = m_apVoiceTapRingBuffer[nSIDIndex].get();
+		return pRingBuffer != nullptr ? pRingBuffer->GetReadAvailable() / 3 : 0;
+	}
+
+	unsigned int SIDProxy::ReadVoiceTap(int nSIDIndex, short* pBuffer, unsigned int nSampleCount)
+	{
+		FOUNDATION_ASSERT(nSIDIndex >= 0 && nSIDIndex < SID_MAX_COUNT);
+
+		TSPSCRingBuffer<short>* pRingBuffer = m_apVoiceTapRingBuffer[nSIDIndex].get();
+		return pRingBuffer != nullptr ? pRingBuffer->Read(pBuffer, nSampleCount * 3) / 3 : 0;
+	}
+
+	void SIDProxy::DiscardVoiceTap(int nSIDIndex)
 	{
-		FOUNDATION_ASSERT(!m_FileName.empty());
+		FOUNDATION_ASSERT(nSIDIndex >= 0 && nSIDIndex < SID_MAX_COUNT);
+
+		if (m_apVoiceTapRingBuffer[nSIDIndex] != nullptr)
+			m_apVoiceTapRingBuffer[nSIDIndex]->Discard();
+	}
 
-		if (m_FileOutput.size() > 0)
+	void SIDProxy::SetVoiceTapsSuspended(bool bSuspended)
+	{
+		if (bSuspended != m_bVoiceTapsSuspended)
 		{
-			FILE* file = fopen(m_FileName.c_str(), "wb");
-		
-			struct wave_header
-			{
-				char chunk_id[4] = { 'R', 'I', 'F', 'F' };
-				int chunk_size;
-				char format[4] = { 'W', 'A', 'V', 'E' }; 
-				char sub_chunk1_id[4] = { 'f', 'm', 't', ' ' };
-				int sub_chunk1_size;
-				short audio_format = 1;
-				short num_channels = 1;			//    Mono = 1, Stereo = 2, etc.
-				int sample_rate = 44100;		//      8000, 44100, etc.
-				int byte_rate = 88200;			//== SampleRate * NumChannels * BitsPerSample / 8
-				short block_align = 2;			// == NumChannels * BitsPerSample / 8
-				short bits_per_sample = 16;		//    8 bits = 8, 16 bits = 16, etc.
-				char sub_chunk2_id[4] = { 'd', 'a', 't', 'a' };
-				int sub_chunk2_size;
-			} header;
+			m_bVoiceTapsSuspended = bSuspended;
 
-			const int data_size = static_cast<int>(m_FileOutput.size()) * 2;
-			header.chunk_size = 36 + data_size;
-			header.sub_chunk1_size = 16;
-			header.sub_chunk2_size = data_size;
+			for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+				m_apSID[i]->setVoiceTap(m_bVoiceTapsSuspended ? nullptr : m_apVoiceTap[i].get());
+		}
+	}
 
-			header.sample_rate = m_sConfiguration.m_nSampleFrequency;
-			header.byte_rate = header.block_align * m_sConfiguration.m_nSampleFrequency;
+	//------------------------------------------------------------------------------------------------------------
 
-			fwrite(&header, sizeof(wave_header), 1, file);
+	void SIDProxy::StartRecordToFile(const std::string& inFileName)
+	{
+		FOUNDATION_ASSERT(m_FileOutput == nullptr);
 
-			for (short sample : m_FileOutput)
-				fwrite(&sample, 2, 1, file);
+		m_FileOutput = std::make_unique<WaveFileStreamWriter>(static_cast<unsigned int>(m_sConfiguration.m_nSampleFrequency), static_cast<unsigned short>(m_sConfiguration.m_nOutputChannelCount));
 
-			fclose(file);
+		if (!m_FileOutput->Open(inFileName))
+		{
+			Logging::instance().Warning("Could not open %s for recording", inFileName.c_str());
+			m_FileOutput = nullptr;
 		}
+	}
 
-		m_FileOutput.clear();
-		m_FileName.clear();
+	void SIDProxy::StopRecordToFile()
+	{
+		FOUNDATION_ASSERT(m_FileOutput != nullptr);
+
+		m_FileOutput->Close();
+
+		if (m_FileOutput->GetDroppedSampleCount() > 0)
+			Logging::instance().Warning("Recording dropped %u samples", m_FileOutput->GetDroppedSampleCount());
+
+		m_FileOutput = nullptr;
 	}
 
 	bool SIDProxy::IsRecordingToFile() const
 	{
-		return !m_FileName.empty();
+		return m_FileOutput != nullptr;
 	}
 
 	//------------------------------------------------------------------------------------------------------------
 
 	void SIDProxy::Reset()
 	{
-		FOUNDATION_ASSERT(m_pSID != nullptr);
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
 
-		m_pSID->reset();
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			m_apSID[i]->reset();
 	}
 
-	int SIDProxy::Clock(int& nDeltaCycles, short* pBuffer, int nBufferSize)
+	void SIDProxy::SaveState(SIDProxyState& outState) const
 	{
-		FOUNDATION_ASSERT(m_pSID != nullptr);
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
 
-		// Cast to reSid type
-		unsigned int nInternalDeltaCycles = static_cast<unsigned int>(nDeltaCycles);
+		// The chips of the state must have the same sampling parameters, to copy the state of the resampler
+		if (outState.m_sConfiguration != m_sConfiguration)
+		{
+			for (auto& pSID : outState.m_apSID)
+				pSID = nullptr;
 
-		// Clock
-		int nSamplesWritten = m_pSID->clock(nInternalDeltaCycles, pBuffer/*nBufferSize*/);
+			outState.m_sConfiguration = m_sConfiguration;
+		}
 
-		if (IsRecordingToFile())
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
 		{
-			m_FileOutput.push_back(0);
-			for (int i = 0; i < nSamplesWritten; ++i)
-				m_FileOutput.push_back(pBuffer[i]);
+			if (outState.m_apSID[i] == nullptr)
+			{
+				outState.m_apSID[i] = std::make_unique<reSIDfp::SID>();
+				ConfigureSID(outState.m_apSID[i].get());
+			}
+
+			outState.m_apSID[i]->copyState(*m_apSID[i]);
 		}
+	}
+
+	bool SIDProxy::RestoreState(const SIDProxyState& inState)
+	{
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
+
+		if (inState.IsEmpty() || inState.m_sConfiguration != m_sConfiguration)
+			return false;
+
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			m_apSID[i]->copyState(*inState.m_apSID[i]);
+
+		return true;
+	}
+
+	void SIDProxy::SaveSnapshot(SIDProxySnapshot& outSnapshot) const
+	{
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
 
-		// Cast back to int
-		nDeltaCycles = static_cast<int>(nInternalDeltaCycles);
+		outSnapshot.m_sConfiguration = m_sConfiguration;
+		outSnapshot.m_aSID.resize(m_sConfiguration.m_nSIDCount);
+
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			m_apSID[i]->saveSnapshot(outSnapshot.m_aSID[i]);
+	}
+
+	bool SIDProxy::RestoreSnapshot(const SIDProxySnapshot& inSnapshot)
+	{
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
+
+		if (inSnapshot.IsEmpty() || inSnapshot.m_sConfiguration != m_sConfiguration)
+			return false;
+
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			m_apSID[i]->restoreSnapshot(inSnapshot.m_aSID[i]);
+
+		return true;
+	}
+
+	int SIDProxy::ClockFrame(const std::vector<SIDWrite>& aWrites, int nCycles, short* pBuffer, int nBufferSize)
+	{
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
+
+		// A driver exceeding the cycle window may write after the end of the frame, which extends the frame for all chips
+		if (!aWrites.empty())
+			nCycles = std::max(nCycles, aWrites.back().m_iCycle);
+
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			m_aSIDWrites[i].clear();
+
+		for (const SIDWrite& write : aWrites)
+		{
+			FOUNDATION_ASSERT(write.m_ucSIDIndex < m_sConfiguration.m_nSIDCount);
+			FOUNDATION_ASSERT(m_aSIDWrites[write.m_ucSIDIndex].empty() || static_cast<unsigned int>(write.m_iCycle) >= m_aSIDWrites[write.m_ucSIDIndex].back().cycle);
+
+			m_aSIDWrites[write.m_ucSIDIndex].push_back({ static_cast<unsigned int>(write.m_iCycle), write.m_ucReg, write.m_ucValue });
+		}
+
+		if (m_apVoiceTap[0] != nullptr && !m_bVoiceTapsSuspended)
+		{
+			const double dCyclesPerSecond = m_sConfiguration.m_eEnvironment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SECOND_PAL : EMULATION_CYCLES_PER_SECOND_NTSC;
+			const size_t uiVoiceTapOutputSize = (static_cast<size_t>(static_cast<double>(nCycles) * m_nVoiceTapSampleFrequency / dCyclesPerSecond) + 4) * 3;
+
+			for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			{
+				if (m_aVoiceTapOutput[i].size() < uiVoiceTapOutputSize)
+					m_aVoiceTapOutput[i].resize(uiVoiceTapOutputSize);
+
+				m_apVoiceTap[i]->setBuffer(&m_aVoiceTapOutput[i][0], static_cast<unsigned int>(uiVoiceTapOutputSize / 3));
+			}
+		}
+
+		int nSamplesWritten = 0;
+
+		if (m_sConfiguration.m_nSIDCount == 1 && m_sConfiguration.m_nOutputChannelCount == 1)
+			nSamplesWritten = ClockSID(0, nCycles, pBuffer);
+		else
+		{
+			const double dCyclesPerSecond = m_sConfiguration.m_eEnvironment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SECOND_PAL : EMULATION_CYCLES_PER_SECOND_NTSC;
+			const size_t uiSIDOutputSize = static_cast<size_t>(static_cast<double>(nCycles) * m_sConfiguration.m_nSampleFrequency / dCyclesPerSecond) + 4;
+
+			for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+			{
+				if (m_aSIDOutput[i].size() < uiSIDOutputSize)
+					m_aSIDOutput[i].resize(uiSIDOutputSize);
+			}
+
+			if (!m_aClockThreads.empty())
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_ClockMutex);
+
+					m_nClockCycles = nCycles;
+					m_nClockThreadsBusy = static_cast<int>(m_aClockThreads.size());
+					++m_uiClockGeneration;
+				}
+
+				m_ClockStart.notify_all();
+
+				m_anSIDSampleCount[0] = ClockSID(0, nCycles, &m_aSIDOutput[0][0]);
+
+				std::unique_lock<std::mutex> lock(m_ClockMutex);
+				m_ClockDone.wait(lock, [this]() { return m_nClockThreadsBusy == 0; });
+			}
+			else
+			{
+				for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+					m_anSIDSampleCount[i] = ClockSID(i, nCycles, &m_aSIDOutput[i][0]);
+			}
+
+			// All chips are clocked with the same settings for the same number of cycles, so they produce the same number of samples
+			const int nSampleCount = m_anSIDSampleCount[0];
+
+			for (int i = 1; i < m_sConfiguration.m_nSIDCount; ++i)
+				FOUNDATION_ASSERT(m_anSIDSampleCount[i] == nSampleCount);
+
+			FOUNDATION_ASSERT(nSampleCount * m_sConfiguration.m_nOutputChannelCount <= nBufferSize);
+
+			MixSIDOutput(nSampleCount, pBuffer);
+			nSamplesWritten = nSampleCount * m_sConfiguration.m_nOutputChannelCount;
+		}
+
+		if (m_FileOutput != nullptr && nSamplesWritten > 0)
+			m_FileOutput->Write(pBuffer, static_cast<unsigned int>(nSamplesWritten));
 
 		// Return number of samples written!
 		return nSamplesWritten;
 	}
 
-	void SIDProxy::Write(unsigned char ucReg, unsigned char ucValue)
+	//------------------------------------------------------------------------------------------------------------
+
+	void SIDProxy::ClockFrameSilent(const std::vector<SIDWrite>& aWrites, int nCycles)
+	{
+		FOUNDATION_ASSERT(m_apSID[0] != nullptr);
+
+		if (!aWrites.empty())
+			nCycles = std::max(nCycles, aWrites.back().m_iCycle);
+
+		int anCycle[SID_MAX_COUNT] = { 0 };
+
+		for (const SIDWrite& write : aWrites)
+		{
+			FOUNDATION_ASSERT(write.m_ucSIDIndex < m_sConfiguration.m_nSIDCount);
+
+			reSIDfp::SID* pSID = m_apSID[write.m_ucSIDIndex];
+			int& nCycle = anCycle[write.m_ucSIDIndex];
+
+			if (write.m_iCycle > nCycle)
+			{
+				pSID->clockSilent(static_cast<unsigned int>(write.m_iCycle - nCycle));
+				nCycle = write.m_iCycle;
+			}
+
+			pSID->write(write.m_ucReg, write.m_ucValue);
+		}
+
+		for (int i = 0; i < m_sConfiguration.m_nSIDCount; ++i)
+		{
+			if (nCycles > anCycle[i])
+				m_apSID[i]->clockSilent(static_cast<unsigned int>(nCycles - anCycle[i]));
+		}
+	}
+
+
+	int SIDProxy::ClockSID(int nSIDIndex, int nCycles, short* pBuffer)
 	{
-		FOUNDATION_ASSERT(m_pSID != nullptr);
-		m_pSID->write(static_cast<int>(ucReg), static_cast<unsigned char>(ucValue));
+		const std::vector<reSIDfp::RegisterWrite>& aWrites = m_aSIDWrites[nSIDIndex];
+		const int nSampleCount = m_apSID[nSIDIndex]->clock(aWrites.data(), static_cast<unsigned int>(aWrites.size()), static_cast<unsigned int>(nCycles), pBuffer);
+
+		// A reader that falls behind misses the samples that do not fit
+		reSIDfp::VoiceTap* pVoiceTap = m_apVoiceTap[nSIDIndex].get();
+
+		if (pVoiceTap != nullptr && !m_bVoiceTapsSuspended)
+			m_apVoiceTapRingBuffer[nSIDIndex]->Write(&m_aVoiceTapOutput[nSIDIndex][0], pVoiceTap->getSampleCount() * 3);
+
+		return nSampleCount;
+	}
+
+	void SIDProxy::MixSIDOutput(int nSampleCount, short* pBuffer) const
+	{
+		const short* pSID0 = &m_aSIDOutput[0][0];
+		const short* pSID1 = m_sConfiguration.m_nSIDCount > 1 ? &m_aSIDOutput[1][0] : nullptr;
+		const short* pSID2 = m_sConfiguration.m_nSIDCount > 2 ? &m_aSIDOutput[2][0] : nullptr;
+
+		if (m_sConfiguration.m_nOutputChannelCount == 1)
+		{
+			// Mono: the average of all chips
+			for (int i = 0; i < nSampleCount; ++i)
+			{
+				int nSample = pSID0[i];
+
+				if (pSID1 != nullptr)
+					nSample += pSID1[i];
+				if (pSID2 != nullptr)
+					nSample += pSID2[i];
+
+				pBuffer[i] = static_cast<short>(nSample / m_sConfiguration.m_nSIDCount);
+			}
+		}
+		else
+		{
+			// Stereo: the first chip to the left, the second to the right and the third in the center
+			for (int i = 0; i < nSampleCount; ++i)
+			{
+				int nLeft = pSID0[i];
+				int nRight = pSID1 != nullptr ? pSID1[i] : pSID0[i];
+
+				if (pSID2 != nullptr)
+				{
+					nLeft = (nLeft * 2 + pSID2[i]) / 3;
+					nRight = (nRight * 2 + pSID2[i]) / 3;
+				}
+
+				pBuffer[i * 2] = static_cast<short>(nLeft);
+				pBuffer[i * 2 + 1] = static_cast<short>(nRight);
+			}
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void SIDProxy::StartClockThreads()
+	{
+		FOUNDATION_ASSERT(m_aClockThreads.empty());
+
+		m_bStopClockThreads = false;
+
+		for (int i = 1; i < m_sConfiguration.m_nSIDCount; ++i)
+			m_aClockThreads.push_back(std::thread(&SIDProxy::ClockThread, this, i, m_uiClockGeneration));
+	}
+
+	void SIDProxy::StopClockThreads()
+	{
+		if (m_aClockThreads.empty())
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_ClockMutex);
+			m_bStopClockThreads = true;
+		}
+
+		m_ClockStart.notify_all();
+
+		for (std::thread& thread : m_aClockThreads)
+			thread.join();
+
+		m_aClockThreads.clear();
+	}
+
+	void SIDProxy::ClockThread(int nSIDIndex, unsigned int uiGeneration)
+	{
+		while (true)
+		{
+			int nCycles = 0;
+
+			{
+				std::unique_lock<std::mutex> lock(m_ClockMutex);
+				m_ClockStart.wait(lock, [this, uiGeneration]() { return m_bStopClockThreads || m_uiClockGeneration != uiGeneration; });
+
+				if (m_bStopClockThreads)
+					break;
+
+				uiGeneration = m_uiClockGeneration;
+				nCycles = m_nClockCycles;
+			}
+
+			m_anSIDSampleCount[nSIDIndex] = ClockSID(nSIDIndex, nCycles, &m_aSIDOutput[nSIDIndex][0]);
+
+			{
+				std::lock_guard<std::mutex> lock(m_ClockMutex);
+
+				if (--m_nClockThreadsBusy == 0)
+					m_ClockDone.notify_one();
+			}
+		}
 	}
 }
@@ -1,17 +1,49 @@
 #pragma once
 
 #include "sidproxydefines.h"
-#include <stdio.h>
-#include <vector>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace reSIDfp
 {
 	class SID;
+	class VoiceTap;
+	struct RegisterWrite;
+}
+
+namespace Utility
+{
+	class WaveFileStreamWriter;
+
+	template<typename T>
+	class TSPSCRingBuffer;
 }
 
 namespace Emulation
 {
+	// Copy of the emulation state of the SID chips, which a SID proxy with the same configuration can continue from
+	class SIDProxyState final
+	{
+	public:
+		SIDProxyState();
+		~SIDProxyState();
+
+		bool IsEmpty() const;
+		const SIDConfiguration& GetConfiguration() const;
+
+	private:
+		friend class SIDProxy;
+
+		SIDConfiguration m_sConfiguration;
+		std::unique_ptr<reSIDfp::SID> m_apSID[SID_MAX_COUNT];
+	};
+
+	class SIDProxySnapshot;
+
 	class SIDProxy
 	{
 	public:
@@ -29,9 +61,32 @@ namespace Emulation
 		SIDSampleMethod GetSampleMethod() const;
 		int GetSampleFrequency() const;
 
+		int GetSIDCount() const;
+		unsigned short GetSIDAddress(int nSIDIndex) const;
+		int GetOutputChannelCount() const;
+
+		// Returns the index of the SID chip with the register at the address, or -1 if there is none
+		int GetSIDIndex(unsigned short usAddress) const;
+
 		void SetConfiguration(const SIDConfiguration& sConfiguration);
 		void ApplySettings();
 
+		// Switches the model of the chips without resetting them, they continue from their current state
+		void ChangeModel(SIDModel eModel);
+
+		// Voice taps record the output of each voice of each chip, before the voices are mixed and filtered, at their own
+		// sample frequency, for scopes and for rendering the voices to separate files. A sample frequency of 0 disables
+		// them. The taps can be read on another thread than the one clocking the chips, but only on the thread that
+		// changes the settings. Each sample has three interleaved values, one for each voice
+		void SetVoiceTapSampleFrequency(int nSampleFrequency);
+		int GetVoiceTapSampleFrequency() const;
+		unsigned int GetVoiceTapReadAvailable(int nSIDIndex) const;
+		unsigned int ReadVoiceTap(int nSIDIndex, short* pBuffer, unsigned int nSampleCount);
+		void DiscardVoiceTap(int nSIDIndex);
+
+		// Frames clocked while the taps are suspended, which are not heard, are not recorded
+		void SetVoiceTapsSuspended(bool bSuspended);
+
 		void StartRecordToFile(const std::string& inFileName);
 		void StopRecordToFile();
 		bool IsRecordingToFile() const;
@@ -39,17 +94,66 @@ namespace Emulation
 		// Runtime
 		void Reset();
 
-		int Clock(int& nDeltaCycles, short* pBuffer, int nBufferSize);
-		void Write(unsigned char ucReg, unsigned char ucValue);
+		// Save the emulation state of the SID chips, and restore it later. A state can only be restored with the
+		// configuration it was saved with, otherwise false is returned
+		void SaveState(SIDProxyState& outState) const;
+		bool RestoreState(const SIDProxyState& inState);
+
+		// The same for a compact snapshot of the emulation state
+		void SaveSnapshot(SIDProxySnapshot& outSnapshot) const;
+		bool RestoreSnapshot(const SIDProxySnapshot& inSnapshot);
+
+		// Clocks all SID chips through a frame, applying the writes at their cycles. The writes must be sorted by cycle.
+		// The chips are mixed to the output channels, and the number of samples written to the buffer is returned.
+		int ClockFrame(const std::vector<SIDWrite>& aWrites, int nCycles, short* pBuffer, int nBufferSize);
+
+		// Clocks all SID chips through a frame without audio output, for seeking. Only the waveform and envelope
+		// generators are emulated, the filters keep their state and the resamplers only advance their output phase
+		void ClockFrameSilent(const std::vector<SIDWrite>& aWrites, int nCycles);
 
 	private:
-		std::string m_FileName;
-		std::vector<short> m_FileOutput;
+		void ConfigureSID(reSIDfp::SID* pSID) const;
+		void ConfigureVoiceTaps();
+		int ClockSID(int nSIDIndex, int nCycles, short* pBuffer);
+		void MixSIDOutput(int nSampleCount, short* pBuffer) const;
+
+		void StartClockThreads();
+		void StopClockThreads();
+		void ClockThread(int nSIDIndex, unsigned int uiGeneration);
+
+		std::unique_ptr<Utility::WaveFileStreamWriter> m_FileOutput;
 
 		SIDConfiguration m_sConfiguration;
 
-		reSIDfp::SID* m_pSID;
+		reSIDfp::SID* m_apSID[SID_MAX_COUNT];
+
+		double m_dFilter6581Curve;
+		double m_dFilter8580Curve;
+
+		// Writes of the frame being clocked, for each SID chip. They are passed to the chip in a single call
+		std::vector<reSIDfp::RegisterWrite> m_aSIDWrites[SID_MAX_COUNT];
+
+		// Output of each SID chip, when more than one chip is mixed or the output is stereo
+		std::vector<short> m_aSIDOutput[SID_MAX_COUNT];
+		int m_anSIDSampleCount[SID_MAX_COUNT];
+
+		// Clock threads, one for each SID chip after the first, which is clocked on the calling thread
+		std::vector<std::thread> m_aClockThreads;
+		std::mutex m_ClockMutex;
+		std::condition_variable m_ClockStart;
+		std::condition_variable m_ClockDone;
+		unsigned int m_uiClockGeneration;
+		int m_nClockThreadsBusy;
+		bool m_bStopClockThreads;
+		int m_nClockCycles;
 
 		int m_SampleCounter;
+
+		// Voice taps, with the buffer each chip records a frame into, and the ring buffer the frames are read from
+		int m_nVoiceTapSampleFrequency;
+		bool m_bVoiceTapsSuspended;
+		std::unique_ptr<reSIDfp::VoiceTap> m_apVoiceTap[SID_MAX_COUNT];
+		std::vector<short> m_aVoiceTapOutput[SID_MAX_COUNT];
+		std::unique_ptr<Utility::TSPSCRingBuffer<short>> m_apVoiceTapRingBuffer[SID_MAX_COUNT];
 	};
 }
\ No newline at end of file
@@ -23,6 +23,9 @@ namespace Emulation
 		SID_SAMPLE_METHOD_RESAMPLE_FAST
 	};
 
+	// Maximum number of SID chips emulated at the same time
+	const int SID_MAX_COUNT = 3;
+
 	struct SIDConfiguration
 	{
 		SIDModel m_eModel;
@@ -30,15 +33,54 @@ namespace Emulation
 		SIDSampleMethod m_eSampleMethod;
 		int m_nSampleFrequency;
 
+		int m_nSIDCount;								// Number of SID chips, from 1 to SID_MAX_COUNT
+		unsigned short m_aSIDAddress[SID_MAX_COUNT];	// Base address of each SID chip
+		int m_nOutputChannelCount;						// 1 for mono or 2 for stereo, the samples of a stereo output are interleaved
+		bool m_bClockInParallel;						// Clock the additional SID chips on worker threads
+
 		// Default constructor
 		SIDConfiguration()
 			: m_eModel(SID_MODEL_6581)
 			, m_eEnvironment(SID_ENVIRONMENT_PAL)
 			, m_eSampleMethod(SID_SAMPLE_METHOD_INTERPOLATE)
 			, m_nSampleFrequency(44100)
+			, m_nSIDCount(1)
+			, m_aSIDAddress{ 0xd400, 0xd420, 0xd440 }
+			, m_nOutputChannelCount(1)
+			, m_bClockInParallel(false)
 		{
 
 		}
+
+		// Configurations are the same if they produce the same emulation. Clocking in parallel does not change it
+		bool operator==(const SIDConfiguration& sOther) const
+		{
+			if (m_eModel != sOther.m_eModel || m_eEnvironment != sOther.m_eEnvironment || m_eSampleMethod != sOther.m_eSampleMethod
+				|| m_nSampleFrequency != sOther.m_nSampleFrequency || m_nSIDCount != sOther.m_nSIDCount || m_nOutputChannelCount != sOther.m_nOutputChannelCount)
+				return false;
+
+			for (int i = 0; i < m_nSIDCount && i < SID_MAX_COUNT; ++i)
+			{
+				if (m_aSIDAddress[i] != sOther.m_aSIDAddress[i])
+					return false;
+			}
+
+			return true;
+		}
+
+		bool operator!=(const SIDConfiguration& sOther) const
+		{
+			return !(*this == sOther);
+		}
+	};
+
+	// A write to a SID register, at a cycle within a frame
+	struct SIDWrite
+	{
+		int m_iCycle;
+		unsigned char m_ucSIDIndex;
+		unsigned char m_ucReg;
+		unsigned char m_ucValue;
 	};
 }
 
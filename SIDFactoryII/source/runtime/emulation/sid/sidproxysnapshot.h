@@ -0,0 +1,24 @@
+#pragma once
+
+#include "sidproxydefines.h"
+#include "libraries/residfp/SID.h"
+#include <vector>
+
+namespace Emulation
+{
+	// Compact snapshot of the emulation state of the SID chips, for keeping many of them. It holds none of the tables of
+	// the chip model, and of the resamplers only the output phase, so the chips must be clocked with audio output for a
+	// frame after restoring it, before they are heard
+	class SIDProxySnapshot final
+	{
+	public:
+		bool IsEmpty() const;
+		const SIDConfiguration& GetConfiguration() const;
+
+	private:
+		friend class SIDProxy;
+
+		SIDConfiguration m_sConfiguration;
+		std::vector<reSIDfp::SID::Snapshot> m_aSID;
+	};
+}
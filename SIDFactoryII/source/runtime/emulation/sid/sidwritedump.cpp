@@ -0,0 +1,371 @@
+#include "sidwritedump.h"
+
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES
+#define MINIZ_HEADER_FILE_ONLY
+#include "libraries/miniz/miniz.c"
+
+#include "foundation/base/assert.h"
+#include <string.h>
+
+namespace Emulation
+{
+	namespace
+	{
+		const unsigned int HeaderSize = 0x10;
+		const unsigned char Version = 1;
+		const size_t BufferSize = 0x10000;
+
+		void EncodeHeader(const SIDWriteDumpHeader& inHeader, unsigned char* outData)
+		{
+			memcpy(outData, "SF2W", 4);
+
+			outData[0x04] = Version;
+			outData[0x05] = static_cast<unsigned char>(inHeader.m_Model);
+			outData[0x06] = static_cast<unsigned char>(inHeader.m_Environment);
+			outData[0x07] = static_cast<unsigned char>(inHeader.m_SIDCount);
+
+			for (int i = 0; i < 4; ++i)
+			{
+				outData[0x08 + i] = static_cast<unsigned char>(inHeader.m_CyclesPerFrame >> (i * 8));
+				outData[0x0c + i] = static_cast<unsigned char>(inHeader.m_FrameCount >> (i * 8));
+			}
+		}
+
+		bool DecodeHeader(const unsigned char* inData, SIDWriteDumpHeader& outHeader)
+		{
+			if (memcmp(inData, "SF2W", 4) != 0 || inData[0x04] != Version)
+				return false;
+
+			if (inData[0x05] > SID_MODEL_8580 || inData[0x06] > SID_ENVIRONMENT_NTSC || inData[0x07] == 0 || inData[0x07] > SID_MAX_COUNT)
+				return false;
+
+			outHeader.m_Model = static_cast<SIDModel>(inData[0x05]);
+			outHeader.m_Environment = static_cast<SIDEnvironment>(inData[0x06]);
+			outHeader.m_SIDCount = inData[0x07];
+			outHeader.m_CyclesPerFrame = 0;
+			outHeader.m_FrameCount = 0;
+
+			for (int i = 0; i < 4; ++i)
+			{
+				outHeader.m_CyclesPerFrame |= static_cast<unsigned int>(inData[0x08 + i]) << (i * 8);
+				outHeader.m_FrameCount |= static_cast<unsigned int>(inData[0x0c + i]) << (i * 8);
+			}
+
+			return outHeader.m_CyclesPerFrame > 0;
+		}
+	}
+
+	SIDWriteDumpWriter::SIDWriteDumpWriter()
+		: m_File(nullptr)
+		, m_Stream(nullptr)
+		, m_Header()
+	{
+	}
+
+	SIDWriteDumpWriter::~SIDWriteDumpWriter()
+	{
+		Close();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool SIDWriteDumpWriter::Open(const std::string& inFileName, SIDModel inModel, SIDEnvironment inEnvironment, int inSIDCount, unsigned int inCyclesPerFrame)
+	{
+		FOUNDATION_ASSERT(m_File == nullptr);
+		FOUNDATION_ASSERT(inSIDCount > 0 && inSIDCount <= SID_MAX_COUNT);
+
+		m_File = fopen(inFileName.c_str(), "wb");
+
+		if (m_File == nullptr)
+			return false;
+
+		m_Header = { inModel, inEnvironment, inSIDCount, inCyclesPerFrame, 0 };
+
+		// Write the header without the frame count, it is patched when closing the file
+		unsigned char header[HeaderSize];
+		EncodeHeader(m_Header, header);
+		fwrite(header, 1, HeaderSize, m_File);
+
+		m_Stream = new mz_stream();
+		mz_deflateInit(m_Stream, MZ_DEFAULT_LEVEL);
+
+		memset(m_RegisterValues, 0, sizeof(m_RegisterValues));
+
+		m_InputBuffer.clear();
+		m_InputBuffer.reserve(BufferSize);
+		m_OutputBuffer.resize(BufferSize);
+
+		return true;
+	}
+
+	void SIDWriteDumpWriter::Close()
+	{
+		if (m_File != nullptr)
+		{
+			Deflate(true);
+
+			mz_deflateEnd(m_Stream);
+			delete m_Stream;
+			m_Stream = nullptr;
+
+			unsigned char header[HeaderSize];
+			EncodeHeader(m_Header, header);
+
+			fseek(m_File, 0, SEEK_SET);
+			fwrite(header, 1, HeaderSize, m_File);
+
+			fclose(m_File);
+			m_File = nullptr;
+		}
+	}
+
+	bool SIDWriteDumpWriter::IsOpen() const
+	{
+		return m_File != nullptr;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void SIDWriteDumpWriter::WriteFrame(const std::vector<SIDWrite>& inWrites)
+	{
+		FOUNDATION_ASSERT(m_File != nullptr);
+
+		WriteVarInt(static_cast<unsigned int>(inWrites.size()));
+
+		int previous_cycle = 0;
+
+		for (const SIDWrite& write : inWrites)
+		{
+			FOUNDATION_ASSERT(write.m_iCycle >= previous_cycle);
+			FOUNDATION_ASSERT(write.m_ucSIDIndex < m_Header.m_SIDCount);
+			FOUNDATION_ASSERT(write.m_ucReg < 0x20);
+
+			unsigned char& register_value = m_RegisterValues[write.m_ucSIDIndex][write.m_ucReg];
+
+			WriteVarInt(static_cast<unsigned int>(write.m_iCycle - previous_cycle));
+			WriteByte(static_cast<unsigned char>((write.m_ucSIDIndex << 5) | write.m_ucReg));
+			WriteByte(write.m_ucValue ^ register_value);
+
+			register_value = write.m_ucValue;
+			previous_cycle = write.m_iCycle;
+		}
+
+		++m_Header.m_FrameCount;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void SIDWriteDumpWriter::WriteByte(unsigned char inValue)
+	{
+		m_InputBuffer.push_back(inValue);
+
+		if (m_InputBuffer.size() >= BufferSize)
+			Deflate(false);
+	}
+
+	void SIDWriteDumpWriter::WriteVarInt(unsigned int inValue)
+	{
+		while (inValue >= 0x80)
+		{
+			WriteByte(static_cast<unsigned char>(inValue | 0x80));
+			inValue >>= 7;
+		}
+
+		WriteByte(static_cast<unsigned char>(inValue));
+	}
+
+	void SIDWriteDumpWriter::Deflate(bool inFinish)
+	{
+		m_Stream->next_in = m_InputBuffer.data();
+		m_Stream->avail_in = static_cast<unsigned int>(m_InputBuffer.size());
+
+		for (;;)
+		{
+			m_Stream->next_out = m_OutputBuffer.data();
+			m_Stream->avail_out = static_cast<unsigned int>(m_OutputBuffer.size());
+
+			const int status = mz_deflate(m_Stream, inFinish ? MZ_FINISH : MZ_NO_FLUSH);
+			const size_t output_size = m_OutputBuffer.size() - m_Stream->avail_out;
+
+			if (output_size > 0)
+				fwrite(m_OutputBuffer.data(), 1, output_size, m_File);
+
+			if (status != MZ_OK || (m_Stream->avail_in == 0 && !inFinish))
+				break;
+		}
+
+		m_InputBuffer.clear();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	SIDWriteDumpReader::SIDWriteDumpReader()
+		: m_File(nullptr)
+		, m_Stream(nullptr)
+		, m_IsEndOfStream(false)
+		, m_Header()
+		, m_OutputReadPosition(0)
+		, m_OutputSize(0)
+	{
+	}
+
+	SIDWriteDumpReader::~SIDWriteDumpReader()
+	{
+		Close();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool SIDWriteDumpReader::Open(const std::string& inFileName)
+	{
+		FOUNDATION_ASSERT(m_File == nullptr);
+
+		m_File = fopen(inFileName.c_str(), "rb");
+
+		if (m_File == nullptr)
+			return false;
+
+		unsigned char header[HeaderSize];
+
+		if (fread(header, 1, HeaderSize, m_File) != HeaderSize || !DecodeHeader(header, m_Header))
+		{
+			fclose(m_File);
+			m_File = nullptr;
+
+			return false;
+		}
+
+		m_Stream = new mz_stream();
+		mz_inflateInit(m_Stream);
+
+		m_IsEndOfStream = false;
+
+		memset(m_RegisterValues, 0, sizeof(m_RegisterValues));
+
+		m_InputBuffer.resize(BufferSize);
+		m_OutputBuffer.resize(BufferSize);
+		m_OutputReadPosition = 0;
+		m_OutputSize = 0;
+
+		return true;
+	}
+
+	void SIDWriteDumpReader::Close()
+	{
+		if (m_File != nullptr)
+		{
+			mz_inflateEnd(m_Stream);
+			delete m_Stream;
+			m_Stream = nullptr;
+
+			fclose(m_File);
+			m_File = nullptr;
+		}
+	}
+
+	bool SIDWriteDumpReader::IsOpen() const
+	{
+		return m_File != nullptr;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool SIDWriteDumpReader::ReadFrame(std::vector<SIDWrite>& outWrites)
+	{
+		FOUNDATION_ASSERT(m_File != nullptr);
+
+		outWrites.clear();
+
+		unsigned int write_count = 0;
+
+		if (!ReadVarInt(write_count))
+			return false;
+
+		int cycle = 0;
+
+		for (unsigned int i = 0; i < write_count; ++i)
+		{
+			unsigned int cycle_delta = 0;
+			unsigned char sid_register = 0;
+			unsigned char value = 0;
+
+			if (!ReadVarInt(cycle_delta) || !ReadByte(sid_register) || !ReadByte(value))
+				return false;
+
+			const unsigned char sid_index = sid_register >> 5;
+			const unsigned char reg = sid_register & 0x1f;
+
+			if (sid_index >= m_Header.m_SIDCount)
+				return false;
+
+			unsigned char& register_value = m_RegisterValues[sid_index][reg];
+			register_value ^= value;
+
+			cycle += static_cast<int>(cycle_delta);
+
+			outWrites.push_back({ cycle, sid_index, reg, register_value });
+		}
+
+		return true;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool SIDWriteDumpReader::ReadByte(unsigned char& outValue)
+	{
+		while (m_OutputReadPosition >= m_OutputSize)
+		{
+			if (m_IsEndOfStream)
+				return false;
+
+			if (m_Stream->avail_in == 0)
+			{
+				const size_t read_size = fread(m_InputBuffer.data(), 1, m_InputBuffer.size(), m_File);
+
+				// The file ended before the end of the stream
+				if (read_size == 0)
+					return false;
+
+				m_Stream->next_in = m_InputBuffer.data();
+				m_Stream->avail_in = static_cast<unsigned int>(read_size);
+			}
+
+			m_Stream->next_out = m_OutputBuffer.data();
+			m_Stream->avail_out = static_cast<unsigned int>(m_OutputBuffer.size());
+
+			const int status = mz_inflate(m_Stream, MZ_NO_FLUSH);
+
+			if (status == MZ_STREAM_END)
+				m_IsEndOfStream = true;
+			else if (status != MZ_OK && status != MZ_BUF_ERROR)
+				return false;
+
+			m_OutputReadPosition = 0;
+			m_OutputSize = m_OutputBuffer.size() - m_Stream->avail_out;
+		}
+
+		outValue = m_OutputBuffer[m_OutputReadPosition++];
+
+		return true;
+	}
+
+	bool SIDWriteDumpReader::ReadVarInt(unsigned int& outValue)
+	{
+		outValue = 0;
+
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			unsigned char value = 0;
+
+			if (!ReadByte(value))
+				return false;
+
+			outValue |= static_cast<unsigned int>(value & 0x7f) << shift;
+
+			if ((value & 0x80) == 0)
+				return true;
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "sidproxydefines.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+struct mz_stream_s;
+
+namespace Emulation
+{
+	// A SID write dump holds every write to the SID chips of a song, frame by frame, so the song can be played into a
+	// SID proxy without running the driver on the 6510.
+	//
+	// The file starts with a header of 16 bytes, little endian:
+	//
+	//   0x00  "SF2W"
+	//   0x04  Version
+	//   0x05  SID model
+	//   0x06  Environment
+	//   0x07  Number of SID chips
+	//   0x08  Cycles per frame, 32 bits
+	//   0x0c  Number of frames, 32 bits. Written when the dump is closed
+	//
+	// It is followed by a zlib stream holding each frame as:
+	//
+	//   Number of writes in the frame, varint
+	//   For each write:
+	//     Cycles since the previous write in the frame, or since the start of the frame for the first, varint
+	//     SID index << 5 | register
+	//     Value xor'ed with the previous value written to the same register
+	//
+	// Varints are stored 7 bits per byte, least significant first, with bit 7 set on all but the last byte.
+	struct SIDWriteDumpHeader
+	{
+		SIDModel m_Model;
+		SIDEnvironment m_Environment;
+		int m_SIDCount;
+		unsigned int m_CyclesPerFrame;
+		unsigned int m_FrameCount;
+	};
+
+	class SIDWriteDumpWriter final
+	{
+	public:
+		SIDWriteDumpWriter();
+		~SIDWriteDumpWriter();
+
+		bool Open(const std::string& inFileName, SIDModel inModel, SIDEnvironment inEnvironment, int inSIDCount, unsigned int inCyclesPerFrame);
+		void Close();
+		bool IsOpen() const;
+
+		void WriteFrame(const std::vector<SIDWrite>& inWrites);
+
+		unsigned int GetWrittenFrameCount() const { return m_Header.m_FrameCount; }
+
+	private:
+		void WriteByte(unsigned char inValue);
+		void WriteVarInt(unsigned int inValue);
+		void Deflate(bool inFinish);
+
+		FILE* m_File;
+		mz_stream_s* m_Stream;
+
+		SIDWriteDumpHeader m_Header;
+		unsigned char m_RegisterValues[SID_MAX_COUNT][0x20];
+
+		std::vector<unsigned char> m_InputBuffer;
+		std::vector<unsigned char> m_OutputBuffer;
+	};
+
+	class SIDWriteDumpReader final
+	{
+	public:
+		SIDWriteDumpReader();
+		~SIDWriteDumpReader();
+
+		// Returns false if the file could not be read or is not a SID write dump
+		bool Open(const std::string& inFileName);
+		void Close();
+		bool IsOpen() const;
+
+		// The frame count is 0 if the dump was not closed when writing it
+		const SIDWriteDumpHeader& GetHeader() const { return m_Header; }
+
+		// Returns false at the end of the dump, or if the data is broken
+		bool ReadFrame(std::vector<SIDWrite>& outWrites);
+
+	private:
+		bool ReadByte(unsigned char& outValue);
+		bool ReadVarInt(unsigned int& outValue);
+
+		FILE* m_File;
+		mz_stream_s* m_Stream;
+		bool m_IsEndOfStream;
+
+		SIDWriteDumpHeader m_Header;
+		unsigned char m_RegisterValues[SID_MAX_COUNT][0x20];
+
+		std::vector<unsigned char> m_InputBuffer;
+		std::vector<unsigned char> m_OutputBuffer;
+		size_t m_OutputReadPosition;
+		size_t m_OutputSize;
+	};
+}
@@ -0,0 +1,22 @@
+#if !defined(__EMULATIONSTATE_H__)
+#define __EMULATIONSTATE_H__
+
+#include "runtime/emulation/cpumos6510.h"
+#include "runtime/emulation/sid/sidproxysnapshot.h"
+#include <vector>
+
+namespace Emulation
+{
+	// State of the emulation between two frames, which playback can continue from. The SID chips must be clocked with
+	// audio output for a frame after restoring it, before they are heard, which a seek from the state does
+	struct EmulationState
+	{
+		unsigned int m_FrameIndex;					// Number of frames played since init
+		int m_EventPosition;						// Event position reached by the frames played since init
+		std::vector<unsigned char> m_Memory;		// All of the CPU memory
+		CPUmos6510::Registers m_CPURegisters;
+		SIDProxySnapshot m_SIDSnapshot;
+	};
+}
+
+#endif //__EMULATIONSTATE_H__
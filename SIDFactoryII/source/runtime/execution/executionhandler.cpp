@@ -2,9 +2,11 @@
 
 #include "runtime/emulation/cpuframecapture.h"
 #include "runtime/emulation/cpumos6510.h"
+#include "runtime/emulation/sid/sidaudition.h"
 #include "runtime/emulation/sid/sidproxy.h"
 
 #include "runtime/environmentdefines.h"
+#include "runtime/execution/emulationstate.h"
 #include "runtime/execution/flightrecorder.h"
 
 #include "foundation/base/assert.h"
@@ -14,8 +16,10 @@
 #include "utils/configfile.h"
 #include "utils/logging.h"
 #include "utils/global.h"
+#include "utils/spscringbuffer.h"
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 
 
@@ -45,18 +49,43 @@ namespace Emulation
 		, m_SampleBufferWriteCursor(0)
 		, m_CPUFrameCounter(0)
 		, m_UpdateEnabled(false)
+		, m_FastForwardUpdateCount(0)
+		, m_SeekFrameCount(0)
     , m_ErrorState(false)
+		, m_IsEmulationThreadRunning(false)
+		, m_StopEmulationThread(false)
+		, m_FlushSampleRingBuffer(false)
+		, m_RequestedSampleCount(0)
+		, m_UnderrunCount(0)
+		, m_FrameCycles(0)
+		, m_FrameCyclesClocked(0)
+		, m_FrameSIDWriteIndex(0)
+		, m_LatencyProbeStage(LatencyProbeStage::Idle)
+		, m_LatencyProbeSamplePosition(0)
+		, m_LatencyProbeDeviceSampleCount(0)
 	{
 		m_CyclesPerFrame = EMULATION_CYCLES_PER_FRAME_PAL;
+		m_OutputChannelCount = static_cast<unsigned int>(pSIDProxy->GetOutputChannelCount());
 
 		// Create a sample buffer. The sample frequency is used for determining the size, which is probably 50 times the size required.
-		m_SampleBufferSize = (static_cast<unsigned int>(pSIDProxy->GetSampleFrequency()) << 8);
+		m_SampleBufferSize = (static_cast<unsigned int>(pSIDProxy->GetSampleFrequency()) << 8) * m_OutputChannelCount;
 		m_SampleBuffer = new short[m_SampleBufferSize];
+
+		// Create the ring buffer used by the emulation thread, half a second of audio is plenty. A PAL frame is the longest possible frame.
+		m_MaxFrameSampleCount = (static_cast<unsigned int>(pSIDProxy->GetSampleFrequency()) / 50 + 2) * m_OutputChannelCount;
+		m_SampleRingBuffer = std::make_unique<TSPSCRingBuffer<short>>(std::max((static_cast<unsigned int>(pSIDProxy->GetSampleFrequency()) >> 1) * m_OutputChannelCount, m_MaxFrameSampleCount << 2));
 		m_Mutex = Global::instance().GetPlatform().CreateMutex();
 		m_OutputGain = GetSingleConfigurationValue<Utility::Config::ConfigValueFloat>(Global::instance().GetConfig(), "Sound.Output.Gain", -1.0f);
 
 		Logging::instance().Info("Sound.Output.Gain = %f", m_OutputGain);
 
+		// Slice length of the emulation thread, 0 for whole frames. Slices of very few cycles only add overhead
+		const int slice_cycles = GetSingleConfigurationValue<Utility::Config::ConfigValueInt>(Global::instance().GetConfig(), "Sound.Emulation.SliceCycles", 0);
+		m_SliceCycles = slice_cycles <= 0 ? 0 : static_cast<unsigned int>(std::min(std::max(slice_cycles, 500), static_cast<int>(EMULATION_CYCLES_PER_FRAME_PAL)));
+		m_MaxSliceSampleCount = (static_cast<unsigned int>(static_cast<double>(m_SliceCycles) * pSIDProxy->GetSampleFrequency() / EMULATION_CYCLES_PER_SECOND_PAL) + 2) * m_OutputChannelCount;
+
+		Logging::instance().Info("Sound.Emulation.SliceCycles = %d", m_SliceCycles);
+
 		// Set default action vector
 		m_InitVector = 0x1000;
 		m_StopVector = 0x1003;
@@ -68,6 +97,9 @@ namespace Emulation
 
 	ExecutionHandler::~ExecutionHandler()
 	{
+		StopEmulationThread();
+
+		m_SIDAudition = nullptr;
 		m_Mutex = nullptr;
 
 		if (m_SampleBuffer != nullptr)
@@ -80,6 +112,8 @@ namespace Emulation
 
 	void ExecutionHandler::Start()
 	{
+		Lock();
+
 		if (!m_IsStarted)
 		{
 			m_FeedCount = 0;
@@ -87,29 +121,43 @@ namespace Emulation
 			m_CPUCyclesSpend = 0;
 			m_CPUFrameCounter = 0;
 
+			// The rest of a frame being sliced when the handler was stopped is not played
+			m_FrameCycles = 0;
+			m_FrameCyclesClocked = 0;
+
 			if (m_SIDProxy != nullptr)
+			{
 				m_SIDProxy->Reset();
 
+				if (m_SIDAudition != nullptr)
+					m_SIDAudition->Synchronize(*m_SIDProxy);
+			}
+
 			if (m_SIDRegisterFlightRecorder != nullptr)
-			{
-				m_SIDRegisterFlightRecorder->Lock();
 				m_SIDRegisterFlightRecorder->Reset();
-				m_SIDRegisterFlightRecorder->Unlock();
-			}
 
 			m_IsStarted = true;
 		}
+
+		Unlock();
 	}
 
 	void ExecutionHandler::Stop()
 	{
+		Lock();
+
 		if (m_IsStarted)
 		{
 			m_SampleBufferReadCursor = 0;
 			m_SampleBufferWriteCursor = 0;
 
+			// Samples already produced by the emulation thread must not be played if the handler is started again
+			m_FlushSampleRingBuffer = true;
+
 			m_IsStarted = false;
 		}
+
+		Unlock();
 	}
 
 	//----------------------------------------------------------------------------------------------------------------
@@ -143,49 +191,246 @@ namespace Emulation
 		m_FeedCount++;
 		m_BytesFedCount += inByteCount;
 
-		if (!m_IsStarted)
+		if (m_IsEmulationThreadRunning)
+		{
+			FeedFromSampleRingBuffer(inBuffer, inByteCount);
+		}
+		else if (!m_IsStarted)
 		{
 			memset(inBuffer, 0, inByteCount);
 		}
 		else
 		{
-			unsigned int uiRemainingSamples = (inByteCount >> 1);
+			RenderPCM(inBuffer, inByteCount);
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	// Offline rendering
+	//----------------------------------------------------------------------------------------------------------------
+
+	void ExecutionHandler::RenderPCM(void* outBuffer, unsigned int inByteCount)
+	{
+		FOUNDATION_ASSERT(m_IsStarted);
 
-			short* pSource = static_cast<short*>(m_SampleBuffer);
-			short* pTarget = static_cast<short*>(inBuffer);
+		unsigned int uiRemainingSamples = (inByteCount >> 1);
 
-			while (uiRemainingSamples > 0)
+		short* pSource = static_cast<short*>(m_SampleBuffer);
+		short* pTarget = static_cast<short*>(outBuffer);
+
+		while (uiRemainingSamples > 0)
+		{
+			FOUNDATION_ASSERT(m_SampleBufferReadCursor <= m_SampleBufferWriteCursor);
+
+			if (m_SampleBufferReadCursor >= m_SampleBufferWriteCursor)
 			{
-				FOUNDATION_ASSERT(m_SampleBufferReadCursor <= m_SampleBufferWriteCursor);
+				// Capture a single frame of audio
+				CaptureNewFrame();
+			}
 
-				if (m_SampleBufferReadCursor >= m_SampleBufferWriteCursor)
-				{
-					// Capture a single frame of audio
-					CaptureNewFrame();
-				}
+			const unsigned int uiRemainingSourceSamples = m_SampleBufferWriteCursor - m_SampleBufferReadCursor;
+			const unsigned int uiSamplesToCopy = uiRemainingSamples > uiRemainingSourceSamples ? uiRemainingSourceSamples : uiRemainingSamples;
+
+			ApplyOutputGain(pSource + m_SampleBufferReadCursor, pTarget, uiSamplesToCopy);
+
+			// Forward the read cursor
+			m_SampleBufferReadCursor += uiSamplesToCopy;
 
-				const unsigned int uiRemainingSourceSamples = m_SampleBufferWriteCursor - m_SampleBufferReadCursor;
-				const unsigned int uiSamplesToCopy = uiRemainingSamples > uiRemainingSourceSamples ? uiRemainingSourceSamples : uiRemainingSamples;
+			// Forward the target pointer
+			pTarget += uiSamplesToCopy;
+
+			// Decrement the remaining number of samples
+			uiRemainingSamples -= uiSamplesToCopy;
+		}
+	}
+
+	void ExecutionHandler::ApplyOutputGain(const short* inSource, short* outTarget, unsigned int inSampleCount) const
+	{
+		for (unsigned int i = 0; i < inSampleCount; ++i)
+		{
+			const float fSample = static_cast<float>(inSource[i]) * m_OutputGain;
+			const float fClampedSample = fmin(sampleCeiling, fmax(fSample, sampleFloor));
+			outTarget[i] = static_cast<short>(fClampedSample);
+		}
+	}
+
+	//----------------------------------------------------------------------------------------------------------------
+	// Emulation thread
+	//----------------------------------------------------------------------------------------------------------------
+
+	void ExecutionHandler::StartEmulationThread()
+	{
+		if (!m_IsEmulationThreadRunning)
+		{
+			m_StopEmulationThread = false;
+			m_EmulationThread = std::thread(&ExecutionHandler::EmulationThread, this);
+
+			m_IsEmulationThreadRunning = true;
+		}
+	}
+
+	void ExecutionHandler::StopEmulationThread()
+	{
+		if (m_IsEmulationThreadRunning)
+		{
+			m_StopEmulationThread = true;
+			m_EmulationThreadWakeUp.notify_one();
+			m_EmulationThread.join();
+
+			m_IsEmulationThreadRunning = false;
+		}
+	}
+
+	bool ExecutionHandler::IsEmulationThreadRunning() const
+	{
+		return m_IsEmulationThreadRunning;
+	}
+
+	unsigned int ExecutionHandler::GetUnderrunCount() const
+	{
+		return m_UnderrunCount;
+	}
+
+	unsigned int ExecutionHandler::GetOutputChannelCount() const
+	{
+		return m_OutputChannelCount;
+	}
+
+	void ExecutionHandler::FeedFromSampleRingBuffer(void* outBuffer, unsigned int inByteCount)
+	{
+		// Called from the audio callback. Must never wait for a lock, so only the ring buffer is touched here.
+		const unsigned int sample_count = inByteCount >> 1;
+		short* target = static_cast<short*>(outBuffer);
+
+		if (m_FlushSampleRingBuffer)
+		{
+			m_SampleRingBuffer->Discard();
+			m_FlushSampleRingBuffer = false;
+		}
 
-				for (unsigned int i = 0; i < uiSamplesToCopy; ++i)
+		unsigned int samples_read = 0;
+
+		if (m_IsStarted)
+		{
+			samples_read = m_SampleRingBuffer->Read(target, sample_count);
+			ApplyOutputGain(target, target, samples_read);
+
+			if (samples_read < sample_count)
+				++m_UnderrunCount;
+
+			if (m_LatencyProbeStage == LatencyProbeStage::Waiting)
+			{
+				// Samples ahead of the first sample of the note, negative if it has been read
+				const int samples_ahead = static_cast<int>(m_LatencyProbeSamplePosition - m_SampleRingBuffer->GetReadPosition());
+
+				if (samples_ahead < 0)
 				{
-					const float fSample = static_cast<float>(pSource[i + m_SampleBufferReadCursor]) * m_OutputGain;
-					const float fClampedSample = fmin(sampleCeiling, fmax(fSample, sampleFloor));
-					pTarget[i] = static_cast<short>(fClampedSample);
+					LatencyProbeStage expected = LatencyProbeStage::Waiting;
+
+					// A note that was discarded by a flush of the ring buffer was never heard
+					if (samples_ahead + static_cast<int>(samples_read) < 0)
+						m_LatencyProbeStage.compare_exchange_strong(expected, LatencyProbeStage::Idle);
+					else
+					{
+						// The samples before the note in this buffer are played first
+						m_LatencyProbeOutputTime = std::chrono::steady_clock::now();
+						m_LatencyProbeDeviceSampleCount = sample_count + samples_read + samples_ahead;
+						m_LatencyProbeStage.compare_exchange_strong(expected, LatencyProbeStage::Done);
+					}
 				}
+			}
+		}
 
-				// Forward the read cursor
-				m_SampleBufferReadCursor += uiSamplesToCopy;
+		memset(target + samples_read, 0, (sample_count - samples_read) * sizeof(short));
 
-				// Forward the target pointer
-				pTarget += uiSamplesToCopy;
+		// Let the emulation thread know how much was consumed, so it can stay ahead
+		m_RequestedSampleCount = sample_count;
+		m_EmulationThreadWakeUp.notify_one();
+	}
+
+	void ExecutionHandler::EmulationThread()
+	{
+		// Keep twice the amount of samples requested by the last audio callback in the ring buffer, but at least a single frame,
+		// or a single slice when the frames are sliced. Until the first callback a frame is kept, as its size is not known yet
+		const unsigned int max_target_sample_count = m_SampleRingBuffer->GetCapacity() - m_MaxFrameSampleCount;
+		const unsigned int min_target_sample_count = m_SliceCycles > 0 ? m_MaxSliceSampleCount : m_MaxFrameSampleCount;
+
+		while (!m_StopEmulationThread)
+		{
+			bool has_captured_frame = false;
+
+			Lock();
+
+			const unsigned int requested_sample_count = m_RequestedSampleCount;
+			const unsigned int target_sample_count = requested_sample_count == 0 ? m_MaxFrameSampleCount : std::min(std::max(requested_sample_count << 1, min_target_sample_count), max_target_sample_count);
+
+			if (m_IsStarted && !m_FlushSampleRingBuffer && m_SampleRingBuffer->GetReadAvailable() < target_sample_count)
+			{
+				if (m_SliceCycles > 0)
+					ProduceSlice();
+				else
+					CaptureNewFrame();
 
-				// Decrement the remaining number of samples
-				uiRemainingSamples -= uiSamplesToCopy;
+				const unsigned int samples_written = m_SampleRingBuffer->Write(m_SampleBuffer, m_SampleBufferWriteCursor);
+				FOUNDATION_ASSERT(samples_written == m_SampleBufferWriteCursor);
+
+				m_SampleBufferReadCursor = m_SampleBufferWriteCursor;
+				has_captured_frame = true;
+			}
+
+			Unlock();
+
+			if (!has_captured_frame)
+			{
+				std::unique_lock<std::mutex> lock(m_EmulationThreadMutex);
+				m_EmulationThreadWakeUp.wait_for(lock, std::chrono::milliseconds(1));
 			}
 		}
 	}
 
+	//----------------------------------------------------------------------------------------------------------------
+	// Latency probe
+	//----------------------------------------------------------------------------------------------------------------
+
+	void ExecutionHandler::ArmLatencyProbe()
+	{
+		if (!m_IsEmulationThreadRunning)
+			return;
+
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		const LatencyProbeStage stage = m_LatencyProbeStage;
+
+		if (stage != LatencyProbeStage::Idle && stage != LatencyProbeStage::Done && now - m_LatencyProbeKeyTime < std::chrono::seconds(1))
+			return;
+
+		m_LatencyProbeKeyTime = now;
+		m_LatencyProbeStage = LatencyProbeStage::Armed;
+	}
+
+	void ExecutionHandler::MarkLatencyProbe()
+	{
+		LatencyProbeStage expected = LatencyProbeStage::Armed;
+
+		if (m_LatencyProbeStage.compare_exchange_strong(expected, LatencyProbeStage::Marked))
+			m_LatencyProbeUpdateTime = std::chrono::steady_clock::now();
+	}
+
+	bool ExecutionHandler::GetLatencyProbeResult(LatencyProbeResult& outResult)
+	{
+		if (m_LatencyProbeStage != LatencyProbeStage::Done)
+			return false;
+
+		using milliseconds = std::chrono::duration<float, std::milli>;
+
+		outResult.m_KeyToUpdate = milliseconds(m_LatencyProbeUpdateTime - m_LatencyProbeKeyTime).count();
+		outResult.m_UpdateToOutput = milliseconds(m_LatencyProbeOutputTime - m_LatencyProbeUpdateTime).count();
+		outResult.m_DeviceLatency = 1000.0f * static_cast<float>(m_LatencyProbeDeviceSampleCount / m_OutputChannelCount) / static_cast<float>(m_SIDProxy->GetSampleFrequency());
+
+		m_LatencyProbeStage = LatencyProbeStage::Idle;
+
+		return true;
+	}
+
 	//----------------------------------------------------------------------------------------------------------------
 	// Lock and unlock
 	//----------------------------------------------------------------------------------------------------------------
@@ -210,6 +455,55 @@ namespace Emulation
 	}
 
 
+	void ExecutionHandler::SetSIDModelAudition(bool inEnabled)
+	{
+		FOUNDATION_ASSERT(m_SIDProxy != nullptr);
+
+		Lock();
+
+		if (!inEnabled)
+			m_SIDAudition = nullptr;
+		else if (m_SIDAudition == nullptr)
+		{
+			const SIDModel other_model = m_SIDProxy->GetModel() == SID_MODEL_6581 ? SID_MODEL_8580 : SID_MODEL_6581;
+			m_SIDAudition = std::make_unique<SIDAudition>(*m_SIDProxy, std::vector<SIDModel>({ other_model }));
+		}
+
+		Unlock();
+	}
+
+
+	bool ExecutionHandler::IsSIDModelAuditionEnabled() const
+	{
+		return m_SIDAudition != nullptr;
+	}
+
+
+	bool ExecutionHandler::SwitchAuditionModel(SIDModel inModel)
+	{
+		FOUNDATION_ASSERT(m_SIDProxy != nullptr);
+
+		Lock();
+
+		bool is_switched = m_SIDProxy->GetModel() == inModel;
+
+		if (!is_switched && m_SIDAudition != nullptr)
+		{
+			const int index = m_SIDAudition->FindModel(inModel);
+
+			if (index >= 0)
+			{
+				m_SIDAudition->Exchange(index, *m_SIDProxy);
+				is_switched = true;
+			}
+		}
+
+		Unlock();
+
+		return is_switched;
+	}
+
+
 	//----------------------------------------------------------------------------------------------------------------
 	// Error
 	//----------------------------------------------------------------------------------------------------------------
@@ -288,6 +582,30 @@ namespace Emulation
 	}
 
 
+	void ExecutionHandler::QueueRestoreState(const std::shared_ptr<const EmulationState>& inState)
+	{
+		FOUNDATION_ASSERT(inState != nullptr);
+
+		Lock();
+		m_ActionQueue.push_back({ ActionType::RestoreState, 0, nullptr, inState });
+		Unlock();
+	}
+
+
+	void ExecutionHandler::QueueSeek(unsigned int inMaxFrameCount, const std::function<bool(CPUMemory*)>& inIsSeekDoneCallback)
+	{
+		Lock();
+		m_ActionQueue.push_back({ ActionType::Seek, 0, nullptr, nullptr, inMaxFrameCount, inIsSeekDoneCallback });
+		Unlock();
+	}
+
+
+	bool ExecutionHandler::IsSeeking() const
+	{
+		return m_SeekFrameCount > 0;
+	}
+
+
 	void ExecutionHandler::SetInitVector(unsigned short inVector)
 	{
 		Lock();
@@ -316,6 +634,13 @@ namespace Emulation
 		Unlock();
 	}
 
+	void ExecutionHandler::SetSIDWritesCallback(const std::function<void(const std::vector<SIDWrite>&)>& inSIDWritesCallback)
+	{
+		Lock();
+		m_SIDWritesCallback = inSIDWritesCallback;
+		Unlock();
+	}
+
 	void ExecutionHandler::StartWriteOutputToFile(const std::string& inFilename)
 	{
 		FOUNDATION_ASSERT(m_SIDProxy != nullptr);
@@ -332,6 +657,14 @@ namespace Emulation
 		Unlock();
 	}
 
+	void ExecutionHandler::SetCPUProfiler(CPUProfiler* inCPUProfiler)
+	{
+		FOUNDATION_ASSERT(m_CPU != nullptr);
+		Lock();
+		m_CPU->SetProfiler(inCPUProfiler);
+		Unlock();
+	}
+
 	bool ExecutionHandler::IsWritingOutputToFile() const
 	{
 		FOUNDATION_ASSERT(m_SIDProxy != nullptr);
@@ -361,11 +694,10 @@ namespace Emulation
 
 	//----------------------------------------------------------------------------------------------------------------
 
-	void ExecutionHandler::SimulateSID(int inDeltaCycles)
+	void ExecutionHandler::SimulateSID(const std::vector<SIDWrite>& inWrites, int inCycles)
 	{
 		short* pSampleBuffer = static_cast<short*>(m_SampleBuffer);
 
-		//while (inDeltaCycles > 0)
 		{
 			// Get offset pointer inside the sample buffer
 			short* sample_buffer_write_location = pSampleBuffer + m_SampleBufferWriteCursor;
@@ -373,8 +705,15 @@ namespace Emulation
 			// Calculate remaining samples in the buffer, so that we do not overflow it!
 			const int uiRemainingSamplesInBuffer = m_SampleBufferSize - m_SampleBufferWriteCursor;
 
-			// Clock the sid
-			const int nSamplesWritten = m_SIDProxy->Clock(inDeltaCycles, sample_buffer_write_location, uiRemainingSamplesInBuffer);
+			// Clock the sid chips through the frame, applying the captured writes. The audition chips are clocked
+			// through the same frame on their own threads meanwhile
+			if (m_SIDAudition != nullptr)
+				m_SIDAudition->StartFrame(inWrites, inCycles);
+
+			const int nSamplesWritten = m_SIDProxy->ClockFrame(inWrites, inCycles, sample_buffer_write_location, uiRemainingSamplesInBuffer);
+
+			if (m_SIDAudition != nullptr)
+				m_SIDAudition->FinishFrame();
 
 			// Negative sample count written is invalid!
 			FOUNDATION_ASSERT(nSamplesWritten >= 0);
@@ -389,23 +728,95 @@ namespace Emulation
 
 	void ExecutionHandler::CaptureNewFrame()
 	{
-		FOUNDATION_ASSERT(m_CPU != nullptr);
-
 		// Lock execution handler
 		Lock();
 
-		// Lock memory access
-		m_Memory->Lock();
-
 		// Reset read/write cursor, and run simulation of the SID
 		m_SampleBufferReadCursor = 0;
 		m_SampleBufferWriteCursor = 0;
 
+		// Do all writes to the SID and emulate cycles spend
+		if (CaptureFrame())
+			SimulateSID(m_SIDWrites, static_cast<int>(m_CyclesPerFrame));
+
+		// Unlock execution handler
+		Unlock();
+	}
+
+
+	void ExecutionHandler::ProduceSlice()
+	{
+		Lock();
+
+		m_SampleBufferReadCursor = 0;
+		m_SampleBufferWriteCursor = 0;
+
+		if (m_FrameCyclesClocked >= m_FrameCycles)
+		{
+			if (!CaptureFrame())
+			{
+				Unlock();
+				return;
+			}
+
+			// A driver exceeding the cycle window extends the frame
+			m_FrameCycles = std::max(static_cast<int>(m_CyclesPerFrame), m_SIDWrites.empty() ? 0 : m_SIDWrites.back().m_iCycle);
+			m_FrameCyclesClocked = 0;
+			m_FrameSIDWriteIndex = 0;
+		}
+
+		// Clock the chips to the end of the slice, with the writes of the frame within it at cycles relative to its start.
+		// Writes at the very end of the frame are applied after the last cycle, as when the frame is clocked at once
+		const int slice_end = std::min(m_FrameCyclesClocked + static_cast<int>(m_SliceCycles), m_FrameCycles);
+		const bool is_last_slice = slice_end == m_FrameCycles;
+
+		m_SliceSIDWrites.clear();
+
+		for (; m_FrameSIDWriteIndex < m_SIDWrites.size(); ++m_FrameSIDWriteIndex)
+		{
+			SIDWrite write = m_SIDWrites[m_FrameSIDWriteIndex];
+
+			if (write.m_iCycle >= slice_end && !is_last_slice)
+				break;
+
+			write.m_iCycle -= m_FrameCyclesClocked;
+			m_SliceSIDWrites.push_back(write);
+		}
+
+		SimulateSID(m_SliceSIDWrites, slice_end - m_FrameCyclesClocked);
+
+		m_FrameCyclesClocked = slice_end;
+
+		Unlock();
+	}
+
+
+	bool ExecutionHandler::CaptureFrame()
+	{
+		FOUNDATION_ASSERT(m_CPU != nullptr);
+
+		// The note picked up by the driver in the previous frame is heard from this frame on, which starts at the current
+		// write position of the ring buffer
+		if (m_LatencyProbeStage == LatencyProbeStage::Marked)
+		{
+			LatencyProbeStage expected = LatencyProbeStage::Marked;
+
+			m_LatencyProbeSamplePosition = m_SampleRingBuffer->GetWritePosition();
+			m_LatencyProbeStage.compare_exchange_strong(expected, LatencyProbeStage::Waiting);
+		}
+
+		// Lock memory access
+		m_Memory->Lock();
+
 		// Attach memory to cpu
 		m_CPU->SetMemory(m_Memory);
 
-		// Capture the frame (this will run the CPU )
-		CPUFrameCapture frameCapture(m_CPU, 0xd400, 0xd418, m_CyclesPerFrame);
+		// Capture the frame (this will run the CPU ), with the registers of all sid chips
+		const unsigned short first_sid_address = m_SIDProxy->GetSIDAddress(0);
+		CPUFrameCapture frameCapture(m_CPU, first_sid_address, first_sid_address + 0x18, m_CyclesPerFrame);
+
+		for (int i = 1; i < m_SIDProxy->GetSIDCount(); ++i)
+			frameCapture.AddCaptureRange(m_SIDProxy->GetSIDAddress(i), m_SIDProxy->GetSIDAddress(i) + 0x18);
 
 		// Execute queued actions
 		for (const Action& action : m_ActionQueue)
@@ -414,8 +825,14 @@ namespace Emulation
 			{
 			case ActionType::ApplyMuteState:
 			{
-				const unsigned short offset = action.m_ActionArgument * 7;
-				const unsigned short address = 0xd400 + offset;
+				// Channels of additional sid chips follow the three channels of the first
+				const int sid_index = action.m_ActionArgument / 3;
+
+				if (sid_index >= m_SIDProxy->GetSIDCount())
+					break;
+
+				const unsigned short offset = (action.m_ActionArgument % 3) * 7;
+				const unsigned short address = m_SIDProxy->GetSIDAddress(sid_index) + offset;
 
 				for (int i = 0; i < 7; ++i)
 					frameCapture.Write(address + i, 0, 0);
@@ -423,9 +840,35 @@ namespace Emulation
 			break;
 			case ActionType::ClearMuteAllState:
 				break;
+			case ActionType::RestoreState:
+			{
+				const EmulationState& state = *action.m_State;
+
+				FOUNDATION_ASSERT(state.m_Memory.size() == m_Memory->GetSize());
+
+				m_Memory->SetData(0, state.m_Memory.data(), static_cast<unsigned int>(state.m_Memory.size()));
+				m_CPU->SetRegisters(state.m_CPURegisters);
+
+				// Writes of the actions before the restore must not reach the restored chips
+				frameCapture.DiscardWrites();
+
+				if (!m_SIDProxy->RestoreSnapshot(state.m_SIDSnapshot))
+					Logging::instance().Warning("The SID state to restore was saved with another configuration");
+				else if (m_SIDAudition != nullptr)
+					m_SIDAudition->Synchronize(*m_SIDProxy);
+
+				CancelSeek();
+			}
+			break;
+			case ActionType::Seek:
+				CancelSeek();
+				m_SeekFrameCount = action.m_FrameCount;
+				m_IsSeekDoneCallback = action.m_IsSeekDoneCallback;
+				break;
 			case ActionType::Init:
 			case ActionType::Stop:
 				frameCapture.Capture(GetAddressFromActionType(action.m_ActionType), action.m_ActionArgument);
+				CancelSeek();
 				break;
 			case ActionType::Update:
 				if (!m_ErrorState)
@@ -440,6 +883,19 @@ namespace Emulation
 
 		m_ActionQueue.clear();
 
+		// Play the frames of a seek in progress before this frame. No audio is produced until the seek has ended
+		if (m_SeekFrameCount > 0 && m_UpdateEnabled && !m_ErrorState)
+		{
+			SeekFrames(frameCapture);
+
+			if (m_SeekFrameCount > 0)
+			{
+				m_Memory->Unlock();
+
+				return false;
+			}
+		}
+
 		// Execute driver update, if enabled
 		if (m_UpdateEnabled && !m_ErrorState)
 		{
@@ -483,13 +939,15 @@ namespace Emulation
 		// Increment frame counter
 		m_CPUFrameCounter++;
 
+		// Collect the writes to the SID
+		CollectSIDWrites(frameCapture);
+
+		if (m_SIDWritesCallback)
+			m_SIDWritesCallback(m_SIDWrites);
+
 		// Run the flight recorder
 		if (m_SIDRegisterFlightRecorder != nullptr && m_SIDRegisterFlightRecorder->IsRecording())
-		{
-			m_SIDRegisterFlightRecorder->Lock();
-			m_SIDRegisterFlightRecorder->Record(m_CPUFrameCounter, m_Memory, frameCapture.GetCyclesSpend());
-			m_SIDRegisterFlightRecorder->Unlock();
-		}
+			m_SIDRegisterFlightRecorder->Record(m_CPUFrameCounter, m_Memory, frameCapture.GetCyclesSpend(), m_SIDWrites);
 
 		// Copy sid registers after driver update
 		m_Memory->GetData(0xd400, m_SIDRegisterLastDriverUpdate.m_Buffer, sizeof(m_SIDRegisterLastDriverUpdate.m_Buffer));
@@ -500,33 +958,105 @@ namespace Emulation
 		// Grab the cycle count of the CPU here, as this will be the number of cycles spend on the driver update
 		m_CPUCyclesSpend = frameCapture.GetCyclesSpend();
 
-		// Do all writes to the SID and emulate cycles spend
-		int nCycle = 0;
+		// Reset cycle counter
+		m_CurrentCycle = 0;
+
+		return true;
+	}
+
+
+	void ExecutionHandler::CollectSIDWrites(CPUFrameCapture& inFrameCapture)
+	{
+		m_SIDWrites.clear();
 
-		while (frameCapture.HasNext())
+		while (inFrameCapture.HasNext())
 		{
-			const CPUFrameCapture::WriteCapture& capture = frameCapture.GetNext();
+			const CPUFrameCapture::WriteCapture& capture = inFrameCapture.GetNext();
+			const int sid_index = m_SIDProxy->GetSIDIndex(capture.m_usReg);
 
-			FOUNDATION_ASSERT(nCycle <= capture.m_iCycle);
+			FOUNDATION_ASSERT(sid_index >= 0);
+			FOUNDATION_ASSERT(m_SIDWrites.empty() || m_SIDWrites.back().m_iCycle <= capture.m_iCycle);
 
-			const int deltaCycles = capture.m_iCycle - nCycle;
-			SimulateSID(deltaCycles);
-			m_SIDProxy->Write((unsigned char)(capture.m_usReg & 0xff), capture.m_ucVal);
-			nCycle += deltaCycles;
+			m_SIDWrites.push_back({ capture.m_iCycle, static_cast<unsigned char>(sid_index), static_cast<unsigned char>(capture.m_usReg - m_SIDProxy->GetSIDAddress(sid_index)), capture.m_ucVal });
 		}
+	}
+
 
-		// Do the rest of the frame
-		while (nCycle < (int)m_CyclesPerFrame)
+	void ExecutionHandler::SeekFrames(CPUFrameCapture& ioFrameCapture)
+	{
+		// The first frame also holds the writes of the actions executed before it
+		for (unsigned int i = 0; i < SeekFramesPerCapture && m_SeekFrameCount > 0; ++i)
 		{
-			const int deltaCycles = m_CyclesPerFrame - nCycle;
-			SimulateSID(deltaCycles);
-			nCycle += deltaCycles;
+			if (!ioFrameCapture.IsMaxCycleCountReached())
+				ioFrameCapture.Capture(GetAddressFromActionType(ActionType::Update), 0);
+
+			if (ioFrameCapture.IsMaxCycleCountReached())
+			{
+				m_ErrorState = true;
+				m_ErrorMessage = "Emulation of 6510 code exceeded cycle window!";
+				m_SeekFrameCount = 0;
+
+				break;
+			}
+
+			if (m_PostUpdateCallback)
+				m_PostUpdateCallback(m_Memory);
+
+			CollectSIDWrites(ioFrameCapture);
+			ioFrameCapture.Restart();
+
+			if (m_SeekSettleFrames.size() >= SeekFilterSettleFrameCount)
+			{
+				m_SIDProxy->ClockFrameSilent(m_SeekSettleFrames.front(), static_cast<int>(m_CyclesPerFrame));
+				m_SeekSettleFrames.pop_front();
+			}
+
+			m_SeekSettleFrames.push_back(m_SIDWrites);
+
+			m_CPUFrameCounter++;
+			m_SeekFrameCount--;
+
+			if (m_IsSeekDoneCallback && m_IsSeekDoneCallback(m_Memory))
+				m_SeekFrameCount = 0;
 		}
 
-		// Reset cycle counter
-		m_CurrentCycle = 0;
+		if (m_SeekFrameCount == 0)
+			EndSeek();
+	}
 
-		// Unlock execution handler
-		Unlock();
+
+	void ExecutionHandler::EndSeek()
+	{
+		// The very last frames are clocked with audio output, which is discarded, to settle the filters and resamplers as well.
+		// The voice taps do not record them either. The audition chips continue from the state before these frames and are
+		// clocked through them too, which settles the filter of their own model, as the filter state copied for it was not
+		// clocked by the audible chips
+		if (m_SIDAudition != nullptr)
+			m_SIDAudition->Synchronize(*m_SIDProxy);
+
+		m_SIDProxy->SetVoiceTapsSuspended(true);
+
+		for (const std::vector<SIDWrite>& writes : m_SeekSettleFrames)
+		{
+			if (m_SIDAudition != nullptr)
+				m_SIDAudition->StartFrame(writes, static_cast<int>(m_CyclesPerFrame));
+
+			m_SIDProxy->ClockFrame(writes, static_cast<int>(m_CyclesPerFrame), m_SampleBuffer, static_cast<int>(m_SampleBufferSize));
+
+			if (m_SIDAudition != nullptr)
+				m_SIDAudition->FinishFrame();
+		}
+
+		m_SIDProxy->SetVoiceTapsSuspended(false);
+
+		CancelSeek();
+	}
+
+
+	void ExecutionHandler::CancelSeek()
+	{
+		m_SeekFrameCount = 0;
+		m_IsSeekDoneCallback = nullptr;
+		m_SeekSettleFrames.clear();
 	}
 }
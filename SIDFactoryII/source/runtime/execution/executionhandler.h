@@ -2,14 +2,24 @@
 #define __EXECUTIONHANDLER_H__
 
 #include "foundation/sound/audiostream.h"
+#include "runtime/emulation/sid/sidproxydefines.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace Utility
 {
 	class ConfigFile;
+
+	template<typename T>
+	class TSPSCRingBuffer;
 }
 
 namespace Foundation
@@ -22,8 +32,12 @@ namespace Emulation
 {
 	class CPUmos6510;
 	class CPUMemory;
+	class CPUFrameCapture;
 	class SIDProxy;
+	class SIDAudition;
 	class FlightRecorder;
+	class CPUProfiler;
+	struct EmulationState;
 
 	class ExecutionHandler : public Foundation::IAudioStreamFeeder
 	{
@@ -32,6 +46,16 @@ namespace Emulation
 		{
 			unsigned char m_Buffer[0x200];
 		};
+
+		// Times in milliseconds from a note key press until the note is heard
+		struct LatencyProbeResult
+		{
+			float m_KeyToUpdate;		// Until the driver update that picked up the note
+			float m_UpdateToOutput;		// Until the first sample of the note was handed to the audio device
+			float m_DeviceLatency;		// Estimated time the audio device takes to play the sample, from the buffer size
+
+			float GetTotal() const { return m_KeyToUpdate + m_UpdateToOutput + m_DeviceLatency; }
+		};
 		
 		ExecutionHandler(
 			CPUmos6510* pCPU,
@@ -53,6 +77,30 @@ namespace Emulation
 		virtual void PreFeedPCM(void* inBuffer, unsigned int inByteCount);
 		virtual void FeedPCM(void* inBuffer, unsigned int inByteCount);
 
+		// Offline rendering, runs the emulation on the calling thread until the buffer has been filled
+		void RenderPCM(void* outBuffer, unsigned int inByteCount);
+
+		// Emulation thread. While it is running, frames are produced ahead of time into a sample ring buffer, and
+		// FeedPCM only copies samples from it. Start it before the audio stream is started and stop it after the
+		// audio stream has been stopped.
+		void StartEmulationThread();
+		void StopEmulationThread();
+		bool IsEmulationThreadRunning() const;
+
+		// Number of times the audio callback found too few samples in the ring buffer
+		unsigned int GetUnderrunCount() const;
+
+		// Number of output channels. The samples of all channels are interleaved in the PCM data
+		unsigned int GetOutputChannelCount() const;
+
+		// Latency probe, for the emulation thread. Arm it when a note key is pressed, and mark the driver update that
+		// picked up the note from the post update callback. The note is heard from the next frame, and the result is
+		// available when its first sample has been handed to the audio device. A probe that does not complete within
+		// a second, for example because playback stopped, can be armed again
+		void ArmLatencyProbe();
+		void MarkLatencyProbe();
+		bool GetLatencyProbeResult(LatencyProbeResult& outResult);
+
 		// Lock and unlock
 		void Lock();
 		void Unlock();
@@ -60,6 +108,13 @@ namespace Emulation
 		// Settings
 		void SetPAL(const bool inPALMode);
 
+		// A/B audition of the SID models. While enabled, the other model is emulated alongside the one that is heard,
+		// from the same writes, so switching the model heard is instant and does not reset the chips. Disable it
+		// before the configuration of the SID proxy is changed
+		void SetSIDModelAudition(bool inEnabled);
+		bool IsSIDModelAuditionEnabled() const;
+		bool SwitchAuditionModel(SIDModel inModel);
+
 		// Error
 		bool IsInErrorState() const;
 		std::string GetErrorMessage() const;
@@ -75,11 +130,25 @@ namespace Emulation
 		void QueueMuteChannel(unsigned char inChannel, const std::function<void(CPUMemory*)>& inMuteCallback);
 		void QueueClearAllMuteState(const std::function<void(CPUMemory*)>& inClearMuteStateCallback);
 
+		// Replace the memory, the CPU registers and the state of the SID chips, to continue playback from the state.
+		// Writes to the SID chips by actions queued before it are discarded. A seek queued after it settles the chips
+		// before they are heard
+		void QueueRestoreState(const std::shared_ptr<const EmulationState>& inState);
+
+		// Seek by playing the driver update for many frames per captured frame, without audio output. The seek ends
+		// when the callback returns true after an update, or after the maximum number of frames. Init, stop and restore
+		// state actions cancel a seek in progress
+		void QueueSeek(unsigned int inMaxFrameCount, const std::function<bool(CPUMemory*)>& inIsSeekDoneCallback);
+		bool IsSeeking() const;
+
 		void SetInitVector(unsigned short inVector);
 		void SetStopVector(unsigned short inVector);
 		void SetUpdateVector(unsigned short inVector);
 		void SetPostUpdateCallback(const std::function<void(CPUMemory*)>& inPostUpdateCallback);
 
+		// Called with the writes to the SID chips of every frame with audio output, before the chips are clocked
+		void SetSIDWritesCallback(const std::function<void(const std::vector<SIDWrite>&)>& inSIDWritesCallback);
+
 		// Cycles
 		unsigned int GetCPUCyclesSpendLastFrame() const { return m_CPUCyclesSpend; }
 		unsigned int GetCPUFrameUpdateCount() const { return m_CPUFrameCounter; }
@@ -90,6 +159,9 @@ namespace Emulation
 		// Flight recorder
 		FlightRecorder* GetFlightRecorder() const { return m_SIDRegisterFlightRecorder; }
 
+		// CPU profiler, attached to the CPU while it is set. Pass nullptr to stop profiling
+		void SetCPUProfiler(CPUProfiler* inCPUProfiler);
+
 		// SID registers buffer
 		SIDRegistersBuffer GetSIDRegistersBufferAfterLastDriverUpdate() const { return m_SIDRegisterLastDriverUpdate; }
 
@@ -99,26 +171,51 @@ namespace Emulation
 		bool IsWritingOutputToFile() const;
 
 	private:
+		// Most frames played silently per captured frame while seeking. Clocking the SID chips silently takes about half
+		// a millisecond per frame, so this keeps the lock from being held for much longer than a frame
+		static const unsigned int SeekFramesPerCapture = 25;
+
+		// The SID chips are clocked silently for every frame of a seek, which keeps the oscillators and envelopes exact.
+		// The last frames are clocked with audio output, which is discarded, to settle the filters and refill the sample
+		// history of the resamplers as well
+		static const unsigned int SeekFilterSettleFrameCount = 10;
+
 		enum class ActionType : int
 		{
 			Init,
 			Stop,
 			Update,
 			ApplyMuteState,
-			ClearMuteAllState
+			ClearMuteAllState,
+			RestoreState,
+			Seek
 		};
 
 		struct Action
 		{
-			ActionType m_ActionType;
-			unsigned char m_ActionArgument;
-			std::function<void(CPUMemory*)> m_PostActionCallback;
+			ActionType m_ActionType = ActionType::Init;
+			unsigned char m_ActionArgument = 0;
+			std::function<void(CPUMemory*)> m_PostActionCallback = nullptr;
+			std::shared_ptr<const EmulationState> m_State = nullptr;
+			unsigned int m_FrameCount = 0;
+			std::function<bool(CPUMemory*)> m_IsSeekDoneCallback = nullptr;
 		};
 
 		const unsigned short GetAddressFromActionType(ActionType inActionType) const;
 
-		void SimulateSID(int inDeltaCycles);
+		void SimulateSID(const std::vector<SIDWrite>& inWrites, int inCycles);
 		void CaptureNewFrame();
+		bool CaptureFrame();		// Runs the actions and the driver update of a frame, false while a seek is in progress
+		void ProduceSlice();
+		void CollectSIDWrites(CPUFrameCapture& inFrameCapture);
+		void SeekFrames(CPUFrameCapture& ioFrameCapture);
+		void EndSeek();
+		void CancelSeek();
+
+		void FeedFromSampleRingBuffer(void* outBuffer, unsigned int inByteCount);
+		void ApplyOutputGain(const short* inSource, short* outTarget, unsigned int inSampleCount) const;
+
+		void EmulationThread();
 
 		// Audio stream feeding
 
@@ -134,7 +231,7 @@ namespace Emulation
 		unsigned int m_SampleBufferReadCursor;
 		unsigned int m_SampleBufferWriteCursor;
 
-		bool m_IsStarted;
+		std::atomic<bool> m_IsStarted;
 
 		// Error state
 		bool m_ErrorState;
@@ -147,6 +244,12 @@ namespace Emulation
 		bool m_UpdateEnabled;
 		unsigned int m_FastForwardUpdateCount;
 		std::function<void(CPUMemory*)> m_PostUpdateCallback;
+		std::function<void(const std::vector<SIDWrite>&)> m_SIDWritesCallback;
+
+		// Seek
+		unsigned int m_SeekFrameCount;
+		std::function<bool(CPUMemory*)> m_IsSeekDoneCallback;
+		std::deque<std::vector<SIDWrite>> m_SeekSettleFrames;
 
 		// Driver vectors
 		unsigned short m_InitVector;
@@ -155,6 +258,7 @@ namespace Emulation
 
 		// SID and CPU
 		SIDProxy* m_SIDProxy;
+		std::unique_ptr<SIDAudition> m_SIDAudition;
 		CPUmos6510* m_CPU;
 		CPUMemory* m_Memory;
 
@@ -166,10 +270,53 @@ namespace Emulation
 		// SID Registers last update
 		SIDRegistersBuffer m_SIDRegisterLastDriverUpdate;
 
+		// Writes to the SID chips during the current frame
+		std::vector<SIDWrite> m_SIDWrites;
+
 		// Audio output
 		unsigned int m_SampleBufferSize;
 		short* m_SampleBuffer;
 		float m_OutputGain;
+
+		// Emulation thread
+		std::thread m_EmulationThread;
+		std::atomic<bool> m_IsEmulationThreadRunning;
+		std::atomic<bool> m_StopEmulationThread;
+		std::mutex m_EmulationThreadMutex;
+		std::condition_variable m_EmulationThreadWakeUp;
+
+		std::unique_ptr<Utility::TSPSCRingBuffer<short>> m_SampleRingBuffer;
+		unsigned int m_OutputChannelCount;
+		unsigned int m_MaxFrameSampleCount;
+		std::atomic<bool> m_FlushSampleRingBuffer;
+		std::atomic<unsigned int> m_RequestedSampleCount;
+		std::atomic<unsigned int> m_UnderrunCount;
+
+		// Sub-frame production. With a slice length, the emulation thread clocks the SID chips through each captured
+		// frame in slices of that many cycles, so the ring buffer only has to stay a slice ahead of the audio callback
+		unsigned int m_SliceCycles;
+		unsigned int m_MaxSliceSampleCount;
+		int m_FrameCycles;			// Cycles of the frame being sliced, extended if the driver exceeded the cycle window
+		int m_FrameCyclesClocked;
+		size_t m_FrameSIDWriteIndex;
+		std::vector<SIDWrite> m_SliceSIDWrites;
+
+		// Latency probe
+		enum class LatencyProbeStage : int
+		{
+			Idle,
+			Armed,				// Key pressed
+			Marked,				// Note picked up by the driver
+			Waiting,			// Frame with the note produced, waiting for the audio callback to reach it
+			Done
+		};
+
+		std::atomic<LatencyProbeStage> m_LatencyProbeStage;
+		std::chrono::steady_clock::time_point m_LatencyProbeKeyTime;
+		std::chrono::steady_clock::time_point m_LatencyProbeUpdateTime;
+		std::chrono::steady_clock::time_point m_LatencyProbeOutputTime;
+		unsigned int m_LatencyProbeSamplePosition;
+		unsigned int m_LatencyProbeDeviceSampleCount;
 	};
 }
 
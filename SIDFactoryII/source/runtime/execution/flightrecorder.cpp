@@ -1,46 +1,34 @@
 #include "flightrecorder.h"
 
-#include "foundation/platform/iplatform.h"
-#include "foundation/platform/imutex.h"
 #include "runtime/emulation/cpumemory.h"
-#include <memory>
 #include "foundation/base/assert.h"
+#include <algorithm>
 
 namespace Emulation
 {
 	FlightRecorder::FlightRecorder(Foundation::IPlatform* inPlatform, unsigned int inCapacity)
-		: m_FrameCapacity(inCapacity)
-		, m_Locked(false)
-		, m_IsRecording(false)
-		, m_TopIndex(0)
-		, m_RecordedFrameCount(0)
+		: m_IsRecording(false)
 		, m_DriverSyncAddress(0x0000)
+		, m_DriverTempoCounterAddress(0x0000)
+		, m_RecordCount(0)
+		, m_FirstRecordIndex(0)
+		, m_FrameCapacity(inCapacity)
 	{
-		m_Mutex = inPlatform->CreateMutex();
+		FOUNDATION_ASSERT(m_FrameCapacity > 0);
 
-		m_Frames = new Frame[m_FrameCapacity];
+		m_Slots = new Slot[m_FrameCapacity];
 
 		for (unsigned int i = 0; i < m_FrameCapacity; ++i)
-			m_Frames[i].Reset();
+		{
+			m_Slots[i].m_Sequence = 0;
+			m_Slots[i].m_RecordIndex = 0;
+			m_Slots[i].m_Frame.Reset();
+		}
 	}
 
 	FlightRecorder::~FlightRecorder()
 	{
-		delete[] m_Frames;
-	}
-
-	//------------------------------------------------------------------------------------------------
-
-	void FlightRecorder::Lock()
-	{
-		m_Mutex->Lock();
-		m_Locked = true;
-	}
-
-	void FlightRecorder::Unlock()
-	{
-		m_Locked = false;
-		m_Mutex->Unlock();
+		delete[] m_Slots;
 	}
 
 	//------------------------------------------------------------------------------------------------
@@ -71,94 +59,123 @@ namespace Emulation
 
 	void FlightRecorder::Reset()
 	{
-		FOUNDATION_ASSERT(m_Locked);
-
-		m_TopIndex = 0;
-		m_RecordedFrameCount = 0;
-
-		for (unsigned int i = 0; i < m_FrameCapacity; ++i)
-			m_Frames[i].Reset();
+		m_FirstRecordIndex.store(m_RecordCount.load(std::memory_order_acquire), std::memory_order_release);
 	}
 
 	//------------------------------------------------------------------------------------------------
 
-	void FlightRecorder::Record(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend)
+	void FlightRecorder::Record(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend, const std::vector<SIDWrite>& inSIDWrites)
 	{
-		FOUNDATION_ASSERT(m_Locked);
 		FOUNDATION_ASSERT(m_IsRecording);
 
 		if (inMemory != nullptr)
 		{
-			if (m_RecordedFrameCount < m_FrameCapacity)
-			{
-				FOUNDATION_ASSERT(m_TopIndex == 0);
-
-				Frame& frame = m_Frames[m_RecordedFrameCount];
-				RecordFrame(inFrame, inMemory, inCyclesSpend, frame);
+			const unsigned int record_index = m_RecordCount.load(std::memory_order_relaxed);
+			Slot& slot = m_Slots[record_index % m_FrameCapacity];
 
-				m_LastRecordedFrame = frame;
+			const unsigned int sequence = slot.m_Sequence.load(std::memory_order_relaxed);
 
-				m_RecordedFrameCount++;
-			}
-			else
-			{
-				FOUNDATION_ASSERT(m_RecordedFrameCount == m_FrameCapacity);
-				FOUNDATION_ASSERT(m_TopIndex < m_FrameCapacity);
-
-				Frame& frame = m_Frames[m_TopIndex];
-				RecordFrame(inFrame, inMemory, inCyclesSpend, frame);
+			slot.m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
 
-				m_LastRecordedFrame = frame;
-				
-				m_TopIndex++;
+			slot.m_RecordIndex = record_index;
+			RecordFrame(inFrame, inMemory, inCyclesSpend, inSIDWrites, slot.m_Frame);
 
-				if (m_TopIndex >= m_FrameCapacity)
-					m_TopIndex = 0;
-			}
+			slot.m_Sequence.store(sequence + 2, std::memory_order_release);
+			m_RecordCount.store(record_index + 1, std::memory_order_release);
 		}
 	}
 
 	unsigned int FlightRecorder::RecordedFrameCount() const
 	{
-		FOUNDATION_ASSERT(m_Locked);
-		return m_RecordedFrameCount;
+		const unsigned int first_record_index = m_FirstRecordIndex.load(std::memory_order_acquire);
+		const unsigned int record_count = m_RecordCount.load(std::memory_order_acquire);
+
+		return std::min(record_count - first_record_index, m_FrameCapacity);
 	}
 
 	//------------------------------------------------------------------------------------------------
 
-	const FlightRecorder::Frame& FlightRecorder::GetFrame(unsigned int inIndex) const
+	unsigned int FlightRecorder::CopyFrames(unsigned int inFirstIndex, unsigned int inCount, Frame* outFrames) const
 	{
-		FOUNDATION_ASSERT(m_Locked);
+		FOUNDATION_ASSERT(outFrames != nullptr || inCount == 0);
 
-		inIndex += m_TopIndex;
+		const unsigned int first_record_index = m_FirstRecordIndex.load(std::memory_order_acquire);
+		const unsigned int record_count = m_RecordCount.load(std::memory_order_acquire);
+		const unsigned int recorded_frame_count = std::min(record_count - first_record_index, m_FrameCapacity);
 
-		if (inIndex >= m_FrameCapacity)
-			inIndex -= m_FrameCapacity;
+		if (inFirstIndex >= recorded_frame_count)
+			return 0;
 
-		FOUNDATION_ASSERT(inIndex >= 0 && inIndex < m_FrameCapacity);
+		const unsigned int oldest_record_index = record_count - recorded_frame_count;
+		const unsigned int copy_count = std::min(inCount, recorded_frame_count - inFirstIndex);
 
-		return m_Frames[inIndex];
+		for (unsigned int i = 0; i < copy_count; ++i)
+		{
+			const unsigned int record_index = oldest_record_index + inFirstIndex + i;
+			const Slot& slot = m_Slots[record_index % m_FrameCapacity];
+
+			for (;;)
+			{
+				const unsigned int sequence = slot.m_Sequence.load(std::memory_order_acquire);
+
+				if ((sequence & 1) == 0)
+				{
+					const unsigned int slot_record_index = slot.m_RecordIndex;
+					outFrames[i] = slot.m_Frame;
+
+					std::atomic_thread_fence(std::memory_order_acquire);
+
+					if (slot.m_Sequence.load(std::memory_order_relaxed) == sequence)
+					{
+						// The recording has passed the frame, while copying the ones before it
+						if (slot_record_index != record_index)
+							return i;
+
+						break;
+					}
+				}
+			}
+		}
+
+		return copy_count;
 	}
 
-	const FlightRecorder::Frame& FlightRecorder::GetNewestFrame() const
+	FlightRecorder::Frame FlightRecorder::GetNewestFrame() const
 	{
-		return m_LastRecordedFrame;	
+		Frame frame;
+
+		const unsigned int recorded_frame_count = RecordedFrameCount();
+
+		if (recorded_frame_count == 0 || CopyFrames(recorded_frame_count - 1, 1, &frame) == 0)
+			frame.Reset();
+
+		return frame;
 	}
 
 	//------------------------------------------------------------------------------------------------
 
-	void FlightRecorder::RecordFrame(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend, Frame& inFrameData)
+	void FlightRecorder::RecordFrame(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend, const std::vector<SIDWrite>& inSIDWrites, Frame& inFrameData)
 	{
-		FOUNDATION_ASSERT(m_Locked);
-
 		inFrameData.m_nFrameNumber = inFrame;
 		inFrameData.m_nCyclesSpend = inCyclesSpend;
 
 		inMemory->GetData(0xd400, &inFrameData.m_SIDData, 0x19);
 
-		inFrameData.m_TempoCounter = (*inMemory)[m_DriverTempoCounterAddress];
+		inFrameData.m_TempoCounter = inMemory->GetByte(m_DriverTempoCounterAddress);
 
 		for (int i = 0; i < 3; ++i)
-			inFrameData.m_DriverSync[i] = (*inMemory)[m_DriverSyncAddress + i];
+			inFrameData.m_DriverSync[i] = inMemory->GetByte(m_DriverSyncAddress + i);
+
+		const size_t write_count = std::min(inSIDWrites.size(), static_cast<size_t>(0xffff));
+		const size_t stored_write_count = std::min(write_count, static_cast<size_t>(Frame::MaxWriteCount));
+
+		inFrameData.m_WriteCount = static_cast<unsigned short>(write_count);
+
+		for (size_t i = 0; i < stored_write_count; ++i)
+		{
+			const SIDWrite& write = inSIDWrites[i];
+			inFrameData.m_Writes[i] = { static_cast<unsigned short>(write.m_iCycle), write.m_ucSIDIndex, write.m_ucReg, write.m_ucValue };
+		}
 	}
 }
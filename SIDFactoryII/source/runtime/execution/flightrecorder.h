@@ -1,33 +1,53 @@
 #pragma once
 
-#include <memory>
+#include "runtime/emulation/sid/sidproxydefines.h"
+#include <atomic>
+#include <vector>
 
 namespace Foundation
 {
 	class IPlatform;
-	class IMutex;
 }
 
 namespace Emulation
 {
 	class CPUMemory;
 
+	// Ring buffer of the frames played by the emulation. Recording is done by the thread running the emulation, while
+	// any other thread can read from it at the same time. Neither side ever waits for the other: every frame is guarded
+	// by a sequence counter, which is odd while the frame is being written, and a reader copying a frame retries if the
+	// counter changed while copying it.
 	class FlightRecorder
 	{
 	public:
 		struct Frame
 		{
+			static const unsigned int MaxWriteCount = 64;
+
+			struct Write
+			{
+				unsigned short m_Cycle;				// Cycle of the frame on which the CPU wrote the register
+				unsigned char m_SIDIndex;
+				unsigned char m_Register;
+				unsigned char m_Value;
+			};
+
 			unsigned int m_nFrameNumber = 0;
 			unsigned int m_nCyclesSpend = 0;
 			unsigned char m_TempoCounter = 0;
 			unsigned char m_DriverSync[3];
 			unsigned char m_SIDData[0x19];
 
+			// Writes to the SID chips in the frame, of which the first MaxWriteCount are stored
+			unsigned short m_WriteCount = 0;
+			Write m_Writes[MaxWriteCount];
+
 			void Reset()
 			{
 				m_nFrameNumber = 0;
 				m_nCyclesSpend = 0;
 				m_TempoCounter = 0;
+				m_WriteCount = 0;
 
 				for (int i = 0; i < 3; ++i)
 					m_DriverSync[i] = 0;
@@ -39,42 +59,49 @@ namespace Emulation
 		FlightRecorder(Foundation::IPlatform* inPlatform, unsigned int inFrameCapacity);
 		~FlightRecorder();
 
-		void Lock();
-		void Unlock();
-
 		void SetDriverSyncReadAddress(unsigned short inDriverSyncReadAddress);
 		void SetDriverTempoCounterReadAddress(unsigned short inDriverTempoCounterReadAddress);
 
 		void SetRecording(bool inRecord);
 		bool IsRecording() const;
 
+		// Can be called from any thread. Frames recorded before the reset are no longer read
 		void Reset();
-		void Record(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend);
 
+		// Must only be called from the thread running the emulation, with the memory locked
+		void Record(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend, const std::vector<SIDWrite>& inSIDWrites);
+
+		// Number of frames that can be read, up to the capacity
 		unsigned int RecordedFrameCount() const;
-		const Frame& GetFrame(unsigned int inIndex) const;
-		const Frame& GetNewestFrame() const;
+
+		// Copies the frames from the index, where index 0 is the oldest recorded frame, and returns the number of frames
+		// copied. This is less than requested if the frames have not been recorded yet
+		unsigned int CopyFrames(unsigned int inFirstIndex, unsigned int inCount, Frame* outFrames) const;
+		Frame GetNewestFrame() const;
 
 		const unsigned int GetCapacity() const { return m_FrameCapacity; }
 
 	private:
-		void RecordFrame(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend, Frame& inFrameData);
+		struct Slot
+		{
+			std::atomic<unsigned int> m_Sequence;
+			unsigned int m_RecordIndex;						// Index of the recorded frame in the slot, counted from the construction
+			Frame m_Frame;
+		};
 
-		std::shared_ptr<Foundation::IMutex> m_Mutex;
+		void RecordFrame(unsigned int inFrame, CPUMemory* inMemory, unsigned int inCyclesSpend, const std::vector<SIDWrite>& inSIDWrites, Frame& inFrameData);
 
-		bool m_IsRecording;
+		std::atomic<bool> m_IsRecording;
 
 		unsigned short m_DriverSyncAddress;
 		unsigned short m_DriverTempoCounterAddress;
 
-		unsigned int m_TopIndex;
-		unsigned int m_RecordedFrameCount;
+		// Record index of the next frame to record, and of the first frame recorded after the last reset
+		std::atomic<unsigned int> m_RecordCount;
+		std::atomic<unsigned int> m_FirstRecordIndex;
 
 		unsigned int m_FrameCapacity;
 
-		bool m_Locked;
-
-		Frame m_LastRecordedFrame;
-		Frame* m_Frames;
+		Slot* m_Slots;
 	};
 }
@@ -0,0 +1,521 @@
+#include "keyframecache.h"
+
+#include "runtime/editor/driver/driver_info.h"
+#include "runtime/emulation/cpuframecapture.h"
+#include "runtime/emulation/cpumemory.h"
+#include "runtime/environmentdefines.h"
+#include "runtime/execution/emulationstate.h"
+
+#include "foundation/base/assert.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace Editor;
+
+namespace Emulation
+{
+	namespace
+	{
+		const unsigned int FrameNotReached = std::numeric_limits<unsigned int>::max();
+
+		const unsigned char DriverStatePlaying = 0x80;
+		const unsigned char DriverStateStopped = 0x40;
+
+		// The cache plays without audio output, so the additional SID chips are clocked on the playthrough thread
+		SIDConfiguration GetMachineConfiguration(const SIDConfiguration& inSIDConfiguration)
+		{
+			SIDConfiguration configuration = inSIDConfiguration;
+			configuration.m_bClockInParallel = false;
+
+			return configuration;
+		}
+	}
+
+
+	KeyframeCache::Machine::Machine(Foundation::IPlatform* inPlatform, const SIDConfiguration& inSIDConfiguration)
+		: m_Memory(std::make_unique<CPUMemory>(0x10000, inPlatform))
+		, m_BaseMemoryVersion(0)
+		, m_SIDProxy(GetMachineConfiguration(inSIDConfiguration))
+	{
+		// Room for more than a frame of samples at the lowest frame rate
+		m_SampleBuffer.resize((inSIDConfiguration.m_nSampleFrequency / 25 + 16) * inSIDConfiguration.m_nOutputChannelCount);
+		m_CPU.SetMemory(m_Memory.get());
+	}
+
+
+	KeyframeCache::Machine::~Machine()
+	{
+	}
+
+
+	//------------------------------------------------------------------------------------------------------------------
+
+
+	KeyframeCache::KeyframeCache(const DriverInfo& inDriverInfo, Foundation::IPlatform* inPlatform)
+		: m_DriverInfo(inDriverInfo)
+		, m_Platform(inPlatform)
+		, m_CyclesPerFrame(EMULATION_CYCLES_PER_FRAME_PAL)
+		, m_TrackCount(inDriverInfo.GetMusicData().m_TrackCount)
+		, m_DataTypes(0x10000, DataType::None)
+		, m_DataIndices(0x10000, 0)
+		, m_IsInitialized(false)
+		, m_SongIndex(0)
+		, m_MaxEventPosition(0)
+		, m_BaseMemoryVersion(0)
+		, m_IsComplete(false)
+		, m_StopThread(false)
+	{
+		const DriverInfo::MusicData& music_data = m_DriverInfo.GetMusicData();
+
+		auto mark_data = [&](unsigned int inAddress, unsigned int inSize, DataType inDataType, unsigned int inIndex)
+		{
+			for (unsigned int address = inAddress; address < inAddress + inSize && address < 0x10000; ++address)
+			{
+				m_DataTypes[address] = inDataType;
+				m_DataIndices[address] = static_cast<unsigned char>(inIndex);
+			}
+		};
+
+		for (const DriverInfo::TableDefinition& table : m_DriverInfo.GetTableDefinitions())
+			mark_data(table.m_Address, table.m_ColumnCount * table.m_RowCount, DataType::Other, 0);
+
+		mark_data(music_data.m_TrackOrderListPointersLowAddress, music_data.m_TrackCount, DataType::Other, 0);
+		mark_data(music_data.m_TrackOrderListPointersHighAddress, music_data.m_TrackCount, DataType::Other, 0);
+		mark_data(music_data.m_SequencePointersLowAddress, music_data.m_SequenceCount, DataType::Other, 0);
+		mark_data(music_data.m_SequencePointersHighAddress, music_data.m_SequenceCount, DataType::Other, 0);
+
+		for (int i = 0; i < m_TrackCount; ++i)
+			mark_data(music_data.m_OrderListTrack1Address + i * music_data.m_OrderListSize, music_data.m_OrderListSize, DataType::OrderList, i);
+
+		for (unsigned int i = 0; i < music_data.m_SequenceCount; ++i)
+			mark_data(music_data.m_Sequence00Address + i * music_data.m_SequenceSize, music_data.m_SequenceSize, DataType::Sequence, i);
+
+		m_SequenceFirstFrames.resize(music_data.m_SequenceCount, FrameNotReached);
+		m_OrderListFirstFrames.resize(m_TrackCount, std::vector<unsigned int>(music_data.m_OrderListSize, FrameNotReached));
+	}
+
+
+	KeyframeCache::~KeyframeCache()
+	{
+		StopPlaythrough();
+	}
+
+
+	void KeyframeCache::Update(const CPUMemory& inMemory, unsigned char inSongIndex, const SIDConfiguration& inSIDConfiguration, int inMaxEventPosition)
+	{
+		const DriverInfo::DriverCommon& driver_common = m_DriverInfo.GetDriverCommon();
+
+		// Event positions are counted from the tempo counter and the state of the driver
+		if (driver_common.m_TempoCounterAddress == 0 || driver_common.m_DriverStateAddress == 0)
+			return;
+
+		FOUNDATION_ASSERT(inMemory.GetSize() == 0x10000);
+
+		StopPlaythrough();
+
+		const bool is_same_playthrough = m_IsInitialized && inSongIndex == m_SongIndex && inSIDConfiguration == m_SIDConfiguration;
+
+		if (!is_same_playthrough)
+		{
+			m_BaseMemory.resize(inMemory.GetSize());
+			inMemory.GetData(0, m_BaseMemory.data(), inMemory.GetSize());
+			++m_BaseMemoryVersion;
+
+			m_SongIndex = inSongIndex;
+			m_SIDConfiguration = inSIDConfiguration;
+			m_CyclesPerFrame = inSIDConfiguration.m_eEnvironment == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_FRAME_PAL : EMULATION_CYCLES_PER_FRAME_NTSC;
+			m_MaxEventPosition = inMaxEventPosition;
+			m_IsInitialized = true;
+
+			Truncate(0);
+		}
+		else
+		{
+			unsigned int frame_index = GetFirstFrameReadingChangedData(inMemory);
+
+			// A new length of the song moves the point where the playthrough wraps around
+			if (inMaxEventPosition != m_MaxEventPosition)
+			{
+				const size_t event_position = static_cast<size_t>(std::max(0, std::min(inMaxEventPosition, m_MaxEventPosition)));
+				const unsigned int wrap_frame_index = event_position < m_EventFrames.size() ? m_EventFrames[event_position] : (m_EventFrames.empty() ? 0 : m_EventFrames.back());
+
+				frame_index = std::min(frame_index, wrap_frame_index);
+				m_MaxEventPosition = inMaxEventPosition;
+			}
+
+			if (frame_index != FrameNotReached)
+			{
+				std::vector<unsigned char> memory(inMemory.GetSize());
+				inMemory.GetData(0, memory.data(), inMemory.GetSize());
+
+				for (size_t i = 0; i < memory.size(); ++i)
+				{
+					if (m_DataTypes[i] != DataType::None)
+						m_BaseMemory[i] = memory[i];
+				}
+
+				++m_BaseMemoryVersion;
+
+				Truncate(frame_index);
+			}
+		}
+
+		// Play with all channels audible, muting is applied to the playback itself
+		for (int i = 0; i < m_TrackCount; ++i)
+			m_BaseMemory[driver_common.m_SIDChannelOffsetAddress + i] = static_cast<unsigned char>(i * 7);
+
+		if (!m_IsComplete)
+			StartPlaythrough();
+	}
+
+
+	std::shared_ptr<const EmulationState> KeyframeCache::Seek(int inEventPosition, unsigned int& outFrameCount)
+	{
+		if (!m_IsInitialized || inEventPosition < 0)
+			return nullptr;
+
+		std::shared_ptr<const Keyframe> keyframe;
+		unsigned int frame_index = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			if (static_cast<size_t>(inEventPosition) >= m_EventFrames.size())
+				return nullptr;
+
+			frame_index = m_EventFrames[inEventPosition];
+
+			// Starting at the first frame is the same as a regular start of the song
+			if (frame_index == 0)
+				return nullptr;
+
+			for (auto it = m_Keyframes.rbegin(); it != m_Keyframes.rend(); ++it)
+			{
+				if ((*it)->m_FrameIndex <= frame_index)
+				{
+					keyframe = *it;
+					break;
+				}
+			}
+		}
+
+		// The first keyframe is the state before init, which a seek can not start from, as it only plays the update
+		if (keyframe == nullptr || keyframe->m_FrameIndex == 0)
+			return nullptr;
+
+		// The frames from the keyframe on are played by the seek of the execution handler, which clocks the SID chips
+		// silently on the emulation thread
+		std::shared_ptr<EmulationState> state = std::make_shared<EmulationState>();
+
+		state->m_FrameIndex = keyframe->m_FrameIndex;
+		state->m_EventPosition = keyframe->m_EventPosition;
+		state->m_Memory = m_BaseMemory;
+
+		for (const auto& delta : keyframe->m_MemoryDelta)
+			state->m_Memory[delta.first] = delta.second;
+
+		state->m_CPURegisters = keyframe->m_CPURegisters;
+		state->m_SIDSnapshot = keyframe->m_SIDSnapshot;
+
+		outFrameCount = frame_index - keyframe->m_FrameIndex;
+
+		return state;
+	}
+
+
+	void KeyframeCache::StartPlaythrough()
+	{
+		FOUNDATION_ASSERT(!m_Thread.joinable());
+
+		m_StopThread = false;
+		m_Thread = std::thread(&KeyframeCache::Playthrough, this);
+	}
+
+
+	void KeyframeCache::StopPlaythrough()
+	{
+		if (m_Thread.joinable())
+		{
+			m_StopThread = true;
+			m_Thread.join();
+		}
+	}
+
+
+	void KeyframeCache::Playthrough()
+	{
+		const DriverInfo::DriverCommon& driver_common = m_DriverInfo.GetDriverCommon();
+
+		Machine machine(m_Platform, m_SIDConfiguration);
+		const CPUMemory& memory = *machine.m_Memory;
+
+		std::shared_ptr<const Keyframe> keyframe;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			if (!m_Keyframes.empty())
+				keyframe = m_Keyframes.back();
+		}
+
+		unsigned int frame_index = 0;
+		int event_position = -1;
+		std::vector<unsigned int> order_list_reach_counts(m_TrackCount, 0);
+
+		machine.m_Memory->Lock();
+
+		if (keyframe != nullptr)
+		{
+			RestoreKeyframe(*keyframe, machine);
+
+			frame_index = keyframe->m_FrameIndex;
+			event_position = keyframe->m_EventPosition;
+			order_list_reach_counts = keyframe->m_OrderListReachCounts;
+		}
+		else
+			RestoreBaseMemory(machine);
+
+		bool is_complete = false;
+
+		while (!is_complete && !m_StopThread)
+		{
+			if (frame_index % KeyframeInterval == 0 && (keyframe == nullptr || keyframe->m_FrameIndex < frame_index))
+			{
+				keyframe = CreateKeyframe(frame_index, event_position, order_list_reach_counts, machine);
+
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Keyframes.push_back(keyframe);
+			}
+
+			// An update that does not return within a frame ends the playthrough, as it stops the playback
+			if (!PlayFrame(frame_index, machine))
+				break;
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			for (int i = 0; i < m_TrackCount; ++i)
+			{
+				const unsigned char sequence_index = memory[driver_common.m_CurrentSequenceAddress + i];
+
+				if (sequence_index < m_SequenceFirstFrames.size() && m_SequenceFirstFrames[sequence_index] == FrameNotReached)
+					m_SequenceFirstFrames[sequence_index] = frame_index;
+
+				// The driver reads the order list up to its index
+				std::vector<unsigned int>& order_list_first_frames = m_OrderListFirstFrames[i];
+				const unsigned int order_list_index = memory[driver_common.m_OrderListIndexAddress + i];
+
+				unsigned int& reach_count = order_list_reach_counts[i];
+
+				while (reach_count <= order_list_index && reach_count < order_list_first_frames.size())
+					order_list_first_frames[reach_count++] = frame_index;
+			}
+
+			// Counted as the event position of the tracks view counts it during playback
+			const unsigned char driver_state = memory[driver_common.m_DriverStateAddress];
+
+			if (driver_state == DriverStatePlaying && memory[driver_common.m_TempoCounterAddress] == 0)
+			{
+				++event_position;
+
+				if (event_position >= m_MaxEventPosition)
+					is_complete = true;
+				else
+				{
+					FOUNDATION_ASSERT(m_EventFrames.size() == static_cast<size_t>(event_position));
+					m_EventFrames.push_back(frame_index);
+				}
+			}
+			else if (driver_state == DriverStateStopped)
+				is_complete = true;
+
+			++frame_index;
+
+			if (frame_index >= MaxFrameCount)
+				is_complete = true;
+		}
+
+		machine.m_Memory->Unlock();
+
+		if (!m_StopThread)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsComplete = true;
+		}
+	}
+
+
+	unsigned int KeyframeCache::GetFirstFrameReadingChangedData(const CPUMemory& inMemory) const
+	{
+		const DriverInfo::MusicData& music_data = m_DriverInfo.GetMusicData();
+
+		std::vector<unsigned char> memory(inMemory.GetSize());
+		inMemory.GetData(0, memory.data(), inMemory.GetSize());
+
+		unsigned int first_frame_index = FrameNotReached;
+
+		for (size_t i = 0; i < memory.size(); ++i)
+		{
+			if (m_DataTypes[i] == DataType::None || memory[i] == m_BaseMemory[i])
+				continue;
+
+			const unsigned char data_index = m_DataIndices[i];
+
+			switch (m_DataTypes[i])
+			{
+			case DataType::Sequence:
+				first_frame_index = std::min(first_frame_index, m_SequenceFirstFrames[data_index]);
+				break;
+			case DataType::OrderList:
+			{
+				const size_t offset = i - (music_data.m_OrderListTrack1Address + data_index * music_data.m_OrderListSize);
+				first_frame_index = std::min(first_frame_index, m_OrderListFirstFrames[data_index][offset]);
+			}
+			break;
+			default:
+				// Tables and pointers may be read at any time
+				return 0;
+			}
+		}
+
+		// The driver reads the next event of a sequence ahead of playing it
+		if (first_frame_index == FrameNotReached || first_frame_index == 0)
+			return first_frame_index;
+
+		return first_frame_index - 1;
+	}
+
+
+	void KeyframeCache::Truncate(unsigned int inFrameIndex)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		while (!m_Keyframes.empty() && m_Keyframes.back()->m_FrameIndex > inFrameIndex)
+			m_Keyframes.pop_back();
+
+		// Everything recorded from the last keyframe on is recorded again, when the playthrough continues from it
+		const unsigned int frame_index = m_Keyframes.empty() ? 0 : m_Keyframes.back()->m_FrameIndex;
+
+		while (!m_EventFrames.empty() && m_EventFrames.back() >= frame_index)
+			m_EventFrames.pop_back();
+
+		for (unsigned int& first_frame_index : m_SequenceFirstFrames)
+		{
+			if (first_frame_index != FrameNotReached && first_frame_index >= frame_index)
+				first_frame_index = FrameNotReached;
+		}
+
+		for (std::vector<unsigned int>& order_list_first_frames : m_OrderListFirstFrames)
+		{
+			for (unsigned int& first_frame_index : order_list_first_frames)
+			{
+				if (first_frame_index != FrameNotReached && first_frame_index >= frame_index)
+					first_frame_index = FrameNotReached;
+			}
+		}
+
+		m_IsComplete = false;
+	}
+
+
+	void KeyframeCache::RestoreBaseMemory(Machine& inMachine) const
+	{
+		CPUMemory& memory = *inMachine.m_Memory;
+
+		// While the base memory is unchanged, only the pages written since it was restored the last time are copied
+		if (inMachine.m_BaseSnapshot != nullptr && inMachine.m_BaseMemoryVersion == m_BaseMemoryVersion)
+			memory.RestoreSnapshot(*inMachine.m_BaseSnapshot);
+		else
+		{
+			memory.SetData(0, m_BaseMemory.data(), static_cast<unsigned int>(m_BaseMemory.size()));
+
+			inMachine.m_BaseSnapshot = memory.CreateSnapshot();
+			inMachine.m_BaseMemoryVersion = m_BaseMemoryVersion;
+		}
+	}
+
+
+	void KeyframeCache::RestoreKeyframe(const Keyframe& inKeyframe, Machine& inMachine) const
+	{
+		CPUMemory& memory = *inMachine.m_Memory;
+
+		RestoreBaseMemory(inMachine);
+
+		for (const auto& delta : inKeyframe.m_MemoryDelta)
+			memory[delta.first] = delta.second;
+
+		inMachine.m_CPU.SetRegisters(inKeyframe.m_CPURegisters);
+
+		const bool is_restored = inMachine.m_SIDProxy.RestoreSnapshot(inKeyframe.m_SIDSnapshot);
+		FOUNDATION_ASSERT(is_restored);
+		(void)is_restored;
+	}
+
+
+	std::shared_ptr<const KeyframeCache::Keyframe> KeyframeCache::CreateKeyframe(unsigned int inFrameIndex, int inEventPosition, const std::vector<unsigned int>& inOrderListReachCounts, const Machine& inMachine) const
+	{
+		std::shared_ptr<Keyframe> keyframe = std::make_shared<Keyframe>();
+
+		keyframe->m_FrameIndex = inFrameIndex;
+		keyframe->m_EventPosition = inEventPosition;
+		keyframe->m_OrderListReachCounts = inOrderListReachCounts;
+
+		// The music data is taken from the base memory when restoring, so it can change without affecting the keyframe.
+		// Only the pages written since the base memory was restored can differ from it
+		const CPUMemory& memory = *inMachine.m_Memory;
+
+		for (unsigned int page : memory.GetPagesChangedSince(*inMachine.m_BaseSnapshot))
+		{
+			const unsigned int page_address = page * CPUMemory::PageSize;
+
+			for (unsigned int i = page_address; i < page_address + CPUMemory::PageSize; ++i)
+			{
+				if (m_DataTypes[i] == DataType::None && memory[i] != m_BaseMemory[i])
+					keyframe->m_MemoryDelta.push_back({ static_cast<unsigned short>(i), memory[i] });
+			}
+		}
+
+		keyframe->m_CPURegisters = inMachine.m_CPU.GetRegisters();
+		inMachine.m_SIDProxy.SaveSnapshot(keyframe->m_SIDSnapshot);
+
+		return keyframe;
+	}
+
+
+	bool KeyframeCache::PlayFrame(unsigned int inFrameIndex, Machine& inMachine) const
+	{
+		const DriverInfo::DriverCommon& driver_common = m_DriverInfo.GetDriverCommon();
+		SIDProxy& sid_proxy = inMachine.m_SIDProxy;
+
+		const unsigned short first_sid_address = sid_proxy.GetSIDAddress(0);
+		CPUFrameCapture frame_capture(&inMachine.m_CPU, first_sid_address, first_sid_address + 0x18, m_CyclesPerFrame);
+
+		for (int i = 1; i < sid_proxy.GetSIDCount(); ++i)
+			frame_capture.AddCaptureRange(sid_proxy.GetSIDAddress(i), sid_proxy.GetSIDAddress(i) + 0x18);
+
+		// The song is initialized in the frame of the first update, as the execution handler does when playback starts
+		if (inFrameIndex == 0)
+			frame_capture.Capture(driver_common.m_InitAddress, m_SongIndex);
+
+		if (!frame_capture.IsMaxCycleCountReached())
+			frame_capture.Capture(driver_common.m_UpdateAddress, 0);
+
+		const bool is_within_frame = !frame_capture.IsMaxCycleCountReached();
+
+		inMachine.m_SIDWrites.clear();
+
+		while (frame_capture.HasNext())
+		{
+			const CPUFrameCapture::WriteCapture& capture = frame_capture.GetNext();
+			const int sid_index = sid_proxy.GetSIDIndex(capture.m_usReg);
+
+			FOUNDATION_ASSERT(sid_index >= 0);
+
+			inMachine.m_SIDWrites.push_back({ capture.m_iCycle, static_cast<unsigned char>(sid_index), static_cast<unsigned char>(capture.m_usReg - sid_proxy.GetSIDAddress(sid_index)), capture.m_ucVal });
+		}
+
+		sid_proxy.ClockFrame(inMachine.m_SIDWrites, static_cast<int>(m_CyclesPerFrame), inMachine.m_SampleBuffer.data(), static_cast<int>(inMachine.m_SampleBuffer.size()));
+
+		return is_within_frame;
+	}
+}
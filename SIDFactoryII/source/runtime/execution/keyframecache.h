@@ -0,0 +1,136 @@
+#if !defined(__KEYFRAMECACHE_H__)
+#define __KEYFRAMECACHE_H__
+
+#include "runtime/emulation/cpumemory.h"
+#include "runtime/emulation/cpumos6510.h"
+#include "runtime/emulation/sid/sidproxy.h"
+#include "runtime/emulation/sid/sidproxysnapshot.h"
+#include "runtime/emulation/sid/sidproxydefines.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace Foundation
+{
+	class IPlatform;
+}
+
+namespace Editor
+{
+	class DriverInfo;
+}
+
+namespace Emulation
+{
+	struct EmulationState;
+
+	// Plays the selected song from init on a background thread, without audio output, and stores a keyframe of the
+	// emulation state every KeyframeInterval frames. Playback from an event position can then continue from the state
+	// of a full playthrough, by running the frames from the nearest keyframe before it, instead of setting the indices
+	// of the driver after init, which leaves out the instruments, pulse and filter programs and the envelopes that are
+	// still sounding at that point.
+	//
+	// When the music data changes, the keyframes before the first frame that reads any of the changed data are kept, and
+	// the playthrough continues from the last of them.
+	class KeyframeCache final
+	{
+	public:
+		static const unsigned int KeyframeInterval = 50;
+		static const unsigned int MaxFrameCount = 50 * 60 * 30;
+
+		KeyframeCache(const Editor::DriverInfo& inDriverInfo, Foundation::IPlatform* inPlatform);
+		~KeyframeCache();
+
+		// Bring the cache up to date with the memory, which must be locked, the song and the configuration of the SID
+		// chips, and continue the playthrough in the background if it has not reached the end of the song
+		void Update(const CPUMemory& inMemory, unsigned char inSongIndex, const SIDConfiguration& inSIDConfiguration, int inMaxEventPosition);
+
+		// The emulation state of the last keyframe before the update that starts the event position, and the number of
+		// frames to seek from it to reach that update, or nullptr if the playthrough has not reached the event position
+		// yet, or it is in the frames before the second keyframe. The state is based on the memory passed to the last
+		// update of the cache
+		std::shared_ptr<const EmulationState> Seek(int inEventPosition, unsigned int& outFrameCount);
+
+	private:
+		enum class DataType : unsigned char
+		{
+			None,
+			Sequence,
+			OrderList,
+			Other
+		};
+
+		struct Keyframe
+		{
+			unsigned int m_FrameIndex;
+			int m_EventPosition;											// Event position after the frames before the keyframe
+			std::vector<unsigned int> m_OrderListReachCounts;				// Number of order list bytes reached by each track
+			std::vector<std::pair<unsigned short, unsigned char>> m_MemoryDelta;	// Bytes outside the music data that differ from the base memory
+			CPUmos6510::Registers m_CPURegisters;
+			SIDProxySnapshot m_SIDSnapshot;
+		};
+
+		// A machine for playing frames, without audio output
+		struct Machine
+		{
+			Machine(Foundation::IPlatform* inPlatform, const SIDConfiguration& inSIDConfiguration);
+			~Machine();
+
+			std::unique_ptr<CPUMemory> m_Memory;
+			std::shared_ptr<const CPUMemory::Snapshot> m_BaseSnapshot;	// Snapshot of the base memory, with the version it was taken from
+			unsigned int m_BaseMemoryVersion;
+			CPUmos6510 m_CPU;
+			SIDProxy m_SIDProxy;
+			std::vector<SIDWrite> m_SIDWrites;
+			std::vector<short> m_SampleBuffer;
+		};
+
+		void StartPlaythrough();
+		void StopPlaythrough();
+		void Playthrough();
+
+		unsigned int GetFirstFrameReadingChangedData(const CPUMemory& inMemory) const;
+		void Truncate(unsigned int inFrameIndex);
+
+		void RestoreBaseMemory(Machine& inMachine) const;
+		void RestoreKeyframe(const Keyframe& inKeyframe, Machine& inMachine) const;
+		std::shared_ptr<const Keyframe> CreateKeyframe(unsigned int inFrameIndex, int inEventPosition, const std::vector<unsigned int>& inOrderListReachCounts, const Machine& inMachine) const;
+
+		// Returns false if the update exceeded the frame
+		bool PlayFrame(unsigned int inFrameIndex, Machine& inMachine) const;
+
+		const Editor::DriverInfo& m_DriverInfo;
+		Foundation::IPlatform* m_Platform;
+
+		unsigned int m_CyclesPerFrame;
+		int m_TrackCount;
+
+		// What kind of music data each address holds, and the index of the sequence or track
+		std::vector<DataType> m_DataTypes;
+		std::vector<unsigned char> m_DataIndices;
+
+		// Set by update, while the playthrough is not running
+		bool m_IsInitialized;
+		unsigned char m_SongIndex;
+		SIDConfiguration m_SIDConfiguration;
+		int m_MaxEventPosition;
+		std::vector<unsigned char> m_BaseMemory;						// Memory before init, with the current music data
+		unsigned int m_BaseMemoryVersion;								// Incremented on every change of the base memory
+
+		// Results of the playthrough
+		std::mutex m_Mutex;
+		std::vector<std::shared_ptr<const Keyframe>> m_Keyframes;
+		std::vector<unsigned int> m_EventFrames;						// The frame in which each event position starts
+		std::vector<unsigned int> m_SequenceFirstFrames;				// The first frame playing each sequence
+		std::vector<std::vector<unsigned int>> m_OrderListFirstFrames;	// The first frame after which the order list index of a track reaches each byte
+		bool m_IsComplete;
+
+		std::thread m_Thread;
+		std::atomic<bool> m_StopThread;
+	};
+}
+
+#endif //__KEYFRAMECACHE_H__
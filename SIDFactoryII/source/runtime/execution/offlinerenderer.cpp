@@ -0,0 +1,237 @@
+#include "offlinerenderer.h"
+
+#include "runtime/editor/auxilarydata/auxilary_data_collection.h"
+#include "runtime/editor/auxilarydata/auxilary_data_hardware_preferences.h"
+#include "runtime/editor/auxilarydata/auxilary_data_songs.h"
+#include "runtime/editor/driver/driver_info.h"
+#include "runtime/emulation/cpumemory.h"
+#include "runtime/emulation/cpumos6510.h"
+#include "runtime/emulation/sid/sidproxy.h"
+#include "runtime/execution/executionhandler.h"
+
+#include "foundation/base/assert.h"
+#include "foundation/platform/iplatform.h"
+
+#include "utils/c64file.h"
+#include "utils/global.h"
+#include "utils/utilities.h"
+
+using namespace Editor;
+using namespace Utility;
+
+namespace Emulation
+{
+	OfflineRenderer::OfflineRenderer(const SIDConfiguration& inSIDConfiguration)
+		: m_HasModelOverride(false)
+		, m_HasEnvironmentOverride(false)
+		, m_ModelOverride(SID_MODEL_6581)
+		, m_EnvironmentOverride(SID_ENVIRONMENT_PAL)
+		, m_DriverStopped(false)
+	{
+		m_SIDProxy = new SIDProxy(inSIDConfiguration);
+		m_Memory = new CPUMemory(0x10000, &Global::instance().GetPlatform());
+		m_CPU = new CPUmos6510();
+		m_ExecutionHandler = new ExecutionHandler(m_CPU, m_Memory, m_SIDProxy, nullptr);
+	}
+
+	OfflineRenderer::~OfflineRenderer()
+	{
+		delete m_ExecutionHandler;
+		delete m_SIDProxy;
+		delete m_CPU;
+		delete m_Memory;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool OfflineRenderer::Load(const std::string& inPathAndFilename)
+	{
+		m_C64File = nullptr;
+		m_DriverInfo = nullptr;
+
+		void* data = nullptr;
+		long data_size = 0;
+
+		if (!ReadFile(inPathAndFilename, 0x10000, &data, data_size))
+			return false;
+
+		std::shared_ptr<C64File> c64_file = data_size > 2 ? C64File::CreateFromPRGData(data, static_cast<unsigned int>(data_size)) : nullptr;
+		delete[] static_cast<char*>(data);
+
+		if (c64_file == nullptr)
+			return false;
+
+		std::shared_ptr<DriverInfo> driver_info = std::make_shared<DriverInfo>();
+		driver_info->Parse(*c64_file);
+
+		if (!driver_info->IsValid())
+			return false;
+
+		m_C64File = c64_file;
+		m_DriverInfo = driver_info;
+
+		const DriverInfo::DriverCommon& driver_common = m_DriverInfo->GetDriverCommon();
+
+		m_ExecutionHandler->SetInitVector(driver_common.m_InitAddress);
+		m_ExecutionHandler->SetStopVector(driver_common.m_StopAddress);
+		m_ExecutionHandler->SetUpdateVector(driver_common.m_UpdateAddress);
+
+		return true;
+	}
+
+	bool OfflineRenderer::IsLoaded() const
+	{
+		return m_DriverInfo != nullptr;
+	}
+
+	const DriverInfo& OfflineRenderer::GetDriverInfo() const
+	{
+		FOUNDATION_ASSERT(m_DriverInfo != nullptr);
+		return *m_DriverInfo;
+	}
+
+	unsigned char OfflineRenderer::GetSongCount() const
+	{
+		return GetDriverInfo().GetAuxilaryDataCollection().GetSongs().GetSongCount();
+	}
+
+	unsigned char OfflineRenderer::GetSelectedSong() const
+	{
+		return GetDriverInfo().GetAuxilaryDataCollection().GetSongs().GetSelectedSong();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void OfflineRenderer::OverrideModel(SIDModel inModel)
+	{
+		m_HasModelOverride = true;
+		m_ModelOverride = inModel;
+	}
+
+	void OfflineRenderer::OverrideEnvironment(SIDEnvironment inEnvironment)
+	{
+		m_HasEnvironmentOverride = true;
+		m_EnvironmentOverride = inEnvironment;
+	}
+
+	SIDModel OfflineRenderer::GetModel() const
+	{
+		if (m_HasModelOverride)
+			return m_ModelOverride;
+
+		const auto& hardware_preferences = GetDriverInfo().GetAuxilaryDataCollection().GetHardwarePreferences();
+		return hardware_preferences.GetSIDModel() == AuxilaryDataHardwarePreferences::SIDModel::MOS6581 ? SID_MODEL_6581 : SID_MODEL_8580;
+	}
+
+	SIDEnvironment OfflineRenderer::GetEnvironment() const
+	{
+		if (m_HasEnvironmentOverride)
+			return m_EnvironmentOverride;
+
+		const auto& hardware_preferences = GetDriverInfo().GetAuxilaryDataCollection().GetHardwarePreferences();
+		return hardware_preferences.GetRegion() == AuxilaryDataHardwarePreferences::Region::PAL ? SID_ENVIRONMENT_PAL : SID_ENVIRONMENT_NTSC;
+	}
+
+	int OfflineRenderer::GetSampleFrequency() const
+	{
+		return m_SIDProxy->GetSampleFrequency();
+	}
+
+	int OfflineRenderer::GetOutputChannelCount() const
+	{
+		return m_SIDProxy->GetOutputChannelCount();
+	}
+
+	int OfflineRenderer::GetSIDCount() const
+	{
+		return m_SIDProxy->GetSIDCount();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void OfflineRenderer::Start(unsigned char inSongIndex, unsigned int inSkipFrameCount)
+	{
+		FOUNDATION_ASSERT(IsLoaded());
+		FOUNDATION_ASSERT(inSongIndex < GetSongCount());
+
+		m_ExecutionHandler->Stop();
+		m_ExecutionHandler->ClearErrorState();
+
+		RestoreMemory();
+
+		const SIDEnvironment environment = GetEnvironment();
+
+		m_SIDProxy->SetModel(GetModel());
+		m_SIDProxy->SetEnvironment(environment);
+		m_SIDProxy->ApplySettings();
+
+		m_ExecutionHandler->SetPAL(environment == SID_ENVIRONMENT_PAL);
+
+		// Watch the driver state, so that songs ending on a stop command can be detected
+		const unsigned short driver_state_address = m_DriverInfo->GetDriverCommon().m_DriverStateAddress;
+
+		m_DriverStopped = false;
+		m_ExecutionHandler->SetPostUpdateCallback([this, driver_state_address](CPUMemory* inCPUMemory)
+		{
+			if (driver_state_address != 0 && inCPUMemory->GetByte(driver_state_address) == 0x40)
+				m_DriverStopped = true;
+		});
+
+		m_ExecutionHandler->Start();
+		m_ExecutionHandler->SetEnableUpdate(true);
+		m_ExecutionHandler->QueueInit(inSongIndex);
+
+		if (inSkipFrameCount > 0)
+			m_ExecutionHandler->QueueSeek(inSkipFrameCount, [this](CPUMemory*) { return m_DriverStopped; });
+	}
+
+	void OfflineRenderer::Render(short* outBuffer, unsigned int inSampleCount)
+	{
+		FOUNDATION_ASSERT(m_ExecutionHandler->IsStarted());
+		m_ExecutionHandler->RenderPCM(outBuffer, inSampleCount * m_SIDProxy->GetOutputChannelCount() * sizeof(short));
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool OfflineRenderer::HasDriverStopped() const
+	{
+		return m_DriverStopped;
+	}
+
+	bool OfflineRenderer::IsInErrorState() const
+	{
+		return m_ExecutionHandler->IsInErrorState();
+	}
+
+	std::string OfflineRenderer::GetErrorMessage() const
+	{
+		return m_ExecutionHandler->GetErrorMessage();
+	}
+
+	ExecutionHandler& OfflineRenderer::GetExecutionHandler() const
+	{
+		return *m_ExecutionHandler;
+	}
+
+	CPUMemory& OfflineRenderer::GetMemory() const
+	{
+		return *m_Memory;
+	}
+
+	SIDProxy& OfflineRenderer::GetSIDProxy() const
+	{
+		return *m_SIDProxy;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void OfflineRenderer::RestoreMemory()
+	{
+		FOUNDATION_ASSERT(m_C64File != nullptr);
+
+		m_Memory->Lock();
+		m_Memory->Clear();
+		m_Memory->SetData(m_C64File->GetTopAddress(), m_C64File->GetData(), m_C64File->GetDataSize());
+		m_Memory->Unlock();
+	}
+}
@@ -0,0 +1,88 @@
+#if !defined(__OFFLINERENDERER_H__)
+#define __OFFLINERENDERER_H__
+
+#include "runtime/emulation/sid/sidproxydefines.h"
+#include <memory>
+#include <string>
+
+namespace Utility
+{
+	class C64File;
+}
+
+namespace Editor
+{
+	class DriverInfo;
+}
+
+namespace Emulation
+{
+	class CPUmos6510;
+	class CPUMemory;
+	class SIDProxy;
+	class ExecutionHandler;
+
+	// Runs a driver and its music data without an audio device or a user interface attached. The emulation
+	// is clocked on the calling thread, as fast as the host allows.
+	class OfflineRenderer final
+	{
+	public:
+		OfflineRenderer(const SIDConfiguration& inSIDConfiguration);
+		~OfflineRenderer();
+
+		// Load an sf2 file, returns false if the file could not be read or is not a valid sf2 file
+		bool Load(const std::string& inPathAndFilename);
+		bool IsLoaded() const;
+
+		const Editor::DriverInfo& GetDriverInfo() const;
+
+		unsigned char GetSongCount() const;
+		unsigned char GetSelectedSong() const;
+
+		// Hardware settings. By default the settings stored in the hardware preferences of the loaded file are used
+		void OverrideModel(SIDModel inModel);
+		void OverrideEnvironment(SIDEnvironment inEnvironment);
+
+		SIDModel GetModel() const;
+		SIDEnvironment GetEnvironment() const;
+		int GetSampleFrequency() const;
+		int GetOutputChannelCount() const;
+		int GetSIDCount() const;
+
+		// Restore the loaded data to memory and initialize the song at the given index. Skipped frames are played
+		// without audio output before the first rendered sample
+		void Start(unsigned char inSongIndex, unsigned int inSkipFrameCount = 0);
+
+		// Render the next samples of the song. With more than one output channel, the buffer receives a value for each
+		// channel per sample, interleaved
+		void Render(short* outBuffer, unsigned int inSampleCount);
+
+		bool HasDriverStopped() const;
+		bool IsInErrorState() const;
+		std::string GetErrorMessage() const;
+
+		ExecutionHandler& GetExecutionHandler() const;
+		CPUMemory& GetMemory() const;
+		SIDProxy& GetSIDProxy() const;
+
+	private:
+		void RestoreMemory();
+
+		std::shared_ptr<Utility::C64File> m_C64File;
+		std::shared_ptr<Editor::DriverInfo> m_DriverInfo;
+
+		bool m_HasModelOverride;
+		bool m_HasEnvironmentOverride;
+		SIDModel m_ModelOverride;
+		SIDEnvironment m_EnvironmentOverride;
+
+		bool m_DriverStopped;
+
+		CPUmos6510* m_CPU;
+		CPUMemory* m_Memory;
+		SIDProxy* m_SIDProxy;
+		ExecutionHandler* m_ExecutionHandler;
+	};
+}
+
+#endif //__OFFLINERENDERER_H__
@@ -0,0 +1,339 @@
+#include "rastertimeanalyzer.h"
+
+#include "runtime/editor/auxilarydata/auxilary_data_collection.h"
+#include "runtime/editor/auxilarydata/auxilary_data_hardware_preferences.h"
+#include "runtime/editor/auxilarydata/auxilary_data_songs.h"
+#include "runtime/editor/driver/driver_info.h"
+#include "runtime/emulation/cpuframecapture.h"
+#include "runtime/emulation/cpumemory.h"
+#include "runtime/emulation/cpumos6510.h"
+#include "runtime/environmentdefines.h"
+
+#include "foundation/base/assert.h"
+
+#include "utils/c64file.h"
+#include "utils/global.h"
+#include "utils/utilities.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace Editor;
+using namespace Utility;
+
+namespace Emulation
+{
+	namespace
+	{
+		// The order list of a track, as the driver sees it after init
+		struct OrderListLayout
+		{
+			bool m_Loops = false;							// Ends with a loop marker, otherwise with an end marker
+			unsigned int m_LoopEntry = 0;					// Entry the driver continues from, after the last entry
+			std::vector<unsigned char> m_SequenceOffsets;	// Byte offset of each entry
+		};
+
+		OrderListLayout GetOrderListLayout(const CPUMemory& inMemory, unsigned short inAddress)
+		{
+			OrderListLayout layout;
+
+			for (unsigned int i = 0; i < 0xff; ++i)
+			{
+				const unsigned char value = inMemory[inAddress + i];
+
+				if (value >= 0xfe)
+				{
+					const unsigned char loop_offset = inMemory[inAddress + i + 1];
+
+					layout.m_Loops = value == 0xff;
+					layout.m_LoopEntry = static_cast<unsigned int>(std::count_if(layout.m_SequenceOffsets.begin(), layout.m_SequenceOffsets.end(), [loop_offset](unsigned char inOffset) { return inOffset < loop_offset; }));
+					break;
+				}
+
+				if (value < 0x80)
+					layout.m_SequenceOffsets.push_back(static_cast<unsigned char>(i));
+			}
+
+			return layout;
+		}
+
+		// The entry playing after a number of sequences have been started, following the loop
+		unsigned char GetOrderListEntry(const OrderListLayout& inLayout, unsigned int inSequenceStartCount)
+		{
+			const unsigned int entry_count = static_cast<unsigned int>(inLayout.m_SequenceOffsets.size());
+
+			if (inSequenceStartCount == 0 || entry_count == 0)
+				return 0;
+
+			const unsigned int entry = inSequenceStartCount - 1;
+
+			if (entry < entry_count || !inLayout.m_Loops || inLayout.m_LoopEntry >= entry_count)
+				return static_cast<unsigned char>(std::min(entry, entry_count - 1));
+
+			return static_cast<unsigned char>(inLayout.m_LoopEntry + (entry - entry_count) % (entry_count - inLayout.m_LoopEntry));
+		}
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	RasterTimeAnalyzer::RasterTimeAnalyzer()
+		: m_HasEnvironmentOverride(false)
+		, m_EnvironmentOverride(SID_ENVIRONMENT_PAL)
+		, m_MaxFrameCount(50 * 60 * 30)
+		, m_ThreadCount(0)
+		, m_WorstFrameCount(8)
+	{
+	}
+
+	RasterTimeAnalyzer::~RasterTimeAnalyzer()
+	{
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool RasterTimeAnalyzer::Load(const std::string& inPathAndFilename)
+	{
+		m_C64File = nullptr;
+		m_DriverInfo = nullptr;
+
+		void* data = nullptr;
+		long data_size = 0;
+
+		if (!ReadFile(inPathAndFilename, 0x10000, &data, data_size))
+			return false;
+
+		std::shared_ptr<C64File> c64_file = data_size > 2 ? C64File::CreateFromPRGData(data, static_cast<unsigned int>(data_size)) : nullptr;
+		delete[] static_cast<char*>(data);
+
+		if (c64_file == nullptr)
+			return false;
+
+		std::shared_ptr<DriverInfo> driver_info = std::make_shared<DriverInfo>();
+		driver_info->Parse(*c64_file);
+
+		if (!driver_info->IsValid())
+			return false;
+
+		m_C64File = c64_file;
+		m_DriverInfo = driver_info;
+
+		return true;
+	}
+
+	bool RasterTimeAnalyzer::IsLoaded() const
+	{
+		return m_DriverInfo != nullptr;
+	}
+
+	const DriverInfo& RasterTimeAnalyzer::GetDriverInfo() const
+	{
+		FOUNDATION_ASSERT(m_DriverInfo != nullptr);
+		return *m_DriverInfo;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void RasterTimeAnalyzer::OverrideEnvironment(SIDEnvironment inEnvironment)
+	{
+		m_HasEnvironmentOverride = true;
+		m_EnvironmentOverride = inEnvironment;
+	}
+
+	SIDEnvironment RasterTimeAnalyzer::GetEnvironment() const
+	{
+		if (m_HasEnvironmentOverride)
+			return m_EnvironmentOverride;
+
+		const auto& hardware_preferences = GetDriverInfo().GetAuxilaryDataCollection().GetHardwarePreferences();
+		return hardware_preferences.GetRegion() == AuxilaryDataHardwarePreferences::Region::PAL ? SID_ENVIRONMENT_PAL : SID_ENVIRONMENT_NTSC;
+	}
+
+	void RasterTimeAnalyzer::SetMaxFrameCount(unsigned int inMaxFrameCount)
+	{
+		m_MaxFrameCount = inMaxFrameCount;
+	}
+
+	void RasterTimeAnalyzer::SetThreadCount(unsigned int inThreadCount)
+	{
+		m_ThreadCount = inThreadCount;
+	}
+
+	void RasterTimeAnalyzer::SetWorstFrameCount(unsigned int inWorstFrameCount)
+	{
+		m_WorstFrameCount = inWorstFrameCount;
+	}
+
+	unsigned int RasterTimeAnalyzer::GetCyclesPerFrame() const
+	{
+		return GetEnvironment() == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_FRAME_PAL : EMULATION_CYCLES_PER_FRAME_NTSC;
+	}
+
+	unsigned int RasterTimeAnalyzer::GetCyclesPerRasterline() const
+	{
+		return GetEnvironment() == SID_ENVIRONMENT_PAL ? EMULATION_CYCLES_PER_SCANLINE_PAL : EMULATION_CYCLES_PER_SCANLINE_NTSC;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	std::vector<RasterTimeAnalyzer::SongResult> RasterTimeAnalyzer::Analyze() const
+	{
+		FOUNDATION_ASSERT(IsLoaded());
+
+		const unsigned int song_count = GetDriverInfo().GetAuxilaryDataCollection().GetSongs().GetSongCount();
+		const unsigned int hardware_thread_count = std::max(std::thread::hardware_concurrency(), 1u);
+		const unsigned int thread_count = std::min(m_ThreadCount > 0 ? m_ThreadCount : hardware_thread_count, song_count);
+
+		std::vector<SongResult> results(song_count);
+		std::atomic<unsigned int> next_song_index(0);
+
+		// Each worker picks the next song not yet taken, and writes only to the result of that song
+		auto worker = [&]()
+		{
+			for (unsigned int song_index = next_song_index++; song_index < song_count; song_index = next_song_index++)
+				results[song_index] = AnalyzeSong(static_cast<unsigned char>(song_index));
+		};
+
+		std::vector<std::thread> threads;
+
+		for (unsigned int i = 1; i < thread_count; ++i)
+			threads.push_back(std::thread(worker));
+
+		worker();
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		return results;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	RasterTimeAnalyzer::SongResult RasterTimeAnalyzer::AnalyzeSong(unsigned char inSongIndex) const
+	{
+		const DriverInfo::DriverCommon& driver_common = GetDriverInfo().GetDriverCommon();
+		const DriverInfo::MusicData& music_data = GetDriverInfo().GetMusicData();
+		const unsigned int cycles_per_frame = GetCyclesPerFrame();
+		const int track_count = std::min(static_cast<int>(music_data.m_TrackCount), MaxTrackCount);
+
+		SongResult result;
+
+		result.m_SongIndex = inSongIndex;
+		result.m_SongName = GetDriverInfo().GetAuxilaryDataCollection().GetSongs().GetSongName(inSongIndex);
+		result.m_HasLooped = false;
+		result.m_HasStopped = false;
+		result.m_HasReachedMaxCycles = false;
+
+		// Every song gets a machine of its own, so that songs can be analyzed in parallel
+		CPUMemory memory(0x10000, &Global::instance().GetPlatform());
+		CPUmos6510 cpu;
+
+		memory.Lock();
+		memory.Clear();
+		memory.SetData(m_C64File->GetTopAddress(), m_C64File->GetData(), m_C64File->GetDataSize());
+
+		cpu.SetMemory(&memory);
+
+		{
+			CPUFrameCapture frame_capture(&cpu, 0xd400, 0xd418, cycles_per_frame);
+			frame_capture.Capture(driver_common.m_InitAddress, inSongIndex);
+		}
+
+		// Init selects the order lists of the song
+		OrderListLayout order_lists[MaxTrackCount];
+		TrackPosition previous_positions[MaxTrackCount] = {};		// The driver resets the positions on the first update
+		unsigned int sequence_start_counts[MaxTrackCount] = { 0 };
+
+		for (int i = 0; i < track_count; ++i)
+		{
+			const unsigned short order_list_address = memory.GetByte(music_data.m_TrackOrderListPointersLowAddress + i) | (memory.GetByte(music_data.m_TrackOrderListPointersHighAddress + i) << 8);
+			order_lists[i] = GetOrderListLayout(memory, order_list_address);
+		}
+
+		std::vector<Frame> frames;
+
+		while (frames.size() < m_MaxFrameCount)
+		{
+			CPUFrameCapture frame_capture(&cpu, 0xd400, 0xd418, cycles_per_frame);
+			frame_capture.Capture(driver_common.m_UpdateAddress, 0);
+
+			if (driver_common.m_DriverStateAddress != 0 && memory.GetByte(driver_common.m_DriverStateAddress) == 0x40)
+			{
+				result.m_HasStopped = true;
+				break;
+			}
+
+			Frame frame = {};
+
+			frame.m_FrameIndex = static_cast<unsigned int>(frames.size());
+			frame.m_Cycles = frame_capture.GetCyclesSpend();
+
+			// A sequence starts when the driver reads the next order list entry, or when the only sequence of a loop
+			// is restarted, in which case the order list index does not change but the index into the sequence does.
+			// The track has played all of the order list once the entry at the loop offset starts for the second time.
+			bool has_looped = true;
+
+			for (int i = 0; i < track_count; ++i)
+			{
+				const OrderListLayout& order_list = order_lists[i];
+				TrackPosition& position = frame.m_Tracks[i];
+
+				position.m_OrderListIndex = memory.GetByte(driver_common.m_OrderListIndexAddress + i);
+				position.m_Sequence = memory.GetByte(driver_common.m_CurrentSequenceAddress + i);
+				position.m_SequenceIndex = memory.GetByte(driver_common.m_SequenceIndexAddress + i);
+
+				if (position.m_OrderListIndex != previous_positions[i].m_OrderListIndex || position.m_SequenceIndex < previous_positions[i].m_SequenceIndex)
+					++sequence_start_counts[i];
+
+				position.m_OrderListEntry = GetOrderListEntry(order_list, sequence_start_counts[i]);
+				previous_positions[i] = position;
+
+				const unsigned int entry_count = static_cast<unsigned int>(order_list.m_SequenceOffsets.size());
+				has_looped = has_looped && sequence_start_counts[i] >= (order_list.m_Loops ? entry_count + 1 : entry_count);
+			}
+
+			if (has_looped)
+			{
+				result.m_HasLooped = true;
+				break;
+			}
+
+			frames.push_back(frame);
+
+			if (frame_capture.IsMaxCycleCountReached())
+			{
+				result.m_HasReachedMaxCycles = true;
+				break;
+			}
+		}
+
+		memory.Unlock();
+
+		// Statistics
+		result.m_FrameCount = static_cast<unsigned int>(frames.size());
+		result.m_AverageCycles = 0.0;
+		result.m_PeakFrame = {};
+		result.m_Percentile95Frame = {};
+
+		if (!frames.empty())
+		{
+			unsigned long long total_cycles = 0;
+
+			for (const Frame& frame : frames)
+				total_cycles += frame.m_Cycles;
+
+			result.m_AverageCycles = static_cast<double>(total_cycles) / frames.size();
+
+			// Frames with equal cycles keep their order, so that the first occurrence is reported
+			std::stable_sort(frames.begin(), frames.end(), [](const Frame& inA, const Frame& inB) { return inA.m_Cycles > inB.m_Cycles; });
+
+			const size_t percentile_rank = (frames.size() * 5 + 99) / 100;
+
+			result.m_PeakFrame = frames.front();
+			result.m_Percentile95Frame = frames[percentile_rank > 0 ? percentile_rank - 1 : 0];
+			result.m_WorstFrames.assign(frames.begin(), frames.begin() + std::min<size_t>(m_WorstFrameCount, frames.size()));
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,104 @@
+#if !defined(__RASTERTIMEANALYZER_H__)
+#define __RASTERTIMEANALYZER_H__
+
+#include "runtime/emulation/sid/sidproxydefines.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Utility
+{
+	class C64File;
+}
+
+namespace Editor
+{
+	class DriverInfo;
+}
+
+namespace Emulation
+{
+	// Runs the update of the driver for every frame of every song, from init until all tracks have passed the loop
+	// point of their order list (or the driver stops), and collects the cycles spend per frame. Only the CPU is
+	// emulated, and the songs are analyzed in parallel on worker threads.
+	class RasterTimeAnalyzer final
+	{
+	public:
+		static const int MaxTrackCount = 3;
+
+		struct TrackPosition
+		{
+			unsigned char m_OrderListIndex;		// Byte offset of the next order list entry, as read by the driver
+			unsigned char m_OrderListEntry;		// Entry in the order list of the sequence currently playing
+			unsigned char m_Sequence;
+			unsigned char m_SequenceIndex;		// Byte offset of the next event in the sequence
+		};
+
+		struct Frame
+		{
+			unsigned int m_FrameIndex;
+			unsigned int m_Cycles;
+			TrackPosition m_Tracks[MaxTrackCount];
+		};
+
+		struct SongResult
+		{
+			unsigned char m_SongIndex;
+			std::string m_SongName;
+
+			bool m_HasLooped;					// All tracks passed the loop point of their order list
+			bool m_HasStopped;					// The driver stopped, because all order lists ended
+			bool m_HasReachedMaxCycles;			// An update did not return within a frame
+
+			unsigned int m_FrameCount;
+			double m_AverageCycles;
+
+			Frame m_PeakFrame;
+			Frame m_Percentile95Frame;
+			std::vector<Frame> m_WorstFrames;	// Sorted by cycles, highest first
+		};
+
+		RasterTimeAnalyzer();
+		~RasterTimeAnalyzer();
+
+		// Load an sf2 file, returns false if the file could not be read or is not a valid sf2 file
+		bool Load(const std::string& inPathAndFilename);
+		bool IsLoaded() const;
+
+		const Editor::DriverInfo& GetDriverInfo() const;
+
+		// By default the region stored in the hardware preferences of the loaded file is used
+		void OverrideEnvironment(SIDEnvironment inEnvironment);
+		SIDEnvironment GetEnvironment() const;
+
+		// Songs that do not loop or stop within this number of frames are cut off. Default is 30 minutes of PAL frames
+		void SetMaxFrameCount(unsigned int inMaxFrameCount);
+
+		// Number of worker threads, 0 is the number of hardware threads
+		void SetThreadCount(unsigned int inThreadCount);
+
+		// Number of frames in the worst frames list of each song
+		void SetWorstFrameCount(unsigned int inWorstFrameCount);
+
+		unsigned int GetCyclesPerFrame() const;
+		unsigned int GetCyclesPerRasterline() const;
+
+		// Analyze all songs, the results are sorted by song index
+		std::vector<SongResult> Analyze() const;
+
+	private:
+		SongResult AnalyzeSong(unsigned char inSongIndex) const;
+
+		std::shared_ptr<Utility::C64File> m_C64File;
+		std::shared_ptr<Editor::DriverInfo> m_DriverInfo;
+
+		bool m_HasEnvironmentOverride;
+		SIDEnvironment m_EnvironmentOverride;
+
+		unsigned int m_MaxFrameCount;
+		unsigned int m_ThreadCount;
+		unsigned int m_WorstFrameCount;
+	};
+}
+
+#endif //__RASTERTIMEANALYZER_H__
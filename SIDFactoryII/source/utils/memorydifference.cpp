@@ -0,0 +1,110 @@
+#include "utils/memorydifference.h"
+
+namespace Utility
+{
+	// Each run is the number of unchanged bytes before it, the number of bytes in it and the XOR of the bytes, with the
+	// numbers in groups of 7 bits. Unchanged bytes between changes closer than the size of a run header are in the run
+	static const unsigned int MaxGapInRun = 4;
+
+	void EncodeMemoryDifference(const unsigned char* inData, const unsigned char* inOtherData, unsigned int inSize, std::vector<unsigned char>& outDifference)
+	{
+		EncodeMemoryDifference(inData, inOtherData, { { 0, inSize } }, outDifference);
+	}
+
+
+	void EncodeMemoryDifference(const unsigned char* inData, const unsigned char* inOtherData, const std::vector<std::pair<unsigned int, unsigned int>>& inRanges, std::vector<unsigned char>& outDifference)
+	{
+		auto write_count = [&outDifference](unsigned int inCount)
+		{
+			while (inCount >= 0x80)
+			{
+				outDifference.push_back(static_cast<unsigned char>(0x80 | (inCount & 0x7f)));
+				inCount >>= 7;
+			}
+
+			outDifference.push_back(static_cast<unsigned char>(inCount));
+		};
+
+		outDifference.clear();
+
+		unsigned int position = 0;
+
+		for (const auto& range : inRanges)
+		{
+			const unsigned int range_end = range.second;
+			unsigned int i = range.first > position ? range.first : position;
+
+			while (true)
+			{
+				while (i < range_end && inData[i] == inOtherData[i])
+					++i;
+
+				if (i >= range_end)
+					break;
+
+				const unsigned int run_begin = i;
+				unsigned int run_end = i + 1;
+
+				for (unsigned int j = run_end; j < range_end && j - run_end < MaxGapInRun; ++j)
+				{
+					if (inData[j] != inOtherData[j])
+						run_end = j + 1;
+				}
+
+				write_count(run_begin - position);
+				write_count(run_end - run_begin);
+
+				for (unsigned int j = run_begin; j < run_end; ++j)
+					outDifference.push_back(inData[j] ^ inOtherData[j]);
+
+				position = run_end;
+				i = run_end;
+			}
+		}
+	}
+
+
+	bool ApplyMemoryDifference(const std::vector<unsigned char>& inDifference, unsigned char* ioData, unsigned int inSize)
+	{
+		unsigned int i = 0;
+		unsigned int position = 0;
+
+		auto read_count = [&inDifference, &i](unsigned int& outCount)
+		{
+			outCount = 0;
+
+			for (unsigned int shift = 0; i < inDifference.size() && shift < 32; shift += 7)
+			{
+				const unsigned char value = inDifference[i++];
+				outCount |= static_cast<unsigned int>(value & 0x7f) << shift;
+
+				if ((value & 0x80) == 0)
+					return true;
+			}
+
+			return false;
+		};
+
+		while (i < inDifference.size())
+		{
+			unsigned int skip_count;
+			unsigned int count;
+
+			if (!read_count(skip_count) || !read_count(count))
+				return false;
+
+			if (skip_count > inSize - position || count > inSize - position - skip_count || count > inDifference.size() - i)
+				return false;
+
+			position += skip_count;
+
+			for (unsigned int j = 0; j < count; ++j)
+				ioData[position + j] ^= inDifference[i + j];
+
+			position += count;
+			i += count;
+		}
+
+		return true;
+	}
+}
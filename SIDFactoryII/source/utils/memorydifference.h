@@ -0,0 +1,18 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+namespace Utility
+{
+	// The XOR difference between two blocks of memory of the same size, as runs of changed bytes. Applying it to
+	// either block turns it into the other
+	void EncodeMemoryDifference(const unsigned char* inData, const unsigned char* inOtherData, unsigned int inSize, std::vector<unsigned char>& outDifference);
+
+	// The same, comparing only the ranges of offsets given as the first offset and the offset after the range, in
+	// increasing order. The blocks must be the same outside of them
+	void EncodeMemoryDifference(const unsigned char* inData, const unsigned char* inOtherData, const std::vector<std::pair<unsigned int, unsigned int>>& inRanges, std::vector<unsigned char>& outDifference);
+
+	// Returns false if the difference is damaged or made from larger blocks, in which case the block is partly changed
+	bool ApplyMemoryDifference(const std::vector<unsigned char>& inDifference, unsigned char* ioData, unsigned int inSize);
+}
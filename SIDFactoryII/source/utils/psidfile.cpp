@@ -21,7 +21,9 @@ namespace Utility
 		const std::string& inAuthor,
 		const std::string& inCopyright,
 		const bool in6581,
-		const bool inPAL)
+		const bool inPAL,
+		const unsigned short inSecondSIDAddress,
+		const unsigned short inThirdSIDAddress)
 	{
 		memset(&m_Header, 0, sizeof(Header));
 
@@ -36,7 +38,10 @@ namespace Utility
 		m_Header.m_MagicNumber[2] = 'I';
 		m_Header.m_MagicNumber[3] = 'D';
 
-		m_Header.m_Version = endian_convert(0x02);
+		// Version 3 adds the address of a second SID, and version 4 the address of a third
+		const unsigned short version = inThirdSIDAddress != 0 ? 0x04 : (inSecondSIDAddress != 0 ? 0x03 : 0x02);
+
+		m_Header.m_Version = endian_convert(version);
 		m_Header.m_DataOffset = endian_convert(data_offset);
 		m_Header.m_LoadAddress = 0x0000;
 		m_Header.m_InitAddress = endian_convert(driver_address + inInitOffset);
@@ -49,7 +54,16 @@ namespace Utility
 		CopyString(inAuthor, m_Header.m_Author);
 		CopyString(inCopyright, m_Header.m_Copyright);
 
-		m_Header.m_Flags = endian_convert((in6581 ? 0x10 : 0x20) | (inPAL ? 0x04 : 0x08));
+		// The additional SIDs are of the same model as the first
+		const unsigned short model_flags = in6581 ? 0x01 : 0x02;
+		const unsigned short second_sid_model_flags = inSecondSIDAddress != 0 ? model_flags << 6 : 0;
+		const unsigned short third_sid_model_flags = inThirdSIDAddress != 0 ? model_flags << 8 : 0;
+
+		m_Header.m_Flags = endian_convert((model_flags << 4) | (inPAL ? 0x04 : 0x08) | second_sid_model_flags | third_sid_model_flags);
+
+		// The SID addresses are stored as the middle byte, ie. $42 for $d420
+		m_Header.m_SecondSIDAddress = static_cast<unsigned char>(inSecondSIDAddress >> 4);
+		m_Header.m_ThirdSIDAddress = static_cast<unsigned char>(inThirdSIDAddress >> 4);
 
 		unsigned short header_size = sizeof(Header);
 
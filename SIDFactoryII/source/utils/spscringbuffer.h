@@ -0,0 +1,112 @@
+#pragma once
+
+#include "foundation/base/assert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+namespace Utility
+{
+	// Lock free ring buffer for exactly one producer thread and one consumer thread. The capacity is rounded up
+	// to a power of two. Only trivially copyable types are supported, data is moved in and out with memcpy.
+	template<typename T>
+	class TSPSCRingBuffer
+	{
+	public:
+		TSPSCRingBuffer(unsigned int inCapacity)
+			: m_ReadIndex(0)
+			, m_WriteIndex(0)
+		{
+			unsigned int capacity = 1;
+			while (capacity < inCapacity)
+				capacity <<= 1;
+
+			m_Buffer.resize(capacity);
+			m_Mask = capacity - 1;
+		}
+
+		unsigned int GetCapacity() const
+		{
+			return m_Mask + 1;
+		}
+
+		// Producer side
+
+		unsigned int GetWriteAvailable() const
+		{
+			const unsigned int write_index = m_WriteIndex.load(std::memory_order_relaxed);
+			const unsigned int read_index = m_ReadIndex.load(std::memory_order_acquire);
+
+			return GetCapacity() - (write_index - read_index);
+		}
+
+		// Number of elements written since the buffer was created, wrapping around at the range of an unsigned int
+		unsigned int GetWritePosition() const
+		{
+			return m_WriteIndex.load(std::memory_order_relaxed);
+		}
+
+		// Returns the number of elements written, which is less than requested if the buffer is full
+		unsigned int Write(const T* inData, unsigned int inCount)
+		{
+			const unsigned int write_index = m_WriteIndex.load(std::memory_order_relaxed);
+			const unsigned int count = std::min(inCount, GetWriteAvailable());
+			const unsigned int offset = write_index & m_Mask;
+			const unsigned int first_count = std::min(count, GetCapacity() - offset);
+
+			memcpy(&m_Buffer[offset], inData, first_count * sizeof(T));
+			memcpy(&m_Buffer[0], inData + first_count, (count - first_count) * sizeof(T));
+
+			m_WriteIndex.store(write_index + count, std::memory_order_release);
+
+			return count;
+		}
+
+		// Consumer side
+
+		unsigned int GetReadAvailable() const
+		{
+			const unsigned int read_index = m_ReadIndex.load(std::memory_order_relaxed);
+			const unsigned int write_index = m_WriteIndex.load(std::memory_order_acquire);
+
+			return write_index - read_index;
+		}
+
+		// Number of elements read or discarded since the buffer was created, wrapping like the write position
+		unsigned int GetReadPosition() const
+		{
+			return m_ReadIndex.load(std::memory_order_relaxed);
+		}
+
+		// Returns the number of elements read, which is less than requested if the buffer runs dry
+		unsigned int Read(T* outData, unsigned int inCount)
+		{
+			const unsigned int read_index = m_ReadIndex.load(std::memory_order_relaxed);
+			const unsigned int count = std::min(inCount, GetReadAvailable());
+			const unsigned int offset = read_index & m_Mask;
+			const unsigned int first_count = std::min(count, GetCapacity() - offset);
+
+			memcpy(outData, &m_Buffer[offset], first_count * sizeof(T));
+			memcpy(outData + first_count, &m_Buffer[0], (count - first_count) * sizeof(T));
+
+			m_ReadIndex.store(read_index + count, std::memory_order_release);
+
+			return count;
+		}
+
+		// Drop everything that has been written so far
+		void Discard()
+		{
+			m_ReadIndex.store(m_WriteIndex.load(std::memory_order_acquire), std::memory_order_release);
+		}
+
+	private:
+		std::vector<T> m_Buffer;
+		unsigned int m_Mask;
+
+		std::atomic<unsigned int> m_ReadIndex;
+		std::atomic<unsigned int> m_WriteIndex;
+	};
+}
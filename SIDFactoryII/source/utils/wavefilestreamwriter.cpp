@@ -0,0 +1,157 @@
+#include "wavefilestreamwriter.h"
+#include "foundation/base/assert.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Utility
+{
+	WaveFileStreamWriter::WaveFileStreamWriter(unsigned int inSampleFrequency, unsigned short inChannelCount)
+		: m_WaveFileWriter(inSampleFrequency, inChannelCount)
+		, m_Blocks(BlockSampleCount * BlockCount)
+		, m_HasProducerBlock(false)
+		, m_ProducerBlockIndex(0)
+		, m_ProducerBlockSampleCount(0)
+		, m_DroppedSampleCount(0)
+		, m_QueuedBlockCount(0)
+		, m_StopWriterThread(false)
+		, m_ConsumerBlockIndex(0)
+	{
+	}
+
+	WaveFileStreamWriter::~WaveFileStreamWriter()
+	{
+		Close();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool WaveFileStreamWriter::Open(const std::string& inFileName)
+	{
+		FOUNDATION_ASSERT(!IsOpen());
+
+		if (!m_WaveFileWriter.Open(inFileName))
+			return false;
+
+		m_HasProducerBlock = false;
+		m_ProducerBlockIndex = 0;
+		m_ProducerBlockSampleCount = 0;
+		m_DroppedSampleCount = 0;
+
+		m_QueuedBlockCount = 0;
+		m_StopWriterThread = false;
+		m_ConsumerBlockIndex = 0;
+
+		m_WriterThread = std::thread(&WaveFileStreamWriter::WriterThread, this);
+
+		return true;
+	}
+
+	void WaveFileStreamWriter::Close()
+	{
+		if (!IsOpen())
+			return;
+
+		// Let the writer thread drain the queued blocks and exit
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_StopWriterThread = true;
+		}
+
+		m_BlockQueued.notify_one();
+		m_WriterThread.join();
+
+		// Write what is left in the partially filled block and patch the header
+		if (m_HasProducerBlock && m_ProducerBlockSampleCount > 0)
+			m_WaveFileWriter.Write(GetBlock(m_ProducerBlockIndex), m_ProducerBlockSampleCount);
+
+		m_HasProducerBlock = false;
+		m_WaveFileWriter.Close();
+	}
+
+	bool WaveFileStreamWriter::IsOpen() const
+	{
+		return m_WaveFileWriter.IsOpen();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void WaveFileStreamWriter::Write(const short* inSamples, unsigned int inSampleCount)
+	{
+		FOUNDATION_ASSERT(IsOpen());
+		FOUNDATION_ASSERT(inSamples != nullptr);
+
+		while (inSampleCount > 0)
+		{
+			if (!m_HasProducerBlock)
+			{
+				// The block following the queued blocks is free, unless all of them are queued
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+
+					if (m_QueuedBlockCount == BlockCount)
+					{
+						m_DroppedSampleCount += inSampleCount;
+						return;
+					}
+				}
+
+				m_HasProducerBlock = true;
+				m_ProducerBlockSampleCount = 0;
+			}
+
+			const unsigned int sample_count = std::min(inSampleCount, BlockSampleCount - m_ProducerBlockSampleCount);
+			memcpy(GetBlock(m_ProducerBlockIndex) + m_ProducerBlockSampleCount, inSamples, sample_count * sizeof(short));
+
+			m_ProducerBlockSampleCount += sample_count;
+			inSamples += sample_count;
+			inSampleCount -= sample_count;
+
+			if (m_ProducerBlockSampleCount == BlockSampleCount)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_Mutex);
+					++m_QueuedBlockCount;
+				}
+
+				m_BlockQueued.notify_one();
+
+				m_HasProducerBlock = false;
+				m_ProducerBlockIndex = (m_ProducerBlockIndex + 1) % BlockCount;
+			}
+		}
+	}
+
+	unsigned int WaveFileStreamWriter::GetDroppedSampleCount() const
+	{
+		return m_DroppedSampleCount;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void WaveFileStreamWriter::WriterThread()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+
+		while (true)
+		{
+			m_BlockQueued.wait(lock, [this]() { return m_QueuedBlockCount > 0 || m_StopWriterThread; });
+
+			if (m_QueuedBlockCount == 0)
+				break;
+
+			// The block stays counted as queued until it has been written, so the producer will not reuse it
+			lock.unlock();
+			m_WaveFileWriter.Write(GetBlock(m_ConsumerBlockIndex), BlockSampleCount);
+			lock.lock();
+
+			--m_QueuedBlockCount;
+			m_ConsumerBlockIndex = (m_ConsumerBlockIndex + 1) % BlockCount;
+		}
+	}
+
+	short* WaveFileStreamWriter::GetBlock(unsigned int inBlockIndex)
+	{
+		return &m_Blocks[inBlockIndex * BlockSampleCount];
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "utils/wavefilewriter.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Utility
+{
+	// Streams 16 bit PCM data to a wave file from a dedicated writer thread. Samples are collected in a fixed
+	// number of preallocated blocks, so writing from the audio thread never allocates memory or waits for
+	// file i/o. If the writer thread falls behind and all blocks are in use, samples are dropped and counted.
+	class WaveFileStreamWriter final
+	{
+	public:
+		WaveFileStreamWriter(unsigned int inSampleFrequency, unsigned short inChannelCount);
+		~WaveFileStreamWriter();
+
+		bool Open(const std::string& inFileName);
+		void Close();
+		bool IsOpen() const;
+
+		void Write(const short* inSamples, unsigned int inSampleCount);
+
+		unsigned int GetDroppedSampleCount() const;
+
+	private:
+		static const unsigned int BlockSampleCount = 0x4000;
+		static const unsigned int BlockCount = 16;
+
+		void WriterThread();
+
+		short* GetBlock(unsigned int inBlockIndex);
+
+		WaveFileWriter m_WaveFileWriter;
+		std::vector<short> m_Blocks;
+
+		// Producer state, only accessed by the thread calling Write
+		bool m_HasProducerBlock;
+		unsigned int m_ProducerBlockIndex;
+		unsigned int m_ProducerBlockSampleCount;
+		unsigned int m_DroppedSampleCount;
+
+		// Shared state
+		std::mutex m_Mutex;
+		std::condition_variable m_BlockQueued;
+		unsigned int m_QueuedBlockCount;
+		bool m_StopWriterThread;
+
+		// Consumer state, only accessed by the writer thread
+		unsigned int m_ConsumerBlockIndex;
+
+		std::thread m_WriterThread;
+	};
+}
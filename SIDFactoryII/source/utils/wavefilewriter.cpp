@@ -0,0 +1,117 @@
+#include "wavefilewriter.h"
+#include "foundation/base/assert.h"
+
+namespace Utility
+{
+	namespace
+	{
+#pragma pack(push, 1)
+		struct WaveHeader
+		{
+			char m_ChunkID[4];					// 0x00
+			unsigned int m_ChunkSize;			// 0x04
+			char m_Format[4];					// 0x08
+			char m_SubChunk1ID[4];				// 0x0c
+			unsigned int m_SubChunk1Size;		// 0x10
+			unsigned short m_AudioFormat;		// 0x14
+			unsigned short m_ChannelCount;		// 0x16
+			unsigned int m_SampleRate;			// 0x18
+			unsigned int m_ByteRate;			// 0x1c
+			unsigned short m_BlockAlign;		// 0x20
+			unsigned short m_BitsPerSample;		// 0x22
+			char m_SubChunk2ID[4];				// 0x24
+			unsigned int m_SubChunk2Size;		// 0x28
+		};
+#pragma pack(pop)
+	}
+
+	WaveFileWriter::WaveFileWriter(unsigned int inSampleFrequency, unsigned short inChannelCount)
+		: m_SampleFrequency(inSampleFrequency)
+		, m_ChannelCount(inChannelCount)
+		, m_WrittenSampleCount(0)
+		, m_File(nullptr)
+	{
+		FOUNDATION_ASSERT(inChannelCount > 0);
+	}
+
+	WaveFileWriter::~WaveFileWriter()
+	{
+		Close();
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	bool WaveFileWriter::Open(const std::string& inFileName)
+	{
+		FOUNDATION_ASSERT(m_File == nullptr);
+
+		m_File = fopen(inFileName.c_str(), "wb");
+
+		if (m_File == nullptr)
+			return false;
+
+		m_WrittenSampleCount = 0;
+
+		// Write the header with an empty data chunk, the sizes are patched when closing the file
+		WriteHeader(0);
+
+		return true;
+	}
+
+	void WaveFileWriter::Close()
+	{
+		if (m_File != nullptr)
+		{
+			fseek(m_File, 0, SEEK_SET);
+			WriteHeader(m_WrittenSampleCount * sizeof(short));
+
+			fclose(m_File);
+			m_File = nullptr;
+		}
+	}
+
+	bool WaveFileWriter::IsOpen() const
+	{
+		return m_File != nullptr;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void WaveFileWriter::Write(const short* inSamples, unsigned int inSampleCount)
+	{
+		FOUNDATION_ASSERT(m_File != nullptr);
+		FOUNDATION_ASSERT(inSamples != nullptr);
+
+		m_WrittenSampleCount += static_cast<unsigned int>(fwrite(inSamples, sizeof(short), inSampleCount, m_File));
+	}
+
+	unsigned int WaveFileWriter::GetWrittenSampleCount() const
+	{
+		return m_WrittenSampleCount;
+	}
+
+	//------------------------------------------------------------------------------------------------------------
+
+	void WaveFileWriter::WriteHeader(unsigned int inDataByteCount)
+	{
+		const unsigned short block_align = m_ChannelCount * sizeof(short);
+
+		WaveHeader header = {
+			{ 'R', 'I', 'F', 'F' },
+			36 + inDataByteCount,
+			{ 'W', 'A', 'V', 'E' },
+			{ 'f', 'm', 't', ' ' },
+			16,
+			1,
+			m_ChannelCount,
+			m_SampleFrequency,
+			m_SampleFrequency * block_align,
+			block_align,
+			16,
+			{ 'd', 'a', 't', 'a' },
+			inDataByteCount
+		};
+
+		fwrite(&header, sizeof(WaveHeader), 1, m_File);
+	}
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+
+namespace Utility
+{
+	// Writes 16 bit PCM data to a RIFF wave file. The header is written with empty size fields when the file
+	// is opened and patched when the file is closed, so samples can be streamed to disk as they are produced.
+	class WaveFileWriter final
+	{
+	public:
+		WaveFileWriter(unsigned int inSampleFrequency, unsigned short inChannelCount);
+		~WaveFileWriter();
+
+		bool Open(const std::string& inFileName);
+		void Close();
+		bool IsOpen() const;
+
+		void Write(const short* inSamples, unsigned int inSampleCount);
+
+		unsigned int GetWrittenSampleCount() const;
+
+	private:
+		void WriteHeader(unsigned int inDataByteCount);
+
+		unsigned int m_SampleFrequency;
+		unsigned short m_ChannelCount;
+		unsigned int m_WrittenSampleCount;
+
+		FILE* m_File;
+	};
+}